@@ -27,6 +27,7 @@
 
 #include <fstream>
 #include <list>
+#include <algorithm> // find
 #include <cassert>
 #include <stdexcept>
 #include <sstream> // stringstream
@@ -64,6 +65,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/FileDownloader.h"
 #include "Engine/GroupOutput.h"
 #include "Engine/DiskCacheNode.h"
+#include "Engine/ProjectBinarySerialization.h"
 #include "Engine/ProjectSerialization.h"
 #include "Engine/Node.h"
 #include "Engine/NodeSerialization.h"
@@ -169,6 +171,8 @@ public:
     std::list<RenderQueueItem> renderQueue, activeRenders;
     mutable QMutex invalidExprKnobsMutex;
     std::list<KnobIWPtr> invalidExprKnobs;
+    mutable QMutex timeVaryingKnobHoldersMutex;
+    std::list<KnobHolder*> timeVaryingKnobHolders;
 
     ProjectBeingLoadedInfo projectBeingLoaded;
 
@@ -189,6 +193,8 @@ public:
         , activeRenders()
         , invalidExprKnobsMutex()
         , invalidExprKnobs()
+        , timeVaryingKnobHoldersMutex()
+        , timeVaryingKnobHolders()
         , projectBeingLoaded()
     {
     }
@@ -604,10 +610,25 @@ AppInstance::loadInternal(const CLArgs& cl,
             throw std::invalid_argument( tr("%1: No such file.").arg(scriptFilename).toStdString() );
         }
 
+        // Convert the project to another format instead of rendering it
+        const QString& convertProjectPath = cl.getConvertProjectPath();
+        if ( !convertProjectPath.isEmpty() ) {
+            if ( ( info.suffix() != QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) && ( info.suffix() != QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) ) ) {
+                throw std::invalid_argument( tr("--convert only accepts .%1 or .%2 project files.").arg( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ).arg( QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) ).toStdString() );
+            }
+            try {
+                convertProjectFile( shared_from_this(), info.absoluteFilePath().toStdString(), convertProjectPath.toStdString() );
+            } catch (const std::exception& e) {
+                throw std::invalid_argument( tr("Project conversion failed: %1").arg( QString::fromUtf8( e.what() ) ).toStdString() );
+            }
+
+            return;
+        }
+
         std::list<AppInstance::RenderWork> writersWork;
 
 
-        if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
+        if ( ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) || ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) ) ) {
             ///Load the project
             if ( !_imp->_currentProject->loadProject( info.path(), info.fileName() ) ) {
                 throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
@@ -673,7 +694,7 @@ AppInstance::loadInternal(const CLArgs& cl,
         if ( info.exists() ) {
             if ( info.suffix() == QString::fromUtf8("py") ) {
                 loadPythonScript(info);
-            } else if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
+            } else if ( ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) || ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) ) ) {
                 if ( !_imp->_currentProject->loadProject( info.path(), info.fileName() ) ) {
                     throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
                 }
@@ -2334,6 +2355,37 @@ AppInstance::removeInvalidExpressionKnob(const KnobI* knob)
     }
 }
 
+void
+AppInstance::addTimeVaryingKnobHolder(KnobHolder* holder)
+{
+    QMutexLocker k(&_imp->timeVaryingKnobHoldersMutex);
+
+    if ( std::find(_imp->timeVaryingKnobHolders.begin(), _imp->timeVaryingKnobHolders.end(), holder) == _imp->timeVaryingKnobHolders.end() ) {
+        _imp->timeVaryingKnobHolders.push_back(holder);
+    }
+}
+
+void
+AppInstance::removeTimeVaryingKnobHolder(const KnobHolder* holder)
+{
+    QMutexLocker k(&_imp->timeVaryingKnobHoldersMutex);
+
+    for (std::list<KnobHolder*>::iterator it = _imp->timeVaryingKnobHolders.begin(); it != _imp->timeVaryingKnobHolders.end(); ++it) {
+        if (*it == holder) {
+            _imp->timeVaryingKnobHolders.erase(it);
+            break;
+        }
+    }
+}
+
+std::list<KnobHolder*>
+AppInstance::getTimeVaryingKnobHolders() const
+{
+    QMutexLocker k(&_imp->timeVaryingKnobHoldersMutex);
+
+    return _imp->timeVaryingKnobHolders;
+}
+
 void
 AppInstance::recheckInvalidExpressions()
 {
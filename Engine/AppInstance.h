@@ -226,6 +226,15 @@ public:
     {
     }
 
+    /**
+     * @brief Reads the project Gui from inArchive and writes it as-is to outArchive, without applying it.
+     * Used to convert project files (see convertProjectFile). Only Gui apps can do this.
+     **/
+    virtual void copyProjectGui(boost::archive::xml_iarchive & /*inArchive*/,
+                                boost::archive::xml_oarchive & /*outArchive*/) const
+    {
+    }
+
     virtual void setupViewersForViews(const std::vector<std::string>& /*viewNames*/)
     {
     }
@@ -313,6 +322,14 @@ public:
     void removeInvalidExpressionKnob(const KnobI* knob);
     void recheckInvalidExpressions();
 
+    /**
+     * @brief Index of the knob holders that have at least one time-varying knob (see KnobHolder::registerTimeVaryingKnob),
+     * so that a time change only visits these holders. Holders unregister themselves when they are destroyed.
+     **/
+    void addTimeVaryingKnobHolder(KnobHolder* holder);
+    void removeTimeVaryingKnobHolder(const KnobHolder* holder);
+    std::list<KnobHolder*> getTimeVaryingKnobHolders() const WARN_UNUSED_RETURN;
+
     virtual void clearViewersLastRenderedTexture() {}
 
     virtual void toggleAutoHideGraphInputs() {}
@@ -2505,6 +2505,13 @@ AppManager::removeAllCacheEntriesForHolder(const CacheEntryHolder* holder,
     _imp->_viewerCache->removeAllEntriesForHolderPublic(holder, blocking);
 }
 
+void
+AppManager::setImagesPinnedInCacheForHolder(const CacheEntryHolder* holder,
+                                            bool pinned)
+{
+    _imp->_nodeCache->setEntriesPinnedForHolder(holder, pinned);
+}
+
 const QString &
 AppManager::getApplicationBinaryPath() const
 {
@@ -2582,12 +2589,27 @@ AppManager::getCachesTotalMemorySize() const
     return  _imp->_nodeCache->getMemoryCacheSize();
 }
 
+void
+AppManager::notifyRenderBuffersMemoryChanged(std::size_t oldSize,
+                                             std::size_t newSize) const
+{
+    if (_imp->_nodeCache) {
+        _imp->_nodeCache->notifyEntrySizeChanged(oldSize, newSize);
+    }
+}
+
 U64
 AppManager::getCachesTotalDiskSize() const
 {
     return  _imp->_diskCache->getDiskCacheSize() + _imp->_viewerCache->getDiskCacheSize();
 }
 
+U64
+AppManager::getViewerCacheMaximumMemorySize() const
+{
+    return _imp->_viewerCache->getMaximumMemorySize();
+}
+
 CacheSignalEmitterPtr
 AppManager::getOrActivateViewerCacheSignalEmitter() const
 {
@@ -2625,6 +2647,7 @@ AppManager::registerEngineMetaTypes() const
     qRegisterMetaType<RectD>("RectD");
     qRegisterMetaType<RenderStatsPtr>("RenderStatsPtr");
     qRegisterMetaType<RenderStatsMap>("RenderStatsMap");
+    qRegisterMetaType<ParallelRendersDecisionEnum>("ParallelRendersDecisionEnum");
     qRegisterMetaType<ViewIdx>("ViewIdx");
     qRegisterMetaType<ViewSpec>("ViewSpec");
     qRegisterMetaType<NodePtr>("NodePtr");
@@ -2896,9 +2919,9 @@ AppManager::checkCacheFreeMemoryIsGoodEnough()
     while (totalFreeRAM <= systemRAMToKeepFree) {
 #ifdef NATRON_DEBUG_CACHE
         qDebug() << "Total system free RAM is below the threshold:" << printAsRAM(totalFreeRAM)
-        << ", clearing least recently used NodeCache image...";
+        << ", clearing NodeCache image with the lowest eviction priority...";
 #endif
-        if ( !_imp->_nodeCache->evictLRUInMemoryEntry() ) {
+        if ( !_imp->_nodeCache->evictInMemoryEntry() ) {
             break;
         }
 
@@ -222,6 +222,17 @@ public:
 
     U64 getCachesTotalMemorySize() const;
     U64 getCachesTotalDiskSize() const;
+
+    /**
+     * @brief Called by the ImageBufferPool of a render whenever the memory it retains changes, so that
+     * it is accounted in the node cache memory size.
+     **/
+    void notifyRenderBuffersMemoryChanged(std::size_t oldSize, std::size_t newSize) const;
+
+    /**
+     * @brief Returns the maximum size of the in-memory portion of the viewer cache
+     **/
+    U64 getViewerCacheMaximumMemorySize() const;
     CacheSignalEmitterPtr getOrActivateViewerCacheSignalEmitter() const;
 
     void setApplicationsCachesMaximumMemoryPercent(double p);
@@ -245,6 +256,11 @@ public:
 
     void removeAllCacheEntriesForHolder(const CacheEntryHolder* holder, bool blocking);
 
+    /**
+     * @brief Pins the images of the holder in the node cache: they are only evicted when no other image can be.
+     **/
+    void setImagesPinnedInCacheForHolder(const CacheEntryHolder* holder, bool pinned);
+
     SettingsPtr getCurrentSettings() const WARN_UNUSED_RETURN;
     const KnobFactory & getKnobFactory() const WARN_UNUSED_RETURN;
 
@@ -0,0 +1,432 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "AutoSaveJournal.h"
+
+#include <list>
+#include <stdexcept>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+
+#include "Engine/Hash64.h"
+#include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
+#include "Engine/NodeSerialization.h"
+#include "Engine/Project.h"
+#include "Engine/ProjectBinarySerialization.h"
+#include "Engine/ProjectSerialization.h"
+
+/*
+   Layout of a journal file (QDataStream, Qt 4.8 format):
+
+   QByteArray  NATRON_AUTOSAVE_JOURNAL_MAGIC
+   quint32     journal version
+   QString     absolute path of the base file
+   qint64      size of the base file when the journal was started
+   qint64      modification time of the base file, in msecs since epoch
+   quint32     version of the project serialization (PROJECT_SERIALIZATION_VERSION) of the project records
+   records:
+       quint32     record type (see JournalRecordTypeEnum)
+       QByteArray  payload
+
+   A batch is a list of records terminated by a commit record, written by a single append().
+ */
+#define NATRON_AUTOSAVE_JOURNAL_MAGIC "NatronPJ"
+#define NATRON_AUTOSAVE_JOURNAL_VERSION 3
+
+// Above this number of appends, the next auto-save is a full save
+#define NATRON_AUTOSAVE_JOURNAL_MAX_BATCHES 50
+
+NATRON_NAMESPACE_ENTER
+
+enum JournalRecordTypeEnum
+{
+    eJournalRecordNode = 0, // binary NodeSerialization (see encodeBinaryNodeSerialization)
+    eJournalRecordRemoveNode, // script-name of the removed node
+    eJournalRecordProject, // binary project header (see encodeBinaryProjectHeader)
+    eJournalRecordCommit, // empty
+};
+
+AutoSaveJournal::AutoSaveJournal()
+    : _lock()
+    , _journalFilePath()
+    , _baseFilePath()
+    , _baseFileSize(0)
+    , _baseFileModificationTime(0)
+    , _journalFileSize(0)
+    , _nodesState()
+    , _nBatches(0)
+{
+}
+
+AutoSaveJournal::~AutoSaveJournal()
+{
+}
+
+QString
+AutoSaveJournal::getJournalFilePath(const QString& autoSaveFilePath)
+{
+    return autoSaveFilePath + QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX);
+}
+
+bool
+AutoSaveJournal::isJournalFile(const QString& filePath)
+{
+    return filePath.endsWith( QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX) );
+}
+
+static void
+appendNodeState(const NodePtr& node,
+                Hash64* hash)
+{
+    hash->append( node->getHashValue() );
+    hash->append( node->getKnobsAge() );
+    Hash64_appendQString( hash, QString::fromUtf8( node->getScriptName_mt_safe().c_str() ) );
+    Hash64_appendQString( hash, QString::fromUtf8( node->getLabel_mt_safe().c_str() ) );
+
+    // A group is recorded as a whole, hence its state includes the state of its children
+    NodeGroup* isGroup = node->isEffectGroup();
+    if (isGroup) {
+        NodesList children;
+        isGroup->getActiveNodes(&children);
+        for (NodesList::iterator it = children.begin(); it != children.end(); ++it) {
+            appendNodeState(*it, hash);
+        }
+    }
+}
+
+void
+AutoSaveJournal::getNodesState(const ProjectPtr& project,
+                               NodesStateMap* state)
+{
+    // Same nodes as the ones serialized by NodeCollectionSerialization::initialize
+    NodesList nodes;
+
+    project->getActiveNodes(&nodes);
+    for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if ( (*it)->getParentMultiInstance() || !(*it)->isPartOfProject() ) {
+            continue;
+        }
+        Hash64 hash;
+        appendNodeState(*it, &hash);
+        hash.computeHash();
+        (*state)[(*it)->getScriptName_mt_safe()] = hash.value();
+    }
+}
+
+void
+AutoSaveJournal::reset(const QString& journalFilePath,
+                       const QString& baseFilePath,
+                       const NodesStateMap& state)
+{
+    QMutexLocker k(&_lock);
+
+    if ( !_journalFilePath.isEmpty() ) {
+        QFile::remove(_journalFilePath);
+    }
+    QFile::remove(journalFilePath);
+
+    QFileInfo baseInfo(baseFilePath);
+    _journalFilePath = journalFilePath;
+    _baseFilePath = baseInfo.absoluteFilePath();
+    _baseFileSize = baseInfo.size();
+    _baseFileModificationTime = baseInfo.lastModified().toMSecsSinceEpoch();
+    _journalFileSize = 0;
+    _nodesState = state;
+    _nBatches = 0;
+}
+
+void
+AutoSaveJournal::clear()
+{
+    QMutexLocker k(&_lock);
+
+    _journalFilePath.clear();
+    _baseFilePath.clear();
+    _baseFileSize = 0;
+    _baseFileModificationTime = 0;
+    _journalFileSize = 0;
+    _nodesState.clear();
+    _nBatches = 0;
+}
+
+bool
+AutoSaveJournal::isActive() const
+{
+    QMutexLocker k(&_lock);
+
+    return !_journalFilePath.isEmpty();
+}
+
+QString
+AutoSaveJournal::getJournalFilePath() const
+{
+    QMutexLocker k(&_lock);
+
+    return _journalFilePath;
+}
+
+bool
+AutoSaveJournal::mustCompact() const
+{
+    QMutexLocker k(&_lock);
+
+    // Past this point, replaying the journal costs more than loading a fresh full save
+    return _nBatches >= NATRON_AUTOSAVE_JOURNAL_MAX_BATCHES || _journalFileSize > _baseFileSize;
+}
+
+static void
+writeRecord(QDataStream& stream,
+            JournalRecordTypeEnum type,
+            const QByteArray& payload)
+{
+    stream << (quint32)type << payload;
+}
+
+static QByteArray
+toByteArray(const std::string& str)
+{
+    return QByteArray( str.data(), (int)str.size() );
+}
+
+void
+AutoSaveJournal::append(const ProjectPtr& project)
+{
+    QMutexLocker k(&_lock);
+
+    if ( _journalFilePath.isEmpty() ) {
+        throw std::runtime_error("The auto-save journal was not started");
+    }
+
+    NodesStateMap newState;
+    getNodesState(project, &newState);
+
+    // Serialize the changes before touching the file so that a failure leaves the journal untouched
+    std::list<QByteArray> nodeRecords;
+    NodesList nodes;
+    project->getActiveNodes(&nodes);
+    for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        std::string scriptName = (*it)->getScriptName_mt_safe();
+        NodesStateMap::const_iterator found = newState.find(scriptName);
+        if ( found == newState.end() ) {
+            continue;
+        }
+        NodesStateMap::const_iterator previous = _nodesState.find(scriptName);
+        if ( ( previous != _nodesState.end() ) && (previous->second == found->second) ) {
+            continue;
+        }
+        NodeSerialization serialization(*it);
+        nodeRecords.push_back( toByteArray( encodeBinaryNodeSerialization(serialization) ) );
+    }
+
+    std::list<QByteArray> removedNodes;
+    for (NodesStateMap::const_iterator it = _nodesState.begin(); it != _nodesState.end(); ++it) {
+        if ( newState.find(it->first) == newState.end() ) {
+            removedNodes.push_back( toByteArray(it->first) );
+        }
+    }
+
+    ProjectSerialization projectData( project->getApp() );
+    projectData.initializeProjectData( project.get() );
+    QByteArray projectRecord = toByteArray( encodeBinaryProjectHeader(projectData) );
+
+    QFile file(_journalFilePath);
+    bool isNewFile = !file.exists();
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Append) ) {
+        throw std::runtime_error( file.errorString().toStdString() );
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    if (isNewFile) {
+        stream << QByteArray(NATRON_AUTOSAVE_JOURNAL_MAGIC) << (quint32)NATRON_AUTOSAVE_JOURNAL_VERSION << _baseFilePath << _baseFileSize << _baseFileModificationTime << (quint32)PROJECT_SERIALIZATION_VERSION;
+    }
+    for (std::list<QByteArray>::iterator it = nodeRecords.begin(); it != nodeRecords.end(); ++it) {
+        writeRecord(stream, eJournalRecordNode, *it);
+    }
+    for (std::list<QByteArray>::iterator it = removedNodes.begin(); it != removedNodes.end(); ++it) {
+        writeRecord(stream, eJournalRecordRemoveNode, *it);
+    }
+    writeRecord(stream, eJournalRecordProject, projectRecord);
+    writeRecord( stream, eJournalRecordCommit, QByteArray() );
+
+    file.flush();
+    if (stream.status() != QDataStream::Ok) {
+        throw std::runtime_error("Failed to write the auto-save journal");
+    }
+    _journalFileSize = file.size();
+    file.close();
+
+    _nodesState.swap(newState);
+    ++_nBatches;
+} // AutoSaveJournal::append
+
+static bool
+readHeader(QDataStream& stream,
+           QString* baseFilePath,
+           qint64* baseFileSize,
+           qint64* baseFileModificationTime,
+           quint32* projectSerializationVersion)
+{
+    QByteArray magic;
+    quint32 version;
+
+    stream >> magic >> version;
+    if ( (stream.status() != QDataStream::Ok) || (version != NATRON_AUTOSAVE_JOURNAL_VERSION) ) {
+        return false;
+    }
+    stream >> *baseFilePath >> *baseFileSize >> *baseFileModificationTime >> *projectSerializationVersion;
+
+    return stream.status() == QDataStream::Ok &&
+           magic == QByteArray(NATRON_AUTOSAVE_JOURNAL_MAGIC) &&
+           version == NATRON_AUTOSAVE_JOURNAL_VERSION;
+}
+
+QString
+AutoSaveJournal::readBaseFilePath(const QString& journalFilePath)
+{
+    QFile file(journalFilePath);
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return QString();
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    QString baseFilePath;
+    qint64 baseFileSize, baseFileModificationTime;
+    quint32 projectSerializationVersion;
+    if ( !readHeader(stream, &baseFilePath, &baseFileSize, &baseFileModificationTime, &projectSerializationVersion) ) {
+        return QString();
+    }
+
+    // The base file was saved again since the journal was started: the journal does not apply.
+    // The size alone is not enough, a save may produce a file of the same size.
+    QFileInfo baseInfo(baseFilePath);
+    if ( !baseInfo.exists() || (baseInfo.size() != baseFileSize) ||
+         (baseInfo.lastModified().toMSecsSinceEpoch() != baseFileModificationTime) ) {
+        return QString();
+    }
+
+    return baseFilePath;
+}
+
+void
+AutoSaveJournal::filterAutoSaves(const QString& dirPath,
+                                 QStringList* fileNames)
+{
+    QDir dir(dirPath);
+    QStringList supersededBases;
+    QStringList ret;
+
+    Q_FOREACH(const QString &fileName, *fileNames) {
+        if ( !isJournalFile(fileName) ) {
+            continue;
+        }
+        QString baseFilePath = readBaseFilePath( dir.absoluteFilePath(fileName) );
+        if ( !baseFilePath.isEmpty() ) {
+            ret << fileName;
+            supersededBases << QFileInfo(baseFilePath).absoluteFilePath();
+        }
+    }
+    Q_FOREACH(const QString &fileName, *fileNames) {
+        if ( !isJournalFile(fileName) && !supersededBases.contains( QFileInfo( dir.absoluteFilePath(fileName) ).absoluteFilePath() ) ) {
+            ret << fileName;
+        }
+    }
+    *fileNames = ret;
+}
+
+void
+AutoSaveJournal::removeJournalFile(const QString& journalFilePath)
+{
+    QString baseFilePath = readBaseFilePath(journalFilePath);
+
+    // Never remove the project file itself
+    if ( !baseFilePath.isEmpty() && QFileInfo(baseFilePath).fileName().contains( QString::fromUtf8(".autosave") ) ) {
+        QFile::remove(baseFilePath);
+    }
+    QFile::remove(journalFilePath);
+}
+
+void
+AutoSaveJournal::replay(const QString& journalFilePath,
+                        ProjectSerialization* project)
+{
+    QFile file(journalFilePath);
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        throw std::runtime_error( file.errorString().toStdString() );
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    QString baseFilePath;
+    qint64 baseFileSize, baseFileModificationTime;
+    quint32 projectSerializationVersion;
+    if ( !readHeader(stream, &baseFilePath, &baseFileSize, &baseFileModificationTime, &projectSerializationVersion) ) {
+        throw std::runtime_error("Invalid auto-save journal");
+    }
+
+    std::list<std::pair<quint32, QByteArray> > batch;
+    while ( !stream.atEnd() ) {
+        quint32 type;
+        QByteArray payload;
+        stream >> type >> payload;
+        if (stream.status() != QDataStream::Ok) {
+            // Truncated record: the last batch was interrupted, drop it
+            break;
+        }
+        if (type != eJournalRecordCommit) {
+            batch.push_back( std::make_pair(type, payload) );
+            continue;
+        }
+
+        for (std::list<std::pair<quint32, QByteArray> >::iterator it = batch.begin(); it != batch.end(); ++it) {
+            switch ( (JournalRecordTypeEnum)it->first ) {
+            case eJournalRecordNode:
+                project->getNodesSerialization().replaceNodeSerialization( decodeBinaryNodeSerialization( it->second.constData(), it->second.size() ) );
+                break;
+            case eJournalRecordRemoveNode:
+                project->getNodesSerialization().removeNodeSerialization( std::string( it->second.constData(), it->second.size() ) );
+                break;
+            case eJournalRecordProject:
+                decodeBinaryProjectHeader(it->second.constData(), it->second.size(), projectSerializationVersion, project);
+                break;
+            case eJournalRecordCommit:
+                break;
+            }
+        }
+        batch.clear();
+    }
+} // AutoSaveJournal::replay
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,155 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_AutoSaveJournal_h
+#define Engine_AutoSaveJournal_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <string>
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QMutex>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+#define NATRON_AUTOSAVE_JOURNAL_SUFFIX ".journal"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief An append-only journal of the changes made to a project since its last full save.
+ *
+ * The journal references a base file, which is either the project file itself or the last full auto-save.
+ * Each call to append() compares the state of every top-level node against the state recorded at the
+ * previous append and only serializes the nodes that changed, so that the cost of an auto-save scales
+ * with the size of the edit rather than with the size of the project.
+ * A node that is a group is recorded as a whole if any node inside it changed.
+ *
+ * The journal file is a sequence of records (see AutoSaveJournal.cpp). A batch of records only applies
+ * once its commit record is read, hence a journal truncated by a crash is replayed up to its last
+ * complete auto-save.
+ *
+ * The node graph layout is not journaled: it is restored from the base file and only saved again by
+ * the next full save or compaction.
+ **/
+class AutoSaveJournal
+{
+public:
+
+    // State of each top-level node, by script-name
+    typedef std::map<std::string, U64> NodesStateMap;
+
+    AutoSaveJournal();
+
+    ~AutoSaveJournal();
+
+    /**
+     * @brief Returns the journal path associated to the given auto-save file path.
+     **/
+    static QString getJournalFilePath(const QString& autoSaveFilePath);
+
+    static bool isJournalFile(const QString& filePath);
+
+    /**
+     * @brief Computes the state of all top-level nodes of the project. This should be called before
+     * serializing the base file so that a change made during the save is caught by the next append().
+     **/
+    static void getNodesState(const ProjectPtr& project, NodesStateMap* state);
+
+    /**
+     * @brief Starts a new journal against the given base file, removing any previous journal file.
+     * The given state of the project is recorded as the reference for the next append().
+     **/
+    void reset(const QString& journalFilePath,
+               const QString& baseFilePath,
+               const NodesStateMap& state);
+
+    /**
+     * @brief Stops journaling. The journal file is left on disk.
+     **/
+    void clear();
+
+    bool isActive() const;
+
+    QString getJournalFilePath() const;
+
+    /**
+     * @brief Returns true if the journal grew enough that a full save should be done instead of an append.
+     **/
+    bool mustCompact() const;
+
+    /**
+     * @brief Appends the changes made to the project since the last append() or reset().
+     * This is MT-safe and is called from the auto-save thread.
+     * This function throws a std::exception upon failure.
+     **/
+    void append(const ProjectPtr& project);
+
+    /**
+     * @brief Returns the absolute path of the base file referenced by the journal, or an empty string
+     * if the journal is damaged or does not match its base file any longer.
+     **/
+    static QString readBaseFilePath(const QString& journalFilePath);
+
+    /**
+     * @brief Filters the auto-save file names found in the given directory so that each auto-saved project
+     * is listed once: journals that do not apply any longer are skipped, and so are the auto-saves that
+     * are the base of a valid journal.
+     **/
+    static void filterAutoSaves(const QString& dirPath, QStringList* fileNames);
+
+    /**
+     * @brief Removes the journal file, as well as its base file if the base is an auto-save.
+     **/
+    static void removeJournalFile(const QString& journalFilePath);
+
+    /**
+     * @brief Applies all complete batches of the journal on the given project loaded from the base file.
+     * This function throws a std::exception upon failure.
+     **/
+    static void replay(const QString& journalFilePath,
+                       ProjectSerialization* project);
+
+private:
+
+    mutable QMutex _lock;
+    QString _journalFilePath;
+    QString _baseFilePath;
+    qint64 _baseFileSize;
+    qint64 _baseFileModificationTime;
+    qint64 _journalFileSize;
+    // State of the nodes at the last append
+    NodesStateMap _nodesState;
+    int _nBatches;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_AutoSaveJournal_h
@@ -75,6 +75,7 @@ public:
     QString breakpadProcessFilePath;
     qint64 breakpadProcessPID;
     QString exportDocsPath;
+    QString convertProjectPath;
 
     CLArgsPrivate()
         : args()
@@ -102,6 +103,7 @@ public:
         , breakpadProcessFilePath()
         , breakpadProcessPID(-1)
         , exportDocsPath()
+        , convertProjectPath()
     {
     }
 
@@ -233,6 +235,7 @@ CLArgs::operator=(const CLArgs& other)
     _imp->isEmpty = other._imp->isEmpty;
     _imp->imageFilename = other._imp->imageFilename;
     _imp->exportDocsPath = other._imp->exportDocsPath;
+    _imp->convertProjectPath = other._imp->convertProjectPath;
 }
 
 bool
@@ -340,7 +343,12 @@ CLArgs::printUsage(const std::string& programName)
         "     breakdown contains information about each nodes, render times etc...\n"
         "     This option is useful for debugging purposes or to control that a render\n"
         "     is working correctly.\n"
-        "     **Please note** that it does not work when writing video files."
+        "     **Please note** that it does not work when writing video files.\n"
+        "  --convert <output project file path>\n"
+        "     Convert the project to the format given by the extension of the output\n"
+        "     file (.%2 for XML, ." NATRON_PROJECT_BINARY_FILE_EXT " for binary) without rendering\n"
+        "     anything. In background mode, the node graph layout is not carried\n"
+        "     over.\n"
         "Sample uses:\n"
         "  %1 /Users/Me/MyNatronProjects/MyProject.ntp\n"
         "  %1 -b -w MyWriter /Users/Me/MyNatronProjects/MyProject.ntp\n"
@@ -348,6 +356,7 @@ CLArgs::printUsage(const std::string& programName)
         "  %1Renderer -w MyWriter /FastDisk/Pictures/sequence'###'.exr 1-100 /Users/Me/MyNatronProjects/MyProject.ntp\n"
         "  %1Renderer -w MyWriter -w MySecondWriter 1-10 /Users/Me/MyNatronProjects/MyProject.ntp\n"
         "  %1Renderer -w MyWriter 1-10 -l /Users/Me/Scripts/onProjectLoaded.py /Users/Me/MyNatronProjects/MyProject.ntp\n"
+        "  %1Renderer --convert /Users/Me/MyNatronProjects/MyProject." NATRON_PROJECT_BINARY_FILE_EXT " /Users/Me/MyNatronProjects/MyProject.ntp\n"
         "\n"
         /* Text must hold in 80 columns ************************************************/
         "Options for the execution of Python scripts:\n"
@@ -561,6 +570,12 @@ CLArgs::getExportDocsPath() const
     return _imp->exportDocsPath;
 }
 
+const QString &
+CLArgs::getConvertProjectPath() const
+{
+    return _imp->convertProjectPath;
+}
+
 QStringList::iterator
 CLArgsPrivate::findFileNameWithExtension(const QString& extension)
 {
@@ -896,6 +911,34 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        // Parsed before the project file name since the output is a project file name too
+        QStringList::iterator it = hasToken( QString::fromUtf8("convert"), QString() );
+        if ( it != args.end() ) {
+            QStringList::iterator next = it;
+            ++next;
+            if ( next == args.end() ) {
+                std::cout << tr("You must specify the output project file path when using the --convert option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            convertProjectPath = *next;
+#ifdef __NATRON_UNIX__
+            convertProjectPath = AppManager::qt_tildeExpansion(convertProjectPath);
+#endif
+            if ( !convertProjectPath.endsWith( QString::fromUtf8("." NATRON_PROJECT_FILE_EXT) ) &&
+                 !convertProjectPath.endsWith( QString::fromUtf8("." NATRON_PROJECT_BINARY_FILE_EXT) ) ) {
+                std::cout << tr("The output of the --convert option must be a .%1 or .%2 project file").arg( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ).arg( QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) ).toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            ++next;
+            args.erase(it, next);
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("IPCpipe"), QString() );
         if ( it != args.end() ) {
@@ -947,6 +990,9 @@ CLArgsPrivate::parse()
 
     {
         QStringList::iterator it = findFileNameWithExtension( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) );
+        if ( it == args.end() ) {
+            it = findFileNameWithExtension( QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) );
+        }
         if ( it == args.end() ) {
             it = findFileNameWithExtension( QString::fromUtf8("py") );
             if ( ( it == args.end() ) && !isInterpreterMode && isBackground ) {
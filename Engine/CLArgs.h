@@ -149,6 +149,11 @@ public:
     const QString& getBreakpadComPipeFilePath() const;
     const QString& getExportDocsPath() const;
 
+    /*
+     * @brief The output file of the project conversion requested with --convert, or an empty string
+     */
+    const QString& getConvertProjectPath() const;
+
 private:
 
     boost::scoped_ptr<CLArgsPrivate> _imp;
@@ -67,9 +67,12 @@ GCC_DIAG_ON(deprecated)
 
 #include "Engine/EngineFwd.h"
 
-//Beyond that percentage of occupation, the cache will start evicting LRU entries
+//Beyond that percentage of occupation, the cache will start evicting entries
 #define NATRON_CACHE_LIMIT_PERCENT 0.9
 
+//Number of least recently used entries among which the entry with the lowest eviction priority is evicted
+#define NATRON_CACHE_EVICTION_CANDIDATES 32
+
 #define NATRON_TILE_CACHE_FILE_SIZE_BYTES 2000000000
 
 ///When defined, number of opened files, memory size and disk size of the cache are printed whenever there's activity.
@@ -512,6 +515,39 @@ private:
     // When set these are used for fast search of a free tile
     TileCacheFileWPtr _nextAvailableCacheFile;
     int _nextAvailableCacheFileIndex;
+
+    // GreedyDual-Size inflation value: the priority of the last evicted entry, protected by _lock
+    mutable double _evictionInflation;
+
+    // Cache IDs of the holders whose entries are only evicted when no other entry can be, protected by _lock
+    std::set<std::string> _pinnedHolders;
+
+    /**
+     * @brief Returns the eviction priority of an entry, or false if it belongs to a pinned holder
+     **/
+    class EvictionPriorityFunctor
+    {
+        const std::set<std::string>& _pinnedHolders;
+
+public:
+
+        EvictionPriorityFunctor(const std::set<std::string>& pinnedHolders)
+            : _pinnedHolders(pinnedHolders)
+        {
+        }
+
+        bool operator()(const EntryTypePtr& entry,
+                        double* priority) const
+        {
+            if ( !_pinnedHolders.empty() && ( _pinnedHolders.find( entry->getKey().getCacheHolderID() ) != _pinnedHolders.end() ) ) {
+                return false;
+            }
+            *priority = entry->getEvictionPriority();
+
+            return true;
+        }
+    };
+
 public:
 
 
@@ -545,6 +581,8 @@ public:
         , _cacheFiles()
         , _nextAvailableCacheFile()
         , _nextAvailableCacheFileIndex(-1)
+        , _evictionInflation(0.)
+        , _pinnedHolders()
     {
         _signalEmitter = boost::make_shared<CacheSignalEmitter>();
     }
@@ -790,7 +828,7 @@ private:
 #ifdef NATRON_DEBUG_CACHE
             qDebug() << "Reached maximum cache files opened limit,clearing last recently used one...";
 #endif
-            if ( !evictLRUDiskEntry() ) {
+            if ( !evictDiskEntry() ) {
                 break;
             }
             ++safeCounter;
@@ -1203,11 +1241,11 @@ public:
     }
 
     /**
-     * @brief Removes the last recently used entry from the in-memory cache.
+     * @brief Removes the entry with the lowest eviction priority from the in-memory cache.
      * This is expensive since it takes the lock. Returns false
      * if there's nothing left to evict.
      **/
-    bool evictLRUInMemoryEntry() const
+    bool evictInMemoryEntry() const
     {
         ///Make sure the shared_ptrs live in this list and are destroyed not while under the lock
         ///so that the memory freeing (which might be expensive for large images) doesn't happen while under the lock
@@ -1222,11 +1260,11 @@ public:
     }
 
     /**
-     * @brief Removes the last recently used entry from the disk cache.
+     * @brief Removes the entry with the lowest eviction priority from the disk cache.
      * This is expensive since it takes the lock. Returns false
      * if there's nothing left to evict.
      **/
-    bool evictLRUDiskEntry() const
+    bool evictDiskEntry() const
     {
 
         QMutexLocker locker(&_lock);
@@ -1569,6 +1607,23 @@ public:
         }
     }
 
+    /**
+     * @brief When pinned, the entries of the holder are only evicted when no other entry can be, so that they survive
+     * the memory pressure caused by the renders of other holders.
+     **/
+    void setEntriesPinnedForHolder(const CacheEntryHolder* holder,
+                                   bool pinned)
+    {
+        std::string holderID = holder->getCacheID();
+        QMutexLocker locker(&_lock);
+
+        if (pinned) {
+            _pinnedHolders.insert(holderID);
+        } else {
+            _pinnedHolders.erase(holderID);
+        }
+    }
+
     void getMemoryStatsForCacheEntryHolder(const CacheEntryHolder* holder,
                                            std::size_t* ramOccupied,
                                            std::size_t* diskOccupied) const
@@ -1679,6 +1734,7 @@ private:
             std::list<EntryTypePtr> & ret = getValueFromIterator(memoryCached);
             for (typename std::list<EntryTypePtr>::const_iterator it = ret.begin(); it != ret.end(); ++it) {
                 if ( (*it)->getKey() == key ) {
+                    (*it)->setEvictionBase(_evictionInflation);
                     returnValue->push_back(*it);
 
                     ///Q_EMIT the added signal otherwise when first reading something that's already cached
@@ -1751,6 +1807,7 @@ private:
                             }
                         }
                         
+                        (*it)->setEvictionBase(_evictionInflation);
                         returnValue->push_back(*it);
                         ///Q_EMIT the added signal otherwise when first reading something that's already cached
                         ///the timeline wouldn't update
@@ -1786,6 +1843,8 @@ private:
         assert( !_lock.tryLock() );   // must be locked
         typename EntryType::hash_type hash = entry->getHashKey();
 
+        entry->setEvictionBase(_evictionInflation);
+
         if (inMemory) {
             /*if the entry doesn't exist on the memory cache,make a new list and insert it*/
             CacheIterator existingEntry = _memoryCache(hash);
@@ -1806,10 +1865,35 @@ private:
         }
     }
 
+    /**
+     * @brief Evicts from the container the entry with the lowest GreedyDual-Size priority among the least recently used ones:
+     * of two entries of the same size accessed at about the same time, the cheapest to render is evicted first.
+     * Entries of pinned holders are only evicted when no other entry can be.
+     **/
+    std::pair<hash_type, EntryTypePtr> evictLowestPriorityEntry(CacheContainer& container) const
+    {
+        assert( !_lock.tryLock() );
+        double priority = 0.;
+        std::pair<hash_type, EntryTypePtr> evicted = container.evictLowestPriority(EvictionPriorityFunctor(_pinnedHolders), NATRON_CACHE_EVICTION_CANDIDATES, &priority);
+        if ( !evicted.second && !_pinnedHolders.empty() ) {
+            // Only entries of pinned holders can be evicted
+            evicted = container.evict();
+            if (evicted.second) {
+                priority = evicted.second->getEvictionPriority();
+            }
+        }
+        if (evicted.second) {
+            // Entries accessed from now on are ranked above the evicted one
+            _evictionInflation = std::max(_evictionInflation, priority);
+        }
+
+        return evicted;
+    }
+
     bool tryEvictInMemoryEntry(std::list<EntryTypePtr> & entriesToBeDeleted) const
     {
         assert( !_lock.tryLock() );
-        std::pair<hash_type, EntryTypePtr> evicted = _memoryCache.evict();
+        std::pair<hash_type, EntryTypePtr> evicted = evictLowestPriorityEntry(_memoryCache);
         //if the cache couldn't evict that means all entries are used somewhere and we shall not remove them!
         //we'll let the user of these entries purge the extra entries left in the cache later on
         if (!evicted.second) {
@@ -1840,7 +1924,7 @@ private:
 
             /*before that we need to clear the disk cache if it exceeds the maximum size allowed*/
             while ( ( diskCacheSize  + evicted.second->size() ) >= (maximumCacheSize - maximumInMemorySize) ) {
-                std::pair<hash_type, EntryTypePtr> evictedFromDisk = _diskCache.evict();
+                std::pair<hash_type, EntryTypePtr> evictedFromDisk = evictLowestPriorityEntry(_diskCache);
                 //if the cache couldn't evict that means all entries are used somewhere and we shall not remove them!
                 //we'll let the user of these entries purge the extra entries left in the cache later on
                 if (!evictedFromDisk.second) {
@@ -1880,7 +1964,7 @@ private:
     {
 
         assert( !_lock.tryLock() );
-        std::pair<hash_type, EntryTypePtr> evicted = _diskCache.evict();
+        std::pair<hash_type, EntryTypePtr> evicted = evictLowestPriorityEntry(_diskCache);
         //if the cache couldn't evict that means all entries are used somewhere and we shall not remove them!
         //we'll let the user of these entries purge the extra entries left in the cache later on
         if (!evicted.second) {
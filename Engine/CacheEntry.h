@@ -49,6 +49,7 @@
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #endif
 
 #include <QtCore/QFile>
@@ -62,6 +63,7 @@
 #endif
 
 #include "Engine/Hash64.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/CacheEntryHolder.h"
 #include "Engine/MemoryFile.h"
 #include "Engine/NonKeyParams.h"
@@ -81,11 +83,42 @@ class RamBuffer
     T* data;
     U64 count;
 
+    // If the buffer was obtained from a render ImageBufferPool, this is the pool it should be given back to
+    // and the actual size of the allocation.
+    ImageBufferPoolWPtr pool;
+    std::size_t allocatedSize;
+    bool fromPool;
+
+    void freeData()
+    {
+        if (!data) {
+            return;
+        }
+        if (fromPool) {
+            ImageBufferPoolPtr p = pool.lock();
+            if (p) {
+                p->release(data, allocatedSize);
+            } else {
+                // The render that allocated the buffer is over, the buffer may have been handed to a cached image
+                free(data);
+            }
+            pool.reset();
+            fromPool = false;
+        } else {
+            free(data);
+        }
+        data = 0;
+        allocatedSize = 0;
+    }
+
 public:
 
     RamBuffer()
         : data(0)
         , count(0)
+        , pool()
+        , allocatedSize(0)
+        , fromPool(false)
     {
     }
 
@@ -103,6 +136,9 @@ public:
     {
         std::swap(data, other.data);
         std::swap(count, other.count);
+        pool.swap(other.pool);
+        std::swap(allocatedSize, other.allocatedSize);
+        std::swap(fromPool, other.fromPool);
     }
 
     U64 size() const
@@ -110,40 +146,39 @@ public:
         return count;
     }
 
-    void resize(U64 size)
+    void resize(U64 size,
+                const ImageBufferPoolPtr& bufferPool = ImageBufferPoolPtr())
     {
         if (size == 0) {
             return;
         }
         count = size;
-        if (data) {
-            free(data);
-            data = 0;
-        }
+        freeData();
         if (count == 0) {
             return;
         }
-        data = (T*)malloc( size * sizeof(T) );
-        if (!data) {
-            throw std::bad_alloc();
+        if (bufferPool) {
+            data = (T*)bufferPool->allocate(size * sizeof(T), &allocatedSize);
+            pool = bufferPool;
+            fromPool = true;
+        } else {
+            data = (T*)malloc( size * sizeof(T) );
+            if (!data) {
+                throw std::bad_alloc();
+            }
+            allocatedSize = size * sizeof(T);
         }
     }
 
     void clear()
     {
         count = 0;
-        if (data) {
-            free(data);
-            data = 0;
-        }
+        freeData();
     }
 
     ~RamBuffer()
     {
-        if (data) {
-            free(data);
-            data = 0;
-        }
+        freeData();
     }
 };
 
@@ -402,7 +437,8 @@ public:
         deallocate();
     }
 
-    void allocateRAM(U64 count)
+    void allocateRAM(U64 count,
+                     const ImageBufferPoolPtr& pool = ImageBufferPoolPtr())
     {
         if ( _buffer && (_buffer->size() > 0) ) {
             return;
@@ -411,7 +447,7 @@ public:
         if (!_buffer) {
             _buffer.reset( new RamBuffer<DataType>() );
         }
-        _buffer->resize(count);
+        _buffer->resize(count, pool);
     }
 
     void allocateMMAP(U64 count,
@@ -771,6 +807,9 @@ public:
         , _cache()
         , _entryLock(QReadWriteLock::Recursive)
         , _removeBackingFileBeforeDestruction(false)
+        , _evictionDataMutex()
+        , _renderCost(0.)
+        , _evictionBase(0.)
     {
     }
 
@@ -789,6 +828,9 @@ public:
         , _cache(cache)
         , _entryLock(QReadWriteLock::Recursive)
         , _removeBackingFileBeforeDestruction(false)
+        , _evictionDataMutex()
+        , _renderCost(0.)
+        , _evictionBase(0.)
     {
     }
 
@@ -1096,6 +1138,46 @@ public:
         return getElementsCountFromParams() * sizeof(DataType);
     }
 
+    /**
+     * @brief Adds to the render cost of the entry the time (in seconds) spent computing a portion of it.
+     * This is thread-safe, several threads may render portions of the same entry.
+     **/
+    void addRenderCost(double seconds)
+    {
+        QMutexLocker k(&_evictionDataMutex);
+
+        _renderCost += seconds;
+    }
+
+    double getRenderCost() const
+    {
+        QMutexLocker k(&_evictionDataMutex);
+
+        return _renderCost;
+    }
+
+    /**
+     * @brief Called by the cache when the entry is inserted or accessed with the inflation value of the cache at that time.
+     **/
+    void setEvictionBase(double base)
+    {
+        QMutexLocker k(&_evictionDataMutex);
+
+        _evictionBase = base;
+    }
+
+    /**
+     * @brief Returns the GreedyDual-Size priority of the entry: the inflation value of the cache when it was last accessed
+     * plus its render cost per megabyte. The cache evicts the entries with the lowest priority first.
+     **/
+    double getEvictionPriority() const
+    {
+        double sizeMB = std::max( (double)getSizeInBytesFromParams() / (1024. * 1024.), 1e-3 );
+        QMutexLocker k(&_evictionDataMutex);
+
+        return _evictionBase + _renderCost / sizeMB;
+    }
+
     virtual U64 getElementsCountFromParams() const OVERRIDE FINAL WARN_UNUSED_RETURN
     {
         const CacheEntryStorageInfo& info = _params->getStorageInfo();
@@ -1222,7 +1304,9 @@ private:
             }
         } else if (info.mode == eStorageModeRAM) {
             U64 count = getElementsCountFromParams();
-            _data.allocateRAM(count);
+            // Entries that do not belong to the cache only live for the duration of a render:
+            // recycle their buffer through the pool of the render, if any
+            _data.allocateRAM( count, _cache ? ImageBufferPoolPtr() : ImageBufferPool::getCurrentThreadPool() );
         } else if (info.mode == eStorageModeGLTex) {
             _data.allocateGLTexture(info.bounds, info.textureTarget);
         }
@@ -1253,6 +1337,15 @@ protected:
     const CacheAPI* _cache;
     mutable QReadWriteLock _entryLock;
     bool _removeBackingFileBeforeDestruction;
+
+    // Protects _renderCost and _evictionBase
+    mutable QMutex _evictionDataMutex;
+
+    // Time in seconds spent rendering this entry
+    double _renderCost;
+
+    // Inflation value of the cache when the entry was last accessed
+    double _evictionBase;
 };
 
 NATRON_NAMESPACE_EXIT
@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <stdexcept>
 
 #if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
@@ -305,6 +306,7 @@ Curve::setPeriodic(bool periodic)
     QMutexLocker k(&_imp->_lock);
     _imp->isPeriodic = periodic;
     _imp->keyFrames.clear();
+    _imp->sampledValuesCache.clear();
 }
 
 bool
@@ -325,6 +327,7 @@ Curve::clearKeyFrames()
     QMutexLocker l(&_imp->_lock);
 
     _imp->keyFrames.clear();
+    _imp->sampledValuesCache.clear();
 }
 
 bool
@@ -907,6 +910,109 @@ Curve::getValueAt(double t,
     //    return _imp->keyFrames.begin()->getValue();
     }
 
+    double v = interpolateValueAt(t);
+
+    if ( doClamp && mustClamp() ) {
+        v = clampValueToCurveYRange(v);
+    }
+
+    return roundValueToCurveType(v);
+} // getValueAt
+
+void
+Curve::getValuesAt(const double* t,
+                   int count,
+                   double* values,
+                   bool doClamp) const
+{
+    if (count <= 0) {
+        return;
+    }
+
+    QMutexLocker l(&_imp->_lock);
+
+    if ( _imp->keyFrames.empty() ) {
+        // Same as getValueAt(): a curve with no control points is 0 everywhere
+        std::fill(values, values + count, 0.);
+
+        return;
+    }
+
+    // The range only depends on the owner, query it once for all samples
+    bool clamp = doClamp && mustClamp();
+    YRange range = clamp ? getCurveYRange() : YRange( -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() );
+    for (int i = 0; i < count; ++i) {
+        double v = interpolateValueAt(t[i]);
+        if (clamp) {
+            v = std::max( range.min, std::min(range.max, v) );
+        }
+        values[i] = roundValueToCurveType(v);
+    }
+}
+
+void
+Curve::getSampledValues(double first,
+                        double last,
+                        int count,
+                        double* values,
+                        bool doClamp) const
+{
+    if (count <= 0) {
+        return;
+    }
+
+    QMutexLocker l(&_imp->_lock);
+
+    if ( _imp->keyFrames.empty() ) {
+        std::fill(values, values + count, 0.);
+
+        return;
+    }
+
+    // The unclamped samples only depend on the keyframes: they are kept until the curve changes.
+    // The clamping is applied afterwards since the range of the owner may change independently.
+    const std::vector<double>* samples = NULL;
+    for (std::list<CurvePrivate::SampledValues>::const_iterator it = _imp->sampledValuesCache.begin(); it != _imp->sampledValuesCache.end(); ++it) {
+        if ( (it->first == first) && (it->last == last) && ( (int)it->values.size() == count ) ) {
+            samples = &it->values;
+            break;
+        }
+    }
+    if (!samples) {
+        CurvePrivate::SampledValues sampled;
+        sampled.first = first;
+        sampled.last = last;
+        sampled.values.resize(count);
+        double step = count > 1 ? (last - first) / (count - 1) : 0.;
+        for (int i = 0; i < count; ++i) {
+            // The last sample is exactly at last, whatever the rounding errors
+            double t = i == count - 1 ? last : first + i * step;
+            sampled.values[i] = interpolateValueAt(t);
+        }
+        if (_imp->sampledValuesCache.size() >= NATRON_CURVE_SAMPLED_VALUES_CACHE_SIZE) {
+            _imp->sampledValuesCache.pop_back();
+        }
+        _imp->sampledValuesCache.push_front(sampled);
+        samples = &_imp->sampledValuesCache.front().values;
+    }
+
+    bool clamp = doClamp && mustClamp();
+    YRange range = clamp ? getCurveYRange() : YRange( -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() );
+    for (int i = 0; i < count; ++i) {
+        double v = (*samples)[i];
+        if (clamp) {
+            v = std::max( range.min, std::min(range.max, v) );
+        }
+        values[i] = roundValueToCurveType(v);
+    }
+} // getSampledValues
+
+double
+Curve::interpolateValueAt(double t) const
+{
+    // PRIVATE - should not lock
+    assert( !_imp->keyFrames.empty() );
+
     double v;
 #ifdef NATRON_CURVE_USE_CACHE
     std::map<double, double>::const_iterator foundCached = _imp->resultCache.find(t);
@@ -954,10 +1060,13 @@ Curve::getValueAt(double t,
 #endif
     }
 
-    if ( doClamp && mustClamp() ) {
-        v = clampValueToCurveYRange(v);
-    }
+    return v;
+}
 
+double
+Curve::roundValueToCurveType(double v) const
+{
+    // PRIVATE - should not lock
     switch (_imp->type) {
     case CurvePrivate::eCurveTypeString:
     case CurvePrivate::eCurveTypeInt:
@@ -973,7 +1082,7 @@ Curve::getValueAt(double t,
 
         return v;
     }
-} // getValueAt
+}
 
 double
 Curve::getDerivativeAt(double t) const
@@ -1253,6 +1362,8 @@ Curve::setXRange(double a,
 
     _imp->xMin = a;
     _imp->xMax = b;
+    // The periodic interpolation depends on the range
+    _imp->sampledValuesCache.clear();
 }
 
 std::pair<double, double> Curve::getXRange() const
@@ -1837,6 +1948,7 @@ Curve::onCurveChanged()
 #ifdef NATRON_CURVE_USE_CACHE
     _imp->resultCache.clear();
 #endif
+    _imp->sampledValuesCache.clear();
 }
 
 void
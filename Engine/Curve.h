@@ -256,6 +256,18 @@ public:
      */
     double getValueAt(double t, bool clamp = true) const WARN_UNUSED_RETURN;
 
+    /**
+     * @brief Same as getValueAt() for count positions at once, the curve is locked only once.
+     **/
+    void getValuesAt(const double* t, int count, double* values, bool clamp = true) const;
+
+    /**
+     * @brief Returns the value of the curve at count evenly spaced positions from first to last (included).
+     * The samples are cached until the curve changes, so that building a lookup table of the same size
+     * again is just a copy.
+     **/
+    void getSampledValues(double first, double last, int count, double* values, bool clamp = true) const;
+
     double getDerivativeAt(double t) const WARN_UNUSED_RETURN;
 
     double getIntegrateFromTo(double t1, double t2) const WARN_UNUSED_RETURN;
@@ -373,6 +385,10 @@ private:
 
     double clampValueToCurveYRange(double v) const WARN_UNUSED_RETURN;
 
+    double interpolateValueAt(double t) const WARN_UNUSED_RETURN;
+
+    double roundValueToCurveType(double v) const WARN_UNUSED_RETURN;
+
     void setKeyframesInternal(const KeyFrameSet& keys, bool refreshDerivatives);
 
     ///returns an iterator to the new keyframe in the keyframe set and
@@ -28,6 +28,9 @@
 
 #include "Global/Macros.h"
 
+#include <list>
+#include <vector>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #endif
@@ -42,6 +45,9 @@
 
 //#define NATRON_CURVE_USE_CACHE
 
+// Number of evenly spaced samplings of the curve kept by Curve::getSampledValues()
+#define NATRON_CURVE_SAMPLED_VALUES_CACHE_SIZE 4
+
 NATRON_NAMESPACE_ENTER
 
 struct CurvePrivate
@@ -62,6 +68,16 @@ struct CurvePrivate
     std::map<double, double> resultCache; //< a cache for interpolations
 #endif
 
+    // Unclamped values of the curve at count evenly spaced positions in [first, last]
+    struct SampledValues
+    {
+        double first, last;
+        std::vector<double> values;
+    };
+
+    // Most recently used first, cleared whenever the curve changes
+    std::list<SampledValues> sampledValuesCache;
+
     KnobI* owner;
     int dimensionInOwner;
     CurveTypeEnum type;
@@ -76,6 +92,7 @@ struct CurvePrivate
 #ifdef NATRON_CURVE_USE_CACHE
         , resultCache()
 #endif
+        , sampledValuesCache()
         , owner(NULL)
         , dimensionInOwner(-1)
         , type(eCurveTypeDouble)
@@ -98,6 +115,7 @@ struct CurvePrivate
     void operator=(const CurvePrivate & other)
     {
         keyFrames = other.keyFrames;
+        sampledValuesCache.clear();
         owner = other.owner;
         dimensionInOwner = other.dimensionInOwner;
         isParametric = other.isParametric;
@@ -56,6 +56,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/BlockingBackgroundRender.h"
 #include "Engine/DiskCacheNode.h"
 #include "Engine/Image.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/ImageParams.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
@@ -293,7 +294,8 @@ EffectInstance::setParallelRenderArgsTLS(double time,
                                          PluginOpenGLRenderSupport currentOpenGLSupport,
                                          bool doNanHandling,
                                          bool draftMode,
-                                         const RenderStatsPtr & stats)
+                                         const RenderStatsPtr & stats,
+                                         const ImageBufferPoolPtr & bufferPool)
 {
     EffectTLSDataPtr tls = _imp->tlsData->getOrCreateTLSData();
     std::list<ParallelRenderArgsPtr>& argsList = tls->frameArgs;
@@ -324,6 +326,7 @@ EffectInstance::setParallelRenderArgsTLS(double time,
     args->draftMode = draftMode;
     args->tilesSupported = getNode()->getCurrentSupportTiles();
     args->stats = stats;
+    args->bufferPool = bufferPool;
     args->openGLContext = glContext;
     argsList.push_back(args);
 }
@@ -841,6 +844,8 @@ EffectInstance::getImage(int inputNb,
     //    in the kOfxActionInstanceChanged and kOfxActionEndInstanceChanged actions with a kOfxPropChangeReason of kOfxChangeUserEdited
     RectD roi;
     bool roiWasInRequestPass = false;
+    // The first effect upstream of inputEffect which renders, if inputEffect is a pass-through node
+    EffectInstancePtr passThroughEffect;
     bool isAnalysisPass = false;
     RectD thisRod;
     double thisEffectRenderTime = time;
@@ -870,6 +875,7 @@ EffectInstance::getImage(int inputNb,
             if (request) {
                 roiWasInRequestPass = true;
                 roi = request->finalData.finalRoi;
+                passThroughEffect = request->finalData.passThroughEffect.lock();
             }
         }
 
@@ -1072,20 +1078,21 @@ EffectInstance::getImage(int inputNb,
     std::list<ImagePlaneDesc> requestedComps;
     requestedComps.push_back(isMask ? maskComps : components);
     std::map<ImagePlaneDesc, ImagePtr> inputImages;
-    RenderRoIRetCode retCode = inputEffect->renderRoI(RenderRoIArgs(time,
-                                                                    scale,
-                                                                    renderMappedMipMapLevel,
-                                                                    view,
-                                                                    byPassCache,
-                                                                    pixelRoI,
-                                                                    RectD(),
-                                                                    requestedComps,
-                                                                    depth,
-                                                                    true,
-                                                                    this,
-                                                                    returnStorage,
-                                                                    thisEffectRenderTime,
-                                                                    inputImagesThreadLocal), &inputImages);
+    EffectInstancePtr effectToRender = passThroughEffect ? passThroughEffect : inputEffect;
+    RenderRoIRetCode retCode = effectToRender->renderRoI(RenderRoIArgs(time,
+                                                                       scale,
+                                                                       renderMappedMipMapLevel,
+                                                                       view,
+                                                                       byPassCache,
+                                                                       pixelRoI,
+                                                                       RectD(),
+                                                                       requestedComps,
+                                                                       depth,
+                                                                       true,
+                                                                       this,
+                                                                       returnStorage,
+                                                                       thisEffectRenderTime,
+                                                                       inputImagesThreadLocal), &inputImages);
 
     if ( inputImages.empty() || (retCode != eRenderRoIRetCodeOk) ) {
         return ImagePtr();
@@ -1872,6 +1879,69 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool /*useCache*/,
     } // isCached
 } // EffectInstance::getImageFromCacheAndConvertIfNeeded
 
+/**
+ * @brief If effect outputs one of its inputs unchanged at the given time and view, returns that input and its index.
+ * This is the case of disabled nodes, Dots, inputs and outputs of groups and nodes that are identity on their
+ * whole region of definition, as long as that region is the region of definition of the input.
+ **/
+static EffectInstancePtr
+getTransformPassThroughInput(const EffectInstancePtr& effect,
+                             double time,
+                             ViewIdx view,
+                             const RenderScale & scale,
+                             int* inputNb)
+{
+    NodePtr node = effect->getNode();
+
+    if ( node->isNodeDisabled() ) {
+        *inputNb = node->getPreferredInput();
+
+        return (*inputNb == -1) ? EffectInstancePtr() : effect->getInput(*inputNb);
+    }
+
+    RenderScale mappedScale = (effect->supportsRenderScaleMaybe() == EffectInstance::eSupportsNo) ? RenderScale(1.) : scale;
+    U64 hash = effect->getRenderHash();
+    RectD rod;
+    StatusEnum stat = effect->getRegionOfDefinition_public(hash, time, mappedScale, view, &rod, 0);
+    if ( (stat == eStatusFailed) || rod.isNull() ) {
+        return EffectInstancePtr();
+    }
+
+    RectI rodPixel;
+    rod.toPixelEnclosing(mappedScale, effect->getAspectRatio(-1), &rodPixel);
+
+    double identityTime = time;
+    ViewIdx identityView = view;
+    int identityInputNb = -1;
+    bool isIdentity = false;
+    try {
+        isIdentity = effect->isIdentity_public(true, hash, time, mappedScale, rodPixel, view, &identityTime, &identityView, &identityInputNb);
+    } catch (...) {
+        return EffectInstancePtr();
+    }
+
+    // The transforms upstream are evaluated at the same time and view
+    if ( !isIdentity || (identityInputNb < 0) || (identityTime != time) || (identityView != view) ) {
+        return EffectInstancePtr();
+    }
+
+    // A node may be identity and still change the region of definition of its input (e.g: a Crop clamping it),
+    // which fetching directly from the input would bypass
+    EffectInstancePtr input = effect->getInput(identityInputNb);
+    if (!input) {
+        return EffectInstancePtr();
+    }
+    RenderScale inputMappedScale = (input->supportsRenderScaleMaybe() == EffectInstance::eSupportsNo) ? RenderScale(1.) : scale;
+    RectD inputRod;
+    stat = input->getRegionOfDefinition_public(input->getRenderHash(), time, inputMappedScale, view, &inputRod, 0);
+    if ( (stat == eStatusFailed) || (inputRod != rod) ) {
+        return EffectInstancePtr();
+    }
+    *inputNb = identityInputNb;
+
+    return input;
+} // getTransformPassThroughInput
+
 void
 EffectInstance::tryConcatenateTransforms(double time,
                                          bool draftRender,
@@ -1915,52 +1985,30 @@ EffectInstance::tryConcatenateTransforms(double time,
 
 
             // recursion upstream
-            bool inputCanTransform = false;
-            bool inputIsDisabled  =  input->getNode()->isNodeDisabled();
-
-            if (!inputIsDisabled) {
-                inputCanTransform = input->getNode()->getCurrentCanTransform();
-            }
-
-
-            while ( input && (inputCanTransform || inputIsDisabled) ) {
-                //input is either disabled, or identity or can concatenate a transform too
-                if (inputIsDisabled) {
-                    int prefInput;
-                    input = input->getNearestNonDisabled();
-                    prefInput = input ? input->getNode()->getPreferredInput() : -1;
-                    if (prefInput == -1) {
-                        break;
-                    }
-
-                    if (input) {
-                        im.newInputNbToFetchFrom = prefInput;
-                        im.newInputEffect = input;
-                    }
-                } else if (inputCanTransform) {
-                    Transform::Matrix3x3 m;
-                    inputToTransform.reset();
-                    StatusEnum stat = input->getTransform_public(time, scale, draftRender, view, &inputToTransform, &m);
-                    if (stat == eStatusOK) {
-                        matricesByOrder.push_back(m);
-                        if (inputToTransform) {
-                            im.newInputNbToFetchFrom = input->getInputNumber( inputToTransform.get() );
-                            im.newInputEffect = input;
-                            input = inputToTransform;
-                        }
-                    } else {
-                        break;
-                    }
-                } else {
-                    assert(false);
+            while (input) {
+                // Nodes that pass their input through do not break the chain, fetch directly from their input
+                int passThroughInputNb = -1;
+                EffectInstancePtr passThroughInput = getTransformPassThroughInput(input, time, view, scale, &passThroughInputNb);
+                if (passThroughInput) {
+                    im.newInputNbToFetchFrom = passThroughInputNb;
+                    im.newInputEffect = input;
+                    input = passThroughInput;
+                    continue;
                 }
 
-                if (input) {
-                    inputIsDisabled = input->getNode()->isNodeDisabled();
-                    if (!inputIsDisabled) {
-                        inputCanTransform = input->getNode()->getCurrentCanTransform();
-                    }
+                if ( !input->getNode()->getCurrentCanTransform() ) {
+                    break;
+                }
+                Transform::Matrix3x3 m;
+                inputToTransform.reset();
+                StatusEnum stat = input->getTransform_public(time, scale, draftRender, view, &inputToTransform, &m);
+                if ( (stat != eStatusOK) || !inputToTransform ) {
+                    break;
                 }
+                matricesByOrder.push_back(m);
+                im.newInputNbToFetchFrom = input->getInputNumber( inputToTransform.get() );
+                im.newInputEffect = input;
+                input = inputToTransform;
             }
 
             if ( input && !matricesByOrder.empty() ) {
@@ -2217,6 +2265,9 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
 #endif
     EffectTLSDataPtr tls = tlsData->getOrCreateTLSData();
 
+    // The temporary images of this tile recycle their buffer through the pool of the frame render
+    ImageBufferPool::ThreadPoolSetter_RAII bufferPoolScope( tls->frameArgs.empty() ? ImageBufferPoolPtr() : tls->frameArgs.back()->bufferPool );
+
     if ( rectToRender.rect.isNull() ) {
         // should never happen, but crashes when loading
         // https://github.com/NatronGitHub/Natron/files/4630686/maskissue.log
@@ -2407,13 +2458,10 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
                                               const ImagePremultiplicationEnum originalImagePremultiplication,
                                               ImagePlanesToRender & planes)
 {
-    TimeLapsePtr timeRecorder;
+    // Always measure the render time: it is also the cost recorded in the cached images
+    TimeLapsePtr timeRecorder = boost::make_shared<TimeLapse>();
     const ParallelRenderArgsPtr& frameArgs = tls->frameArgs.back();
 
-    if (frameArgs->stats) {
-        timeRecorder = boost::make_shared<TimeLapse>();
-    }
-
     const EffectInstance::PlaneToRender & firstPlane = planes.planes.begin()->second;
     const double time = tls->currentRenderArgs.time;
     const ViewIdx view = tls->currentRenderArgs.view;
@@ -2605,7 +2653,7 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
     for (std::map<ImagePlaneDesc, EffectInstance::PlaneToRender>::iterator it = tls->currentRenderArgs.outputPlanes.begin(); it != tls->currentRenderArgs.outputPlanes.end(); ++it) {
         /*
          * When using the cache, allocate a local temporary buffer onto which the plug-in will render, and then safely
-         * copy this buffer to the shared (among threads) image.
+         * copy this buffer to the shared (among threads) image, unless the plug-in can render directly in the shared image.
          * This is also needed if the plug-in does not support the number of components of the renderMappedImage
          */
         ImagePlaneDesc prefComp;
@@ -2615,9 +2663,24 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
             prefComp = outputClipPrefsComps;
         }
 
+        const bool formatMatches = ( prefComp == it->second.renderMappedImage->getComponents() ) &&
+                                   ( outputClipPrefDepth == it->second.renderMappedImage->getBitDepth() );
+#if NATRON_ENABLE_TRIMAP
+        /*
+         * If the plug-in output matches the cached image, the plug-in renders directly in it: the rectangle being rendered
+         * is marked as pending in its bitmap so no other thread reads or renders it until it is done.
+         */
+        it->second.renderInPlace = formatMatches && it->second.renderMappedImage->usesBitMap() &&
+                                   ( planes.outputPremult == it->second.renderMappedImage->getPremultiplication() ) &&
+                                   ( it->second.renderMappedImage->getStorageMode() != eStorageModeGLTex ) &&
+                                   !_publicInterface->isPaintingOverItselfEnabled() && !planes.useOpenGL;
+#else
+        it->second.renderInPlace = false;
+#endif
+
         // OpenGL render never use the cache and bitmaps, all images are local to a render.
-        if ( ( it->second.renderMappedImage->usesBitMap() || ( prefComp != it->second.renderMappedImage->getComponents() ) ||
-               ( outputClipPrefDepth != it->second.renderMappedImage->getBitDepth() ) ) && !_publicInterface->isPaintingOverItselfEnabled() && !planes.useOpenGL ) {
+        if ( !it->second.renderInPlace &&
+             ( it->second.renderMappedImage->usesBitMap() || !formatMatches ) && !_publicInterface->isPaintingOverItselfEnabled() && !planes.useOpenGL ) {
             it->second.tmpImage = boost::make_shared<Image>(prefComp,
                                                             it->second.renderMappedImage->getRoD(),
                                                             actionArgs.roi,
@@ -2832,7 +2895,9 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
                     }
                 }
 
-                if (mappedOriginalInputImage) {
+                if ( mappedOriginalInputImage &&
+                     !it->second.tmpImage->applyPostRenderPass(renderMappedRectToRender, it->second.tmpImage.get(), processChannels, mappedOriginalInputImage,
+                                                               useMaskMix, maskImage.get(), doMask, false, mix) ) {
                     it->second.tmpImage->copyUnProcessedChannels(renderMappedRectToRender, planes.outputPremult, originalImagePremultiplication, processChannels, mappedOriginalInputImage, true);
                     if (useMaskMix) {
                         it->second.tmpImage->applyMaskMix(renderMappedRectToRender, maskImage.get(), mappedOriginalInputImage.get(), doMask, false, mix);
@@ -2885,8 +2950,17 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
 
 
             } else { // if (renderFullScaleThenDownscale) {
-                ///Copy the rectangle rendered in the downscaled image
-                if (it->second.tmpImage != it->second.downscaleImage) {
+                ///Copy the rectangle rendered in the downscaled image, copy the unprocessed channels and apply the mask/mix
+                ///in a single pass when possible
+                bool postRenderPassDone = false;
+                if ( !planes.useOpenGL &&
+                     ( ( it->second.tmpImage == it->second.downscaleImage ) || ( it->second.tmpImage->getBounds() == actionArgs.roi ) ) ) {
+                    postRenderPassDone = it->second.downscaleImage->applyPostRenderPass(actionArgs.roi, it->second.tmpImage.get(), processChannels, originalInputImage,
+                                                                                        useMaskMix, maskImage.get(), doMask, false, mix);
+                }
+                if (postRenderPassDone) {
+                    // done
+                } else if (it->second.tmpImage != it->second.downscaleImage) {
                     // We cannot be rendering using OpenGL in this case
                     assert(!planes.useOpenGL);
 
@@ -2910,9 +2984,11 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
                     }
                 }
 
-                it->second.downscaleImage->copyUnProcessedChannels(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, originalInputImage, true, glContext);
-                if (useMaskMix) {
-                    it->second.downscaleImage->applyMaskMix(actionArgs.roi, maskImage.get(), originalInputImage.get(), doMask, false, mix, glContext);
+                if (!postRenderPassDone) {
+                    it->second.downscaleImage->copyUnProcessedChannels(actionArgs.roi, planes.outputPremult, originalImagePremultiplication, processChannels, originalInputImage, true, glContext);
+                    if (useMaskMix) {
+                        it->second.downscaleImage->applyMaskMix(actionArgs.roi, maskImage.get(), originalInputImage.get(), doMask, false, mix, glContext);
+                    }
                 }
             } // if (renderFullScaleThenDownscale) {
         } // if (it->second.isAllocatedOnTheFly) {
@@ -2922,6 +2998,16 @@ EffectInstance::Implementation::renderHandler(const EffectTLSDataPtr& tls,
         }
     } // for (std::map<ImagePlaneDesc,PlaneToRender>::const_iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
 
+    // Record the time spent in the images so that the cache keeps the expensive ones longer
+    const double renderCost = timeRecorder->getTimeSinceCreation() / planes.planes.size();
+    for (std::map<ImagePlaneDesc, EffectInstance::PlaneToRender>::const_iterator it = planes.planes.begin(); it != planes.planes.end(); ++it) {
+        if (it->second.fullscaleImage) {
+            it->second.fullscaleImage->addRenderCost(renderCost);
+        }
+        if ( it->second.downscaleImage && (it->second.downscaleImage != it->second.fullscaleImage) ) {
+            it->second.downscaleImage->addRenderCost(renderCost);
+        }
+    }
 
     return eRenderingFunctorRetOK;
 } // tiledRenderingFunctor
@@ -3814,6 +3900,7 @@ EffectInstance::isIdentity_public(bool useIdentityCache, // only set to true whe
         if (getSequentialPreference() != eSequentialPreferenceOnlySequential) {
             try {
                 *inputView = view;
+                _imp->actionsCache->notifyActionCalled(eCachedActionIsIdentity);
                 ret = isIdentity(time, scale, renderWindow, view, inputTime, inputView, inputNb);
             } catch (...) {
                 throw;
@@ -3846,7 +3933,8 @@ EffectInstance::getRegionOfDefinitionFromCache(U64 hash,
                                                RectD* rod,
                                                bool* isProjectFormat)
 {
-    unsigned int mipMapLevel = Image::getLevelFromScale(scale.x);
+    // A plug-in that does not support render scale is always asked for its RoD at scale 1, share the result across scales
+    unsigned int mipMapLevel = (supportsRenderScaleMaybe() == eSupportsNo) ? 0 : Image::getLevelFromScale(scale.x);
     bool foundInCache = _imp->actionsCache->getRoDResult(hash, time, view, mipMapLevel, rod);
 
     if (foundInCache) {
@@ -3875,7 +3963,8 @@ EffectInstance::getRegionOfDefinition_public(U64 hash,
         return eStatusFailed;
     }
 
-    unsigned int mipMapLevel = Image::getLevelFromScale(scale.x);
+    // A plug-in that does not support render scale is always asked for its RoD at scale 1, share the result across scales
+    unsigned int mipMapLevel = (supportsRenderScaleMaybe() == eSupportsNo) ? 0 : Image::getLevelFromScale(scale.x);
     bool foundInCache = _imp->actionsCache->getRoDResult(hash, time, view, mipMapLevel, rod);
     if (foundInCache) {
         if (isProjectFormat) {
@@ -3916,7 +4005,7 @@ EffectInstance::getRegionOfDefinition_public(U64 hash,
         {
             RECURSIVE_ACTION();
 
-
+            _imp->actionsCache->notifyActionCalled(eCachedActionGetRegionOfDefinition);
             ret = getRegionOfDefinition(hash, time, supportsRenderScaleMaybe() == eSupportsNo ? scaleOne : scale, view, rod);
 
             if ( (ret != eStatusOK) && (ret != eStatusReplyDefault) ) {
@@ -3981,6 +4070,7 @@ EffectInstance::getFramesNeeded_public(U64 hash,
     }
 
     try {
+        _imp->actionsCache->notifyActionCalled(eCachedActionGetFramesNeeded);
         framesNeeded = getFramesNeeded(time, view);
     } catch (std::exception &e) {
         if ( !hasPersistentMessage() ) { // plugin may already have set a message
@@ -4021,6 +4111,7 @@ EffectInstance::getFrameRange_public(U64 hash,
         }
 
         NON_RECURSIVE_ACTION();
+        _imp->actionsCache->notifyActionCalled(eCachedActionGetTimeDomain);
         getFrameRange(first, last);
         _imp->actionsCache->setTimeDomainResult(hash, *first, *last);
     }
@@ -4242,6 +4333,15 @@ void
 EffectInstance::clearActionsCache()
 {
     _imp->actionsCache->clearAll();
+    _imp->requestPassCache->clearAll();
+}
+
+void
+EffectInstance::getActionsCacheStatistics(CachedActionEnum action,
+                                          int* nbHits,
+                                          int* nbMisses) const
+{
+    _imp->actionsCache->getStatistics(action, nbHits, nbMisses);
 }
 
 
@@ -4455,6 +4555,7 @@ EffectInstance::getComponentsNeededAndProduced_public(U64 hash,
 
     // call the getClipComponents action
 
+    _imp->actionsCache->notifyActionCalled(eCachedActionGetComponents);
     getComponentsNeededAndProduced(time, view, comps, passThroughTime, passThroughView, passThroughInputNb);
 
 
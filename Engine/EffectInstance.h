@@ -674,7 +674,8 @@ public:
                                   PluginOpenGLRenderSupport currentOpenGLSupport,
                                   bool doNanHandling,
                                   bool draftMode,
-                                  const RenderStatsPtr & stats);
+                                  const RenderStatsPtr & stats,
+                                  const ImageBufferPoolPtr & bufferPool);
 
     void setDuringPaintStrokeCreationThreadLocal(bool duringPaintStroke);
 
@@ -1226,6 +1227,25 @@ public:
 
     void clearActionsCache();
 
+    /**
+     * @brief The actions whose results are stored in the actions cache, keyed by the node hash, time, view and scale.
+     **/
+    enum CachedActionEnum
+    {
+        eCachedActionIsIdentity = 0,
+        eCachedActionGetRegionOfDefinition,
+        eCachedActionGetFramesNeeded,
+        eCachedActionGetComponents,
+        eCachedActionGetTimeDomain,
+        eCachedActionCount
+    };
+
+    /**
+     * @brief Returns how many times the result of the given action was found in the actions cache (hits)
+     * and how many times the action of the plug-in was called (misses) since the effect was created.
+     **/
+    void getActionsCacheStatistics(CachedActionEnum action, int* nbHits, int* nbMisses) const;
+
     /**
      * @brief Use this function to post a transient message to the user. It will be displayed using
      * a dialog. The message can be of 4 types...
@@ -1402,6 +1422,12 @@ public:
          **/
         bool isAllocatedOnTheFly;
 
+        /**
+         * This is set to true if the plug-in renders directly in the cached renderMappedImage (tmpImage == renderMappedImage)
+         * instead of a temporary image, in which case other threads may be rendering other regions of the same image.
+         **/
+        bool renderInPlace;
+
         PlaneToRender()
             : fullscaleImage()
             , downscaleImage()
@@ -1410,6 +1436,7 @@ public:
             , cacheSwapImage()
             , originalCachedImage(0)
             , isAllocatedOnTheFly(false)
+            , renderInPlace(false)
         {
         }
     };
@@ -1834,6 +1861,8 @@ public:
 
     /**
      * @brief Check if Transform effects concatenation is possible on the current node and node upstream.
+     * Nodes passing their input through unchanged (disabled nodes, Dots, inputs and outputs of groups, identity nodes)
+     * do not break the chain of transforms.
      **/
     void tryConcatenateTransforms(double time,
                                   bool draftRender,
@@ -78,17 +78,45 @@ ActionsCache::getOrCreateActionCache(U64 newHash)
     return *found;
 }
 
+const ActionsCache::ActionsCacheInstance*
+ActionsCache::findActionCache(U64 hash) const
+{
+    for (std::list<ActionsCacheInstance>::const_iterator it = _instances.begin(); it != _instances.end(); ++it) {
+        if (it->_hash == hash) {
+            return &*it;
+        }
+    }
+
+    return 0;
+}
+
+void
+ActionsCache::addHit(EffectInstance::CachedActionEnum action) const
+{
+    _nbHits[action].fetchAndAddRelaxed(1);
+}
+
+void
+ActionsCache::notifyActionCalled(EffectInstance::CachedActionEnum action) const
+{
+    _nbMisses[action].fetchAndAddRelaxed(1);
+}
+
 ActionsCache::ActionsCache(int maxAvailableHashes)
-    : _cacheMutex()
+    : _cacheLock()
     , _instances()
     , _maxInstances( (std::size_t)maxAvailableHashes )
 {
+    for (int i = 0; i < EffectInstance::eCachedActionCount; ++i) {
+        _nbHits[i] = 0;
+        _nbMisses[i] = 0;
+    }
 }
 
 void
 ActionsCache::clearAll()
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
 
     _instances.clear();
 }
@@ -96,11 +124,28 @@ ActionsCache::clearAll()
 void
 ActionsCache::invalidateAll(U64 newHash)
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
 
+    // If the hash was used recently (e.g. after an undo), keep its results but make it the most recent
+    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
+        if (it->_hash == newHash) {
+            _instances.splice(_instances.end(), _instances, it);
+
+            return;
+        }
+    }
     createActionCacheInternal(newHash);
 }
 
+void
+ActionsCache::getStatistics(EffectInstance::CachedActionEnum action,
+                            int* nbHits,
+                            int* nbMisses) const
+{
+    *nbHits = (int)_nbHits[action];
+    *nbMisses = (int)_nbMisses[action];
+}
+
 bool
 ActionsCache::getIdentityResult(U64 hash,
                                 double time,
@@ -109,25 +154,23 @@ ActionsCache::getIdentityResult(U64 hash,
                                 ViewIdx *inputView,
                                 double* identityTime)
 {
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = 0;
-
-            IdentityCacheMap::const_iterator found = it->_identityCache.find(key);
-            if ( found != it->_identityCache.end() ) {
-                *inputNbIdentity = found->second.inputIdentityNb;
-                *identityTime = found->second.inputIdentityTime;
-                *inputView = found->second.inputView;
-
-                return true;
-            }
+    QReadLocker l(&_cacheLock);
+    const ActionsCacheInstance* cache = findActionCache(hash);
+
+    if (cache) {
+        ActionKey key;
+        key.time = time;
+        key.view = view;
+        key.mipMapLevel = 0;
+
+        IdentityCacheMap::const_iterator found = cache->_identityCache.find(key);
+        if ( found != cache->_identityCache.end() ) {
+            *inputNbIdentity = found->second.inputIdentityNb;
+            *identityTime = found->second.inputIdentityTime;
+            *inputView = found->second.inputView;
+            addHit(EffectInstance::eCachedActionIsIdentity);
 
-            return false;
+            return true;
         }
     }
 
@@ -142,7 +185,7 @@ ActionsCache::setIdentityResult(U64 hash,
                                 ViewIdx inputView,
                                 double identityTime)
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
     ActionsCacheInstance & cache = getOrCreateActionCache(hash);
     ActionKey key;
 
@@ -160,31 +203,30 @@ bool
 ActionsCache::getComponentsNeededResults(U64 hash, double time, ViewIdx view, EffectInstance::ComponentsNeededMap* neededComps, std::bitset<4> *processChannels, bool *processAll,
                                          std::list<ImagePlaneDesc> *passThroughPlanes, int* passThroughInputNb, ViewIdx *passThroughView, double* passThroughTime)
 {
-    QMutexLocker l(&_cacheMutex);
+    QReadLocker l(&_cacheLock);
+    const ActionsCacheInstance* cache = findActionCache(hash);
+
+    if (cache) {
+        ActionKey key;
+        key.time = time;
+        key.view = view;
+        key.mipMapLevel = 0;
+
+        ComponentsNeededCacheMap::const_iterator found = cache->_componentsNeededCache.find(key);
+        if ( found != cache->_componentsNeededCache.end() ) {
+            *passThroughInputNb = found->second.passThroughInputNb;
+            *passThroughTime = found->second.passThroughTime;
+            *passThroughView = found->second.passThroughView;
+            *neededComps = found->second.neededComps;
+            *processChannels = found->second.processChannels;
+            *processAll = found->second.processAll;
+            *passThroughPlanes = found->second.passThroughPlanes;
+            addHit(EffectInstance::eCachedActionGetComponents);
 
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = 0;
-
-            ComponentsNeededCacheMap::const_iterator found = it->_componentsNeededCache.find(key);
-            if ( found != it->_componentsNeededCache.end() ) {
-                *passThroughInputNb = found->second.passThroughInputNb;
-                *passThroughTime = found->second.passThroughTime;
-                *passThroughView = found->second.passThroughView;
-                *neededComps = found->second.neededComps;
-                *processChannels = found->second.processChannels;
-                *processAll = found->second.processAll;
-                *passThroughPlanes = found->second.passThroughPlanes;
-                return true;
-            }
-
-            return false;
+            return true;
         }
     }
-    
+
     return false;
 }
 
@@ -194,7 +236,7 @@ ActionsCache::setComponentsNeededResults(U64 hash, double time, ViewIdx view, co
                                          bool processAll,
                                          const std::list<ImagePlaneDesc>& passThroughPlanes, int passThroughInputNb, ViewIdx passThroughView, double passThroughTime)
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
     ActionsCacheInstance & cache = getOrCreateActionCache(hash);
     ActionKey key;
 
@@ -220,23 +262,21 @@ ActionsCache::getRoDResult(U64 hash,
                            unsigned int mipMapLevel,
                            RectD* rod)
 {
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = mipMapLevel;
+    QReadLocker l(&_cacheLock);
+    const ActionsCacheInstance* cache = findActionCache(hash);
 
-            RoDCacheMap::const_iterator found = it->_rodCache.find(key);
-            if ( found != it->_rodCache.end() ) {
-                *rod = found->second;
+    if (cache) {
+        ActionKey key;
+        key.time = time;
+        key.view = view;
+        key.mipMapLevel = mipMapLevel;
 
-                return true;
-            }
+        RoDCacheMap::const_iterator found = cache->_rodCache.find(key);
+        if ( found != cache->_rodCache.end() ) {
+            *rod = found->second;
+            addHit(EffectInstance::eCachedActionGetRegionOfDefinition);
 
-            return false;
+            return true;
         }
     }
 
@@ -250,7 +290,7 @@ ActionsCache::setRoDResult(U64 hash,
                            unsigned int mipMapLevel,
                            const RectD & rod)
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
     ActionsCacheInstance & cache = getOrCreateActionCache(hash);
     ActionKey key;
 
@@ -268,23 +308,21 @@ ActionsCache::getFramesNeededResult(U64 hash,
                                     unsigned int mipMapLevel,
                                     FramesNeededMap* framesNeeded)
 {
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = mipMapLevel;
+    QReadLocker l(&_cacheLock);
+    const ActionsCacheInstance* cache = findActionCache(hash);
 
-            FramesNeededCacheMap::const_iterator found = it->_framesNeededCache.find(key);
-            if ( found != it->_framesNeededCache.end() ) {
-                *framesNeeded = found->second;
+    if (cache) {
+        ActionKey key;
+        key.time = time;
+        key.view = view;
+        key.mipMapLevel = mipMapLevel;
 
-                return true;
-            }
+        FramesNeededCacheMap::const_iterator found = cache->_framesNeededCache.find(key);
+        if ( found != cache->_framesNeededCache.end() ) {
+            *framesNeeded = found->second;
+            addHit(EffectInstance::eCachedActionGetFramesNeeded);
 
-            return false;
+            return true;
         }
     }
 
@@ -298,7 +336,7 @@ ActionsCache::setFramesNeededResult(U64 hash,
                                     unsigned int mipMapLevel,
                                     const FramesNeededMap & framesNeeded)
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
     ActionsCacheInstance & cache = getOrCreateActionCache(hash);
     ActionKey key;
 
@@ -314,15 +352,15 @@ ActionsCache::getTimeDomainResult(U64 hash,
                                   double *first,
                                   double* last)
 {
-    QMutexLocker l(&_cacheMutex);
+    QReadLocker l(&_cacheLock);
+    const ActionsCacheInstance* cache = findActionCache(hash);
 
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if ( (it->_hash == hash) && it->_timeDomainSet ) {
-            *first = it->_timeDomain.min;
-            *last = it->_timeDomain.max;
+    if (cache && cache->_timeDomainSet) {
+        *first = cache->_timeDomain.min;
+        *last = cache->_timeDomain.max;
+        addHit(EffectInstance::eCachedActionGetTimeDomain);
 
-            return true;
-        }
+        return true;
     }
 
     return false;
@@ -333,7 +371,7 @@ ActionsCache::setTimeDomainResult(U64 hash,
                                   double first,
                                   double last)
 {
-    QMutexLocker l(&_cacheMutex);
+    QWriteLocker l(&_cacheLock);
     ActionsCacheInstance & cache = getOrCreateActionCache(hash);
 
     cache._timeDomainSet = true;
@@ -341,6 +379,280 @@ ActionsCache::setTimeDomainResult(U64 hash,
     cache._timeDomain.max = last;
 }
 
+// Maximum number of results of each kind remembered by a RequestPassCache. Results are stored for each
+// (view, mipmap level, render window) and a frame rendered in strips requests a different window for each strip.
+#define NATRON_REQUEST_PASS_CACHE_MAX_ENTRIES 32
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Returns true if b is equal to a where all frame ranges are offset by timeOffset
+ **/
+static bool
+framesNeededMatch(const FramesNeededMap& a,
+                  const FramesNeededMap& b,
+                  double timeOffset)
+{
+    if ( a.size() != b.size() ) {
+        return false;
+    }
+    for (FramesNeededMap::const_iterator itA = a.begin(), itB = b.begin(); itA != a.end(); ++itA, ++itB) {
+        if ( (itA->first != itB->first) || ( itA->second.size() != itB->second.size() ) ) {
+            return false;
+        }
+        for (FrameRangesMap::const_iterator viewA = itA->second.begin(), viewB = itB->second.begin(); viewA != itA->second.end(); ++viewA, ++viewB) {
+            if ( (viewA->first != viewB->first) || ( viewA->second.size() != viewB->second.size() ) ) {
+                return false;
+            }
+            for (std::size_t i = 0; i < viewA->second.size(); ++i) {
+                if ( (viewA->second[i].min + timeOffset != viewB->second[i].min) ||
+                     ( viewA->second[i].max + timeOffset != viewB->second[i].max) ) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static void
+offsetFramesNeeded(double timeOffset,
+                   FramesNeededMap* framesNeeded)
+{
+    for (FramesNeededMap::iterator it = framesNeeded->begin(); it != framesNeeded->end(); ++it) {
+        for (FrameRangesMap::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            for (std::size_t i = 0; i < it2->second.size(); ++i) {
+                it2->second[i].min += timeOffset;
+                it2->second[i].max += timeOffset;
+            }
+        }
+    }
+}
+
+static bool
+globalDataMatch(const FrameViewRequestGlobalData& a,
+                const FrameViewRequestGlobalData& b,
+                double timeOffset)
+{
+    if ( (a.identityInputNb != -1) && (a.inputIdentityTime + timeOffset != b.inputIdentityTime) ) {
+        return false;
+    }
+
+    return framesNeededMatch(a.frameViewsNeeded, b.frameViewsNeeded, timeOffset);
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+RequestPassCache::RequestPassCache()
+    : _cacheMutex()
+    , _hash(0)
+    , _globalData()
+    , _inputsRoI()
+{
+}
+
+void
+RequestPassCache::clearAll()
+{
+    QMutexLocker l(&_cacheMutex);
+
+    _globalData.clear();
+    _inputsRoI.clear();
+}
+
+void
+RequestPassCache::checkHash(U64 hash)
+{
+    if (hash != _hash) {
+        _globalData.clear();
+        _inputsRoI.clear();
+        _hash = hash;
+    }
+}
+
+std::list<RequestPassCache::GlobalDataEntry>::iterator
+RequestPassCache::findGlobalData(ViewIdx view,
+                                 unsigned int mipMapLevel,
+                                 bool useTransforms,
+                                 const RectD& renderWindow)
+{
+    for (std::list<GlobalDataEntry>::iterator it = _globalData.begin(); it != _globalData.end(); ++it) {
+        if ( (it->view == view) && (it->mipMapLevel == mipMapLevel) && (it->useTransforms == useTransforms) && (it->renderWindow == renderWindow) ) {
+            // Move it to the back of the LRU list
+            _globalData.splice(_globalData.end(), _globalData, it);
+
+            return it;
+        }
+    }
+
+    return _globalData.end();
+}
+
+bool
+RequestPassCache::getGlobalData(U64 hash,
+                                double time,
+                                ViewIdx view,
+                                unsigned int mipMapLevel,
+                                bool useTransforms,
+                                const RectD& renderWindow,
+                                FrameViewRequestGlobalData* data)
+{
+    QMutexLocker l(&_cacheMutex);
+
+    checkHash(hash);
+    std::list<GlobalDataEntry>::iterator found = findGlobalData(view, mipMapLevel, useTransforms, renderWindow);
+    if ( found == _globalData.end() ) {
+        return false;
+    }
+    switch (found->timeDependency) {
+    case eTimeDependencyUnknown:
+        if (found->time != time) {
+            return false;
+        }
+        *data = found->data;
+        break;
+    case eTimeDependencyRelative: {
+        double timeOffset = time - found->time;
+        *data = found->data;
+        data->inputIdentityTime += timeOffset;
+        offsetFramesNeeded(timeOffset, &data->frameViewsNeeded);
+        break;
+    }
+    case eTimeDependencyAbsolute:
+        *data = found->data;
+        break;
+    case eTimeDependencyVarying:
+
+        return false;
+    }
+    if (useTransforms) {
+        // Only results without any concatenated transform are stored
+        data->transforms = boost::make_shared<InputMatrixMap>();
+    }
+
+    return true;
+} // RequestPassCache::getGlobalData
+
+void
+RequestPassCache::setGlobalData(U64 hash,
+                                double time,
+                                ViewIdx view,
+                                unsigned int mipMapLevel,
+                                bool useTransforms,
+                                const RectD& renderWindow,
+                                const FrameViewRequestGlobalData& data)
+{
+    QMutexLocker l(&_cacheMutex);
+
+    checkHash(hash);
+    std::list<GlobalDataEntry>::iterator found = findGlobalData(view, mipMapLevel, useTransforms, renderWindow);
+
+    // The transforms hold pointers to the effects upstream and depend on the nodes downstream, do not store them
+    bool hasTransforms = data.transforms && !data.transforms->empty();
+
+    if ( found == _globalData.end() ) {
+        if (_globalData.size() >= NATRON_REQUEST_PASS_CACHE_MAX_ENTRIES) {
+            _globalData.pop_front();
+        }
+        GlobalDataEntry entry;
+        entry.view = view;
+        entry.mipMapLevel = mipMapLevel;
+        entry.useTransforms = useTransforms;
+        entry.renderWindow = renderWindow;
+        entry.time = time;
+        entry.timeDependency = hasTransforms ? eTimeDependencyVarying : eTimeDependencyUnknown;
+        entry.data = data;
+        entry.data.transforms.reset();
+        entry.data.reroutesMap.reset();
+        _globalData.push_back(entry);
+
+        return;
+    }
+
+    if (hasTransforms) {
+        found->timeDependency = eTimeDependencyVarying;
+
+        return;
+    }
+    if ( (found->timeDependency != eTimeDependencyUnknown) || (found->time == time) ) {
+        return;
+    }
+
+    // Results are now known at 2 different times: find out how they depend on the time
+    const FrameViewRequestGlobalData& prev = found->data;
+    if ( (prev.rod != data.rod) || (prev.isProjectFormat != data.isProjectFormat) || (prev.isIdentity != data.isIdentity) ||
+         ( prev.identityInputNb != data.identityInputNb) || ( prev.identityView != data.identityView) ) {
+        found->timeDependency = eTimeDependencyVarying;
+    } else if ( globalDataMatch(prev, data, time - found->time) ) {
+        found->timeDependency = eTimeDependencyRelative;
+    } else if ( globalDataMatch(prev, data, 0.) ) {
+        found->timeDependency = eTimeDependencyAbsolute;
+    } else {
+        found->timeDependency = eTimeDependencyVarying;
+    }
+} // RequestPassCache::setGlobalData
+
+bool
+RequestPassCache::getInputsRoI(U64 hash,
+                               ViewIdx view,
+                               unsigned int mipMapLevel,
+                               const RectD& renderWindow,
+                               RoIMap* inputsRoi)
+{
+    QMutexLocker l(&_cacheMutex);
+
+    checkHash(hash);
+    for (std::list<InputsRoIEntry>::iterator it = _inputsRoI.begin(); it != _inputsRoI.end(); ++it) {
+        if ( (it->view != view) || (it->mipMapLevel != mipMapLevel) || (it->renderWindow != renderWindow) ) {
+            continue;
+        }
+        RoIMap ret;
+        for (std::list<std::pair<EffectInstanceWPtr, RectD> >::const_iterator it2 = it->inputsRoi.begin(); it2 != it->inputsRoi.end(); ++it2) {
+            EffectInstancePtr input = it2->first.lock();
+            if (!input) {
+                // An input was deleted since, the node hash should have changed anyway
+                return false;
+            }
+            ret[input] = it2->second;
+        }
+        _inputsRoI.splice(_inputsRoI.end(), _inputsRoI, it);
+        *inputsRoi = ret;
+
+        return true;
+    }
+
+    return false;
+}
+
+void
+RequestPassCache::setInputsRoI(U64 hash,
+                               ViewIdx view,
+                               unsigned int mipMapLevel,
+                               const RectD& renderWindow,
+                               const RoIMap& inputsRoi)
+{
+    QMutexLocker l(&_cacheMutex);
+
+    checkHash(hash);
+    for (std::list<InputsRoIEntry>::iterator it = _inputsRoI.begin(); it != _inputsRoI.end(); ++it) {
+        if ( (it->view == view) && (it->mipMapLevel == mipMapLevel) && (it->renderWindow == renderWindow) ) {
+            return;
+        }
+    }
+    if (_inputsRoI.size() >= NATRON_REQUEST_PASS_CACHE_MAX_ENTRIES) {
+        _inputsRoI.pop_front();
+    }
+    InputsRoIEntry entry;
+    entry.view = view;
+    entry.mipMapLevel = mipMapLevel;
+    entry.renderWindow = renderWindow;
+    for (RoIMap::const_iterator it = inputsRoi.begin(); it != inputsRoi.end(); ++it) {
+        entry.inputsRoi.push_back( std::make_pair(EffectInstanceWPtr(it->first), it->second) );
+    }
+    _inputsRoI.push_back(entry);
+}
+
 EffectInstance::RenderArgs::RenderArgs()
     : rod()
     , regionOfInterestResults()
@@ -414,6 +726,7 @@ EffectInstance::Implementation::Implementation(EffectInstance* publicInterface)
     , pluginMemoryChunks()
     , supportsRenderScale(eSupportsMaybe)
     , actionsCache()
+    , requestPassCache()
 #if NATRON_ENABLE_TRIMAP
     , imagesBeingRenderedMutex()
     , imagesBeingRendered()
@@ -433,6 +746,7 @@ EffectInstance::Implementation::Implementation(EffectInstance* publicInterface)
 {
     tlsData = boost::make_shared<TLSHolder<EffectTLSData> >();
     actionsCache = boost::make_shared<ActionsCache>(appPTR->getHardwareIdealThreadCount() * 2);
+    requestPassCache = boost::make_shared<RequestPassCache>();
 }
 
 EffectInstance::Implementation::Implementation(const Implementation& other)
@@ -444,6 +758,7 @@ EffectInstance::Implementation::Implementation(const Implementation& other)
 , pluginMemoryChunks()
 , supportsRenderScale(other.supportsRenderScale)
 , actionsCache(other.actionsCache)
+, requestPassCache(other.requestPassCache)
 #if NATRON_ENABLE_TRIMAP
 , imagesBeingRenderedMutex()
 , imagesBeingRendered()
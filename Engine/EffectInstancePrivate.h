@@ -37,6 +37,8 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QWaitCondition>
 #include <QtCore/QMutex>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QAtomicInt>
 
 #include "Global/GlobalDefines.h"
 
@@ -109,9 +111,17 @@ typedef std::map<ActionKey, ComponentsNeededResults, CompareActionsCacheKeys> Co
    - getRegionOfDefinition (invalidated on hash change, mapped across time + scale)
    - getTimeDomain (invalidated on hash change, only 1 value possible
    - isIdentity (invalidated on hash change,mapped across time + scale)
+   - getFramesNeeded (invalidated on hash change, mapped across time + scale)
+   - getClipComponents (invalidated on hash change, mapped across time)
  * The reason we store them is that the OFX Clip API can potentially call these actions recursively
  * but this is forbidden by the spec:
  * http://openfx.sourceforge.net/Documentation/1.3/ofxProgrammingReference.html#id475585
+ * They are also called many times per frame (request pass, viewer, overlays, each render) and may be expensive,
+ * e.g. a reader probing a file for its region of definition.
+ *
+ * The results of the last maxAvailableHashes node hashes are kept, the oldest hash is discarded when the node
+ * hash changes (see Node::computeHashInternal). Lookups only take a read lock so that concurrent renders do not
+ * serialize on the cache.
  **/
 class ActionsCache
 {
@@ -120,8 +130,19 @@ public:
 
     void clearAll();
 
+    /**
+     * @brief Makes newHash the most recent hash of the cache, discarding the results of the oldest hash if needed.
+     **/
     void invalidateAll(U64 newHash);
 
+    void getStatistics(EffectInstance::CachedActionEnum action, int* nbHits, int* nbMisses) const;
+
+    /**
+     * @brief Counts a miss for the given action. The get*Result functions only count the hits: this is called
+     * by the effect when it actually calls the action of the plug-in.
+     **/
+    void notifyActionCalled(EffectInstance::CachedActionEnum action) const;
+
     bool getIdentityResult(U64 hash, double time, ViewIdx view, int* inputNbIdentity, ViewIdx *inputView, double* identityTime);
 
     void setIdentityResult(U64 hash, double time, ViewIdx view, int inputNbIdentity, ViewIdx inputView, double identityTime);
@@ -145,7 +166,7 @@ public:
     void setTimeDomainResult(U64 hash, double first, double last);
 
 private:
-    mutable QMutex _cacheMutex; //< protects everything in the cache
+    mutable QReadWriteLock _cacheLock; //< protects everything in the cache but the statistics
     struct ActionsCacheInstance
     {
         U64 _hash;
@@ -162,8 +183,87 @@ private:
     //In  a list to track the LRU
     std::list<ActionsCacheInstance> _instances;
     std::size_t _maxInstances;
+
+    // Number of lookups that found a result and number of calls to the plug-in, for each action
+    mutable QAtomicInt _nbHits[EffectInstance::eCachedActionCount];
+    mutable QAtomicInt _nbMisses[EffectInstance::eCachedActionCount];
+
     std::list<ActionsCacheInstance>::iterator createActionCacheInternal(U64 newHash);
     ActionsCacheInstance & getOrCreateActionCache(U64 newHash);
+    const ActionsCacheInstance* findActionCache(U64 hash) const;
+    void addHit(EffectInstance::CachedActionEnum action) const;
+};
+
+/**
+ * @brief Stores the results of the request pass (EffectInstance::computeRequestPass) of a node whose output
+ * does not depend on the time (see isFrameVaryingOrAnimated_Recursive()), so that they can be reused by the
+ * request pass of the following frames instead of calling the isIdentity, getRegionOfDefinition, getFramesNeeded
+ * and getRegionsOfInterest actions again.
+ *
+ * The times returned by the plug-in (identity time, frames needed) may either follow the rendered time (e.g. a blur
+ * needs the current frame) or be fixed (e.g. a FrameHold): results are first recorded at one time and only reused once
+ * they were computed again at another time and found to be consistent with either case.
+ * Everything is invalidated when the node hash changes.
+ **/
+class RequestPassCache
+{
+public:
+    RequestPassCache();
+
+    void clearAll();
+
+    bool getGlobalData(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, bool useTransforms, const RectD& renderWindow, FrameViewRequestGlobalData* data);
+
+    void setGlobalData(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, bool useTransforms, const RectD& renderWindow, const FrameViewRequestGlobalData& data);
+
+    bool getInputsRoI(U64 hash, ViewIdx view, unsigned int mipMapLevel, const RectD& renderWindow, RoIMap* inputsRoi);
+
+    void setInputsRoI(U64 hash, ViewIdx view, unsigned int mipMapLevel, const RectD& renderWindow, const RoIMap& inputsRoi);
+
+private:
+
+    enum TimeDependencyEnum
+    {
+        eTimeDependencyUnknown = 0, // only computed at a single time so far
+        eTimeDependencyRelative, // the times follow the rendered time
+        eTimeDependencyAbsolute, // the times are the same whatever the rendered time
+        eTimeDependencyVarying // the results cannot be reused at another time
+    };
+
+    struct GlobalDataEntry
+    {
+        // The identity action depends on the render window
+        ViewIdx view;
+        unsigned int mipMapLevel;
+        bool useTransforms;
+        RectD renderWindow;
+
+        // The time at which the results were computed and how they depend on it
+        double time;
+        TimeDependencyEnum timeDependency;
+
+        // Identity, RoD and frames needed, as computed at time
+        FrameViewRequestGlobalData data;
+    };
+
+    struct InputsRoIEntry
+    {
+        ViewIdx view;
+        unsigned int mipMapLevel;
+        RectD renderWindow;
+        std::list<std::pair<EffectInstanceWPtr, RectD> > inputsRoi;
+    };
+
+    mutable QMutex _cacheMutex; //< protects everything in the cache
+    U64 _hash;
+
+    //In lists to track the LRU
+    std::list<GlobalDataEntry> _globalData;
+    std::list<InputsRoIEntry> _inputsRoI;
+
+    void checkHash(U64 hash);
+
+    std::list<GlobalDataEntry>::iterator findGlobalData(ViewIdx view, unsigned int mipMapLevel, bool useTransforms, const RectD& renderWindow);
 };
 
 
@@ -195,6 +295,9 @@ public:
     /// Mt-Safe actions cache
     ActionsCachePtr actionsCache;
 
+    /// Mt-Safe cache of the request pass results, reused across frames
+    RequestPassCachePtr requestPassCache;
+
 #if NATRON_ENABLE_TRIMAP
     ///Store all images being rendered to avoid 2 threads rendering the same portion of an image
     struct ImageBeingRendered
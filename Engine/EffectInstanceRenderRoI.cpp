@@ -57,6 +57,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/DiskCacheNode.h"
 #include "Engine/Cache.h"
 #include "Engine/Image.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/ImageParams.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
@@ -376,6 +377,9 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
         assert(!frameArgs->request || frameArgs->nodeHash == frameArgs->request->nodeHash);
     }
 
+    // Images that do not go to the cache recycle their buffer through the pool of the frame render
+    ImageBufferPool::ThreadPoolSetter_RAII bufferPoolScope(frameArgs->bufferPool);
+
     ///For writer we never want to cache otherwise the next time we want to render it will skip writing the image on disk!
     bool byPassCache = args.byPassCache;
 
@@ -633,7 +637,14 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
             //args.roi.toCanonical(args.mipMapLevel, rod, &canonicalRoI);
             args.roi.toCanonical_noClipping(args.mipMapLevel, par,  &canonicalRoI);
 
-            EffectInstancePtr inputEffectIdentity = getInput(inputNbIdentity);
+            // If the request pass resolved the pass-through nodes upstream, go directly to the first effect which renders
+            EffectInstancePtr inputEffectIdentity;
+            if (requestPassData) {
+                inputEffectIdentity = requestPassData->finalData.passThroughEffect.lock();
+            }
+            if (!inputEffectIdentity) {
+                inputEffectIdentity = getInput(inputNbIdentity);
+            }
             if (inputEffectIdentity) {
                 if ( frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
                     frameArgs->stats->setNodeIdentity( getNode(), inputEffectIdentity->getNode() );
@@ -839,7 +850,7 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
         // If the plug-in knows how to render on CPU, check if we actually should not render on CPU instead.
         if (openGLSupport == ePluginOpenGLRenderSupportYes) {
             // User want to force caching of this node but we cannot cache OpenGL renders, so fallback on CPU.
-            if ( getNode()->isForceCachingEnabled() ) {
+            if ( getNode()->isForceCachingEnabled() || getNode()->isPinnedInCache() ) {
                 storage = eStorageModeRAM;
                 glContextLocker.reset();
             }
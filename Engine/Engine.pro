@@ -71,6 +71,7 @@ SOURCES += \
     AppInstance.cpp \
     AppManager.cpp \
     AppManagerPrivate.cpp \
+    AutoSaveJournal.cpp \
     Backdrop.cpp \
     Bezier.cpp \
     BezierCP.cpp \
@@ -104,6 +105,7 @@ SOURCES += \
     HistogramCPU.cpp \
     HostOverlaySupport.cpp \
     Image.cpp \
+    ImageBufferPool.cpp \
     ImageConvert.cpp \
     ImageCopyChannels.cpp \
     ImageKey.cpp \
@@ -157,6 +159,7 @@ SOURCES += \
     PrecompNode.cpp \
     ProcessHandler.cpp \
     Project.cpp \
+    ProjectBinarySerialization.cpp \
     ProjectPrivate.cpp \
     ProjectSerialization.cpp \
     PyAppInstance.cpp \
@@ -263,6 +266,7 @@ HEADERS += \
     AppInstance.h \
     AppManager.h \
     AppManagerPrivate.h \
+    AutoSaveJournal.h \
     Backdrop.h \
     Bezier.h \
     BezierCP.h \
@@ -311,6 +315,8 @@ HEADERS += \
     HistogramCPU.h \
     HostOverlaySupport.h \
     Image.h \
+    ImageBufferPool.h \
+    ImageKernels.h \
     ImageKey.h \
     ImageLocker.h \
     ImageParams.h \
@@ -372,6 +378,7 @@ HEADERS += \
     PrecompNode.h \
     ProcessHandler.h \
     Project.h \
+    ProjectBinarySerialization.h \
     ProjectPrivate.h \
     ProjectSerialization.h \
     PyAppInstance.h \
@@ -473,6 +480,7 @@ HEADERS += \
     ../libs/OpenFX/include/nuke/fnPublicOfxExtensions.h \
     ../libs/OpenFX/include/tuttle/ofxReadWrite.h \
     ../libs/OpenFX_extensions/ofxhParametricParam.h \
+    ../libs/OpenFX_extensions/ofxNatronParametricParam.h \
     NatronEngine/animatedparam_wrapper.h \
     NatronEngine/app_wrapper.h \
     NatronEngine/appsettings_wrapper.h \
@@ -162,6 +162,7 @@ class HostOverlayKnobsCornerPin;
 class HostOverlayKnobsPosition;
 class HostOverlayKnobsTransform;
 class Image;
+class ImageBufferPool;
 class ImageKey;
 class ImageParams;
 class ImagePlaneDesc;
@@ -236,6 +237,7 @@ class RectI;
 class RenderEngine;
 class RenderStats;
 class RenderingFlagSetter;
+class RequestPassCache;
 class RotoContext;
 class RotoDrawableItem;
 class RotoItem;
@@ -350,6 +352,7 @@ typedef boost::shared_ptr<HostOverlayKnobsPosition> HostOverlayKnobsPositionPtr;
 typedef boost::shared_ptr<HostOverlayKnobsTransform> HostOverlayKnobsTransformPtr;
 typedef boost::shared_ptr<Image> ImagePtr;
 typedef boost::shared_ptr<Image const> ImageConstPtr;
+typedef boost::shared_ptr<ImageBufferPool> ImageBufferPoolPtr;
 typedef boost::shared_ptr<ImageParams> ImageParamsPtr;
 typedef boost::shared_ptr<ImagePlaneDesc> ImagePlaneDescPtr;
 typedef boost::shared_ptr<KnobBool> KnobBoolPtr;
@@ -402,6 +405,7 @@ typedef boost::shared_ptr<Project> ProjectPtr;
 typedef boost::shared_ptr<RenderEngine> RenderEnginePtr;
 typedef boost::shared_ptr<RenderStats> RenderStatsPtr;
 typedef boost::shared_ptr<RenderingFlagSetter> RenderingFlagSetterPtr;
+typedef boost::shared_ptr<RequestPassCache> RequestPassCachePtr;
 typedef boost::shared_ptr<RotoContext> RotoContextPtr;
 typedef boost::shared_ptr<RotoDrawableItem> RotoDrawableItemPtr;
 typedef boost::shared_ptr<RotoItem const> RotoItemConstPtr;
@@ -440,6 +444,7 @@ typedef boost::weak_ptr<EffectInstance> EffectInstanceWPtr;
 typedef boost::weak_ptr<FileSystemItem> FileSystemItemWPtr;
 typedef boost::weak_ptr<FileSystemModel> FileSystemModelWPtr;
 typedef boost::weak_ptr<Image> ImageWPtr;
+typedef boost::weak_ptr<ImageBufferPool> ImageBufferPoolWPtr;
 typedef boost::weak_ptr<KnobBool> KnobBoolWPtr;
 typedef boost::weak_ptr<KnobButton> KnobButtonWPtr;
 typedef boost::weak_ptr<KnobChoice> KnobChoiceWPtr;
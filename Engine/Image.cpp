@@ -29,20 +29,39 @@
 #include <cassert>
 #include <cstring> // for std::memcpy, std::memset
 #include <stdexcept>
+#include <utility> // pair
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NATRON_IMAGE_USE_NEON
+#endif
 
 #if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <boost/math/special_functions/fpclassify.hpp>
+// /usr/local/include/boost/bind/arg.hpp:37:9: warning: unused typedef 'boost_static_assert_typedef_37' [-Wunused-local-typedef]
+#include <boost/bind/bind.hpp>
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #endif
 
 #include <QtCore/QDebug>
+#include <QtCore/QThreadPool>
+CLANG_DIAG_OFF(deprecated)
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+CLANG_DIAG_ON(deprecated)
 
 #include "Engine/AppManager.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/GLShader.h"
+#include "Engine/ImageKernels.h"
+
+using namespace boost::placeholders;
 
 NATRON_NAMESPACE_ENTER
 
@@ -50,6 +69,9 @@ NATRON_NAMESPACE_ENTER
 
 #define PIXEL_UNAVAILABLE 2
 
+// Minimum number of destination pixels for the mipmap kernels to split their work across the threads of the global thread pool
+#define NATRON_IMAGE_MIPMAP_MT_MIN_PIXELS (256 * 256)
+
 template <int trimap>
 RectI
 minimalNonMarkedBbox_internal(const RectI& roi,
@@ -622,7 +644,7 @@ Image::printUnrenderedPixels(const RectI& roi) const
     if (!_useBitmap) {
         return;
     }
-    QReadLocker k(&_entryLock);
+    QMutexLocker k(&_bitmapLock);
     const char* bm = _bitmap.getBitmapAt(roi.x1, roi.y1);
     int roiw = roi.x2 - roi.x1;
     int boundsW = _bitmap.getBounds().width();
@@ -685,6 +707,7 @@ Image::Image(const ImageKey & key,
              const ImageParamsPtr& params,
              const CacheAPI* cache)
     : CacheEntryHelper<unsigned char, ImageKey, ImageParams>(key, params, cache)
+    , _bitmapLock(QMutex::Recursive)
     , _useBitmap(true)
 {
     _bitDepth = params->getBitDepth();
@@ -700,6 +723,7 @@ Image::Image(const ImageKey & key,
 Image::Image(const ImageKey & key,
              const ImageParamsPtr& params)
     : CacheEntryHelper<unsigned char, ImageKey, ImageParams>( key, params, NULL )
+    , _bitmapLock(QMutex::Recursive)
     , _useBitmap(false)
 {
     _bitDepth = params->getBitDepth();
@@ -729,6 +753,7 @@ Image::Image(const ImagePlaneDesc& components,
              StorageModeEnum storage,
              U32 textureTarget)
     : CacheEntryHelper<unsigned char, ImageKey, ImageParams>()
+    , _bitmapLock(QMutex::Recursive)
     , _useBitmap(useBitmap)
 {
     setCacheEntry(makeKey(0, 0, false, 0, ViewIdx(0), false, false),
@@ -780,6 +805,8 @@ Image::~Image()
 void
 Image::onMemoryAllocated(bool diskRestoration)
 {
+    QMutexLocker k(&_bitmapLock);
+
     if (_cache || _useBitmap) {
         _bitmap.initialize(_bounds);
     }
@@ -799,7 +826,7 @@ Image::onMemoryAllocated(bool diskRestoration)
 void
 Image::setBitmapDirtyZone(const RectI& zone)
 {
-    QWriteLocker k(&_entryLock);
+    QMutexLocker k(&_bitmapLock);
 
     _bitmap.setDirtyZone(zone);
 }
@@ -1154,6 +1181,8 @@ Image::ensureBounds(const RectI& newBounds,
     }
 
     QWriteLocker k(&_entryLock);
+    // Regions marked in the bitmap while it is copied would be lost by the swap
+    QMutexLocker k2(&_bitmapLock);
     RectI merge = newBounds;
     merge.merge(_bounds);
 
@@ -1808,6 +1837,514 @@ Image::getRowElements() const
     return getComponentsCount() * _bounds.width();
 }
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Splits the rows [y1, y2) in bands that can be processed concurrently by the global thread pool.
+ * A single band is returned if the area is too small to be worth it or if there is no thread available.
+ **/
+std::vector<std::pair<int, int> >
+splitMipMapRows(int y1,
+                int y2,
+                int width)
+{
+    std::vector<std::pair<int, int> > bands;
+    int height = y2 - y1;
+
+    if (height <= 0) {
+        return bands;
+    }
+    QThreadPool* tp = QThreadPool::globalInstance();
+    int nThreads = std::min( height, tp->maxThreadCount() - tp->activeThreadCount() );
+    if ( (nThreads <= 1) || ( (qint64)width * height < NATRON_IMAGE_MIPMAP_MT_MIN_PIXELS ) ) {
+        bands.push_back( std::make_pair(y1, y2) );
+
+        return bands;
+    }
+    int bandHeight = (height + nThreads - 1) / nThreads;
+    for (int y = y1; y < y2; y += bandHeight) {
+        bands.push_back( std::make_pair( y, std::min(y + bandHeight, y2) ) );
+    }
+
+    return bands;
+}
+
+/**
+ * @brief Averages the 2x2 blocks of the source rows srcRow0 and srcRow1 into count destination pixels.
+ * All the blocks must lie inside the source image. The sum is done in the same order as the generic
+ * code path so that all the implementations give the same result.
+ **/
+template <typename PIX, int nComps>
+void
+halveRowInteriorScalar(const PIX* srcRow0,
+                       const PIX* srcRow1,
+                       PIX* dst,
+                       int count)
+{
+    for (int x = 0; x < count; ++x, srcRow0 += 2 * nComps, srcRow1 += 2 * nComps, dst += nComps) {
+        for (int k = 0; k < nComps; ++k) {
+            dst[k] = (srcRow0[k] + srcRow0[k + nComps] + srcRow1[k] + srcRow1[k + nComps]) / 4;
+        }
+    }
+}
+
+template <typename PIX, int nComps>
+void
+halveRowInterior(const PIX* srcRow0,
+                 const PIX* srcRow1,
+                 PIX* dst,
+                 int count)
+{
+    halveRowInteriorScalar<PIX, nComps>(srcRow0, srcRow1, dst, count);
+}
+
+#if defined(__SSE2__)
+
+template <>
+void
+halveRowInterior<float, 1>(const float* srcRow0,
+                           const float* srcRow1,
+                           float* dst,
+                           int count)
+{
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    int x = 0;
+
+    for (; x + 4 <= count; x += 4, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        __m128 r00 = _mm_loadu_ps(srcRow0);
+        __m128 r01 = _mm_loadu_ps(srcRow0 + 4);
+        __m128 r10 = _mm_loadu_ps(srcRow1);
+        __m128 r11 = _mm_loadu_ps(srcRow1 + 4);
+        ///a b
+        ///c d
+        __m128 a = _mm_shuffle_ps( r00, r01, _MM_SHUFFLE(2, 0, 2, 0) );
+        __m128 b = _mm_shuffle_ps( r00, r01, _MM_SHUFFLE(3, 1, 3, 1) );
+        __m128 c = _mm_shuffle_ps( r10, r11, _MM_SHUFFLE(2, 0, 2, 0) );
+        __m128 d = _mm_shuffle_ps( r10, r11, _MM_SHUFFLE(3, 1, 3, 1) );
+        _mm_storeu_ps( dst, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(a, b), c), d), quarter) );
+    }
+    halveRowInteriorScalar<float, 1>(srcRow0, srcRow1, dst, count - x);
+}
+
+template <>
+void
+halveRowInterior<float, 2>(const float* srcRow0,
+                           const float* srcRow1,
+                           float* dst,
+                           int count)
+{
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    int x = 0;
+
+    for (; x + 2 <= count; x += 2, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        __m128 r00 = _mm_loadu_ps(srcRow0);
+        __m128 r01 = _mm_loadu_ps(srcRow0 + 4);
+        __m128 r10 = _mm_loadu_ps(srcRow1);
+        __m128 r11 = _mm_loadu_ps(srcRow1 + 4);
+        __m128 a = _mm_shuffle_ps( r00, r01, _MM_SHUFFLE(1, 0, 1, 0) );
+        __m128 b = _mm_shuffle_ps( r00, r01, _MM_SHUFFLE(3, 2, 3, 2) );
+        __m128 c = _mm_shuffle_ps( r10, r11, _MM_SHUFFLE(1, 0, 1, 0) );
+        __m128 d = _mm_shuffle_ps( r10, r11, _MM_SHUFFLE(3, 2, 3, 2) );
+        _mm_storeu_ps( dst, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(a, b), c), d), quarter) );
+    }
+    halveRowInteriorScalar<float, 2>(srcRow0, srcRow1, dst, count - x);
+}
+
+template <>
+void
+halveRowInterior<float, 4>(const float* srcRow0,
+                           const float* srcRow1,
+                           float* dst,
+                           int count)
+{
+    const __m128 quarter = _mm_set1_ps(0.25f);
+
+    for (int x = 0; x < count; ++x, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        __m128 a = _mm_loadu_ps(srcRow0);
+        __m128 b = _mm_loadu_ps(srcRow0 + 4);
+        __m128 c = _mm_loadu_ps(srcRow1);
+        __m128 d = _mm_loadu_ps(srcRow1 + 4);
+        _mm_storeu_ps( dst, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(a, b), c), d), quarter) );
+    }
+}
+
+template <>
+void
+halveRowInterior<unsigned char, 4>(const unsigned char* srcRow0,
+                                   const unsigned char* srcRow1,
+                                   unsigned char* dst,
+                                   int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+
+    // 2 destination pixels per iteration, the sums are done on 16 bits (4 * 255 fits)
+    for (; x + 2 <= count; x += 2, srcRow0 += 16, srcRow1 += 16, dst += 8) {
+        __m128i r0 = _mm_loadu_si128( (const __m128i*)srcRow0 );
+        __m128i r1 = _mm_loadu_si128( (const __m128i*)srcRow1 );
+        __m128i sumLo = _mm_add_epi16( _mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero) );
+        __m128i sumHi = _mm_add_epi16( _mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero) );
+        sumLo = _mm_add_epi16( sumLo, _mm_srli_si128(sumLo, 8) );
+        sumHi = _mm_add_epi16( sumHi, _mm_srli_si128(sumHi, 8) );
+        __m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(sumLo, sumHi), 2);
+        _mm_storel_epi64( (__m128i*)dst, _mm_packus_epi16(sum, sum) );
+    }
+    halveRowInteriorScalar<unsigned char, 4>(srcRow0, srcRow1, dst, count - x);
+}
+
+template <>
+void
+halveRowInterior<unsigned short, 4>(const unsigned short* srcRow0,
+                                    const unsigned short* srcRow1,
+                                    unsigned short* dst,
+                                    int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16( (short)-32768 );
+
+    // The sums are done on 32 bits. SSE2 has no unsigned 32 to 16 bits pack, so the values are biased to use the signed one
+    for (int x = 0; x < count; ++x, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        __m128i r0 = _mm_loadu_si128( (const __m128i*)srcRow0 );
+        __m128i r1 = _mm_loadu_si128( (const __m128i*)srcRow1 );
+        __m128i sum = _mm_add_epi32( _mm_add_epi32( _mm_add_epi32( _mm_unpacklo_epi16(r0, zero), _mm_unpackhi_epi16(r0, zero) ),
+                                                    _mm_unpacklo_epi16(r1, zero) ),
+                                     _mm_unpackhi_epi16(r1, zero) );
+        sum = _mm_sub_epi32(_mm_srli_epi32(sum, 2), bias32);
+        _mm_storel_epi64( (__m128i*)dst, _mm_add_epi16(_mm_packs_epi32(sum, sum), bias16) );
+    }
+}
+
+#elif defined(NATRON_IMAGE_USE_NEON)
+
+template <>
+void
+halveRowInterior<float, 1>(const float* srcRow0,
+                           const float* srcRow1,
+                           float* dst,
+                           int count)
+{
+    int x = 0;
+
+    for (; x + 4 <= count; x += 4, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        // vld2q deinterleaves the even and odd columns
+        float32x4x2_t r0 = vld2q_f32(srcRow0);
+        float32x4x2_t r1 = vld2q_f32(srcRow1);
+        vst1q_f32( dst, vmulq_n_f32(vaddq_f32(vaddq_f32(vaddq_f32(r0.val[0], r0.val[1]), r1.val[0]), r1.val[1]), 0.25f) );
+    }
+    halveRowInteriorScalar<float, 1>(srcRow0, srcRow1, dst, count - x);
+}
+
+template <>
+void
+halveRowInterior<float, 2>(const float* srcRow0,
+                           const float* srcRow1,
+                           float* dst,
+                           int count)
+{
+    int x = 0;
+
+    for (; x + 2 <= count; x += 2, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        float32x4_t r00 = vld1q_f32(srcRow0);
+        float32x4_t r01 = vld1q_f32(srcRow0 + 4);
+        float32x4_t r10 = vld1q_f32(srcRow1);
+        float32x4_t r11 = vld1q_f32(srcRow1 + 4);
+        float32x4_t a = vcombine_f32( vget_low_f32(r00), vget_low_f32(r01) );
+        float32x4_t b = vcombine_f32( vget_high_f32(r00), vget_high_f32(r01) );
+        float32x4_t c = vcombine_f32( vget_low_f32(r10), vget_low_f32(r11) );
+        float32x4_t d = vcombine_f32( vget_high_f32(r10), vget_high_f32(r11) );
+        vst1q_f32( dst, vmulq_n_f32(vaddq_f32(vaddq_f32(vaddq_f32(a, b), c), d), 0.25f) );
+    }
+    halveRowInteriorScalar<float, 2>(srcRow0, srcRow1, dst, count - x);
+}
+
+template <>
+void
+halveRowInterior<float, 4>(const float* srcRow0,
+                           const float* srcRow1,
+                           float* dst,
+                           int count)
+{
+    for (int x = 0; x < count; ++x, srcRow0 += 8, srcRow1 += 8, dst += 4) {
+        float32x4_t a = vld1q_f32(srcRow0);
+        float32x4_t b = vld1q_f32(srcRow0 + 4);
+        float32x4_t c = vld1q_f32(srcRow1);
+        float32x4_t d = vld1q_f32(srcRow1 + 4);
+        vst1q_f32( dst, vmulq_n_f32(vaddq_f32(vaddq_f32(vaddq_f32(a, b), c), d), 0.25f) );
+    }
+}
+
+#endif // __SSE2__
+
+/**
+ * @brief Same as halveRowInterior for the bitmap: a destination pixel is rendered only if the 4 source pixels are.
+ * Pixels being rendered by another thread (PIXEL_UNAVAILABLE) are considered as not rendered.
+ **/
+void
+halveBitmapRowInterior(const char* srcRow0,
+                       const char* srcRow1,
+                       char* dst,
+                       int count)
+{
+    for (int x = 0; x < count; ++x, srcRow0 += 2, srcRow1 += 2) {
+        dst[x] = (srcRow0[0] == 1) && (srcRow0[1] == 1) && (srcRow1[0] == 1) && (srcRow1[1] == 1);
+    }
+}
+
+template <typename PIX>
+struct HalveRoIArgs
+{
+    // Pointers offset so that they correspond to pixel (0,0)
+    const PIX* srcData;
+    PIX* dstData;
+    const char* srcBmData;
+    char* dstBmData;
+    int srcRowSize, dstRowSize;
+    int srcBmRowSize, dstBmRowSize;
+    int nComps;
+    bool copyBitMap;
+    RectI srcBounds;
+    RectI dstRoI;
+
+    // The destination columns for which the 2x2 source blocks lie entirely inside srcBounds
+    int interiorX1, interiorX2;
+    void (*halveInterior)(const PIX*, const PIX*, PIX*, int);
+};
+
+/**
+ * @brief Generic code path of halveRows, handling a single destination pixel whose 2x2 source block may be partially
+ * outside of the source image.
+ **/
+template <typename PIX>
+void
+halvePixel(const HalveRoIArgs<PIX>& args,
+           const PIX* const srcLineStart,
+           PIX* const dstLineStart,
+           const char* const srcBmLineStart,
+           char* const dstBmLineStart,
+           int x,
+           bool pickThisRow,
+           bool pickNextRow)
+{
+    const int nComps = args.nComps;
+    const int srcRowSize = args.srcRowSize;
+    const int srcBmRowSize = args.srcBmRowSize;
+    const PIX* const srcPixStart    = srcLineStart   + x * 2 * nComps;
+    const char* const srcBmPixStart = srcBmLineStart + x * 2;
+    PIX* const dstPixStart          = dstLineStart   + x * nComps;
+    char* const dstBmPixStart       = dstBmLineStart + x;
+    int sumH = (int)pickNextRow + (int)pickThisRow;
+
+    // The current dst col, at y, covers the src cols x*2 (thisCol) and x*2+1 (nextCol).
+    // Check that if are within srcBounds.
+    int srcx = x * 2;
+    bool pickThisCol = args.srcBounds.x1 <= (srcx + 0) && (srcx + 0) < args.srcBounds.x2;
+    bool pickNextCol = args.srcBounds.x1 <= (srcx + 1) && (srcx + 1) < args.srcBounds.x2;
+    int sumW = (int)pickThisCol + (int)pickNextCol;
+    assert(sumW == 1 || sumW == 2);
+    const int sum = sumW * sumH;
+    assert(0 < sum && sum <= 4);
+
+    if (sum == 0) { // never happens
+        for (int k = 0; k < nComps; ++k) {
+            dstPixStart[k] = 0;
+        }
+        if (args.copyBitMap) {
+            dstBmPixStart[0] = 0;
+        }
+
+        return;
+    }
+
+    for (int k = 0; k < nComps; ++k) {
+        ///a b
+        ///c d
+
+        const PIX a = (pickThisCol && pickThisRow) ? *(srcPixStart + k) : 0;
+        const PIX b = (pickNextCol && pickThisRow) ? *(srcPixStart + k + nComps) : 0;
+        const PIX c = (pickThisCol && pickNextRow) ? *(srcPixStart + k + srcRowSize) : 0;
+        const PIX d = (pickNextCol && pickNextRow) ? *(srcPixStart + k + srcRowSize  + nComps)  : 0;
+
+        assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
+        assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
+        dstPixStart[k] = (a + b + c + d) / sum;
+    }
+
+    if (args.copyBitMap) {
+        ///a b
+        ///c d
+
+        char a = (pickThisCol && pickThisRow) ? *(srcBmPixStart) : 0;
+        char b = (pickNextCol && pickThisRow) ? *(srcBmPixStart + 1) : 0;
+        char c = (pickThisCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize) : 0;
+        char d = (pickNextCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize  + 1)  : 0;
+#if NATRON_ENABLE_TRIMAP
+        /*
+           The only correct solution is to convert pixels being rendered to 0 otherwise the caller
+           would have to wait for the original fullscale image render to be finished and then re-downscale again.
+         */
+        if (a == PIXEL_UNAVAILABLE) {
+            a = 0;
+        }
+        if (b == PIXEL_UNAVAILABLE) {
+            b = 0;
+        }
+        if (c == PIXEL_UNAVAILABLE) {
+            c = 0;
+        }
+        if (d == PIXEL_UNAVAILABLE) {
+            d = 0;
+        }
+#endif
+        assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
+        assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
+        assert(a + b + c + d <= sum); // bitmaps are 0 or 1
+        // the following is an integer division, the result can be 0 or 1
+        dstBmPixStart[0] = (a + b + c + d) / sum;
+        assert(dstBmPixStart[0] == 0 || dstBmPixStart[0] == 1);
+    }
+} // halvePixel
+
+template <typename PIX>
+void
+halveRows(const HalveRoIArgs<PIX>& args,
+          const std::pair<int, int>& rows)
+{
+    const RectI& srcBounds = args.srcBounds;
+    const RectI& dstRoI = args.dstRoI;
+    const int nComps = args.nComps;
+    const int srcRowSize = args.srcRowSize;
+    const int srcBmRowSize = args.srcBmRowSize;
+    const bool copyBitMap = args.copyBitMap;
+
+    for (int y = rows.first; y < rows.second; ++y) {
+        const PIX* const srcLineStart    = args.srcData + y * 2 * srcRowSize;
+        PIX* const dstLineStart          = args.dstData + y     * args.dstRowSize;
+        const char* const srcBmLineStart = args.srcBmData + y * 2 * srcBmRowSize;
+        char* const dstBmLineStart       = args.dstBmData + y     * args.dstBmRowSize;
+
+        // The current dst row, at y, covers the src rows y*2 (thisRow) and y*2+1 (nextRow).
+        // Check that if are within srcBounds.
+        int srcy = y * 2;
+        bool pickThisRow = srcBounds.y1 <= (srcy + 0) && (srcy + 0) < srcBounds.y2;
+        bool pickNextRow = srcBounds.y1 <= (srcy + 1) && (srcy + 1) < srcBounds.y2;
+        int sumH = (int)pickNextRow + (int)pickThisRow;
+        assert(sumH == 1 || sumH == 2);
+
+        // Fast path for the blocks which are entirely inside the source image, the borders go through the generic code below
+        int x = dstRoI.x1;
+        if ( (sumH == 2) && (args.interiorX1 < args.interiorX2) ) {
+            for (; x < args.interiorX1; ++x) {
+                halvePixel(args, srcLineStart, dstLineStart, srcBmLineStart, dstBmLineStart, x, pickThisRow, pickNextRow);
+            }
+            int count = args.interiorX2 - args.interiorX1;
+            args.halveInterior(srcLineStart + x * 2 * nComps, srcLineStart + x * 2 * nComps + srcRowSize, dstLineStart + x * nComps, count);
+            if (copyBitMap) {
+                halveBitmapRowInterior(srcBmLineStart + x * 2, srcBmLineStart + x * 2 + srcBmRowSize, dstBmLineStart + x, count);
+            }
+            x = args.interiorX2;
+        }
+        for (; x < dstRoI.x2; ++x) {
+            halvePixel(args, srcLineStart, dstLineStart, srcBmLineStart, dstBmLineStart, x, pickThisRow, pickNextRow);
+        }
+    }
+} // halveRows
+
+template <typename PIX>
+struct UpscaleMipMapArgs
+{
+    // Pointers to the pixel (srcRoi.x1, srcRoi.y1) and (dstRoi.x1, dstRoi.y1)
+    const PIX* src;
+    PIX* dst;
+    int srcRowSize, dstRowSize;
+    int nComps;
+    int scale;
+    RectI srcRoi;
+    RectI dstRoi;
+    void (*upscaleRow)(const PIX*, PIX*, int, int, int, int);
+};
+
+/**
+ * @brief Fills the destination row [dstX1, dstX2) by replicating each pixel of the source row scale times.
+ * The first source pixel is at column srcX1 and may be partially covered.
+ **/
+template <typename PIX, int nComps>
+void
+upscaleRowForComponents(const PIX* src,
+                        PIX* dst,
+                        int srcX1,
+                        int dstX1,
+                        int dstX2,
+                        int scale)
+{
+    int xo = dstX1;
+
+    for (int xi = srcX1; xo < dstX2; ++xi, src += nComps) {
+        int xEnd = std::min( (xi + 1) * scale, dstX2 );
+        for (; xo < xEnd; ++xo, dst += nComps) {
+            for (int c = 0; c < nComps; ++c) {
+                dst[c] = src[c];
+            }
+        }
+    }
+}
+
+#if defined(__SSE2__)
+template <>
+void
+upscaleRowForComponents<float, 4>(const float* src,
+                                  float* dst,
+                                  int srcX1,
+                                  int dstX1,
+                                  int dstX2,
+                                  int scale)
+{
+    int xo = dstX1;
+
+    for (int xi = srcX1; xo < dstX2; ++xi, src += 4) {
+        const __m128 p = _mm_loadu_ps(src);
+        int xEnd = std::min( (xi + 1) * scale, dstX2 );
+        for (; xo < xEnd; ++xo, dst += 4) {
+            _mm_storeu_ps(dst, p);
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Upscales the source rows [rows.first, rows.second): each of them fills the first destination row it covers
+ * which is then copied to the other destination rows it covers.
+ **/
+template <typename PIX>
+void
+upscaleRows(const UpscaleMipMapArgs<PIX>& args,
+            const std::pair<int, int>& rows)
+{
+    const RectI& srcRoi = args.srcRoi;
+    const RectI& dstRoi = args.dstRoi;
+    const int dstRowElements = dstRoi.width() * args.nComps;
+
+    for (int yi = rows.first; yi < rows.second; ++yi) {
+        int yo = std::max(dstRoi.y1, yi * args.scale);
+        int yEnd = std::min( (yi + 1) * args.scale, dstRoi.y2 );
+        if (yo >= yEnd) {
+            continue;
+        }
+        const PIX* const srcLineStart = args.src + (yi - srcRoi.y1) * args.srcRowSize;
+        PIX* const dstLineBatchStart = args.dst + (yo - dstRoi.y1) * args.dstRowSize;
+        args.upscaleRow(srcLineStart, dstLineBatchStart, srcRoi.x1, dstRoi.x1, dstRoi.x2, args.scale);
+
+        // now replicate the line as many times as necessary
+        PIX* dstLineStart = dstLineBatchStart + args.dstRowSize;
+        for (++yo; yo < yEnd; ++yo, dstLineStart += args.dstRowSize) {
+            std::copy(dstLineBatchStart, dstLineBatchStart + dstRowElements, dstLineStart);
+        }
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
 // code proofread and fixed by @devernay on 4/12/2014
 template <typename PIX, int maxValue>
 void
@@ -1830,6 +2367,11 @@ Image::halveRoIForDepth(const RectI & roi,
     /// Take the lock for both bitmaps since we're about to read/write from them!
     QWriteLocker k1(&output->_entryLock);
     QReadLocker k2(&_entryLock);
+    QMutexLocker bk1(&output->_bitmapLock);
+    boost::scoped_ptr<QMutexLocker> bk2;
+    if (output != this) {
+        bk2.reset( new QMutexLocker(&_bitmapLock) );
+    }
 
     ///The source rectangle, intersected to this image region of definition in pixels
     const RectI &srcBounds = _bounds;
@@ -1863,105 +2405,60 @@ Image::halveRoIForDepth(const RectI & roi,
     const char* const srcBmPixels   = _bitmap.getBitmapAt(srcBmBounds.x1, srcBmBounds.y1);
     PIX* const dstPixels          = (PIX*)output->pixelAt(dstBounds.x1,   dstBounds.y1);
     char* const dstBmPixels = output->_bitmap.getBitmapAt(dstBmBounds.x1, dstBmBounds.y1);
-    int srcRowSize = srcBounds.width() * _nbComponents;
-    int dstRowSize = dstBounds.width() * _nbComponents;
-
-    // offset pointers so that srcData and dstData correspond to pixel (0,0)
-    const PIX* const srcData = srcPixels - (srcBounds.x1 * _nbComponents + srcRowSize * srcBounds.y1);
-    PIX* const dstData       = dstPixels - (dstBounds.x1 * _nbComponents + dstRowSize * dstBounds.y1);
-    const int srcBmRowSize = srcBmBounds.width();
-    const int dstBmRowSize = dstBmBounds.width();
-    const char* const srcBmData = srcBmPixels - (srcBmBounds.x1 + srcBmRowSize * srcBmBounds.y1);
-    char* const dstBmData       = dstBmPixels - (dstBmBounds.x1 + dstBmRowSize * dstBmBounds.y1);
-
-    for (int y = dstRoI.y1; y < dstRoI.y2; ++y) {
-        const PIX* const srcLineStart    = srcData + y * 2 * srcRowSize;
-        PIX* const dstLineStart          = dstData + y     * dstRowSize;
-        const char* const srcBmLineStart = srcBmData + y * 2 * srcBmRowSize;
-        char* const dstBmLineStart       = dstBmData + y     * dstBmRowSize;
-
-        // The current dst row, at y, covers the src rows y*2 (thisRow) and y*2+1 (nextRow).
-        // Check that if are within srcBounds.
-        int srcy = y * 2;
-        bool pickThisRow = srcBounds.y1 <= (srcy + 0) && (srcy + 0) < srcBounds.y2;
-        bool pickNextRow = srcBounds.y1 <= (srcy + 1) && (srcy + 1) < srcBounds.y2;
-        int sumH = (int)pickNextRow + (int)pickThisRow;
-        assert(sumH == 1 || sumH == 2);
 
-        for (int x = dstRoI.x1; x < dstRoI.x2; ++x) {
-            const PIX* const srcPixStart    = srcLineStart   + x * 2 * _nbComponents;
-            const char* const srcBmPixStart = srcBmLineStart + x * 2;
-            PIX* const dstPixStart          = dstLineStart   + x * _nbComponents;
-            char* const dstBmPixStart       = dstBmLineStart + x;
-
-            // The current dst col, at y, covers the src cols x*2 (thisCol) and x*2+1 (nextCol).
-            // Check that if are within srcBounds.
-            int srcx = x * 2;
-            bool pickThisCol = srcBounds.x1 <= (srcx + 0) && (srcx + 0) < srcBounds.x2;
-            bool pickNextCol = srcBounds.x1 <= (srcx + 1) && (srcx + 1) < srcBounds.x2;
-            int sumW = (int)pickThisCol + (int)pickNextCol;
-            assert(sumW == 1 || sumW == 2);
-            const int sum = sumW * sumH;
-            assert(0 < sum && sum <= 4);
-
-            if (sum == 0) { // never happens
-                for (int k = 0; k < _nbComponents; ++k) {
-                    dstPixStart[k] = 0;
-                }
-                if (copyBitMap) {
-                    dstBmPixStart[0] = 0;
-                }
-                continue;
-            }
-
-            for (int k = 0; k < _nbComponents; ++k) {
-                ///a b
-                ///c d
+    HalveRoIArgs<PIX> args;
+    args.srcRowSize = srcBounds.width() * _nbComponents;
+    args.dstRowSize = dstBounds.width() * _nbComponents;
 
-                const PIX a = (pickThisCol && pickThisRow) ? *(srcPixStart + k) : 0;
-                const PIX b = (pickNextCol && pickThisRow) ? *(srcPixStart + k + _nbComponents) : 0;
-                const PIX c = (pickThisCol && pickNextRow) ? *(srcPixStart + k + srcRowSize) : 0;
-                const PIX d = (pickNextCol && pickNextRow) ? *(srcPixStart + k + srcRowSize  + _nbComponents)  : 0;
-
-                assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
-                assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
-                dstPixStart[k] = (a + b + c + d) / sum;
-            }
+    // offset pointers so that srcData and dstData correspond to pixel (0,0)
+    args.srcData = srcPixels - (srcBounds.x1 * _nbComponents + args.srcRowSize * srcBounds.y1);
+    args.dstData = dstPixels - (dstBounds.x1 * _nbComponents + args.dstRowSize * dstBounds.y1);
+    args.srcBmRowSize = srcBmBounds.width();
+    args.dstBmRowSize = dstBmBounds.width();
+    args.srcBmData = srcBmPixels - (srcBmBounds.x1 + args.srcBmRowSize * srcBmBounds.y1);
+    args.dstBmData = dstBmPixels - (dstBmBounds.x1 + args.dstBmRowSize * dstBmBounds.y1);
+    args.nComps = _nbComponents;
+    args.copyBitMap = copyBitMap;
+    args.srcBounds = srcBounds;
+    args.dstRoI = dstRoI;
+
+    // The columns for which both x*2 and x*2+1 are within srcBounds
+    args.interiorX1 = dstRoI.x1;
+    while ( args.interiorX1 < dstRoI.x2 && (args.interiorX1 * 2 < srcBounds.x1) ) {
+        ++args.interiorX1;
+    }
+    args.interiorX2 = dstRoI.x2;
+    while ( args.interiorX2 > args.interiorX1 && ( (args.interiorX2 - 1) * 2 + 1 >= srcBounds.x2 ) ) {
+        --args.interiorX2;
+    }
 
-            if (copyBitMap) {
-                ///a b
-                ///c d
+    switch (_nbComponents) {
+    case 1:
+        args.halveInterior = halveRowInterior<PIX, 1>;
+        break;
+    case 2:
+        args.halveInterior = halveRowInterior<PIX, 2>;
+        break;
+    case 3:
+        args.halveInterior = halveRowInterior<PIX, 3>;
+        break;
+    case 4:
+        args.halveInterior = halveRowInterior<PIX, 4>;
+        break;
+    default:
+        // Use the generic code path for all pixels
+        args.halveInterior = 0;
+        args.interiorX2 = args.interiorX1;
+        break;
+    }
 
-                char a = (pickThisCol && pickThisRow) ? *(srcBmPixStart) : 0;
-                char b = (pickNextCol && pickThisRow) ? *(srcBmPixStart + 1) : 0;
-                char c = (pickThisCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize) : 0;
-                char d = (pickNextCol && pickNextRow) ? *(srcBmPixStart + srcBmRowSize  + 1)  : 0;
-#if NATRON_ENABLE_TRIMAP
-                /*
-                   The only correct solution is to convert pixels being rendered to 0 otherwise the caller
-                   would have to wait for the original fullscale image render to be finished and then re-downscale again.
-                 */
-                if (a == PIXEL_UNAVAILABLE) {
-                    a = 0;
-                }
-                if (b == PIXEL_UNAVAILABLE) {
-                    b = 0;
-                }
-                if (c == PIXEL_UNAVAILABLE) {
-                    c = 0;
-                }
-                if (d == PIXEL_UNAVAILABLE) {
-                    d = 0;
-                }
-#endif
-                assert( sumW == 2 || ( sumW == 1 && ( (a == 0 && c == 0) || (b == 0 && d == 0) ) ) );
-                assert( sumH == 2 || ( sumH == 1 && ( (a == 0 && b == 0) || (c == 0 && d == 0) ) ) );
-                assert(a + b + c + d <= sum); // bitmaps are 0 or 1
-                // the following is an integer division, the result can be 0 or 1
-                dstBmPixStart[0] = (a + b + c + d) / sum;
-                assert(dstBmPixStart[0] == 0 || dstBmPixStart[0] == 1);
-            }
+    std::vector<std::pair<int, int> > bands = splitMipMapRows( dstRoI.y1, dstRoI.y2, dstRoI.width() );
+    if (bands.size() <= 1) {
+        for (std::size_t i = 0; i < bands.size(); ++i) {
+            halveRows(args, bands[i]);
         }
+    } else {
+        QtConcurrent::map( bands, boost::bind(&halveRows<PIX>, boost::cref(args), _1) ).waitForFinished();
     }
 } // halveRoIForDepth
 
@@ -2171,48 +2668,46 @@ Image::upscaleMipMapForDepth(const RectI & roi,
 
     QWriteLocker k1(&output->_entryLock);
     QReadLocker k2(&_entryLock);
-    int srcRowSize = _bounds.width() * _nbComponents;
-    int dstRowSize = output->_bounds.width() * _nbComponents;
-    const PIX *src = (const PIX*)pixelAt(srcRoi.x1, srcRoi.y1);
-    PIX* dst = (PIX*)output->pixelAt(dstRoi.x1, dstRoi.y1);
-    assert(src && dst);
 
-    // algorithm: fill the first line of output, and replicate it as many times as necessary
+    UpscaleMipMapArgs<PIX> args;
+    args.srcRowSize = _bounds.width() * _nbComponents;
+    args.dstRowSize = output->_bounds.width() * _nbComponents;
+    args.src = (const PIX*)pixelAt(srcRoi.x1, srcRoi.y1);
+    args.dst = (PIX*)output->pixelAt(dstRoi.x1, dstRoi.y1);
+    assert(args.src && args.dst);
+    args.nComps = _nbComponents;
+    args.scale = scale;
+    args.srcRoi = srcRoi;
+    args.dstRoi = dstRoi;
+    switch (_nbComponents) {
+    case 1:
+        args.upscaleRow = upscaleRowForComponents<PIX, 1>;
+        break;
+    case 2:
+        args.upscaleRow = upscaleRowForComponents<PIX, 2>;
+        break;
+    case 3:
+        args.upscaleRow = upscaleRowForComponents<PIX, 3>;
+        break;
+    default:
+        assert(_nbComponents == 4);
+        args.upscaleRow = upscaleRowForComponents<PIX, 4>;
+        break;
+    }
+
+    // algorithm: fill the first line of output covered by a source line, and replicate it as many times as necessary
     // works even if dstRoi is not exactly a multiple of srcRoi (first/last column/line may not be complete)
-    int yi = srcRoi.y1;
-    int ycount; // how many lines should be filled
-    for (int yo = dstRoi.y1; yo < dstRoi.y2; ++yi, src += srcRowSize, yo += ycount, dst += ycount * dstRowSize) {
-        const PIX * const srcLineStart = src;
-        PIX * const dstLineBatchStart = dst;
-        ycount = scale - (yo - yi * scale); // how many lines should be filled
-        ycount = std::min(ycount, dstRoi.y2 - yo);
-        assert(0 < ycount && ycount <= scale);
-        int xi = srcRoi.x1;
-        int xcount = 0; // how many pixels should be filled
-        const PIX * srcPix = srcLineStart;
-        PIX * dstPixFirst = dstLineBatchStart;
-        // fill the first line
-        for (int xo = dstRoi.x1; xo < dstRoi.x2; ++xi, srcPix += _nbComponents, xo += xcount, dstPixFirst += xcount * _nbComponents) {
-            xcount = scale - (xo - xi * scale);
-            xcount = std::min(xcount, dstRoi.x2 - xo);
-            //assert(0 < xcount && xcount <= scale);
-            // replicate srcPix as many times as necessary
-            PIX * dstPix = dstPixFirst;
-            //assert((srcPix-(PIX*)pixelAt(srcRoi.x1, srcRoi.y1)) % components == 0);
-            for (int i = 0; i < xcount; ++i, dstPix += _nbComponents) {
-                assert( ( dstPix - (PIX*)output->pixelAt(dstRoi.x1, dstRoi.y1) ) % _nbComponents == 0 );
-                assert(dstPix >= (PIX*)output->pixelAt(xo, yo) && dstPix < (PIX*)output->pixelAt(xo, yo) + xcount * _nbComponents);
-                for (int c = 0; c < _nbComponents; ++c) {
-                    dstPix[c] = srcPix[c];
-                }
-            }
-            //assert(dstPix == dstPixFirst + xcount*components);
-        }
-        PIX * dstLineStart = dstLineBatchStart + dstRowSize; // first line was filled already
-        // now replicate the line as many times as necessary
-        for (int i = 1; i < ycount; ++i, dstLineStart += dstRowSize) {
-            std::copy(dstLineBatchStart, dstLineBatchStart + dstRowSize, dstLineStart);
+    int srcRowsEnd = srcRoi.y1;
+    while (std::max(dstRoi.y1, srcRowsEnd * scale) < dstRoi.y2) {
+        ++srcRowsEnd;
+    }
+    std::vector<std::pair<int, int> > bands = splitMipMapRows( srcRoi.y1, srcRowsEnd, dstRoi.width() * scale );
+    if (bands.size() <= 1) {
+        for (std::size_t i = 0; i < bands.size(); ++i) {
+            upscaleRows(args, bands[i]);
         }
+    } else {
+        QtConcurrent::map( bands, boost::bind(&upscaleRows<PIX>, boost::cref(args), _1) ).waitForFinished();
     }
 } // upscaleMipMapForDepth
 
@@ -2330,6 +2825,12 @@ Image::copyBitmapRowPortion(int x1,
                             int y,
                             const Image& other)
 {
+    QMutexLocker k(&_bitmapLock);
+    boost::scoped_ptr<QMutexLocker> k2;
+    if (&other != this) {
+        k2.reset( new QMutexLocker(&other._bitmapLock) );
+    }
+
     _bitmap.copyRowPortion(x1, x2, y, other._bitmap);
 }
 
@@ -2354,6 +2855,12 @@ void
 Image::copyBitmapPortion(const RectI& roi,
                          const Image& other)
 {
+    QMutexLocker k(&_bitmapLock);
+    boost::scoped_ptr<QMutexLocker> k2;
+    if (&other != this) {
+        k2.reset( new QMutexLocker(&other._bitmapLock) );
+    }
+
     _bitmap.copyBitmapPortion(roi, other._bitmap);
 }
 
@@ -2383,6 +2890,40 @@ Bitmap::copyBitmapPortion(const RectI& roi,
     }
 }
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Premultiplies (or unpremultiplies) a row of count RGBA pixels with a vectorized kernel if there is one for PIX.
+// Returns false if there is none.
+template <typename PIX, bool doPremult>
+bool
+premultRowFast(PIX* /*pix*/,
+               int /*count*/)
+{
+    return false;
+}
+
+template <>
+bool
+premultRowFast<float, true>(float* pix,
+                            int count)
+{
+    ImageKernels::premultRowRGBA(pix, count);
+
+    return true;
+}
+
+template <>
+bool
+premultRowFast<float, false>(float* pix,
+                             int count)
+{
+    ImageKernels::unpremultRowRGBA(pix, count);
+
+    return true;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
 template <typename PIX, bool doPremult>
 void
 Image::premultInternal(const RectI& roi)
@@ -2397,6 +2938,10 @@ Image::premultInternal(const RectI& roi)
     int srcRowElements = 4 * _bounds.width();
     PIX* dstPix = (PIX*)acc.pixelAt(renderWindow.x1, renderWindow.y1);
     for ( int y = renderWindow.y1; y < renderWindow.y2; ++y, dstPix += (srcRowElements - (renderWindow.x2 - renderWindow.x1) * 4) ) {
+        if ( premultRowFast<PIX, doPremult>(dstPix, renderWindow.x2 - renderWindow.x1) ) {
+            dstPix += (renderWindow.x2 - renderWindow.x1) * 4;
+            continue;
+        }
         for (int x = renderWindow.x1; x < renderWindow.x2; ++x, dstPix += 4) {
             for (int c = 0; c < 3; ++c) {
                 if (doPremult) {
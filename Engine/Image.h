@@ -39,6 +39,7 @@ CLANG_DIAG_OFF(deprecated)
 #include <QtCore/QHash>
 CLANG_DIAG_ON(deprecated)
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QMutex>
 
 #include "Engine/ImageKey.h"
 #include "Engine/ImagePlaneDesc.h"
@@ -49,6 +50,12 @@ CLANG_DIAG_ON(deprecated)
 #include "Engine/ViewIdx.h"
 #include "Engine/EngineFwd.h"
 
+// NATRON_COPY_CHANNELS_UNPREMULT:
+// Repremult R G and B if output is premult and alpha was modified.
+// We do not consider it a good thing, since the user explicitly deselected the channels, and expects
+// to get the values from input instead.
+// The fused Image::applyPostRenderPass() does not support it and falls back to the separate passes.
+//#define NATRON_COPY_CHANNELS_UNPREMULT
 
 NATRON_NAMESPACE_ENTER
 
@@ -474,6 +481,44 @@ public:
 
     typedef boost::shared_ptr<WriteAccess> WriteAccessPtr;
 
+    /**
+     * @brief Lock the image for reading so that its buffer cannot be resized while this object is living, but give
+     * access to the pixels for writing. This is used when several threads render disjoint regions of the same cached
+     * image at the same time: the regions are reserved in the bitmap, the lock only keeps the buffer in place.
+     * The bitmap has its own lock, so marking regions of the image does not wait for this object to die.
+     * You may no longer use the pointer returned by pixelAt once this object dies.
+     **/
+    class SharedWriteAccess
+        : public GenericAccess
+    {
+        Image* img;
+
+public:
+
+        SharedWriteAccess(Image* img)
+            : GenericAccess()
+            , img(img)
+        {
+            img->lockForRead();
+        }
+
+        virtual ~SharedWriteAccess()
+        {
+            img->unlock();
+        }
+
+        /**
+         * @brief Access pixels. The pointer must be cast to the appropriate type afterwards.
+         **/
+        unsigned char* pixelAt(int x,
+                               int y)
+        {
+            return img->pixelAt(x, y);
+        }
+    };
+
+    typedef boost::shared_ptr<SharedWriteAccess> SharedWriteAccessPtr;
+
     ReadAccess getReadRights() const
     {
         return ReadAccess(this);
@@ -490,6 +535,7 @@ private:
 
     friend class ReadAccess;
     friend class WriteAccess;
+    friend class SharedWriteAccess;
 
     /**
      * These are private accessors to the buffer. They may only exclusively called while under the lock
@@ -622,7 +668,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QReadLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
         _bitmap.minimalNonMarkedRects_trimap(regionOfInterest, ret, isBeingRenderedElsewhere);
     }
 
@@ -633,7 +679,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QReadLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
         _bitmap.minimalNonMarkedRects(regionOfInterest, ret);
     }
 
@@ -644,7 +690,7 @@ public:
         if (!_useBitmap) {
             return regionOfInterest;
         }
-        QReadLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
 
         return _bitmap.minimalNonMarkedBbox_trimap(regionOfInterest, isBeingRenderedElsewhere);
     }
@@ -655,7 +701,7 @@ public:
         if (!_useBitmap) {
             return regionOfInterest;
         }
-        QReadLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
 
         return _bitmap.minimalNonMarkedBbox(regionOfInterest);
     }
@@ -667,11 +713,8 @@ public:
         if (!_useBitmap) {
             return regionOfInterest;
         }
-        RectI ret;
-        {
-            QReadLocker locker(&_entryLock);
-            ret = _bitmap.minimalNonMarkedBbox_trimap(regionOfInterest, isBeingRenderedElsewhere);
-        }
+        QMutexLocker locker(&_bitmapLock);
+        RectI ret = _bitmap.minimalNonMarkedBbox_trimap(regionOfInterest, isBeingRenderedElsewhere);
         markForRendering(ret);
 
         return ret;
@@ -684,7 +727,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QWriteLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
         RectI intersection;
         _bounds.intersect(roi, &intersection);
         _bitmap.markForRendered(intersection);
@@ -697,7 +740,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QWriteLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
         RectI intersection;
         _bounds.intersect(roi, &intersection);
         _bitmap.markForRendering(intersection);
@@ -710,7 +753,7 @@ public:
         if (!_useBitmap) {
             return;
         }
-        QWriteLocker locker(&_entryLock);
+        QMutexLocker locker(&_bitmapLock);
         RectI intersection;
         _bounds.intersect(roi, &intersection);
         _bitmap.clear(intersection);
@@ -875,6 +918,24 @@ public:
                        float mix,
                        const OSGLContextPtr& glContext = OSGLContextPtr() );
 
+    /**
+     * @brief Does in a single sweep over roi, row by row, what pasteFrom(*renderedImage), copyUnProcessedChannels()
+     * and applyMaskMix() do in 3 passes after a tile has been rendered in renderedImage (which may be this image).
+     * The unprocessed channels are copied from originalImage as-is, as copyUnProcessedChannels does.
+     * Returns false without doing anything if the images cannot be processed together (OpenGL textures, different
+     * formats, or originalImage at another mipmap level): the separate passes must then be used.
+     * If renderedImage is this image and it has a bitmap, roi must have been marked for rendering by the caller.
+     **/
+    bool applyPostRenderPass(const RectI& roi,
+                             const Image* renderedImage,
+                             std::bitset<4> processChannels,
+                             const ImagePtr& originalImage,
+                             bool doMaskMix,
+                             const Image* maskImg,
+                             bool masked,
+                             bool maskInvert,
+                             float mix) WARN_UNUSED_RETURN;
+
     /**
      * @brief Eeturns true if image contains NaNs or infinite values, and fix them.
      * Currently, no OpenGL implementation is provided.
@@ -936,6 +997,39 @@ private:
                                       bool maskInvert,
                                       float mix);
 
+    template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+    void applyPostRenderPassForComponents(const RectI& roi,
+                                          const Image* renderedImage,
+                                          const bool doChannels[4],
+                                          const Image* originalImg,
+                                          bool doMaskMix,
+                                          const Image* maskImg,
+                                          bool masked,
+                                          bool maskInvert,
+                                          float mix);
+
+    template <typename PIX, int maxValue, int dstNComps>
+    void applyPostRenderPassForDstComponents(const RectI& roi,
+                                             const Image* renderedImage,
+                                             const bool doChannels[4],
+                                             const Image* originalImg,
+                                             bool doMaskMix,
+                                             const Image* maskImg,
+                                             bool masked,
+                                             bool maskInvert,
+                                             float mix);
+
+    template <typename PIX, int maxValue>
+    void applyPostRenderPassForDepth(const RectI& roi,
+                                     const Image* renderedImage,
+                                     const bool doChannels[4],
+                                     const Image* originalImg,
+                                     bool doMaskMix,
+                                     const Image* maskImg,
+                                     bool masked,
+                                     bool maskInvert,
+                                     float mix);
+
     template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool doR, bool doG, bool doB, bool doA, bool premult, bool originalPremult, bool ignorePremult>
     void copyUnProcessedChannelsForPremult(std::bitset<4> processChannels,
                                            const RectI& roi,
@@ -1030,6 +1124,10 @@ private:
     ImageBitDepthEnum _bitDepth;
     int _depthBytesSize;
     Bitmap _bitmap;
+    // Protects _bitmap. It is separate from the entry lock so that threads rendering in place (which hold the
+    // entry lock for reading) do not hold back the threads marking their region of the same image.
+    // It is always taken after the entry lock, and _bounds is only changed while holding both.
+    mutable QMutex _bitmapLock;
     RectD _rod;     // rod in canonical coordinates (not the same as the OFX::Image RoD, which is in pixel coordinates)
     RectI _bounds;
     double _par;
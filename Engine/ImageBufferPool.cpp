@@ -0,0 +1,230 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ImageBufferPool.h"
+
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <vector>
+
+#include <QtCore/QMutex>
+
+#include "Engine/AppManager.h"
+#include "Engine/ThreadStorage.h"
+
+// Buffers smaller than this are not worth pooling: malloc already recycles them efficiently.
+#define NATRON_IMAGE_BUFFER_POOL_MIN_SIZE (128 * 1024)
+
+// Maximum amount of memory (in bytes) a pool may keep on its free-lists, above it released buffers are freed.
+#define NATRON_IMAGE_BUFFER_POOL_MAX_RETAINED_SIZE ( (std::size_t)512 * 1024 * 1024 )
+
+NATRON_NAMESPACE_ENTER
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+static ThreadStorage<ImageBufferPoolPtr> currentThreadPool;
+
+/**
+ * @brief Rounds size up to its size class. There are 4 classes per power of 2 so that
+ * at most 25% of a buffer is wasted.
+ **/
+static std::size_t
+getSizeClass(std::size_t size)
+{
+    int highBit = 0;
+
+    while ( (size >> (highBit + 1)) != 0 ) {
+        ++highBit;
+    }
+    std::size_t step = (std::size_t)1 << (highBit - 2);
+
+    return (size + step - 1) & ~(step - 1);
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+typedef std::map<std::size_t, std::vector<void*> > FreeListsMap;
+
+struct ImageBufferPoolPrivate
+{
+    mutable QMutex lock;
+
+    // Released buffers, per size class
+    FreeListsMap freeLists;
+
+    // Sum of the size of all buffers in freeLists
+    std::size_t retainedMemory;
+
+    ImageBufferPoolPrivate()
+        : lock()
+        , freeLists()
+        , retainedMemory(0)
+    {
+    }
+
+    void notifyRetainedMemoryChanged(std::size_t oldSize)
+    {
+        if (appPTR) {
+            appPTR->notifyRenderBuffersMemoryChanged(oldSize, retainedMemory);
+        }
+    }
+};
+
+ImageBufferPool::ImageBufferPool()
+    : _imp( new ImageBufferPoolPrivate() )
+{
+}
+
+ImageBufferPool::~ImageBufferPool()
+{
+    std::size_t oldSize = _imp->retainedMemory;
+
+    for (FreeListsMap::iterator it = _imp->freeLists.begin(); it != _imp->freeLists.end(); ++it) {
+        for (std::vector<void*>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            free(*it2);
+        }
+    }
+    _imp->freeLists.clear();
+    _imp->retainedMemory = 0;
+    if (oldSize) {
+        _imp->notifyRetainedMemoryChanged(oldSize);
+    }
+}
+
+void*
+ImageBufferPool::allocate(std::size_t size,
+                          std::size_t* allocatedSize)
+{
+    if (size < NATRON_IMAGE_BUFFER_POOL_MIN_SIZE) {
+        void* data = malloc(size);
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        *allocatedSize = size;
+
+        return data;
+    }
+
+    std::size_t sizeClass = getSizeClass(size);
+    {
+        QMutexLocker k(&_imp->lock);
+        FreeListsMap::iterator found = _imp->freeLists.find(sizeClass);
+        if ( ( found != _imp->freeLists.end() ) && !found->second.empty() ) {
+            void* data = found->second.back();
+            found->second.pop_back();
+            std::size_t oldSize = _imp->retainedMemory;
+            _imp->retainedMemory -= sizeClass;
+            _imp->notifyRetainedMemoryChanged(oldSize);
+            *allocatedSize = sizeClass;
+
+            return data;
+        }
+    }
+
+    void* data = malloc(sizeClass);
+    if (!data) {
+        // Give the memory retained by the pool back to the system and retry
+        {
+            QMutexLocker k(&_imp->lock);
+            std::size_t oldSize = _imp->retainedMemory;
+            for (FreeListsMap::iterator it = _imp->freeLists.begin(); it != _imp->freeLists.end(); ++it) {
+                for (std::vector<void*>::iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+                    free(*it2);
+                }
+            }
+            _imp->freeLists.clear();
+            _imp->retainedMemory = 0;
+            if (oldSize) {
+                _imp->notifyRetainedMemoryChanged(oldSize);
+            }
+        }
+        data = malloc(sizeClass);
+        if (!data) {
+            throw std::bad_alloc();
+        }
+    }
+    *allocatedSize = sizeClass;
+
+    return data;
+} // ImageBufferPool::allocate
+
+void
+ImageBufferPool::release(void* data,
+                         std::size_t allocatedSize)
+{
+    if (!data) {
+        return;
+    }
+    if (allocatedSize < NATRON_IMAGE_BUFFER_POOL_MIN_SIZE) {
+        free(data);
+
+        return;
+    }
+
+    {
+        QMutexLocker k(&_imp->lock);
+        if (_imp->retainedMemory + allocatedSize <= NATRON_IMAGE_BUFFER_POOL_MAX_RETAINED_SIZE) {
+            _imp->freeLists[allocatedSize].push_back(data);
+            std::size_t oldSize = _imp->retainedMemory;
+            _imp->retainedMemory += allocatedSize;
+            _imp->notifyRetainedMemoryChanged(oldSize);
+
+            return;
+        }
+    }
+    free(data);
+}
+
+std::size_t
+ImageBufferPool::getRetainedMemory() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->retainedMemory;
+}
+
+ImageBufferPoolPtr
+ImageBufferPool::getCurrentThreadPool()
+{
+    if ( !currentThreadPool.hasLocalData() ) {
+        return ImageBufferPoolPtr();
+    }
+
+    return currentThreadPool.localData();
+}
+
+ImageBufferPool::ThreadPoolSetter_RAII::ThreadPoolSetter_RAII(const ImageBufferPoolPtr& pool)
+    : _previousPool( ImageBufferPool::getCurrentThreadPool() )
+{
+    currentThreadPool.setLocalData(pool);
+}
+
+ImageBufferPool::ThreadPoolSetter_RAII::~ThreadPoolSetter_RAII()
+{
+    currentThreadPool.setLocalData(_previousPool);
+}
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,111 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_IMAGEBUFFERPOOL_H
+#define NATRON_ENGINE_IMAGEBUFFERPOOL_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER
+
+/**
+ * @brief Recycles the RAM buffers of the transient (non-cached) images allocated during the render of a frame.
+ *
+ * A render allocates and frees many large buffers of the same few sizes (the tmp images of the tiles, the
+ * images of the nodes that are not cached, the downscaled copies...). Instead of going back to malloc/free
+ * each time, the buffers are rounded up to a size class and kept on a free-list when released so that the next
+ * allocation of the same class can reuse them.
+ *
+ * During playback or a render on disk, one pool is held by the RenderEngine and shared by all the frames,
+ * nodes and threads of that render. Other renders (e.g. the current frame of a viewer) get their own pool.
+ * The retained buffers are freed when the last reference to the pool goes away.
+ * The memory retained by the pool is capped and reported to the node cache so that the cache
+ * memory limit still reflects the real memory footprint.
+ **/
+struct ImageBufferPoolPrivate;
+class ImageBufferPool
+    : boost::noncopyable
+{
+public:
+
+    ImageBufferPool();
+
+    ~ImageBufferPool();
+
+    /**
+     * @brief Returns a buffer of at least size bytes. The actual size of the buffer is returned in allocatedSize
+     * and must be given back to release().
+     * Throws std::bad_alloc on failure.
+     **/
+    void* allocate(std::size_t size, std::size_t* allocatedSize);
+
+    /**
+     * @brief Gives back a buffer obtained by allocate(). It is either kept for a later allocation or freed.
+     **/
+    void release(void* data, std::size_t allocatedSize);
+
+    /**
+     * @brief Returns the amount of memory (in bytes) currently held on the free-lists.
+     **/
+    std::size_t getRetainedMemory() const;
+
+    /**
+     * @brief Returns the pool of the render running on the calling thread, if any.
+     **/
+    static ImageBufferPoolPtr getCurrentThreadPool();
+
+    /**
+     * @brief Sets the pool used by the calling thread for the lifetime of this object, and restores
+     * the previous one on destruction.
+     **/
+    class ThreadPoolSetter_RAII
+    {
+        ImageBufferPoolPtr _previousPool;
+
+public:
+
+        ThreadPoolSetter_RAII(const ImageBufferPoolPtr& pool);
+
+        ~ThreadPoolSetter_RAII();
+    };
+
+private:
+
+    boost::scoped_ptr<ImageBufferPoolPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT
+
+#endif // NATRON_ENGINE_IMAGEBUFFERPOOL_H
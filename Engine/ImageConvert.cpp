@@ -27,6 +27,7 @@
 
 #include <algorithm> // min, max
 #include <cassert>
+#include <cstring> // memcpy
 #include <stdexcept>
 
 #ifndef Q_MOC_RUN
@@ -38,6 +39,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include <QtCore/QDebug>
 
 #include "Engine/AppManager.h"
+#include "Engine/ImageKernels.h"
 #include "Engine/Lut.h"
 
 NATRON_NAMESPACE_ENTER
@@ -163,6 +165,18 @@ Image::convertToFormatInternal_sameComps(const RectI & renderWindow,
     if ( intersection.isNull() ) {
         return;
     }
+    if ( (srcMaxValue == dstMaxValue) && (sizeof(SRCPIX) == sizeof(DSTPIX)) && !srcLut && !dstLut ) {
+        ///Same depth and no colorspace conversion: each row is a plain copy
+        std::size_t rowBytes = (std::size_t)intersection.width() * nComp * sizeof(SRCPIX);
+        for (int y = intersection.y1; y < intersection.y2; ++y) {
+            std::memcpy(dstImg.pixelAt(intersection.x1, y), srcImg.pixelAt(intersection.x1, y), rowBytes);
+            if (copyBitmap) {
+                dstImg.copyBitmapRowPortion(intersection.x1, intersection.x2, y, srcImg);
+            }
+        }
+
+        return;
+    }
     for (int y = 0; y < intersection.height(); ++y) {
         // coverity[dont_call]
         int start = rand() % intersection.width();
@@ -304,6 +318,20 @@ Image::convertToFormatInternalForColorSpace(const RectI & renderWindow,
         return;
     }
 
+    ///Extraction of a channel of a float RGBA image to a float alpha image (masks): no depth conversion is needed
+    if ( (dstNComps == 1) && (srcNComps == 4) && (srcMaxValue == 1) && (dstMaxValue == 1) ) {
+        assert(channelForAlpha > -1 && channelForAlpha <= 3);
+        for (int y = renderWindow.y1; y < renderWindow.y2; ++y) {
+            ImageKernels::extractChannelRow( (float*)dstImg.pixelAt(renderWindow.x1, y), (const float*)srcImg.pixelAt(renderWindow.x1, y),
+                                             srcNComps, channelForAlpha, renderWindow.width() );
+        }
+        if (copyBitmap) {
+            dstImg.copyBitmapPortion(renderWindow, srcImg);
+        }
+
+        return;
+    }
+
     const Color::Lut* const srcLut = useColorspaces ? lutFromColorspace( (ViewerColorSpaceEnum)srcColorSpace ) : 0;
     const Color::Lut* const dstLut = useColorspaces ? lutFromColorspace( (ViewerColorSpaceEnum)dstColorSpace ) : 0;
 
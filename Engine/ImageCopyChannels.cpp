@@ -25,6 +25,7 @@
 
 #include "Image.h"
 
+#include <algorithm> // min, max
 #include <cassert>
 #include <stdexcept>
 
@@ -38,6 +39,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Engine/OSGLContext.h"
 #include "Engine/GLShader.h"
+#include "Engine/ImageKernels.h"
 
 
 // disable some warnings due to unused parameters
@@ -46,14 +48,72 @@ GCC_DIAG_OFF(unused-parameter)
 GCC_DIAG_OFF(unused-but-set-variable) // only on gcc >= 4.6
 #endif
 
-// NATRON_COPY_CHANNELS_UNPREMULT:
-// Repremult R G and B if output is premult and alpha was modified.
-// We do not consider it a good thing, since the user explicitly deselected the channels, and expects
-// to get the values from input instead.
-//#define NATRON_COPY_CHANNELS_UNPREMULT
+// NATRON_COPY_CHANNELS_UNPREMULT is defined in Image.h
 
 NATRON_NAMESPACE_ENTER
 
+#ifndef NATRON_COPY_CHANNELS_UNPREMULT
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Row by row copy of the unprocessed channels for the formats that have a vectorized kernel.
+ * srcPixels points to the pixel at (srcBounds.x1, srcBounds.y1) and is NULL if there is no original image.
+ * Returns false if the format is not handled, in which case nothing is done.
+ **/
+template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+struct CopyUnProcessedChannelsRows
+{
+    static bool process(bool /*doR*/,
+                        bool /*doG*/,
+                        bool /*doB*/,
+                        bool /*doA*/,
+                        const RectI& /*roi*/,
+                        PIX* /*dstPixels*/,
+                        int /*dstRowElements*/,
+                        const RectI& /*srcBounds*/,
+                        const PIX* /*srcPixels*/)
+    {
+        return false;
+    }
+};
+
+// Float RGBA to float RGBA: the channels are either copied from the original image or set to 0 outside of it
+template <>
+struct CopyUnProcessedChannelsRows<float, 1, 4, 4>
+{
+    static bool process(bool doR,
+                        bool doG,
+                        bool doB,
+                        bool doA,
+                        const RectI& roi,
+                        float* dstPixels,
+                        int dstRowElements,
+                        const RectI& srcBounds,
+                        const float* srcPixels)
+    {
+        int srcRowElements = 4 * srcBounds.width();
+
+        for (int y = roi.y1; y < roi.y2; ++y, dstPixels += dstRowElements) {
+            const float* srcRow = 0;
+            int srcX1 = roi.x2, srcX2 = roi.x2;
+            if ( srcPixels && (y >= srcBounds.y1) && (y < srcBounds.y2) ) {
+                srcX1 = std::min( std::max(roi.x1, srcBounds.x1), roi.x2 );
+                srcX2 = std::max( std::min(roi.x2, srcBounds.x2), srcX1 );
+                srcRow = srcPixels + (std::size_t)(y - srcBounds.y1) * srcRowElements + (srcX1 - srcBounds.x1) * 4;
+            }
+            // left of the original image, inside, right of it
+            ImageKernels::copyChannelsRowRGBA(dstPixels, 0, doR, doG, doB, doA, srcX1 - roi.x1);
+            ImageKernels::copyChannelsRowRGBA(dstPixels + (srcX1 - roi.x1) * 4, srcRow, doR, doG, doB, doA, srcX2 - srcX1);
+            ImageKernels::copyChannelsRowRGBA(dstPixels + (srcX2 - roi.x1) * 4, 0, doR, doG, doB, doA, roi.x2 - srcX2);
+        }
+
+        return true;
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+#endif // !NATRON_COPY_CHANNELS_UNPREMULT
+
 template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool doR, bool doG, bool doB, bool doA, bool premult, bool originalPremult, bool ignorePremult>
 void
 Image::copyUnProcessedChannelsForPremult(const std::bitset<4> processChannels,
@@ -72,6 +132,20 @@ Image::copyUnProcessedChannelsForPremult(const std::bitset<4> processChannels,
     assert(srcNComps == 1 || srcNComps == 4 || !originalPremult); // only A or RGBA can be premult
     assert(dstNComps == 1 || dstNComps == 4 || !premult); // only A or RGBA can be premult
 
+#ifndef NATRON_COPY_CHANNELS_UNPREMULT
+    {
+        RectI srcBounds;
+        const PIX* srcPixels = 0;
+        if (originalImage) {
+            srcBounds = originalImage->_bounds;
+            srcPixels = (const PIX*)acc.pixelAt(srcBounds.x1, srcBounds.y1);
+        }
+        if ( CopyUnProcessedChannelsRows<PIX, maxValue, srcNComps, dstNComps>::process(doR, doG, doB, doA, roi, dst_pixels, dstRowElements, srcBounds, srcPixels) ) {
+            return;
+        }
+    }
+#endif
+
     for ( int y = roi.y1; y < roi.y2; ++y, dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) {
         for (int x = roi.x1; x < roi.x2; ++x, dst_pixels += dstNComps) {
             const PIX* src_pixels = originalImage ? (const PIX*)acc.pixelAt(x, y) : 0;
@@ -226,6 +300,20 @@ Image::copyUnProcessedChannelsForPremult(const bool premult,
     Q_UNUSED(premult);
     Q_UNUSED(originalPremult);
 
+#ifndef NATRON_COPY_CHANNELS_UNPREMULT
+    {
+        RectI srcBounds;
+        const PIX* srcPixels = 0;
+        if (originalImage) {
+            srcBounds = originalImage->_bounds;
+            srcPixels = (const PIX*)acc.pixelAt(srcBounds.x1, srcBounds.y1);
+        }
+        if ( CopyUnProcessedChannelsRows<PIX, maxValue, srcNComps, dstNComps>::process(doR, doG, doB, doA, roi, dst_pixels, dstRowElements, srcBounds, srcPixels) ) {
+            return;
+        }
+    }
+#endif
+
     for ( int y = roi.y1; y < roi.y2; ++y, dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) {
         for (int x = roi.x1; x < roi.x2; ++x, dst_pixels += dstNComps) {
             const PIX* src_pixels = originalImage ? (const PIX*)acc.pixelAt(x, y) : 0;
@@ -0,0 +1,351 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_IMAGEKERNELS_H
+#define NATRON_ENGINE_IMAGEKERNELS_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+///
+/// Row kernels of the per-tile post-processing of float RGBA images (premultiplication, mask/mix, copy of the
+/// unprocessed channels, channel extraction).
+/// Each kernel has a scalar version and a vectorized version (SSE2 on x86, NEON on ARM64) which gives the same
+/// results bit for bit: the vectorized versions do the same floating point operations in the same order.
+///
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define NATRON_IMAGE_KERNELS_SIMD
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define NATRON_IMAGE_KERNELS_SIMD
+#endif
+
+NATRON_NAMESPACE_ENTER
+namespace ImageKernels {
+#ifdef NATRON_IMAGE_KERNELS_SIMD
+
+// Minimal set of operations on 4 floats (1 RGBA pixel) used by the kernels below
+#if defined(__SSE2__)
+typedef __m128 Float4;
+typedef __m128 Mask4;
+
+inline Float4 load4(const float* p) { return _mm_loadu_ps(p); }
+inline void store4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+inline Float4 set4(float v) { return _mm_set1_ps(v); }
+inline Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Float4 div4(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+inline Float4 splatAlpha4(Float4 v) { return _mm_shuffle_ps( v, v, _MM_SHUFFLE(3, 3, 3, 3) ); }
+inline Mask4 notZero4(Float4 v) { return _mm_cmpneq_ps( v, _mm_setzero_ps() ); }
+inline Mask4 and4(Mask4 a, Mask4 b) { return _mm_and_ps(a, b); }
+inline Float4 select4(Mask4 m, Float4 a, Float4 b) { return _mm_or_ps( _mm_and_ps(m, a), _mm_andnot_ps(m, b) ); }
+inline Mask4 channelsMask4(bool r, bool g, bool b, bool a)
+{
+    return _mm_castsi128_ps( _mm_set_epi32(a ? -1 : 0, b ? -1 : 0, g ? -1 : 0, r ? -1 : 0) );
+}
+
+#else // NEON
+typedef float32x4_t Float4;
+typedef uint32x4_t Mask4;
+
+inline Float4 load4(const float* p) { return vld1q_f32(p); }
+inline void store4(float* p, Float4 v) { vst1q_f32(p, v); }
+inline Float4 set4(float v) { return vdupq_n_f32(v); }
+inline Float4 add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+inline Float4 mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+inline Float4 div4(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+inline Float4 splatAlpha4(Float4 v) { return vdupq_laneq_f32(v, 3); }
+inline Mask4 notZero4(Float4 v) { return vmvnq_u32( vceqq_f32( v, vdupq_n_f32(0.f) ) ); }
+inline Mask4 and4(Mask4 a, Mask4 b) { return vandq_u32(a, b); }
+inline Float4 select4(Mask4 m, Float4 a, Float4 b) { return vbslq_f32(m, a, b); }
+inline Mask4 channelsMask4(bool r, bool g, bool b, bool a)
+{
+    const uint32_t m[4] = { r ? 0xffffffffU : 0U, g ? 0xffffffffU : 0U, b ? 0xffffffffU : 0U, a ? 0xffffffffU : 0U };
+
+    return vld1q_u32(m);
+}
+
+#endif // __SSE2__
+#endif // NATRON_IMAGE_KERNELS_SIMD
+
+/**
+ * @brief Multiplies the RGB channels of count RGBA pixels by their alpha.
+ **/
+inline void
+premultRowRGBAScalar(float* pix,
+                     int count)
+{
+    for (int x = 0; x < count; ++x, pix += 4) {
+        for (int c = 0; c < 3; ++c) {
+            pix[c] = pix[c] * pix[3];
+        }
+    }
+}
+
+inline void
+premultRowRGBA(float* pix,
+               int count)
+{
+#ifdef NATRON_IMAGE_KERNELS_SIMD
+    const Mask4 rgb = channelsMask4(true, true, true, false);
+
+    for (int x = 0; x < count; ++x, pix += 4) {
+        Float4 v = load4(pix);
+        store4( pix, select4( rgb, mul4( v, splatAlpha4(v) ), v ) );
+    }
+#else
+    premultRowRGBAScalar(pix, count);
+#endif
+}
+
+/**
+ * @brief Divides the RGB channels of count RGBA pixels by their alpha. Pixels with a zero alpha are left untouched.
+ **/
+inline void
+unpremultRowRGBAScalar(float* pix,
+                       int count)
+{
+    for (int x = 0; x < count; ++x, pix += 4) {
+        if (pix[3] != 0) {
+            for (int c = 0; c < 3; ++c) {
+                pix[c] = pix[c] / pix[3];
+            }
+        }
+    }
+}
+
+inline void
+unpremultRowRGBA(float* pix,
+                 int count)
+{
+#ifdef NATRON_IMAGE_KERNELS_SIMD
+    const Mask4 rgb = channelsMask4(true, true, true, false);
+    const Float4 one = set4(1.f);
+
+    for (int x = 0; x < count; ++x, pix += 4) {
+        Float4 v = load4(pix);
+        Float4 a = splatAlpha4(v);
+        Mask4 nonZero = notZero4(a);
+        // Divide by 1 where alpha is 0 so that no floating point exception may be raised
+        Float4 unpremult = div4( v, select4(nonZero, a, one) );
+        store4( pix, select4(and4(rgb, nonZero), unpremult, v) );
+    }
+#else
+    unpremultRowRGBAScalar(pix, count);
+#endif
+}
+
+/**
+ * @brief Mixes count RGBA pixels of dst with the pixels of src: dst = dst * alpha + (1 - alpha) * src
+ * where alpha is mix, multiplied by the mask value (or 1 - the mask value if maskInvert is true) if a mask is given.
+ * If src is NULL, it is considered black and transparent. The mask has maskNComps components, the first one is used.
+ **/
+inline void
+maskMixRowRGBAScalar(float* dst,
+                     const float* src,
+                     const float* mask,
+                     int maskNComps,
+                     bool maskInvert,
+                     float mix,
+                     int count)
+{
+    for (int x = 0; x < count; ++x, dst += 4) {
+        float alpha = mix;
+        if (mask) {
+            float maskScale = maskInvert ? 1.f - *mask : *mask;
+            alpha = mix * maskScale;
+            mask += maskNComps;
+        }
+        if (src) {
+            for (int c = 0; c < 4; ++c) {
+                dst[c] = dst[c] * alpha + (1.f - alpha) * src[c];
+            }
+            src += 4;
+        } else {
+            for (int c = 0; c < 4; ++c) {
+                dst[c] = dst[c] * alpha;
+            }
+        }
+    }
+}
+
+inline void
+maskMixRowRGBA(float* dst,
+               const float* src,
+               const float* mask,
+               int maskNComps,
+               bool maskInvert,
+               float mix,
+               int count)
+{
+#ifdef NATRON_IMAGE_KERNELS_SIMD
+    Float4 alpha = set4(mix);
+    Float4 oneMinusAlpha = set4(1.f - mix);
+
+    for (int x = 0; x < count; ++x, dst += 4) {
+        if (mask) {
+            float maskScale = maskInvert ? 1.f - *mask : *mask;
+            float a = mix * maskScale;
+            alpha = set4(a);
+            oneMinusAlpha = set4(1.f - a);
+            mask += maskNComps;
+        }
+        if (src) {
+            store4( dst, add4( mul4(load4(dst), alpha), mul4( oneMinusAlpha, load4(src) ) ) );
+            src += 4;
+        } else {
+            store4( dst, mul4(load4(dst), alpha) );
+        }
+    }
+#else
+    maskMixRowRGBAScalar(dst, src, mask, maskNComps, maskInvert, mix, count);
+#endif
+}
+
+/**
+ * @brief Copies the given channels of count RGBA pixels from src to dst. If src is NULL, the channels are set to 0.
+ **/
+inline void
+copyChannelsRowRGBAScalar(float* dst,
+                          const float* src,
+                          bool doR,
+                          bool doG,
+                          bool doB,
+                          bool doA,
+                          int count)
+{
+    const bool doChannel[4] = { doR, doG, doB, doA };
+
+    for (int x = 0; x < count; ++x, dst += 4) {
+        for (int c = 0; c < 4; ++c) {
+            if (doChannel[c]) {
+                dst[c] = src ? src[c] : 0.f;
+            }
+        }
+        if (src) {
+            src += 4;
+        }
+    }
+}
+
+inline void
+copyChannelsRowRGBA(float* dst,
+                    const float* src,
+                    bool doR,
+                    bool doG,
+                    bool doB,
+                    bool doA,
+                    int count)
+{
+#ifdef NATRON_IMAGE_KERNELS_SIMD
+    const Mask4 channels = channelsMask4(doR, doG, doB, doA);
+    const Float4 zero = set4(0.f);
+
+    if (src) {
+        for (int x = 0; x < count; ++x, dst += 4, src += 4) {
+            store4( dst, select4( channels, load4(src), load4(dst) ) );
+        }
+    } else {
+        for (int x = 0; x < count; ++x, dst += 4) {
+            store4( dst, select4( channels, zero, load4(dst) ) );
+        }
+    }
+#else
+    copyChannelsRowRGBAScalar(dst, src, doR, doG, doB, doA, count);
+#endif
+}
+
+/**
+ * @brief Copies the channel at index channel of count pixels of srcNComps components to a single channel row.
+ **/
+inline void
+extractChannelRowScalar(float* dst,
+                        const float* src,
+                        int srcNComps,
+                        int channel,
+                        int count)
+{
+    src += channel;
+    for (int x = 0; x < count; ++x, src += srcNComps) {
+        dst[x] = *src;
+    }
+}
+
+inline void
+extractChannelRow(float* dst,
+                  const float* src,
+                  int srcNComps,
+                  int channel,
+                  int count)
+{
+#if defined(__SSE2__)
+    if (srcNComps == 4) {
+        int x = 0;
+        for (; x + 4 <= count; x += 4, src += 16) {
+            // Transpose 4 pixels to get the channel in a single register
+            Float4 p0 = load4(src);
+            Float4 p1 = load4(src + 4);
+            Float4 p2 = load4(src + 8);
+            Float4 p3 = load4(src + 12);
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+            switch (channel) {
+            case 0:
+                store4(dst + x, p0);
+                break;
+            case 1:
+                store4(dst + x, p1);
+                break;
+            case 2:
+                store4(dst + x, p2);
+                break;
+            default:
+                store4(dst + x, p3);
+                break;
+            }
+        }
+        extractChannelRowScalar(dst + x, src, srcNComps, channel, count - x);
+
+        return;
+    }
+#elif defined(NATRON_IMAGE_KERNELS_SIMD)
+    if (srcNComps == 4) {
+        int x = 0;
+        for (; x + 4 <= count; x += 4, src += 16) {
+            // vld4q deinterleaves the 4 channels of 4 pixels
+            float32x4x4_t p = vld4q_f32(src);
+            store4(dst + x, p.val[channel]);
+        }
+        extractChannelRowScalar(dst + x, src, srcNComps, channel, count - x);
+
+        return;
+    }
+#endif
+    extractChannelRowScalar(dst, src, srcNComps, channel, count);
+}
+} // namespace ImageKernels
+NATRON_NAMESPACE_EXIT
+
+#endif // NATRON_ENGINE_IMAGEKERNELS_H
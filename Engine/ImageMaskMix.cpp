@@ -25,48 +25,36 @@
 
 #include "Image.h"
 
+#include <algorithm> // min, max, sort
 #include <cassert>
+#include <cstring> // memcpy
 #include <stdexcept>
 #include "Engine/GLShader.h"
+#include "Engine/ImageKernels.h"
 #include "Engine/OSGLContext.h"
 
 NATRON_NAMESPACE_ENTER
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Mixes count pixels of a row of dst with src. src (resp. mask) is NULL if the span is outside of the
+ * original (resp. mask) image.
+ **/
 template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked, bool maskInvert>
-void
-Image::applyMaskMixForMaskInvert(const RectI& roi,
-                                 const Image* maskImg,
-                                 const Image* originalImg,
-                                 float mix)
+struct MaskMixSpan
 {
-    PIX* dst_pixels = (PIX*)pixelAt(roi.x1, roi.y1);
-    unsigned int dstRowElements = _bounds.width() * getComponentsCount();
-
-    for ( int y = roi.y1; y < roi.y2; ++y,
-          dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) { // 1 row stride minus what was done at previous iteration
-        for (int x = roi.x1; x < roi.x2; ++x,
-             dst_pixels += dstNComps) {
-            const PIX* src_pixels = originalImg ? (const PIX*)originalImg->pixelAt(x, y) : 0;
-            float maskScale = 1.f;
-            if (!masked) {
-                // just mix
-                float alpha = mix;
-                if (src_pixels) {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        if (c < srcNComps) {
-                            float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
-                            dst_pixels[c] = clampIfInt<PIX>(v);
-                        }
-                    }
-                } else {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        float v = float(dst_pixels[c]) * alpha;
-                        dst_pixels[c] = clampIfInt<PIX>(v);
-                    }
-                }
-            } else {
-                const PIX* maskPixels = maskImg ? (const PIX*)maskImg->pixelAt(x, y) : 0;
+    static void process(PIX* dst_pixels,
+                        const PIX* src_pixels,
+                        const PIX* maskPixels,
+                        float mix,
+                        int count)
+    {
+        for (int x = 0; x < count; ++x, dst_pixels += dstNComps) {
+            float alpha = mix;
+            if (masked) {
                 // figure the scale factor from that pixel
+                float maskScale;
                 if (maskPixels == 0) {
                     maskScale = maskInvert ? 1.f : 0.f;
                 } else {
@@ -74,24 +62,156 @@ Image::applyMaskMixForMaskInvert(const RectI& roi,
                     if (maskInvert) {
                         maskScale = 1.f - maskScale;
                     }
+                    ++maskPixels;
                 }
-                float alpha = mix * maskScale;
-                if (src_pixels) {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        if (c < srcNComps) {
-                            float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
-                            dst_pixels[c] = clampIfInt<PIX>(v);
-                        }
+                alpha = mix * maskScale;
+            }
+            if (src_pixels) {
+                for (int c = 0; c < dstNComps; ++c) {
+                    if (c < srcNComps) {
+                        float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
+                        dst_pixels[c] = Image::clampIfInt<PIX>(v);
                     }
-                } else {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        float v = float(dst_pixels[c]) * alpha;
-                        dst_pixels[c] = clampIfInt<PIX>(v);
+                }
+                src_pixels += srcNComps;
+            } else {
+                for (int c = 0; c < dstNComps; ++c) {
+                    float v = float(dst_pixels[c]) * alpha;
+                    dst_pixels[c] = Image::clampIfInt<PIX>(v);
+                }
+            }
+        }
+    }
+};
+
+// Float RGBA: use the vectorized kernel
+template<bool masked, bool maskInvert>
+struct MaskMixSpan<4, 4, float, 1, masked, maskInvert>
+{
+    static void process(float* dst_pixels,
+                        const float* src_pixels,
+                        const float* maskPixels,
+                        float mix,
+                        int count)
+    {
+        if (masked && !maskPixels) {
+            // constant mask value outside of the mask image
+            mix = mix * (maskInvert ? 1.f : 0.f);
+        }
+        ImageKernels::maskMixRowRGBA(dst_pixels, src_pixels, masked ? maskPixels : 0, 1, maskInvert, mix, count);
+    }
+};
+
+template<int srcNComps, int dstNComps, typename PIX, int maxValue>
+void
+maskMixSpan(PIX* dst_pixels,
+            const PIX* src_pixels,
+            const PIX* maskPixels,
+            bool masked,
+            bool maskInvert,
+            float mix,
+            int count)
+{
+    if (!masked) {
+        MaskMixSpan<srcNComps, dstNComps, PIX, maxValue, false, false>::process(dst_pixels, src_pixels, 0, mix, count);
+    } else if (maskInvert) {
+        MaskMixSpan<srcNComps, dstNComps, PIX, maxValue, true, true>::process(dst_pixels, src_pixels, maskPixels, mix, count);
+    } else {
+        MaskMixSpan<srcNComps, dstNComps, PIX, maxValue, true, false>::process(dst_pixels, src_pixels, maskPixels, mix, count);
+    }
+}
+
+/**
+ * @brief Copies the channels flagged in doChannels (R, G, B, A) of count pixels from src to dst, the same way
+ * copyUnProcessedChannels does: channels missing in src (or all channels if src is NULL) are set to 0, except
+ * alpha which is opaque if src has no alpha.
+ **/
+template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+struct CopyChannelsSpan
+{
+    static void process(PIX* dst_pixels,
+                        const PIX* src_pixels,
+                        const bool doChannels[4],
+                        int count)
+    {
+        for (int x = 0; x < count; ++x, dst_pixels += dstNComps) {
+            PIX srcA = src_pixels ? maxValue : 0; /* be opaque for anything that doesn't contain alpha */
+            if ( ( (srcNComps == 1) || (srcNComps == 4) ) && src_pixels ) {
+                srcA = src_pixels[srcNComps - 1];
+            }
+            if (dstNComps == 1) {
+                if (doChannels[3]) {
+                    dst_pixels[0] = srcA;
+                }
+            } else {
+                for (int c = 0; c < 3 && c < dstNComps; ++c) {
+                    if (doChannels[c]) {
+                        dst_pixels[c] = (!src_pixels || c >= srcNComps) ? 0 : src_pixels[c];
                     }
                 }
+                if ( (dstNComps == 4) && doChannels[3] ) {
+                    dst_pixels[dstNComps - 1] = srcA;
+                }
+            }
+            if (src_pixels) {
+                src_pixels += srcNComps;
             }
         }
     }
+};
+
+// Float RGBA: use the vectorized kernel
+template <>
+struct CopyChannelsSpan<float, 1, 4, 4>
+{
+    static void process(float* dst_pixels,
+                        const float* src_pixels,
+                        const bool doChannels[4],
+                        int count)
+    {
+        ImageKernels::copyChannelsRowRGBA(dst_pixels, src_pixels, doChannels[0], doChannels[1], doChannels[2], doChannels[3], count);
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked, bool maskInvert>
+void
+Image::applyMaskMixForMaskInvert(const RectI& roi,
+                                 const Image* maskImg,
+                                 const Image* originalImg,
+                                 float mix)
+{
+    // The row is cut at the horizontal edges of the original and mask images, so that the pixel pointers are
+    // fetched once per span instead of once per pixel
+    int cuts[6];
+    int nCuts = 0;
+
+    cuts[nCuts++] = roi.x1;
+    if (originalImg) {
+        cuts[nCuts++] = originalImg->_bounds.x1;
+        cuts[nCuts++] = originalImg->_bounds.x2;
+    }
+    if (masked && maskImg) {
+        cuts[nCuts++] = maskImg->_bounds.x1;
+        cuts[nCuts++] = maskImg->_bounds.x2;
+    }
+    cuts[nCuts++] = roi.x2;
+    std::sort(cuts, cuts + nCuts);
+
+    for (int y = roi.y1; y < roi.y2; ++y) {
+        for (int i = 0; i + 1 < nCuts; ++i) {
+            int x1 = std::max(cuts[i], roi.x1);
+            int x2 = std::min(cuts[i + 1], roi.x2);
+            if (x1 >= x2) {
+                continue;
+            }
+            PIX* dst_pixels = (PIX*)pixelAt(x1, y);
+            const PIX* src_pixels = originalImg ? (const PIX*)originalImg->pixelAt(x1, y) : 0;
+            const PIX* maskPixels = (masked && maskImg) ? (const PIX*)maskImg->pixelAt(x1, y) : 0;
+            MaskMixSpan<srcNComps, dstNComps, PIX, maxValue, masked, maskInvert>::process(dst_pixels, src_pixels, maskPixels, mix, x2 - x1);
+        }
+    }
 } // Image::applyMaskMixForMaskInvert
 
 template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked>
@@ -298,4 +418,229 @@ Image::applyMaskMix(const RectI& roi,
     }
 } // applyMaskMix
 
+template <typename PIX, int maxValue, int srcNComps, int dstNComps>
+void
+Image::applyPostRenderPassForComponents(const RectI& roi,
+                                        const Image* renderedImage,
+                                        const bool doChannels[4],
+                                        const Image* originalImg,
+                                        bool doMaskMix,
+                                        const Image* maskImg,
+                                        bool masked,
+                                        bool maskInvert,
+                                        float mix)
+{
+    const bool doCopy = doChannels[0] || doChannels[1] || doChannels[2] || doChannels[3];
+
+    // Cut the rows at the horizontal edges of the original and mask images, see applyMaskMixForMaskInvert
+    int cuts[6];
+    int nCuts = 0;
+
+    cuts[nCuts++] = roi.x1;
+    if (originalImg) {
+        cuts[nCuts++] = originalImg->_bounds.x1;
+        cuts[nCuts++] = originalImg->_bounds.x2;
+    }
+    if (doMaskMix && masked && maskImg) {
+        cuts[nCuts++] = maskImg->_bounds.x1;
+        cuts[nCuts++] = maskImg->_bounds.x2;
+    }
+    cuts[nCuts++] = roi.x2;
+    std::sort(cuts, cuts + nCuts);
+
+    const std::size_t rowBytes = (std::size_t)roi.width() * dstNComps * sizeof(PIX);
+    for (int y = roi.y1; y < roi.y2; ++y) {
+        // Each step works on a single row, which stays in cache from one step to the next
+        if (renderedImage != this) {
+            std::memcpy( pixelAt(roi.x1, y), renderedImage->pixelAt(roi.x1, y), rowBytes );
+        }
+        for (int i = 0; i + 1 < nCuts; ++i) {
+            int x1 = std::max(cuts[i], roi.x1);
+            int x2 = std::min(cuts[i + 1], roi.x2);
+            if (x1 >= x2) {
+                continue;
+            }
+            PIX* dst_pixels = (PIX*)pixelAt(x1, y);
+            const PIX* src_pixels = originalImg ? (const PIX*)originalImg->pixelAt(x1, y) : 0;
+            if (doCopy) {
+                CopyChannelsSpan<PIX, maxValue, srcNComps, dstNComps>::process(dst_pixels, src_pixels, doChannels, x2 - x1);
+            }
+            if (doMaskMix) {
+                const PIX* maskPixels = (masked && maskImg) ? (const PIX*)maskImg->pixelAt(x1, y) : 0;
+                maskMixSpan<srcNComps, dstNComps, PIX, maxValue>(dst_pixels, src_pixels, maskPixels, masked, maskInvert, mix, x2 - x1);
+            }
+        }
+    }
+} // Image::applyPostRenderPassForComponents
+
+template <typename PIX, int maxValue, int dstNComps>
+void
+Image::applyPostRenderPassForDstComponents(const RectI& roi,
+                                           const Image* renderedImage,
+                                           const bool doChannels[4],
+                                           const Image* originalImg,
+                                           bool doMaskMix,
+                                           const Image* maskImg,
+                                           bool masked,
+                                           bool maskInvert,
+                                           float mix)
+{
+    int srcNComps = originalImg ? (int)originalImg->getComponentsCount() : 0;
+
+    switch (srcNComps) {
+    case 0:
+        applyPostRenderPassForComponents<PIX, maxValue, 0, dstNComps>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 1:
+        applyPostRenderPassForComponents<PIX, maxValue, 1, dstNComps>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 2:
+        applyPostRenderPassForComponents<PIX, maxValue, 2, dstNComps>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 3:
+        applyPostRenderPassForComponents<PIX, maxValue, 3, dstNComps>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 4:
+        applyPostRenderPassForComponents<PIX, maxValue, 4, dstNComps>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+template <typename PIX, int maxValue>
+void
+Image::applyPostRenderPassForDepth(const RectI& roi,
+                                   const Image* renderedImage,
+                                   const bool doChannels[4],
+                                   const Image* originalImg,
+                                   bool doMaskMix,
+                                   const Image* maskImg,
+                                   bool masked,
+                                   bool maskInvert,
+                                   float mix)
+{
+    switch ( getComponentsCount() ) {
+    case 1:
+        applyPostRenderPassForDstComponents<PIX, maxValue, 1>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 2:
+        applyPostRenderPassForDstComponents<PIX, maxValue, 2>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 3:
+        applyPostRenderPassForDstComponents<PIX, maxValue, 3>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case 4:
+        applyPostRenderPassForDstComponents<PIX, maxValue, 4>(roi, renderedImage, doChannels, originalImg, doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+bool
+Image::applyPostRenderPass(const RectI& roi,
+                           const Image* renderedImage,
+                           const std::bitset<4> processChannels,
+                           const ImagePtr& originalImage,
+                           bool doMaskMix,
+                           const Image* maskImg,
+                           bool masked,
+                           bool maskInvert,
+                           float mix)
+{
+    assert(renderedImage);
+    if ( (getStorageMode() == eStorageModeGLTex) || (renderedImage->getStorageMode() == eStorageModeGLTex) ||
+         ( originalImage && (originalImage->getStorageMode() == eStorageModeGLTex) ) ||
+         ( maskImg && (maskImg->getStorageMode() == eStorageModeGLTex) ) ) {
+        return false;
+    }
+    if ( (renderedImage != this) &&
+         ( ( renderedImage->getComponentsCount() != getComponentsCount() ) || ( renderedImage->getBitDepth() != getBitDepth() ) ) ) {
+        return false;
+    }
+    if ( originalImage && ( ( getMipMapLevel() != originalImage->getMipMapLevel() ) || ( originalImage->getBitDepth() != getBitDepth() ) ) ) {
+        return false;
+    }
+    if ( (originalImage.get() == this) || (maskImg == this) ) {
+        // the rows would be read after being overwritten
+        return false;
+    }
+
+    // Same conditions as copyUnProcessedChannels and applyMaskMix
+    bool doChannels[4] = { false, false, false, false };
+    if ( canCallCopyUnProcessedChannels(processChannels) ) {
+        int dstNComps = (int)getComponentsCount();
+        doChannels[0] = !processChannels[0] && (dstNComps >= 2);
+        doChannels[1] = !processChannels[1] && (dstNComps >= 2);
+        doChannels[2] = !processChannels[2] && (dstNComps >= 3);
+        doChannels[3] = !processChannels[3] && (dstNComps == 1 || dstNComps == 4);
+    }
+#ifdef NATRON_COPY_CHANNELS_UNPREMULT
+    // copyUnProcessedChannels() repremultiplies the copied channels, which is not done here
+    if ( doChannels[0] || doChannels[1] || doChannels[2] || doChannels[3] ) {
+        return false;
+    }
+#endif
+    // Without original image, the result is mixed with black as in applyMaskMix
+    doMaskMix = doMaskMix && ( masked || (mix != 1) );
+    if ( (renderedImage == this) && !doMaskMix && !doChannels[0] && !doChannels[1] && !doChannels[2] && !doChannels[3] ) {
+        // Nothing to do
+        return true;
+    }
+
+    // Take each lock once, images may be shared between the arguments.
+    // When rendering in place, the region was reserved in the bitmap by the render: as with
+    // SharedWriteAccess, only keep the buffer in place so that the other tiles of the image are not held back.
+    boost::scoped_ptr<QReadLocker> sharedLock;
+    boost::scoped_ptr<QWriteLocker> exclusiveLock;
+    if ( (renderedImage == this) && usesBitMap() ) {
+        sharedLock.reset( new QReadLocker(&_entryLock) );
+    } else {
+        exclusiveLock.reset( new QWriteLocker(&_entryLock) );
+    }
+    boost::scoped_ptr<QReadLocker> renderedLock;
+    boost::scoped_ptr<QReadLocker> originalLock;
+    boost::scoped_ptr<QReadLocker> maskLock;
+    if (renderedImage != this) {
+        renderedLock.reset( new QReadLocker(&renderedImage->_entryLock) );
+    }
+    if ( originalImage && (originalImage.get() != renderedImage) ) {
+        originalLock.reset( new QReadLocker(&originalImage->_entryLock) );
+    }
+    if ( doMaskMix && maskImg && (maskImg != renderedImage) && (maskImg != originalImage.get()) ) {
+        maskLock.reset( new QReadLocker(&maskImg->_entryLock) );
+    }
+
+    RectI realRoI;
+    if ( !roi.intersect(_bounds, &realRoI) ) {
+        return true;
+    }
+    if ( (renderedImage != this) && !renderedImage->_bounds.contains(realRoI) ) {
+        // a partial paste is not supported by the fused pass
+        return false;
+    }
+
+    assert( !doMaskMix || !masked || !maskImg || maskImg->getComponents() == ImagePlaneDesc::getAlphaComponents() );
+
+    switch ( getBitDepth() ) {
+    case eImageBitDepthByte:
+        applyPostRenderPassForDepth<unsigned char, 255>(realRoI, renderedImage, doChannels, originalImage.get(), doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case eImageBitDepthShort:
+        applyPostRenderPassForDepth<unsigned short, 65535>(realRoI, renderedImage, doChannels, originalImage.get(), doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    case eImageBitDepthFloat:
+        applyPostRenderPassForDepth<float, 1>(realRoI, renderedImage, doChannels, originalImage.get(), doMaskMix, maskImg, masked, maskInvert, mix);
+        break;
+    default:
+
+        return false;
+    }
+
+    return true;
+} // applyPostRenderPass
+
 NATRON_NAMESPACE_EXIT
@@ -430,6 +430,7 @@ struct KnobHelperPrivate
     KnobI::ListenerDimsMap listeners;
     mutable QMutex animationLevelMutex;
     std::vector<AnimationLevelEnum> animationLevel; //< indicates for each dimension whether it is static/interpolated/onkeyframe
+    bool timeVarying; //< protected by animationLevelMutex: true if the knob is registered in the time-varying knobs of its holder
     bool declaredByPlugin; //< was the knob declared by a plug-in or added by Natron
     bool dynamicallyCreated; //< true if the knob was dynamically created by the user (either via python or via the gui)
     bool userKnob; //< true if it was created by the user and should be put into the "User" page
@@ -512,6 +513,7 @@ struct KnobHelperPrivate
         , listeners()
         , animationLevelMutex()
         , animationLevel(dimension_)
+        , timeVarying(false)
         , declaredByPlugin(declaredByPlugin_)
         , dynamicallyCreated(false)
         , userKnob(false)
@@ -1567,6 +1569,7 @@ KnobHelper::removeAnimationWithReason(ViewSpec view,
     if (_imp->holder) {
         _imp->holder->updateHasAnimation();
     }
+    refreshTimeVaryingState();
 
 
     if (!useGuiCurve) {
@@ -1647,6 +1650,7 @@ KnobHelper::cloneGuiCurvesIfNeeded(std::map<int, ValueChangedReasonEnum>& modifi
     }
     if (hasChanged && _imp->holder) {
         _imp->holder->updateHasAnimation();
+        refreshTimeVaryingState();
     }
 }
 
@@ -3022,6 +3026,7 @@ KnobHelper::expressionChanged(int dimension)
     if (_imp->holder) {
         _imp->holder->updateHasAnimation();
     }
+    refreshTimeVaryingState();
 
     if (_signalSlotHandler) {
         _signalSlotHandler->s_expressionChanged(dimension);
@@ -3720,6 +3725,9 @@ KnobHelper::slaveToInternal(int dimension,
         masterKnob->addListener( false, dimension, otherDimension, shared_from_this() );
     }
 
+    ///The curve is now the one of the master
+    refreshTimeVaryingState();
+
     return true;
 } // KnobHelper::slaveTo
 
@@ -3796,6 +3804,57 @@ KnobHelper::checkAnimationLevel(ViewSpec view,
     if ( changed && _signalSlotHandler && hasGui && !hasGui->isGuiFrozenForPlayback() ) {
         _signalSlotHandler->s_animationLevelChanged(view, dimension );
     }
+
+    refreshTimeVaryingState();
+}
+
+void
+KnobHelper::refreshTimeVaryingState()
+{
+    KnobHolder* holder = getHolder();
+
+    if (!holder) {
+        return;
+    }
+
+    bool timeVarying = evaluateValueChangeOnTimeChange();
+    for (int i = 0; i < _imp->dimension && !timeVarying; ++i) {
+        // isAnimated() follows the master curve if this dimension is slaved
+        timeVarying = isAnimated( i, ViewIdx(0) ) || !getExpression(i).empty();
+    }
+
+    {
+        QMutexLocker l(&_imp->animationLevelMutex);
+        if (_imp->timeVarying == timeVarying) {
+            return;
+        }
+        _imp->timeVarying = timeVarying;
+    }
+
+    KnobIPtr thisShared = shared_from_this();
+    if (timeVarying) {
+        holder->registerTimeVaryingKnob(thisShared);
+    } else {
+        holder->unregisterTimeVaryingKnob( thisShared.get() );
+    }
+
+    ///Knobs slaved to this one read our curves: their state may have changed as well
+    ListenerDimsMap listeners;
+    getListeners(listeners);
+    for (ListenerDimsMap::iterator it = listeners.begin(); it != listeners.end(); ++it) {
+        KnobIPtr listener = it->first.lock();
+        if (listener) {
+            listener->refreshTimeVaryingState();
+        }
+    }
+} // KnobHelper::refreshTimeVaryingState
+
+bool
+KnobHelper::isTimeVarying() const
+{
+    QMutexLocker l(&_imp->animationLevelMutex);
+
+    return _imp->timeVarying;
 }
 
 AnimationLevelEnum
@@ -4873,6 +4932,8 @@ struct KnobHolder::KnobHolderPrivate
     bool knobsFrozen;
     mutable QMutex hasAnimationMutex;
     bool hasAnimation;
+    mutable QMutex timeVaryingKnobsMutex;
+    std::list<KnobIWPtr> timeVaryingKnobs; //< knobs that must be refreshed on time changes, see registerTimeVaryingKnob
     DockablePanelI* settingsPanel;
 
     KnobHolderPrivate(const AppInstancePtr& appInstance_)
@@ -4898,6 +4959,8 @@ struct KnobHolder::KnobHolderPrivate
         , knobsFrozen(false)
         , hasAnimationMutex()
         , hasAnimation(false)
+        , timeVaryingKnobsMutex()
+        , timeVaryingKnobs()
         , settingsPanel(0)
 
     {
@@ -4926,6 +4989,8 @@ struct KnobHolder::KnobHolderPrivate
     , knobsFrozen(false)
     , hasAnimationMutex()
     , hasAnimation(other.hasAnimation)
+    , timeVaryingKnobsMutex()
+    , timeVaryingKnobs()
     , settingsPanel(other.settingsPanel)
     {
 
@@ -4963,6 +5028,10 @@ KnobHolder::~KnobHolder()
             helper->_imp->holder = 0;
         }
     }
+    AppInstancePtr app = getApp();
+    if (app) {
+        app->removeTimeVaryingKnobHolder(this);
+    }
 }
 
 void
@@ -5019,13 +5088,20 @@ void
 KnobHolder::addKnob(const KnobIPtr& k)
 {
     assert( QThread::currentThread() == qApp->thread() );
-    QMutexLocker kk(&_imp->knobsMutex);
-    for (KnobsVec::iterator it = _imp->knobs.begin(); it != _imp->knobs.end(); ++it) {
-        if (*it == k) {
-            return;
+    {
+        QMutexLocker kk(&_imp->knobsMutex);
+        for (KnobsVec::iterator it = _imp->knobs.begin(); it != _imp->knobs.end(); ++it) {
+            if (*it == k) {
+                return;
+            }
         }
+        _imp->knobs.push_back(k);
+    }
+    k->refreshTimeVaryingState();
+    if ( k->isTimeVarying() ) {
+        ///The knob may have been removed from the list and added back
+        registerTimeVaryingKnob(k);
     }
-    _imp->knobs.push_back(k);
 }
 
 void
@@ -5035,24 +5111,33 @@ KnobHolder::insertKnob(int index,
     if (index < 0) {
         return;
     }
-    QMutexLocker kk(&_imp->knobsMutex);
-    for (KnobsVec::iterator it = _imp->knobs.begin(); it != _imp->knobs.end(); ++it) {
-        if (*it == k) {
-            return;
+    {
+        QMutexLocker kk(&_imp->knobsMutex);
+        for (KnobsVec::iterator it = _imp->knobs.begin(); it != _imp->knobs.end(); ++it) {
+            if (*it == k) {
+                return;
+            }
+        }
+        if ( index >= (int)_imp->knobs.size() ) {
+            _imp->knobs.push_back(k);
+        } else {
+            KnobsVec::iterator it = _imp->knobs.begin();
+            std::advance(it, index);
+            _imp->knobs.insert(it, k);
         }
     }
-    if ( index >= (int)_imp->knobs.size() ) {
-        _imp->knobs.push_back(k);
-    } else {
-        KnobsVec::iterator it = _imp->knobs.begin();
-        std::advance(it, index);
-        _imp->knobs.insert(it, k);
+    k->refreshTimeVaryingState();
+    if ( k->isTimeVarying() ) {
+        ///The knob may have been removed from the list and added back
+        registerTimeVaryingKnob(k);
     }
 }
 
 void
 KnobHolder::removeKnobFromList(const KnobI* knob)
 {
+    unregisterTimeVaryingKnob(knob);
+
     QMutexLocker kk(&_imp->knobsMutex);
 
     for (KnobsVec::iterator it = _imp->knobs.begin(); it != _imp->knobs.end(); ++it) {
@@ -5806,7 +5891,13 @@ KnobHolder::endChanges(bool discardRendering)
         if (!isMT) {
             Q_EMIT doEvaluateOnMainThread(hasHadSignificantChange, mustRefreshMetadata);
         } else {
-            evaluate(hasHadSignificantChange, mustRefreshMetadata);
+            // Within a batch of nodes changes, the node is evaluated once the hash of all nodes is up to date
+            EffectInstance* isEffect = dynamic_cast<EffectInstance*>(this);
+            AppInstancePtr app = getApp();
+            ProjectPtr project = app ? app->getProject() : ProjectPtr();
+            if ( !isEffect || !project || !project->deferEvaluation(isEffect->shared_from_this(), hasHadSignificantChange, mustRefreshMetadata) ) {
+                evaluate(hasHadSignificantChange, mustRefreshMetadata);
+            }
         }
     }
 
@@ -5995,8 +6086,10 @@ KnobHolder::refreshAfterTimeChange(bool isPlayback,
     if ( !app || app->isGuiFrozen() ) {
         return;
     }
-    for (std::size_t i = 0; i < _imp->knobs.size(); ++i) {
-        _imp->knobs[i]->onTimeChanged(isPlayback, time);
+    ///Only the knobs whose value may change with time need to be refreshed
+    KnobsVec knobs = getTimeVaryingKnobs();
+    for (std::size_t i = 0; i < knobs.size(); ++i) {
+        knobs[i]->onTimeChanged(isPlayback, time);
     }
     refreshExtraStateAfterTimeChanged(isPlayback, time);
 }
@@ -6005,9 +6098,10 @@ void
 KnobHolder::refreshAfterTimeChangeOnlyKnobsWithTimeEvaluation(double time)
 {
     assert( QThread::currentThread() == qApp->thread() );
-    for (std::size_t i = 0; i < _imp->knobs.size(); ++i) {
-        if ( _imp->knobs[i]->evaluateValueChangeOnTimeChange() ) {
-            _imp->knobs[i]->onTimeChanged(false, time);
+    KnobsVec knobs = getTimeVaryingKnobs();
+    for (std::size_t i = 0; i < knobs.size(); ++i) {
+        if ( knobs[i]->evaluateValueChangeOnTimeChange() ) {
+            knobs[i]->onTimeChanged(false, time);
         }
     }
 }
@@ -6020,9 +6114,10 @@ KnobHolder::refreshInstanceSpecificKnobsOnly(bool isPlayback,
     if ( !getApp() || getApp()->isGuiFrozen() ) {
         return;
     }
-    for (U32 i = 0; i < _imp->knobs.size(); ++i) {
-        if ( _imp->knobs[i]->isInstanceSpecific() ) {
-            _imp->knobs[i]->onTimeChanged(isPlayback, time);
+    KnobsVec knobs = getTimeVaryingKnobs();
+    for (U32 i = 0; i < knobs.size(); ++i) {
+        if ( knobs[i]->isInstanceSpecific() ) {
+            knobs[i]->onTimeChanged(isPlayback, time);
         }
     }
 }
@@ -6354,6 +6449,72 @@ KnobHolder::updateHasAnimation()
     _imp->hasAnimation = hasAnimation;
 }
 
+void
+KnobHolder::registerTimeVaryingKnob(const KnobIPtr& knob)
+{
+    {
+        QMutexLocker k(&_imp->timeVaryingKnobsMutex);
+
+        for (std::list<KnobIWPtr>::const_iterator it = _imp->timeVaryingKnobs.begin(); it != _imp->timeVaryingKnobs.end(); ++it) {
+            if (it->lock() == knob) {
+                return;
+            }
+        }
+        _imp->timeVaryingKnobs.push_back(knob);
+        if (_imp->timeVaryingKnobs.size() > 1) {
+            return;
+        }
+    }
+
+    ///This is the first time-varying knob of the holder
+    AppInstancePtr app = getApp();
+    if (app) {
+        app->addTimeVaryingKnobHolder(this);
+    }
+}
+
+void
+KnobHolder::unregisterTimeVaryingKnob(const KnobI* knob)
+{
+    {
+        QMutexLocker k(&_imp->timeVaryingKnobsMutex);
+
+        ///Also drop the knobs that were deleted in the meantime
+        for (std::list<KnobIWPtr>::iterator it = _imp->timeVaryingKnobs.begin(); it != _imp->timeVaryingKnobs.end();) {
+            KnobIPtr registered = it->lock();
+            if ( !registered || (registered.get() == knob) ) {
+                it = _imp->timeVaryingKnobs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if ( !_imp->timeVaryingKnobs.empty() ) {
+            return;
+        }
+    }
+
+    AppInstancePtr app = getApp();
+    if (app) {
+        app->removeTimeVaryingKnobHolder(this);
+    }
+}
+
+KnobsVec
+KnobHolder::getTimeVaryingKnobs() const
+{
+    KnobsVec ret;
+    QMutexLocker k(&_imp->timeVaryingKnobsMutex);
+
+    for (std::list<KnobIWPtr>::const_iterator it = _imp->timeVaryingKnobs.begin(); it != _imp->timeVaryingKnobs.end(); ++it) {
+        KnobIPtr knob = it->lock();
+        if (knob) {
+            ret.push_back(knob);
+        }
+    }
+
+    return ret;
+}
+
 /***************************STRING ANIMATION******************************************/
 void
 AnimatingKnobStringHelper::cloneExtraData(KnobI* other,
@@ -460,6 +460,14 @@ public:
     virtual void computeHasModifications() = 0;
     virtual void checkAnimationLevel(ViewSpec view, int dimension) = 0;
 
+    /**
+     * @brief Recomputes whether the value of this knob may change with time (animated, expression-driven,
+     * slaved to an animated knob or evaluated on time changes) and updates the index of time-varying knobs
+     * of the holder accordingly. Knobs slaved to this one are refreshed as well.
+     **/
+    virtual void refreshTimeVaryingState() = 0;
+    virtual bool isTimeVarying() const = 0;
+
     /**
      * @brief If the parameter is multidimensional, this is the label that will be displayed for a dimension.
      **/
@@ -1601,6 +1609,8 @@ public:
     virtual bool hasModifications(int dimension) const OVERRIDE FINAL WARN_UNUSED_RETURN;
     virtual bool hasModificationsForSerialization() const OVERRIDE FINAL WARN_UNUSED_RETURN;
     virtual void checkAnimationLevel(ViewSpec view, int dimension) OVERRIDE FINAL;
+    virtual void refreshTimeVaryingState() OVERRIDE FINAL;
+    virtual bool isTimeVarying() const OVERRIDE FINAL WARN_UNUSED_RETURN;
     virtual KnobIPtr createDuplicateOnHolder(KnobHolder* otherHolder,
                                             const boost::shared_ptr<KnobPage>& page,
                                             const boost::shared_ptr<KnobGroup>& group,
@@ -2513,6 +2523,17 @@ public:
      **/
     void updateHasAnimation();
 
+    /**
+     * @brief Index of the knobs whose value may change with time: knobs that are animated, driven by an expression,
+     * slaved to such a knob or that must be evaluated on time changes. It is maintained incrementally by the knobs
+     * themselves (see KnobI::refreshTimeVaryingState()) so that a time change only visits these knobs.
+     * The knobs are returned in the order they were registered.
+     * The holder itself is registered in its AppInstance while it has at least one time-varying knob.
+     **/
+    void registerTimeVaryingKnob(const KnobIPtr& knob);
+    void unregisterTimeVaryingKnob(const KnobI* knob);
+    KnobsVec getTimeVaryingKnobs() const WARN_UNUSED_RETURN;
+
     //////////////////////////////////////////////////////////////////////////////////////////
     boost::shared_ptr<KnobPage> getOrCreateUserPageKnob();
     boost::shared_ptr<KnobPage> getUserPageKnob() const;
@@ -1805,6 +1805,8 @@ Knob<T>::unSlaveInternal(int dimension,
     } else {
         checkAnimationLevel(ViewSpec::all(), dimension);
     }
+    ///The curve is no longer the one of the master
+    refreshTimeVaryingState();
 }
 
 template<typename T>
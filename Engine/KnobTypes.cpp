@@ -2022,6 +2022,31 @@ KnobParametric::getValue(int dimension,
     return eStatusOK;
 }
 
+StatusEnum
+KnobParametric::getValues(int dimension,
+                          int count,
+                          const double* parametricPositions,
+                          double *returnValues) const
+{
+    ///Mt-safe as Curve is MT-safe
+    if ( ( dimension >= (int)_curves.size() ) || (count < 0) ) {
+        return eStatusFailed;
+    }
+    try {
+        CurvePtr curve = getParametricCurve(dimension);
+        if (parametricPositions) {
+            curve->getValuesAt(parametricPositions, count, returnValues);
+        } else {
+            std::pair<double, double> range = curve->getXRange();
+            curve->getSampledValues(range.first, range.second, count, returnValues);
+        }
+    } catch (...) {
+        return eStatusFailed;
+    }
+
+    return eStatusOK;
+}
+
 StatusEnum
 KnobParametric::getNControlPoints(int dimension,
                                   int *returnValue) const
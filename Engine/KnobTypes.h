@@ -1012,6 +1012,13 @@ public:
     StatusEnum addControlPoint(ValueChangedReasonEnum reason, int dimension, double key, double value, KeyframeTypeEnum interpolation = eKeyframeTypeSmooth) WARN_UNUSED_RETURN;
     StatusEnum addControlPoint(ValueChangedReasonEnum reason, int dimension, double key, double value, double leftDerivative, double rightDerivative, KeyframeTypeEnum interpolation = eKeyframeTypeSmooth) WARN_UNUSED_RETURN;
     StatusEnum getValue(int dimension, double parametricPosition, double *returnValue) const WARN_UNUSED_RETURN;
+
+    /**
+     * @brief Evaluates the curve at count positions in one call. If parametricPositions is NULL, the curve
+     * is sampled at count evenly spaced positions covering the parametric range, and the samples are cached
+     * until the curve changes.
+     **/
+    StatusEnum getValues(int dimension, int count, const double* parametricPositions, double *returnValues) const WARN_UNUSED_RETURN;
     StatusEnum getNControlPoints(int dimension, int *returnValue) const WARN_UNUSED_RETURN;
     StatusEnum getNthControlPoint(int dimension,
                                   int nthCtl,
@@ -220,6 +220,53 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Among the maxCandidates least recently used elements which are not used elsewhere, purge the one
+    // with the lowest priority. The priority functor returns false for elements that must not be purged.
+    template <typename PriorityFunctor>
+    std::pair<key_type, V> evictLowestPriority(const PriorityFunctor& priorityFunctor,
+                                               int maxCandidates,
+                                               double* priority)
+    {
+        typename key_to_value_type::iterator bestIt = _key_to_value.end();
+        typename std::list<V>::iterator bestIt2;
+        double bestPriority = 0.;
+        int nCandidates = 0;
+
+        for (typename key_tracker_type::iterator kt = _key_tracker.begin();
+             kt != _key_tracker.end() && nCandidates < maxCandidates;
+             ++kt) {
+            typename key_to_value_type::iterator it = _key_to_value.find(*kt);
+            assert( it != _key_to_value.end() );
+            for (typename std::list<V>::iterator it2 = it->second.first.begin(); it2 != it->second.first.end(); ++it2) {
+                double p;
+                if ( ( (*it2).use_count() != 1 ) || !priorityFunctor(*it2, &p) ) {
+                    continue;
+                }
+                if ( ( bestIt == _key_to_value.end() ) || (p < bestPriority) ) {
+                    bestIt = it;
+                    bestIt2 = it2;
+                    bestPriority = p;
+                }
+                ++nCandidates;
+            }
+        }
+        if ( bestIt == _key_to_value.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(bestIt->first, *bestIt2);
+        if (bestIt->second.first.size() == 1) {
+            // Erase both elements to completely purge record
+            _key_tracker.erase(bestIt->second.second);
+            _key_to_value.erase(bestIt);
+        } else {
+            bestIt->second.first.erase(bestIt2);
+        }
+        *priority = bestPriority;
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -333,6 +380,49 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Among the maxCandidates least recently used elements which are not used elsewhere, purge the one
+    // with the lowest priority. The priority functor returns false for elements that must not be purged.
+    template <typename PriorityFunctor>
+    std::pair<key_type, V> evictLowestPriority(const PriorityFunctor& priorityFunctor,
+                                               int maxCandidates,
+                                               double* priority)
+    {
+        typename container_type::right_iterator bestIt = _container.right.end();
+        typename std::list<V>::iterator bestIt2;
+        double bestPriority = 0.;
+        int nCandidates = 0;
+
+        for (typename container_type::right_iterator it = _container.right.begin();
+             it != _container.right.end() && nCandidates < maxCandidates;
+             ++it) {
+            for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end(); ++it2) {
+                double p;
+                if ( ( (*it2).use_count() != 1 ) || !priorityFunctor(*it2, &p) ) {
+                    continue;
+                }
+                if ( ( bestIt == _container.right.end() ) || (p < bestPriority) ) {
+                    bestIt = it;
+                    bestIt2 = it2;
+                    bestPriority = p;
+                }
+                ++nCandidates;
+            }
+        }
+        if ( bestIt == _container.right.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(bestIt->second, *bestIt2);
+        if (bestIt->first.size() == 1) {
+            _container.right.erase(bestIt);
+        } else {
+            bestIt->first.erase(bestIt2);
+        }
+        *priority = bestPriority;
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -454,6 +544,53 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Among the maxCandidates least recently used elements which are not used elsewhere, purge the one
+    // with the lowest priority. The priority functor returns false for elements that must not be purged.
+    template <typename PriorityFunctor>
+    std::pair<key_type, V> evictLowestPriority(const PriorityFunctor& priorityFunctor,
+                                               int maxCandidates,
+                                               double* priority)
+    {
+        typename key_to_value_type::iterator bestIt = _key_to_value.end();
+        typename std::list<V>::iterator bestIt2;
+        double bestPriority = 0.;
+        int nCandidates = 0;
+
+        for (typename key_tracker_type::iterator kt = _key_tracker.begin();
+             kt != _key_tracker.end() && nCandidates < maxCandidates;
+             ++kt) {
+            typename key_to_value_type::iterator it = _key_to_value.find(*kt);
+            assert( it != _key_to_value.end() );
+            for (typename std::list<V>::iterator it2 = it->second.first.begin(); it2 != it->second.first.end(); ++it2) {
+                double p;
+                if ( ( (*it2).use_count() != 1 ) || !priorityFunctor(*it2, &p) ) {
+                    continue;
+                }
+                if ( ( bestIt == _key_to_value.end() ) || (p < bestPriority) ) {
+                    bestIt = it;
+                    bestIt2 = it2;
+                    bestPriority = p;
+                }
+                ++nCandidates;
+            }
+        }
+        if ( bestIt == _key_to_value.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(bestIt->first, *bestIt2);
+        if (bestIt->second.first.size() == 1) {
+            // Erase both elements to completely purge record
+            _key_tracker.erase(bestIt->second.second);
+            _key_to_value.erase(bestIt);
+        } else {
+            bestIt->second.first.erase(bestIt2);
+        }
+        *priority = bestPriority;
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _key_to_value.size();
@@ -561,6 +698,49 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Among the maxCandidates least recently used elements which are not used elsewhere, purge the one
+    // with the lowest priority. The priority functor returns false for elements that must not be purged.
+    template <typename PriorityFunctor>
+    std::pair<key_type, V> evictLowestPriority(const PriorityFunctor& priorityFunctor,
+                                               int maxCandidates,
+                                               double* priority)
+    {
+        typename container_type::right_iterator bestIt = _container.right.end();
+        typename std::list<V>::iterator bestIt2;
+        double bestPriority = 0.;
+        int nCandidates = 0;
+
+        for (typename container_type::right_iterator it = _container.right.begin();
+             it != _container.right.end() && nCandidates < maxCandidates;
+             ++it) {
+            for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end(); ++it2) {
+                double p;
+                if ( ( (*it2).use_count() != 1 ) || !priorityFunctor(*it2, &p) ) {
+                    continue;
+                }
+                if ( ( bestIt == _container.right.end() ) || (p < bestPriority) ) {
+                    bestIt = it;
+                    bestIt2 = it2;
+                    bestPriority = p;
+                }
+                ++nCandidates;
+            }
+        }
+        if ( bestIt == _container.right.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(bestIt->second, *bestIt2);
+        if (bestIt->first.size() == 1) {
+            _container.right.erase(bestIt);
+        } else {
+            bestIt->first.erase(bestIt2);
+        }
+        *priority = bestPriority;
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -663,6 +843,49 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Among the maxCandidates least recently used elements which are not used elsewhere, purge the one
+    // with the lowest priority. The priority functor returns false for elements that must not be purged.
+    template <typename PriorityFunctor>
+    std::pair<key_type, V> evictLowestPriority(const PriorityFunctor& priorityFunctor,
+                                               int maxCandidates,
+                                               double* priority)
+    {
+        typename container_type::right_iterator bestIt = _container.right.end();
+        typename std::list<V>::iterator bestIt2;
+        double bestPriority = 0.;
+        int nCandidates = 0;
+
+        for (typename container_type::right_iterator it = _container.right.begin();
+             it != _container.right.end() && nCandidates < maxCandidates;
+             ++it) {
+            for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end(); ++it2) {
+                double p;
+                if ( ( (*it2).use_count() != 1 ) || !priorityFunctor(*it2, &p) ) {
+                    continue;
+                }
+                if ( ( bestIt == _container.right.end() ) || (p < bestPriority) ) {
+                    bestIt = it;
+                    bestIt2 = it2;
+                    bestPriority = p;
+                }
+                ++nCandidates;
+            }
+        }
+        if ( bestIt == _container.right.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(bestIt->second, *bestIt2);
+        if (bestIt->first.size() == 1) {
+            _container.right.erase(bestIt);
+        } else {
+            bestIt->first.erase(bestIt2);
+        }
+        *priority = bestPriority;
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -32,6 +32,7 @@
 #include <cassert>
 #include <stdexcept>
 #include <sstream> // stringstream
+#include <vector>
 
 #include "Global/Macros.h"
 
@@ -884,26 +885,16 @@ Node::computeHashInternal()
 } // Node::computeHashInternal
 
 void
-Node::computeHashRecursive(std::list<Node*>& marked)
+Node::getHashOutputs(NodesList* outputs) const
 {
-    if ( std::find(marked.begin(), marked.end(), this) != marked.end() ) {
-        return;
-    }
-
-    bool hasChanged = computeHashInternal();
-    marked.push_back(this);
-    if (!hasChanged) {
-        //Nothing changed, no need to recurse on outputs
+    if (!_imp->effect) {
         return;
     }
 
-
     bool isRotoPaint = _imp->effect->isRotoPaintNode();
-
-    ///call it on all the outputs
-    NodesList outputs;
-    getOutputsWithGroupRedirection(outputs);
-    for (NodesList::iterator it = outputs.begin(); it != outputs.end(); ++it) {
+    NodesList allOutputs;
+    getOutputsWithGroupRedirection(allOutputs);
+    for (NodesList::iterator it = allOutputs.begin(); it != allOutputs.end(); ++it) {
         assert(*it);
 
         //Since the rotopaint node is connected to the internal nodes of the tree, don't change their hash
@@ -911,20 +902,112 @@ Node::computeHashRecursive(std::list<Node*>& marked)
         if ( isRotoPaint && attachedStroke && (attachedStroke->getContext()->getNode().get() == this) ) {
             continue;
         }
-        (*it)->computeHashRecursive(marked);
+        outputs->push_back(*it);
     }
 
-
-    ///If the node has a rotopaint tree, compute the hash of the nodes in the tree
+    ///If the node has a rotopaint tree, the hash of the nodes in the tree depends on this node
     if (_imp->rotoContext) {
-        NodesList allItems;
-        _imp->rotoContext->getRotoPaintTreeNodes(&allItems);
-        for (NodesList::iterator it = allItems.begin(); it != allItems.end(); ++it) {
-            (*it)->computeHashRecursive(marked);
-        }
+        _imp->rotoContext->getRotoPaintTreeNodes(outputs);
     }
 }
 
+namespace {
+struct HashVisitedNode
+{
+    Node* node;
+    NodesList outputs;
+    int nPendingInputs; // number of inputs in the visited sub-graph not processed yet
+    bool mustRecompute; // true if the node was given or if one of its inputs changed
+    bool processed;
+
+    HashVisitedNode(Node* node)
+        : node(node)
+        , outputs()
+        , nPendingInputs(0)
+        , mustRecompute(false)
+        , processed(false)
+    {
+    }
+};
+}
+
+void
+Node::computeHashForNodes(const NodesList& nodes)
+{
+    ///Always called in the main thread
+    assert( QThread::currentThread() == qApp->thread() );
+
+    // Each propagation has its own id: marking a node as visited is O(1) and does not need any clean-up
+    static U64 visitStamp = 0;
+    ++visitStamp;
+
+    std::vector<HashVisitedNode> visited;
+    for (NodesList::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        Node* node = it->get();
+        if (node->_imp->hashVisitStamp != visitStamp) {
+            node->_imp->hashVisitStamp = visitStamp;
+            node->_imp->hashVisitIndex = (int)visited.size();
+            visited.push_back( HashVisitedNode(node) );
+        }
+        visited[node->_imp->hashVisitIndex].mustRecompute = true;
+    }
+
+    // Collect the sub-graph downstream of the given nodes, counting the inputs of each node within the sub-graph
+    for (std::size_t i = 0; i < visited.size(); ++i) {
+        NodesList outputs;
+        visited[i].node->getHashOutputs(&outputs);
+        for (NodesList::iterator it = outputs.begin(); it != outputs.end(); ++it) {
+            Node* output = it->get();
+            if (output->_imp->hashVisitStamp != visitStamp) {
+                output->_imp->hashVisitStamp = visitStamp;
+                output->_imp->hashVisitIndex = (int)visited.size();
+                visited.push_back( HashVisitedNode(output) );
+            }
+            ++visited[output->_imp->hashVisitIndex].nPendingInputs;
+        }
+        visited[i].outputs.swap(outputs);
+    }
+
+    // Recompute the hashes in topological order: a node is processed once all its inputs in the sub-graph are,
+    // so that it is computed only once, from up to date inputs.
+    std::vector<int> ready;
+    for (int i = (int)visited.size() - 1; i >= 0; --i) {
+        if (visited[i].nPendingInputs == 0) {
+            ready.push_back(i);
+        }
+    }
+    std::size_t firstNotProcessed = 0;
+    for (;;) {
+        if ( ready.empty() ) {
+            // All nodes left are part of a cycle (e.g: through a rotopaint tree): break it at the first node visited
+            while ( firstNotProcessed < visited.size() && visited[firstNotProcessed].processed ) {
+                ++firstNotProcessed;
+            }
+            if ( firstNotProcessed == visited.size() ) {
+                break;
+            }
+            ready.push_back( (int)firstNotProcessed );
+        }
+        int index = ready.back();
+        ready.pop_back();
+        HashVisitedNode& node = visited[index];
+        if (node.processed) {
+            continue;
+        }
+        node.processed = true;
+
+        //Nothing changed, no need to recompute the outputs
+        bool hasChanged = node.mustRecompute && node.node->computeHashInternal();
+        for (NodesList::iterator it = node.outputs.begin(); it != node.outputs.end(); ++it) {
+            HashVisitedNode& output = visited[(*it)->_imp->hashVisitIndex];
+            output.mustRecompute |= hasChanged;
+            if ( (--output.nPendingInputs == 0) && !output.processed ) {
+                ready.push_back( (*it)->_imp->hashVisitIndex );
+            }
+        }
+    }
+} // Node::computeHashForNodes
+
 void
 Node::removeAllImagesFromCacheWithMatchingIDAndDifferentKey(U64 nodeHashKey)
 {
@@ -978,8 +1061,18 @@ Node::computeHash()
 
         return;
     }
-    std::list<Node*> marked;
-    computeHashRecursive(marked);
+    NodePtr thisShared = shared_from_this();
+    AppInstancePtr app = getApp();
+    ProjectPtr project = app ? app->getProject() : ProjectPtr();
+
+    // Within a batch of changes, the hash is propagated once for all the nodes when the batch is closed
+    if ( project && project->deferHashComputation(thisShared) ) {
+        return;
+    }
+
+    NodesList nodes;
+    nodes.push_back(thisShared);
+    computeHashForNodes(nodes);
 } // computeHash
 
 
@@ -1018,6 +1111,9 @@ Node::loadKnobs(const NodeSerialization & serialization,
 
     setKnobsAge( serialization.getKnobsAge() );
 
+    if ( isPinnedInCache() ) {
+        appPTR->setImagesPinnedInCacheForHolder(this, true);
+    }
 
     _imp->effect->onKnobsLoaded();
 }
@@ -1536,6 +1632,19 @@ Node::makeCacheInfo() const
     std::stringstream ss;
     ss << "<b><font color=\"green\">Cache occupancy:</font></b> RAM: <font color=#c8c8c8>" << ramSizeStr.toStdString() << "</font> / Disk: <font color=#c8c8c8>" << diskSizeStr.toStdString() << "</font>";
 
+    if (_imp->effect) {
+        // Hits/misses of the actions cache, the misses are the actual calls to the plug-in actions
+        static const char* actionNames[EffectInstance::eCachedActionCount] = {
+            "isIdentity", "getRegionOfDefinition", "getFramesNeeded", "getClipComponents", "getTimeDomain"
+        };
+        ss << "<br /><b><font color=\"green\">Actions cache (hits / misses):</font></b>";
+        for (int i = 0; i < EffectInstance::eCachedActionCount; ++i) {
+            int nbHits, nbMisses;
+            _imp->effect->getActionsCacheStatistics( (EffectInstance::CachedActionEnum)i, &nbHits, &nbMisses );
+            ss << (i == 0 ? " " : ", ") << actionNames[i] << ": <font color=#c8c8c8>" << nbHits << " / " << nbMisses << "</font>";
+        }
+    }
+
     return ss.str();
 }
 
@@ -1757,6 +1866,19 @@ Node::createNodePage(const KnobPagePtr& settingsPage)
     _imp->forceCaching = fCaching;
     settingsPage->addKnob(fCaching);
 
+    KnobBoolPtr pinInCache = AppManager::createKnob<KnobBool>(_imp->effect.get(), tr("Pin in cache"), 1, false);
+    pinInCache->setName("pinInCache");
+    pinInCache->setDefaultValue(false);
+    pinInCache->setAnimationEnabled(false);
+    pinInCache->setAddNewLine(false);
+    pinInCache->setIsPersistent(true);
+    pinInCache->setEvaluateOnChange(false);
+    pinInCache->setHintToolTip( tr("When checked, the output of this node is cached and the cache keeps it in RAM as long as it can "
+                                   "evict the images of other nodes instead, so that it survives the renders of the rest of the graph. "
+                                   "Unlike the DiskCache node, the images are not kept across sessions.") );
+    _imp->pinInCache = pinInCache;
+    settingsPage->addKnob(pinInCache);
+
     KnobBoolPtr previewEnabled = AppManager::createKnob<KnobBool>(_imp->effect.get(), tr("Preview"), 1, false);
     assert(previewEnabled);
     previewEnabled->setDefaultValue( makePreviewByDefault() );
@@ -2608,6 +2730,14 @@ Node::isForceCachingEnabled() const
     return b ? b->getValue() : false;
 }
 
+bool
+Node::isPinnedInCache() const
+{
+    KnobBoolPtr b = _imp->pinInCache.lock();
+
+    return b ? b->getValue() : false;
+}
+
 void
 Node::onSetSupportRenderScaleMaybeSet(int support)
 {
@@ -3286,7 +3416,8 @@ bool
 Node::makePreviewImage(SequenceTime time,
                        int *width,
                        int *height,
-                       unsigned int* buf)
+                       unsigned int* buf,
+                       const AbortableRenderInfoPtr& abortInfoParam)
 {
     assert(_imp->knobsInitialized);
 
@@ -3346,7 +3477,7 @@ Node::makePreviewImage(SequenceTime time,
 
 
     {
-        AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+        AbortableRenderInfoPtr abortInfo = abortInfoParam ? abortInfoParam : AbortableRenderInfo::create(true, 0);
         const bool isRenderUserInteraction = true;
         const bool isSequentialRender = false;
         AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
@@ -3363,7 +3494,7 @@ Node::makePreviewImage(SequenceTime time,
                                                   getApp()->getTimeLine().get(), // timeline
                                                   NodePtr(), //rotoPaint node
                                                   false, // isAnalysis
-                                                  true, // isDraft
+                                                  false, // isDraft: share the cache entries of the viewer renders
                                                   RenderStatsPtr() );
         FrameRequestMap request;
         stat = EffectInstance::computeRequestPass(time, ViewIdx(0), mipMapLevel, rod, thisNode, request);
@@ -4922,12 +5053,11 @@ Node::onEffectKnobValueChanged(KnobI* what,
             ///When a group is disabled we have to force a hash change of all nodes inside otherwise the image will stay cached
 
             NodesList nodes = isGroup->getNodes();
-            std::list<Node*> markedNodes;
             for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
                 //This will not trigger a hash recomputation
                 (*it)->incrementKnobsAge_internal();
-                (*it)->computeHashRecursive(markedNodes);
             }
+            computeHashForNodes(nodes);
         }
     } else if ( what == _imp->nodeLabelKnob.lock().get() ) {
         Q_EMIT nodeExtraLabelChanged( QString::fromUtf8( _imp->nodeLabelKnob.lock()->getValue().c_str() ) );
@@ -4944,6 +5074,8 @@ Node::onEffectKnobValueChanged(KnobI* what,
         }
     } else if ( what == _imp->hideInputs.lock().get() ) {
         Q_EMIT hideInputsKnobChanged( _imp->hideInputs.lock()->getValue() );
+    } else if ( what == _imp->pinInCache.lock().get() ) {
+        appPTR->setImagesPinnedInCacheForHolder( this, isPinnedInCache() );
     } else if ( _imp->effect->isReader() && (what->getName() == kReadOIIOAvailableViewsKnobName) ) {
         refreshCreatedViews(what, false /*silent*/);
     } else if ( what == _imp->refreshInfoButton.lock().get() ||
@@ -5747,6 +5879,26 @@ Node::isNodeRendering() const
     return _imp->nodeIsRendering > 0;
 }
 
+void
+Node::setCachingInputsForViews(bool caching)
+{
+    QMutexLocker k(&_imp->cachingInputsForViewsMutex);
+
+    if (caching) {
+        ++_imp->cachingInputsForViews;
+    } else if (_imp->cachingInputsForViews > 0) {
+        --_imp->cachingInputsForViews;
+    }
+}
+
+bool
+Node::isCachingInputsForViews() const
+{
+    QMutexLocker k(&_imp->cachingInputsForViewsMutex);
+
+    return _imp->cachingInputsForViews > 0;
+}
+
 void
 Node::dequeueActions()
 {
@@ -5927,6 +6079,7 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
      * - The plug-in does temporal clip access
      * - Preview image is enabled (and Natron is not running in background)
      * - The node is a direct input of a viewer, this is to overcome linear graphs where all nodes would not be cached
+     * - The node is a direct input of a writer whose views were rendered concurrently up to this node
      * - The node is not frame varying, meaning it will always produce the same image at any time
      * - The node is a roto node and it is being edited
      * - The node does not support tiles
@@ -5968,6 +6121,10 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
                 //This image never changes, cache it once.
                 return true;
             }
+            if ( output->isCachingInputsForViews() ) {
+                //The views are rendered concurrently up to this node, then read from the cache by its output
+                return true;
+            }
             if ( output->isSettingsPanelVisible() ) {
                 //Output node has panel opened, meaning the user is likely to be heavily editing
 
@@ -5990,7 +6147,7 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
                 //analysis pass. Cache it because the image is likely to get asked for severla times.
                 return true;
             }
-            if ( isForceCachingEnabled() ) {
+            if ( isForceCachingEnabled() || isPinnedInCache() ) {
                 //Users wants it cached
                 return true;
             }
@@ -6024,7 +6181,7 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
             // outputs == 0, never cache, unless explicitly set or rotopaint internal node
             RotoDrawableItemPtr attachedStroke = _imp->paintStroke.lock();
 
-            return isForceCachingEnabled() || appPTR->isAggressiveCachingEnabled() ||
+            return isForceCachingEnabled() || isPinnedInCache() || appPTR->isAggressiveCachingEnabled() ||
                    ( attachedStroke && attachedStroke->getContext()->getNode()->isSettingsPanelVisible() );
         }
     }
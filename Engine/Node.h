@@ -227,6 +227,14 @@ public:
      **/
     U64 getHashValue() const;
 
+    /**
+     * @brief Recomputes the hash of the given nodes and propagates the change to their outputs.
+     * Each node downstream is visited once and recomputed after all of its inputs, only if one of them changed,
+     * so that the cost is linear in the size of the affected sub-graph.
+     * This must be called on the main-thread.
+     **/
+    static void computeHashForNodes(const NodesList& nodes);
+
     virtual std::string getCacheID() const OVERRIDE FINAL;
 
     /**
@@ -786,8 +794,12 @@ public:
      *
      * The width and height might be modified by the function, so their value can
      * be queried at the end of the function
+     *
+     * If abortInfo is set, the render may be cancelled by calling setAborted() on it, in which case
+     * this function returns false.
      **/
-    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf);
+    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf,
+                          const AbortableRenderInfoPtr& abortInfo = AbortableRenderInfoPtr());
 
     /**
      * @brief Returns true if the node is currently rendering a preview image.
@@ -1070,6 +1082,14 @@ public:
      **/
     bool isNodeRendering() const;
 
+    /**
+     * @brief While set, the nodes directly upstream of this node cache their output, so that the views rendered
+     * concurrently upstream can be read back from the cache when this node renders each view in turn.
+     * Calls must be balanced since several frames may be rendered at the same time.
+     **/
+    void setCachingInputsForViews(bool caching);
+    bool isCachingInputsForViews() const;
+
     bool hasPersistentMessage() const;
 
     bool hasAnyPersistentMessage() const;
@@ -1085,6 +1105,11 @@ public:
 
     bool isForceCachingEnabled() const;
 
+    /**
+     * @brief When true, the images rendered by this node are cached and only evicted from the cache when no other image can be.
+     **/
+    bool isPinnedInCache() const;
+
 
     /**
      * @brief Declares to Python all parameters as attribute of the variable representing this node.
@@ -1337,7 +1362,10 @@ private:
 
     bool setStreamWarningInternal(StreamWarningEnum warning, const QString& message);
 
-    void computeHashRecursive(std::list<Node*>& marked);
+    /**
+     * @brief Returns the nodes whose hash depends on the hash of this node
+     **/
+    void getHashOutputs(NodesList* outputs) const;
 
     /**
      * @brief Refreshes the node hash depending on its context (knobs age, inputs etc...)
@@ -60,6 +60,31 @@ NodeCollectionSerialization::initialize(const NodeCollection& group)
     }
 }
 
+void
+NodeCollectionSerialization::replaceNodeSerialization(const NodeSerializationPtr& s)
+{
+    for (std::list<NodeSerializationPtr>::iterator it = _serializedNodes.begin(); it != _serializedNodes.end(); ++it) {
+        if ( (*it)->getNodeScriptName() == s->getNodeScriptName() ) {
+            *it = s;
+
+            return;
+        }
+    }
+    _serializedNodes.push_back(s);
+}
+
+void
+NodeCollectionSerialization::removeNodeSerialization(const std::string& scriptName)
+{
+    for (std::list<NodeSerializationPtr>::iterator it = _serializedNodes.begin(); it != _serializedNodes.end(); ++it) {
+        if ( (*it)->getNodeScriptName() == scriptName ) {
+            _serializedNodes.erase(it);
+
+            return;
+        }
+    }
+}
+
 static QString lookForFileRecursively(const QString& dirPath, const QString& filenameUnPathed)
 {
     QDir d(dirPath);
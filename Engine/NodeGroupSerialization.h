@@ -90,6 +90,13 @@ public:
         _serializedNodes.push_back(s);
     }
 
+    /**
+     * @brief Replaces the node with the same script-name, or adds it if there is none.
+     **/
+    void replaceNodeSerialization(const NodeSerializationPtr& s);
+
+    void removeNodeSerialization(const std::string& scriptName);
+
     static bool restoreFromSerialization(const std::list<NodeSerializationPtr> & serializedNodes,
                                          const NodeCollectionPtr& group,
                                          bool createNodes,
@@ -787,6 +787,7 @@ Node::doDestroyNodeInternalEnd(bool autoReconnect)
     ///Remove all images in the cache associated to this node
     ///This will not remove from the disk cache if the project is closing
     removeAllImagesFromCache(false);
+    appPTR->setImagesPinnedInCacheForHolder(this, false);
 
     AppInstancePtr app = getApp();
     if (app) {
@@ -176,6 +176,8 @@ public:
         , renderInstancesSharedMutex(QMutex::Recursive)
         , knobsAge(0)
         , knobsAgeMutex()
+        , hashVisitStamp(0)
+        , hashVisitIndex(0)
         , masterNodeMutex()
         , masterNode()
         , nodeLinks()
@@ -192,6 +194,7 @@ public:
         , refreshInfoButton()
         , useFullScaleImagesWhenRenderScaleUnsupported()
         , forceCaching()
+        , pinInCache()
         , hideInputs()
         , beforeFrameRender()
         , beforeRender()
@@ -222,6 +225,8 @@ public:
         , nodeIsDequeuingCond()
         , nodeIsRendering(0)
         , nodeIsRenderingMutex()
+        , cachingInputsForViews(0)
+        , cachingInputsForViewsMutex()
         , persistentMessage()
         , persistentMessageType(0)
         , persistentMessageMutex()
@@ -364,6 +369,8 @@ public:
     U64 knobsAge; //< the age of the knobs in this effect. It gets incremented every times the effect has its evaluate() function called.
     mutable QReadWriteLock knobsAgeMutex; //< protects knobsAge and hash
     Hash64 hash; //< recomputed every time knobsAge is changed.
+    U64 hashVisitStamp; //< id of the last hash propagation that visited this node, see Node::computeHashForNodes. MT only
+    int hashVisitIndex; //< index of this node in the nodes visited by that propagation. MT only
     mutable QMutex masterNodeMutex; //< protects masterNode and nodeLinks
     NodeWPtr masterNode; //< this points to the master when the node is a clone
     KnobLinkList nodeLinks; //< these point to the parents of the params links
@@ -390,6 +397,7 @@ public:
     KnobButtonWPtr refreshInfoButton;
     KnobBoolWPtr useFullScaleImagesWhenRenderScaleUnsupported;
     KnobBoolWPtr forceCaching;
+    KnobBoolWPtr pinInCache;
     KnobBoolWPtr hideInputs;
     KnobStringWPtr beforeFrameRender;
     KnobStringWPtr beforeRender;
@@ -435,6 +443,10 @@ public:
     ///Counter counting how many parallel renders are active on the node
     int nodeIsRendering;
     mutable QMutex nodeIsRenderingMutex;
+
+    ///Counter counting how many frames are rendering the views of the inputs of the node concurrently
+    int cachingInputsForViews;
+    mutable QMutex cachingInputsForViewsMutex;
     QString persistentMessage;
     int persistentMessageType;
     mutable QMutex persistentMessageMutex;
@@ -1108,6 +1108,7 @@ OfxClipInstance::getOutputImageInternal(const std::string* ofxPlane,
     }
 
     ImagePtr outputImage;
+    bool renderInPlace = false;
 
     /*
        If the plugin is multiplanar return exactly what it requested.
@@ -1118,6 +1119,7 @@ OfxClipInstance::getOutputImageInternal(const std::string* ofxPlane,
     for (std::map<ImagePlaneDesc, EffectInstance::PlaneToRender>::iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
         if (it->first.getPlaneID() == layerName) {
             outputImage = it->second.tmpImage;
+            renderInPlace = it->second.renderInPlace;
             break;
         }
     }
@@ -1185,11 +1187,11 @@ OfxClipInstance::getOutputImageInternal(const std::string* ofxPlane,
     double par = getAspectRatio();
     OfxImageCommon* retCommon = 0;
     if (retImage) {
-        OfxImage* ret =  new OfxImage(renderData, outputImage, false, renderWindow, Transform::Matrix3x3Ptr(), ofxComponents, nComps, par);
+        OfxImage* ret =  new OfxImage(renderData, outputImage, false, renderWindow, Transform::Matrix3x3Ptr(), ofxComponents, nComps, par, renderInPlace);
         *retImage = ret;
         retCommon = ret;
     } else if (retTexture) {
-        OfxTexture* ret =  new OfxTexture(renderData, outputImage, false, renderWindow, Transform::Matrix3x3Ptr(), ofxComponents, nComps, par);
+        OfxTexture* ret =  new OfxTexture(renderData, outputImage, false, renderWindow, Transform::Matrix3x3Ptr(), ofxComponents, nComps, par, renderInPlace);
         *retTexture = ret;
         retCommon = ret;
     }
@@ -1367,7 +1369,8 @@ OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
                                const Transform::Matrix3x3Ptr& mat,
                                const std::string& components,
                                int nComps,
-                               double par)
+                               double par,
+                               bool renderInPlace)
     : _imp( new OfxImageCommonPrivate(ofxImageBase, internalImage, renderData) )
 {
     _imp->components = components;
@@ -1452,18 +1455,29 @@ OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
         // row bytes
         ofxImageBase->setIntProperty(kOfxImagePropRowBytes, srcRowSize);
         
-        NATRON_NAMESPACE::Image::WriteAccessPtr access( new NATRON_NAMESPACE::Image::WriteAccess( internalImage.get() ) );
-
         // data ptr
         renderWindow.intersect(bounds, &pluginsSeenBounds);
 
-        if (storage != eStorageModeGLTex) {
+        if (renderInPlace) {
+            // The plug-in renders directly in the cached image, other threads may be rendering other regions of it:
+            // only prevent the image from being resized
+            assert(storage != eStorageModeGLTex);
+            NATRON_NAMESPACE::Image::SharedWriteAccessPtr access( new NATRON_NAMESPACE::Image::SharedWriteAccess( internalImage.get() ) );
             unsigned char* ptr = access->pixelAt( pluginsSeenBounds.left(), pluginsSeenBounds.bottom() );
             assert(ptr);
             ofxImageBase->setPointerProperty( kOfxImagePropData, ptr);
-        }
+            _imp->access = access;
+        } else {
+            NATRON_NAMESPACE::Image::WriteAccessPtr access( new NATRON_NAMESPACE::Image::WriteAccess( internalImage.get() ) );
 
-        _imp->access = access;
+            if (storage != eStorageModeGLTex) {
+                unsigned char* ptr = access->pixelAt( pluginsSeenBounds.left(), pluginsSeenBounds.bottom() );
+                assert(ptr);
+                ofxImageBase->setPointerProperty( kOfxImagePropData, ptr);
+            }
+
+            _imp->access = access;
+        }
     } // isSrcImage
 
     ///Do not activate this assert! The render window passed to renderRoI can be bigger than the actual RoD of the effect
@@ -332,7 +332,8 @@ public:
                             const Transform::Matrix3x3Ptr& mat,
                             const std::string& components,
                             int nComps,
-                            double par);
+                            double par,
+                            bool renderInPlace);
 
     virtual ~OfxImageCommon();
 
@@ -356,9 +357,10 @@ public:
                        const Transform::Matrix3x3Ptr& mat,
                        const std::string& components,
                        int nComps,
-                      double par)
+                      double par,
+                      bool renderInPlace = false)
         : OFX::Host::ImageEffect::Image()
-        , OfxImageCommon(this, renderData, internalImage, isSrcImage, renderWindow, mat, components, nComps, par)
+        , OfxImageCommon(this, renderData, internalImage, isSrcImage, renderWindow, mat, components, nComps, par, renderInPlace)
     {
     }
 };
@@ -375,9 +377,10 @@ public:
                          const Transform::Matrix3x3Ptr& mat,
                          const std::string& components,
                          int nComps,
-                        double par)
+                        double par,
+                        bool renderInPlace = false)
         : OFX::Host::ImageEffect::Texture()
-        , OfxImageCommon(this, renderData, internalImage, isSrcImage, renderWindow, mat, components, nComps, par)
+        , OfxImageCommon(this, renderData, internalImage, isSrcImage, renderWindow, mat, components, nComps, par, renderInPlace)
     {
     }
 };
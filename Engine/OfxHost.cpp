@@ -1163,6 +1163,8 @@ OfxHost::fetchSuite(const char *suiteName,
 {
     if ( (std::strcmp(suiteName, kOfxParametricParameterSuite) == 0) && (suiteVersion == 1) ) {
         return OFX::Host::ParametricParam::GetSuite(suiteVersion);
+    } else if ( (std::strcmp(suiteName, kNatronParametricParameterSuite) == 0) && (suiteVersion == 1) ) {
+        return OFX::Host::ParametricParam::GetNatronSuite(suiteVersion);
     } else {
         return OFX::Host::ImageEffect::Host::fetchSuite(suiteName, suiteVersion);
     }
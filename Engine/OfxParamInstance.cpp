@@ -4749,6 +4749,26 @@ OfxParametricInstance::getValue(int curveIndex,
     }
 }
 
+OfxStatus
+OfxParametricInstance::getValues(int curveIndex,
+                                 OfxTime /*time*/,
+                                 int nSamples,
+                                 const double* parametricPositions,
+                                 double *returnValues)
+{
+    KnobParametricPtr knob = _knob.lock();
+    if (!knob) {
+        return kOfxStatFailed;
+    }
+    StatusEnum stat = knob->getValues(curveIndex, nSamples, parametricPositions, returnValues);
+
+    if (stat == eStatusOK) {
+        return kOfxStatOK;
+    } else {
+        return kOfxStatFailed;
+    }
+}
+
 OfxStatus
 OfxParametricInstance::getNControlPoints(int curveIndex,
                                          double /*time*/,
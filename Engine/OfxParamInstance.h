@@ -954,6 +954,7 @@ public:
 
     ///derived from CurveHolder
     virtual OfxStatus getValue(int curveIndex, OfxTime time, double parametricPosition, double *returnValue) OVERRIDE FINAL;
+    virtual OfxStatus getValues(int curveIndex, OfxTime time, int nSamples, const double* parametricPositions, double *returnValues) OVERRIDE FINAL;
     virtual OfxStatus getNControlPoints(int curveIndex, double time, int *returnValue) OVERRIDE FINAL;
     virtual OfxStatus getNthControlPoint(int curveIndex,
                                          double time,
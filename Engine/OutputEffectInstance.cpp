@@ -398,7 +398,10 @@ void
 OutputEffectInstance::reportStats(int time,
                                   ViewIdx view,
                                   double wallTime,
-                                  const std::map<NodePtr, NodeRenderStats > & stats)
+                                  const std::map<NodePtr, NodeRenderStats > & stats,
+                                  int nParallelRenders,
+                                  double parallelRendersFps,
+                                  ParallelRendersDecisionEnum parallelRendersDecision)
 {
     std::string filename;
     KnobIPtr fileKnob = getKnobByName(kOfxImageEffectFileParamName);
@@ -433,6 +436,24 @@ OutputEffectInstance::reportStats(int time,
     }
 
     ofile << "Time spent to render frame (wall clock time): " << Timer::printAsTime(wallTime, false).toStdString() << std::endl;
+    if (nParallelRenders > 0) {
+        ofile << "Frames rendered in parallel: " << nParallelRenders;
+        switch (parallelRendersDecision) {
+        case eParallelRendersDecisionFixed:
+            ofile << " (fixed)";
+            break;
+        case eParallelRendersDecisionKeep:
+            ofile << " (kept)";
+            break;
+        case eParallelRendersDecisionIncrease:
+            ofile << " (increased)";
+            break;
+        case eParallelRendersDecisionDecrease:
+            ofile << " (decreased)";
+            break;
+        }
+        ofile << ", throughput: " << parallelRendersFps << " fps" << std::endl;
+    }
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
         ofile << "------------------------------- " << it->first->getScriptName_mt_safe() << "------------------------------- " << std::endl;
         ofile << "Time spent rendering: " << Timer::printAsTime(it->second.getTotalTimeSpentRendering(), false).toStdString() << std::endl;
@@ -28,13 +28,21 @@
 #include <iostream>
 #include <set>
 #include <list>
+#include <map>
 #include <algorithm> // min, max
 #include <cassert>
+#include <climits> // INT_MAX
 #include <stdexcept>
 #include <sstream> // stringstream
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/algorithm/clamp.hpp>
+#if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+// /usr/local/include/boost/bind/arg.hpp:37:9: warning: unused typedef 'boost_static_assert_typedef_37' [-Wunused-local-typedef]
+#include <boost/bind/bind.hpp>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+#endif
 
 #include <QtCore/QMetaType>
 #include <QtCore/QMutex>
@@ -45,6 +53,7 @@
 #include <QtCore/QDebug>
 #include <QtCore/QTextStream>
 #include <QtCore/QRunnable>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 
 #ifdef DEBUG
 #include "Global/FloatingPointExceptions.h"
@@ -54,6 +63,7 @@
 #include "Engine/AppInstance.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/Image.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/KnobFile.h"
 #include "Engine/Node.h"
 #include "Engine/OpenGLViewerI.h"
@@ -77,6 +87,8 @@
 
 #define NATRON_FPS_REFRESH_RATE_SECONDS 1.5
 
+using namespace boost::placeholders;
+
 /*
    When defined, parallel frame renders are spawned from a timer so that the frames
    appear to be rendered all at the same speed.
@@ -91,6 +103,24 @@
 
 #define NATRON_SCHEDULER_ABORT_AFTER_X_UNSUCCESSFUL_ITERATIONS 5000
 
+/*
+   During playback, frames are queued ahead of the playhead. The read-ahead depth grows with
+   the measured frame render time against the desired fps, up to this many frames,
+   and never exceeds this fraction of the in-memory portion of the viewer cache so that
+   frames rendered ahead are not evicted before being displayed.
+ */
+#define NATRON_PLAYBACK_READ_AHEAD_MAX_FRAMES 64
+#define NATRON_PLAYBACK_READ_AHEAD_CACHE_FRACTION 0.5
+
+/*
+   When the number of parallel renders is determined automatically, the throughput is measured over windows
+   of at least this duration. The count only moves if the throughput changed by more than the hysteresis,
+   and after this many windows without change it probes again in the last direction.
+ */
+#define NATRON_PARALLEL_RENDERS_MIN_WINDOW_SEC 0.5
+#define NATRON_PARALLEL_RENDERS_HYSTERESIS 0.05
+#define NATRON_PARALLEL_RENDERS_STABLE_WINDOWS_BEFORE_PROBE 4
+
 NATRON_NAMESPACE_ENTER
 
 
@@ -175,11 +205,172 @@ typedef boost::shared_ptr<OutputSchedulerThreadExecMTArgs> OutputSchedulerThread
 #ifndef NATRON_PLAYBACK_USES_THREAD_POOL
 static bool
 isBufferFull(int nbBufferedElement,
-             int hardwardIdealThreadCount)
+             int hardwardIdealThreadCount,
+             int readAheadDepth,
+             int maxBufferedFrames)
 {
-    return nbBufferedElement >= hardwardIdealThreadCount * 3;
+    ///The RAM budget bounds the buffer, even below the hardware-derived size
+    int cap = std::min( std::max(hardwardIdealThreadCount * 3, readAheadDepth), maxBufferedFrames );
+
+    return nbBufferedElement >= std::max(1, cap);
 }
 
+/**
+ * @brief Hill-climbing controller of the number of frames rendered in parallel.
+ * The throughput (frames/sec) is measured over windows of rendered frames while the number of render threads
+ * matches the target. After each window the target keeps moving in the same direction if the throughput improved
+ * by more than the hysteresis and goes back otherwise. Threads that are not rendering frames are left to the global
+ * thread-pool which is used for tiles and host frame threading within each frame, so that the controller converges
+ * to the best mix of parallel frames against per-frame parallelism on this machine and graph.
+ * Frames are counted when their render completes, not when they are processed by the output device, and the
+ * controller is not fed when the fps is regulated: the throughput would then be capped by the playback timer.
+ **/
+class ParallelRendersController
+{
+    mutable QMutex _lock;
+    int _target;
+    int _direction;
+    double _lastWindowFps;
+    double _windowFps;
+    int _nFramesInWindow;
+    double _windowDuration;
+    TimeLapse _timer;
+    int _nStableWindows;
+    ParallelRendersDecisionEnum _lastDecision;
+
+public:
+
+    ParallelRendersController()
+        : _lock()
+        , _target(0)
+        , _direction(-1)
+        , _lastWindowFps(0.)
+        , _windowFps(0.)
+        , _nFramesInWindow(0)
+        , _windowDuration(0.)
+        , _timer()
+        , _nStableWindows(0)
+        , _lastDecision(eParallelRendersDecisionKeep)
+    {
+    }
+
+    /**
+     * @brief Returns how many frames should be rendered in parallel
+     **/
+    int getNumberOfParallelRenders()
+    {
+        ///How many parallel renders the user wants
+        int userSettingParallelThreads = appPTR->getCurrentSettings()->getNumberOfParallelRenders();
+
+        if (userSettingParallelThreads > 0) {
+            return userSettingParallelThreads;
+        }
+
+        QMutexLocker k(&_lock);
+        int maxThreads = getMaximumNumberOfParallelRenders();
+        if ( (_target <= 0) || (_target > maxThreads) ) {
+            ///Start with as many parallel renders as there are cores, the controller will then go down if it is better
+            _target = maxThreads;
+        }
+
+        return _target;
+    }
+
+    /**
+     * @brief Discards the current measurement window, e.g: when a render starts after some idle time
+     **/
+    void restartWindow()
+    {
+        QMutexLocker k(&_lock);
+
+        _nFramesInWindow = 0;
+        _windowDuration = 0.;
+        _timer.getTimeElapsedReset();
+    }
+
+    /**
+     * @brief Called whenever a frame is rendered with nThreads render threads
+     **/
+    void notifyFrameRendered(int nThreads)
+    {
+        bool isFixed = appPTR->getCurrentSettings()->getNumberOfParallelRenders() > 0;
+        QMutexLocker k(&_lock);
+
+        _windowDuration += _timer.getTimeElapsedReset();
+        if ( !isFixed && (nThreads != _target) ) {
+            ///Render threads are still being started/stopped: the throughput does not reflect the target yet
+            _nFramesInWindow = 0;
+            _windowDuration = 0.;
+
+            return;
+        }
+        ++_nFramesInWindow;
+        if ( (_nFramesInWindow < std::max(4, nThreads * 2)) || (_windowDuration < NATRON_PARALLEL_RENDERS_MIN_WINDOW_SEC) ) {
+            return;
+        }
+
+        _windowFps = _nFramesInWindow / _windowDuration;
+        _nFramesInWindow = 0;
+        _windowDuration = 0.;
+
+        if (isFixed) {
+            _lastDecision = eParallelRendersDecisionFixed;
+
+            return;
+        }
+
+        int step = 0;
+        if (_lastWindowFps <= 0.) {
+            ///First measurement: probe in the current direction
+            step = _direction;
+        } else if ( _windowFps > _lastWindowFps * (1. + NATRON_PARALLEL_RENDERS_HYSTERESIS) ) {
+            ///The last move improved the throughput, keep going
+            step = _direction;
+            _nStableWindows = 0;
+        } else if ( _windowFps < _lastWindowFps * (1. - NATRON_PARALLEL_RENDERS_HYSTERESIS) ) {
+            ///The last move degraded the throughput, go back
+            _direction = -_direction;
+            step = _direction;
+            _nStableWindows = 0;
+        } else if (++_nStableWindows >= NATRON_PARALLEL_RENDERS_STABLE_WINDOWS_BEFORE_PROBE) {
+            ///Nothing changed for a while, probe again in case the load changed
+            _nStableWindows = 0;
+            step = _direction;
+        }
+        _lastWindowFps = _windowFps;
+
+        int newTarget = boost::algorithm::clamp(_target + step, 1, getMaximumNumberOfParallelRenders());
+        if ( (step != 0) && (newTarget == _target) ) {
+            ///Reached a bound, next probe goes the other way
+            _direction = -_direction;
+        }
+        if (newTarget > _target) {
+            _lastDecision = eParallelRendersDecisionIncrease;
+        } else if (newTarget < _target) {
+            _lastDecision = eParallelRendersDecisionDecrease;
+        } else {
+            _lastDecision = eParallelRendersDecisionKeep;
+        }
+        _target = newTarget;
+    }
+
+    void getInfos(double* framesPerSecond,
+                  ParallelRendersDecisionEnum* decision) const
+    {
+        QMutexLocker k(&_lock);
+
+        *framesPerSecond = _windowFps;
+        *decision = _lastDecision;
+    }
+
+private:
+
+    static int getMaximumNumberOfParallelRenders()
+    {
+        return std::max(1, appPTR->getHardwareIdealThreadCount());
+    }
+};
+
 #endif
 
 struct OutputSchedulerThreadPrivate
@@ -243,6 +434,16 @@ struct OutputSchedulerThreadPrivate
     QMutex bufferedOutputMutex;
     int lastBufferedOutputSize;
 
+    ///Moving averages of the time spent by a render thread on a frame and of the size of the buffered frames,
+    ///used to adapt the read-ahead depth during playback. Kept across runs so that it applies right after a seek.
+    mutable QMutex readAheadMutex;
+    double averageFrameRenderTime;
+    std::size_t averageFrameSize;
+
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+    ParallelRendersController parallelRenders;
+#endif
+
 
     OutputSchedulerThreadPrivate(RenderEngine* engine,
                                  const OutputEffectInstancePtr& effect,
@@ -282,6 +483,12 @@ struct OutputSchedulerThreadPrivate
 #endif
         , bufferedOutputMutex()
         , lastBufferedOutputSize(0)
+        , readAheadMutex()
+        , averageFrameRenderTime(0.)
+        , averageFrameSize(0)
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+        , parallelRenders()
+#endif
     {
     }
 
@@ -712,8 +919,9 @@ OutputSchedulerThread::pushFramesToRenderInternal(int startingFrame,
 #endif
         _imp->lastFramePushedIndex = startingFrame;
     } else {
-        ///Push 2x the count of threads to be sure no one will be waiting
-        while ( (int)_imp->framesToRender.size() < nThreads * 2 ) {
+        ///Push enough frames ahead of the playhead to be sure no one will be waiting
+        int readAheadDepth = getReadAheadDepth(nThreads);
+        while ( (int)_imp->framesToRender.size() < readAheadDepth ) {
             _imp->framesToRender.push_back(startingFrame);
 #ifdef TRACE_SCHEDULER
             QString pushDirectionStr = newDirection == eRenderDirectionForward ? QLatin1String("Forward") : QLatin1String("Backward");
@@ -1054,6 +1262,9 @@ OutputSchedulerThread::startRender()
 
     aboutToStartRender();
 
+    ///The buffers released by a frame are reused by the next ones
+    _imp->engine->createImageBufferPool();
+
     ///Notify everyone that the render is started
     _imp->engine->s_renderStarted(forward);
 
@@ -1065,10 +1276,15 @@ OutputSchedulerThread::startRender()
         nThreads = (int)_imp->renderThreads.size();
     }
 
-    ///Start with one thread if it doesn't exist
-    if (nThreads == 0) {
-        int lastNThreads;
-        adjustNumberOfThreads(&nThreads, &lastNThreads);
+    ///Start all threads at once so that the frames following the starting frame
+    ///(e.g: after a seek) are rendered in parallel right away
+    _imp->parallelRenders.restartWindow();
+    int optimalNThreads = _imp->parallelRenders.getNumberOfParallelRenders();
+    if (nThreads < optimalNThreads) {
+        QMutexLocker l(&_imp->renderThreadsMutex);
+        for (; nThreads < optimalNThreads; ++nThreads) {
+            _imp->appendRunnable( createRunnable() );
+        }
     }
 #endif
 
@@ -1192,6 +1408,7 @@ OutputSchedulerThread::stopRender()
 
     bool wasAborted = isBeingAborted();
 
+    _imp->engine->releaseImageBufferPool();
 
     ///Notify everyone that the render is finished
     _imp->engine->s_renderFinished(wasAborted ? 1 : 0);
@@ -1362,9 +1579,11 @@ OutputSchedulerThread::threadLoopOnce(const GenericThreadStartArgsPtr &inArgs)
                     ///is much slower than things upstream, hence the buffer grows quickly, and fills up the RAM.
                     bool bufferFull;
                     {
-                        QMutexLocker k(&_imp->bufMutex);
                         int nbThreadsHardware = appPTR->getHardwareIdealThreadCount();
-                        bufferFull = isBufferFull(_imp->buf.size(), nbThreadsHardware);
+                        int readAheadDepth = getReadAheadDepth(newNThreads);
+                        int maxBufferedFrames = getReadAheadMemoryLimit();
+                        QMutexLocker k(&_imp->bufMutex);
+                        bufferFull = isBufferFull(_imp->buf.size(), nbThreadsHardware, readAheadDepth, maxBufferedFrames);
                     }
                     if (!bufferFull) {
                         pushFramesToRender(newNThreads);
@@ -1506,38 +1725,23 @@ OutputSchedulerThread::adjustNumberOfThreads(int* newNThreads,
                                              int *lastNThreads)
 {
     ///////////
-    /////If we were analysing the CPU activity, now set the appropriate number of threads to render.
-    int optimalNThreads;
-
-    ///How many parallel renders the user wants
-    int userSettingParallelThreads = appPTR->getCurrentSettings()->getNumberOfParallelRenders();
-
-    ///How many threads are running in the application
-    int runningThreads = appPTR->getNRunningThreads() + QThreadPool::globalInstance()->activeThreadCount();
+    /////Move towards the number of parallel renders chosen by the controller from the measured throughput
+    int optimalNThreads = _imp->parallelRenders.getNumberOfParallelRenders();
 
     ///How many current threads are used by THIS renderer
     int currentParallelRenders = getNRenderThreads();
 
     *lastNThreads = currentParallelRenders;
 
-    if (userSettingParallelThreads == 0) {
-        ///User wants it to be automatically computed, do a simple heuristic: launch as many parallel renders
-        ///as there are cores
-        optimalNThreads = appPTR->getHardwareIdealThreadCount();
-    } else {
-        optimalNThreads = userSettingParallelThreads;
-    }
-    optimalNThreads = std::max(1, optimalNThreads);
-
 
-    if ( ( (runningThreads < optimalNThreads) && (currentParallelRenders < optimalNThreads) ) || (currentParallelRenders == 0) ) {
+    if ( (currentParallelRenders < optimalNThreads) || (currentParallelRenders == 0) ) {
         ////////
         ///Launch 1 thread
         QMutexLocker l(&_imp->renderThreadsMutex);
 
         _imp->appendRunnable( createRunnable() );
         *newNThreads = currentParallelRenders +  1;
-    } else if ( (runningThreads > optimalNThreads) && (currentParallelRenders > optimalNThreads) ) {
+    } else if (currentParallelRenders > optimalNThreads) {
         ////////
         ///Stop 1 thread
         stopRenderThreads(1);
@@ -1549,8 +1753,75 @@ OutputSchedulerThread::adjustNumberOfThreads(int* newNThreads,
     }
 }
 
+int
+OutputSchedulerThread::getReadAheadDepth(int nThreads) const
+{
+    ///Push 2x the count of threads to be sure no one will be waiting
+    int depth = std::max(1, nThreads) * 2;
+
+    if ( !isFPSRegulationNeeded() ) {
+        return depth;
+    }
+
+    double frameTime;
+    {
+        QMutexLocker k(&_imp->readAheadMutex);
+        frameTime = _imp->averageFrameRenderTime;
+    }
+    double desiredFPS = getDesiredFPS();
+    if ( (frameTime > 0.) && (desiredFPS > 0.) ) {
+        ///While a thread renders a frame, this many frames are displayed: they must already be queued
+        int framesPerRender = (int)std::ceil(frameTime * desiredFPS);
+        depth = std::max(depth, nThreads + framesPerRender);
+        depth = std::min( depth, std::max(nThreads * 2, NATRON_PLAYBACK_READ_AHEAD_MAX_FRAMES) );
+    }
+
+    ///Do not read ahead more frames than the viewer cache can keep in RAM
+    depth = std::min( depth, getReadAheadMemoryLimit() );
+
+    return std::max(1, depth);
+}
+
+int
+OutputSchedulerThread::getReadAheadMemoryLimit() const
+{
+    std::size_t frameSize;
+    {
+        QMutexLocker k(&_imp->readAheadMutex);
+        frameSize = _imp->averageFrameSize;
+    }
+    if (frameSize == 0) {
+        return INT_MAX;
+    }
+    U64 budget = appPTR->getViewerCacheMaximumMemorySize() * NATRON_PLAYBACK_READ_AHEAD_CACHE_FRACTION;
+
+    return (int)std::min( (U64)INT_MAX, std::max( (U64)1, budget / frameSize ) );
+}
+
 #endif // ifndef NATRON_PLAYBACK_USES_THREAD_POOL
 
+void
+OutputSchedulerThread::notifyFrameRenderTime(double timeSpentSec)
+{
+    {
+        QMutexLocker k(&_imp->readAheadMutex);
+
+        if (_imp->averageFrameRenderTime == 0.) {
+            _imp->averageFrameRenderTime = timeSpentSec;
+        } else {
+            _imp->averageFrameRenderTime = _imp->averageFrameRenderTime * 0.75 + timeSpentSec * 0.25;
+        }
+    }
+
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+    // Feed the controller of the number of parallel renders with the render throughput.
+    // When the fps is regulated, frames complete at the pace of the playback timer whatever the number of renders.
+    if ( !isFPSRegulationNeeded() ) {
+        _imp->parallelRenders.notifyFrameRendered( getNRenderThreads() );
+    }
+#endif
+}
+
 void
 OutputSchedulerThread::notifyFrameRendered(int frame,
                                            ViewIdx viewIndex,
@@ -1565,10 +1836,19 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
     // Report render stats if desired
     OutputEffectInstancePtr effect = _imp->outputEffect.lock();
     if (stats) {
+        // Record the state of the controller of the number of parallel renders when this frame was rendered
+        int nParallelRenders = getNRenderThreads();
+        double parallelRendersFps = 0.;
+        ParallelRendersDecisionEnum parallelRendersDecision = eParallelRendersDecisionFixed;
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+        _imp->parallelRenders.getInfos(&parallelRendersFps, &parallelRendersDecision);
+#endif
+        stats->setParallelRendersInfos(nParallelRenders, parallelRendersFps, parallelRendersDecision);
+
         double timeSpentForFrame;
         std::map<NodePtr, NodeRenderStats > statResults = stats->getStats(&timeSpentForFrame);
         if ( !statResults.empty() ) {
-            effect->reportStats(frame, viewIndex, timeSpentForFrame, statResults);
+            effect->reportStats(frame, viewIndex, timeSpentForFrame, statResults, nParallelRenders, parallelRendersFps, parallelRendersDecision);
         }
     }
 
@@ -1649,12 +1929,33 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
         QString percentageStr = QString::number(fractionDone * 100, 'f', 1);
         QString timeRemainingStr = timeRemaining < 0 ? tr("unknown") : Timer::printAsTime(timeRemaining, true);
 
-        longMessage = (tr("%1 ==> Frame: %2, Progress: %3%, %4 Fps, Time Remaining: %5")
+        QString parallelRendersStr = QString::number( getNRenderThreads() );
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+        double parallelRendersFps;
+        ParallelRendersDecisionEnum parallelRendersDecision;
+        _imp->parallelRenders.getInfos(&parallelRendersFps, &parallelRendersDecision);
+        switch (parallelRendersDecision) {
+        case eParallelRendersDecisionFixed:
+            break;
+        case eParallelRendersDecisionKeep:
+            parallelRendersStr += tr(" (kept)");
+            break;
+        case eParallelRendersDecisionIncrease:
+            parallelRendersStr += tr(" (increased)");
+            break;
+        case eParallelRendersDecisionDecrease:
+            parallelRendersStr += tr(" (decreased)");
+            break;
+        }
+#endif
+
+        longMessage = (tr("%1 ==> Frame: %2, Progress: %3%, %4 Fps, Time Remaining: %5, Parallel Renders: %6")
                        .arg(QString::fromUtf8(effect->getScriptName_mt_safe().c_str()))
                        .arg(frameStr)
                        .arg(percentageStr)
                        .arg(fpsStr)
-                       .arg(timeRemainingStr));
+                       .arg(timeRemainingStr)
+                       .arg(parallelRendersStr));
 
         QString shortMessage = QString::fromUtf8(kFrameRenderedStringShort) + frameStr + QString::fromUtf8(kProgressChangedStringShort) + QString::number(fractionDone);
         {
@@ -1750,6 +2051,15 @@ OutputSchedulerThread::appendToBuffer_internal(double time,
         }
     } else {
         ///Called by the scheduler thread when an image is rendered
+        if (frame) {
+            std::size_t frameSize = frame->sizeInRAM();
+            QMutexLocker k(&_imp->readAheadMutex);
+            if (_imp->averageFrameSize == 0) {
+                _imp->averageFrameSize = frameSize;
+            } else {
+                _imp->averageFrameSize = (_imp->averageFrameSize * 3 + frameSize) / 4;
+            }
+        }
 
         QMutexLocker l(&_imp->bufMutex);
         _imp->appendBufferedFrame(time, view, stats, frame);
@@ -2069,7 +2379,11 @@ RenderThreadTask::run()
 #ifdef TRACE_SCHEDULER
         qDebug() << "Parallel Render Thread: Picking frame to render: " << time;
 #endif
+        TimeLapse frameTimer;
         renderFrame(time, viewsToRender, enableRenderStats);
+        if ( !mustQuit() ) {
+            _imp->scheduler->notifyFrameRenderTime( frameTimer.getTimeSinceCreation() );
+        }
 
         appPTR->getAppTLS()->cleanupTLSForThread();
 
@@ -2151,6 +2465,196 @@ DefaultScheduler::~DefaultScheduler()
 {
 }
 
+/**
+ * @brief Returns true if the frames of the given writer may be rendered in strips, see computeRenderStrips().
+ **/
+static bool
+canRenderInStrips(const EffectInstancePtr& writer)
+{
+    return appPTR->getCurrentSettings()->getStripRenderingHeight() > 0 && writer->supportsTiles();
+}
+
+/**
+ * @brief Splits the render window of the given writer in horizontal strips, from the top of the image to the bottom,
+ * according to the "Strip rendering height" setting. Strips are rendered and handed to the writer one after the other
+ * in that order.
+ * Only writers which support tiles (for OpenFX writers: both the effect and its output clip) are rendered in strips.
+ * Writers which need the full image at once, such as the DiskCache node or writers encoding whole frames, always get the
+ * full window as a single strip, as they do when rendering in strips is disabled.
+ **/
+static void
+computeRenderStrips(const RectI& renderWindow,
+                    const EffectInstancePtr& writer,
+                    std::list<RectI>* strips)
+{
+    int stripHeight = appPTR->getCurrentSettings()->getStripRenderingHeight();
+
+    if ( !canRenderInStrips(writer) || (renderWindow.height() <= stripHeight) ) {
+        strips->push_back(renderWindow);
+
+        return;
+    }
+    for (int y2 = renderWindow.y2; y2 > renderWindow.y1; y2 -= stripHeight) {
+        strips->push_back( RectI( renderWindow.x1, std::max(renderWindow.y1, y2 - stripHeight), renderWindow.x2, y2 ) );
+    }
+}
+
+// Image keys indexed by their hash
+typedef std::map<U64, ImageKey> StripImageKeys;
+
+/**
+ * @brief Returns the keys of the images that rendering a strip may create in the cache.
+ * Keys of nodes which support tiles are returned in stripKeys: their images only cover the strip.
+ * Keys of nodes which do not support tiles are returned in frameKeys: their images cover the full frame and are
+ * kept until the last strip of the frame is rendered, so they are not rendered again for each strip.
+ **/
+static void
+getStripImageKeys(const FrameRequestMap& request,
+                  StripImageKeys* stripKeys,
+                  StripImageKeys* frameKeys)
+{
+    for (FrameRequestMap::const_iterator it = request.begin(); it != request.end(); ++it) {
+        EffectInstancePtr effect = it->first->getEffectInstance();
+        if (!effect) {
+            continue;
+        }
+        StripImageKeys* keys = effect->supportsTiles() ? stripKeys : frameKeys;
+        // Same keys as the ones of the images created by EffectInstance::renderRoI
+        bool frameVaryingOrAnimated = effect->isFrameVaryingOrAnimated_Recursive();
+        for (NodeFrameViewRequestData::const_iterator it2 = it->second->frames.begin(); it2 != it->second->frames.end(); ++it2) {
+            // The image may have been cached with or without downscaled inputs
+            for (int fullScaleWithDownscaleInputs = 0; fullScaleWithDownscaleInputs < 2; ++fullScaleWithDownscaleInputs) {
+                ImageKey key = Image::makeKey(it->first.get(), it->second->nodeHash, frameVaryingOrAnimated, it2->first.time, it2->first.view, false, fullScaleWithDownscaleInputs == 1);
+                keys->insert( std::make_pair(key.getHash(), key) );
+            }
+        }
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Counts for each image key the strip renders in flight which may use its images, across all the frames and views
+ * being rendered. The images created while rendering strips are removed from the cache as soon as no render in flight
+ * holds their key anymore, whatever the node: images shared by frames or views rendered in parallel (time or view invariant
+ * nodes) are released once the last of these renders is done with them.
+ * Images which were already cached when their key was first held were not created by the strip renders: they are kept.
+ **/
+class StripImagesRegistry
+{
+    struct HeldKey
+    {
+        ImageKey key;
+        int nHolders;
+        std::set<ImagePtr> cachedBefore;
+    };
+
+    typedef std::map<U64, HeldKey> HeldKeysMap;
+
+public:
+
+    static StripImagesRegistry& instance()
+    {
+        static StripImagesRegistry registry;
+
+        return registry;
+    }
+
+    void hold(const StripImageKeys& keys)
+    {
+        QMutexLocker k(&_lock);
+
+        for (StripImageKeys::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            HeldKeysMap::iterator found = _keys.find(it->first);
+            if ( found == _keys.end() ) {
+                HeldKey& held = _keys[it->first];
+                held.key = it->second;
+                held.nHolders = 0;
+                std::list<ImagePtr> cached;
+                if ( appPTR->getImage(it->second, &cached) ) {
+                    held.cachedBefore.insert( cached.begin(), cached.end() );
+                }
+                found = _keys.find(it->first);
+            }
+            ++found->second.nHolders;
+        }
+    }
+
+    void release(const StripImageKeys& keys)
+    {
+        QMutexLocker k(&_lock);
+
+        for (StripImageKeys::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            HeldKeysMap::iterator found = _keys.find(it->first);
+            assert( found != _keys.end() );
+            if ( found == _keys.end() ) {
+                continue;
+            }
+            if (--found->second.nHolders > 0) {
+                continue;
+            }
+            std::list<ImagePtr> cached;
+            if ( appPTR->getImage(found->second.key, &cached) ) {
+                for (std::list<ImagePtr>::const_iterator it2 = cached.begin(); it2 != cached.end(); ++it2) {
+                    if ( found->second.cachedBefore.find(*it2) == found->second.cachedBefore.end() ) {
+                        appPTR->removeFromNodeCache(*it2);
+                    }
+                }
+            }
+            _keys.erase(found);
+        }
+    }
+
+private:
+
+    StripImagesRegistry()
+        : _lock()
+        , _keys()
+    {
+    }
+
+    QMutex _lock;
+    HeldKeysMap _keys;
+};
+
+/**
+ * @brief Holds image keys in the StripImagesRegistry for the duration of a strip or of a frame,
+ * the keys are released when the holder is destroyed, including when the render fails.
+ **/
+class StripImagesHolder
+{
+public:
+
+    StripImagesHolder()
+        : _keys()
+    {
+    }
+
+    ~StripImagesHolder()
+    {
+        StripImagesRegistry::instance().release(_keys);
+    }
+
+    // Only holds the keys which are not held yet
+    void hold(const StripImageKeys& keys)
+    {
+        StripImageKeys newKeys;
+
+        for (StripImageKeys::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            if ( _keys.insert(*it).second ) {
+                newKeys.insert(*it);
+            }
+        }
+        StripImagesRegistry::instance().hold(newKeys);
+    }
+
+private:
+
+    StripImageKeys _keys;
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
 class DefaultRenderFrameRunnable
     : public RenderThreadTask
 {
@@ -2183,6 +2687,263 @@ public:
 
 private:
 
+    /**
+     * @brief Renders one view of the frame. Returns an error message on failure, an empty string otherwise.
+     **/
+    std::string renderView(int time,
+                           const EffectInstancePtr& activeInputToRender,
+                           U64 activeInputToRenderHash,
+                           const AbortableRenderInfoPtr& abortInfo,
+                           const RenderStatsPtr& stats,
+                           ViewIdx view)
+    {
+        try {
+            return renderViewInternal(time, activeInputToRender, activeInputToRenderHash, abortInfo, stats, view);
+        } catch (const std::exception& e) {
+            return std::string("Error while rendering: ") + e.what();
+        } catch (...) {
+            return "Error caught while rendering";
+        }
+    }
+
+    /**
+     * @brief Renders one view of the input of the writer, as requested by the writer, so that it gets cached.
+     * Returns an error message on failure, an empty string otherwise.
+     * This is called concurrently for the different views of the frame, the writer itself is not rendered.
+     **/
+    std::string renderInputView(int time,
+                                const EffectInstancePtr& activeInputToRender,
+                                U64 activeInputToRenderHash,
+                                const AbortableRenderInfoPtr& abortInfo,
+                                const RenderStatsPtr& stats,
+                                ViewIdx view)
+    {
+        try {
+            return renderInputViewInternal(time, activeInputToRender, activeInputToRenderHash, abortInfo, stats, view);
+        } catch (const std::exception& e) {
+            return std::string("Error while rendering: ") + e.what();
+        } catch (...) {
+            return "Error caught while rendering";
+        }
+    }
+
+    std::string renderInputViewInternal(int time,
+                                        const EffectInstancePtr& activeInputToRender,
+                                        U64 activeInputToRenderHash,
+                                        const AbortableRenderInfoPtr& abortInfo,
+                                        const RenderStatsPtr& stats,
+                                        ViewIdx view)
+    {
+        OutputEffectInstancePtr output = _imp->output.lock();
+        EffectInstancePtr input = activeInputToRender->getInput(0);
+
+        if (!output || !input) {
+            return std::string();
+        }
+
+        int mipMapLevel = 0;
+        RenderScale scale(1.);
+        RectD rod;
+        bool isProjectFormat;
+        NodePtr activeInputNode = activeInputToRender->getNode();
+        StatusEnum stat = activeInputToRender->getRegionOfDefinition_public(activeInputToRenderHash, time, scale, view, &rod, &isProjectFormat);
+        if (stat == eStatusFailed) {
+            return "Error caught while rendering";
+        }
+
+        EffectInstance::ComponentsNeededMap neededComps;
+        std::list<ImagePlaneDesc> passThroughPlanes;
+        bool processAll;
+        double ptTime;
+        int ptView;
+        std::bitset<4> processChannels;
+        int ptInput;
+        activeInputToRender->getComponentsNeededAndProduced_public(activeInputToRenderHash, time, view, &neededComps, &passThroughPlanes, &processAll, &ptTime, &ptView, &processChannels, &ptInput);
+        EffectInstance::ComponentsNeededMap::iterator foundInput = neededComps.find(0);
+        if ( ( foundInput == neededComps.end() ) || foundInput->second.empty() ) {
+            return std::string();
+        }
+
+        // The tree root is the writer so that the request pass and the hashes are the same as when the writer renders
+        ParallelRenderArgsSetter frameRenderArgs(time,
+                                                 view,
+                                                 false,  // is this render due to user interaction ?
+                                                 true, // is sequential ?
+                                                 abortInfo, //abortInfo
+                                                 activeInputNode, // viewer requester
+                                                 0, //texture index
+                                                 output->getApp()->getTimeLine().get(),
+                                                 NodePtr(),
+                                                 false,
+                                                 false,
+                                                 stats);
+        FrameRequestMap request;
+        stat = EffectInstance::computeRequestPass(time, view, mipMapLevel, rod, activeInputNode, request);
+        if (stat == eStatusFailed) {
+            return "Error caught while rendering";
+        }
+        frameRenderArgs.updateNodesRequest(request);
+
+        // Only render what the writer needs from its input at this frame and view
+        FrameRequestMap::const_iterator foundRequest = request.find( input->getNode() );
+        RectD inputRoI;
+        if ( ( foundRequest == request.end() ) || !foundRequest->second->getFrameViewCanonicalRoI(time, view, &inputRoI) ) {
+            return std::string();
+        }
+        RectI inputRoIPixel;
+        inputRoI.toPixelEnclosing( mipMapLevel, input->getAspectRatio(-1), &inputRoIPixel );
+
+        RenderingFlagSetter flagIsRendering( input->getNode() );
+        std::map<ImagePlaneDesc, ImagePtr> planes;
+        boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time,
+                                                                                                       scale,
+                                                                                                       mipMapLevel,
+                                                                                                       view,
+                                                                                                       false,
+                                                                                                       inputRoIPixel,
+                                                                                                       RectD(),
+                                                                                                       foundInput->second,
+                                                                                                       activeInputToRender->getBitDepth(0),
+                                                                                                       false,
+                                                                                                       activeInputToRender.get(),
+                                                                                                       eStorageModeRAM,
+                                                                                                       time) );
+        EffectInstance::RenderRoIRetCode retCode = input->renderRoI(*renderArgs, &planes);
+        if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
+            return "Render aborted";
+        } else if (retCode == EffectInstance::eRenderRoIRetCodeFailed) {
+            return "Error caught while rendering";
+        }
+
+        return std::string();
+    } // renderInputViewInternal
+
+    std::string renderViewInternal(int time,
+                                   const EffectInstancePtr& activeInputToRender,
+                                   U64 activeInputToRenderHash,
+                                   const AbortableRenderInfoPtr& abortInfo,
+                                   const RenderStatsPtr& stats,
+                                   ViewIdx view)
+    {
+        OutputEffectInstancePtr output = _imp->output.lock();
+
+        if (!output) {
+            return std::string();
+        }
+
+        ////Writers always render at scale 1.
+        int mipMapLevel = 0;
+        RenderScale scale(1.);
+        RectD rod;
+        bool isProjectFormat;
+        NodePtr activeInputNode = activeInputToRender->getNode();
+        const double par = activeInputToRender->getAspectRatio(-1);
+        const bool isRenderDueToRenderInteraction = false;
+        const bool isSequentialRender = true;
+
+        StatusEnum stat = activeInputToRender->getRegionOfDefinition_public(activeInputToRenderHash, time, scale, view, &rod, &isProjectFormat);
+        if (stat == eStatusFailed) {
+            return "Error caught while rendering";
+        }
+        std::list<ImagePlaneDesc> components;
+        ImageBitDepthEnum imageDepth;
+
+        //Use needed components to figure out what we need to render
+        EffectInstance::ComponentsNeededMap neededComps;
+        std::list<ImagePlaneDesc> passThroughPlanes;
+        bool processAll;
+        double ptTime;
+        int ptView;
+        std::bitset<4> processChannels;
+        int ptInput;
+        activeInputToRender->getComponentsNeededAndProduced_public(activeInputToRenderHash,time, view, &neededComps, &passThroughPlanes, &processAll, &ptTime, &ptView, &processChannels, &ptInput);
+
+
+        //Retrieve bitdepth only
+        imageDepth = activeInputToRender->getBitDepth(-1);
+        components.clear();
+
+        EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(-1);
+        if ( foundOutput != neededComps.end() ) {
+            for (std::list<ImagePlaneDesc>::const_iterator it2 = foundOutput->second.begin(); it2 != foundOutput->second.end(); ++it2) {
+                components.push_back(*it2);
+            }
+        }
+        RectI renderWindow;
+        rod.toPixelEnclosing(scale, par, &renderWindow);
+
+
+        ParallelRenderArgsSetter frameRenderArgs(time,
+                                                 view,
+                                                 isRenderDueToRenderInteraction,  // is this render due to user interaction ?
+                                                 isSequentialRender,
+                                                 abortInfo, //abortInfo
+                                                 activeInputNode, // viewer requester
+                                                 0, //texture index
+                                                 output->getApp()->getTimeLine().get(),
+                                                 NodePtr(),
+                                                 false,
+                                                 false,
+                                                 stats);
+
+        RenderingFlagSetter flagIsRendering( activeInputToRender->getNode() );
+
+        // When rendering in strips, each strip is pulled through the graph on its own so that the
+        // intermediate images only ever cover the strip being rendered (expanded by the regions of interest upstream)
+        std::list<RectI> strips;
+        computeRenderStrips(renderWindow, activeInputToRender, &strips);
+
+        // Full frame images of the nodes which do not support tiles, released after the last strip
+        StripImagesHolder frameImages;
+        for (std::list<RectI>::const_iterator strip = strips.begin(); strip != strips.end(); ++strip) {
+            RectD stripCanonical = rod;
+            if (strips.size() > 1) {
+                strip->toCanonical(mipMapLevel, par, rod, &stripCanonical);
+            }
+
+            FrameRequestMap request;
+            stat = EffectInstance::computeRequestPass(time, view, mipMapLevel, stripCanonical, activeInputNode, request);
+            if (stat == eStatusFailed) {
+                return "Error caught while rendering";
+            }
+            frameRenderArgs.updateNodesRequest(request);
+
+            // Images of this strip, released once it is rendered
+            StripImagesHolder stripImages;
+            if (strips.size() > 1) {
+                StripImageKeys stripKeys, frameKeys;
+                getStripImageKeys(request, &stripKeys, &frameKeys);
+                stripImages.hold(stripKeys);
+                frameImages.hold(frameKeys);
+            }
+
+            std::map<ImagePlaneDesc, ImagePtr> planes;
+            boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time, //< the time at which to render
+                                                                                                           scale, //< the scale at which to render
+                                                                                                           mipMapLevel, //< the mipmap level (redundant with the scale)
+                                                                                                           view, //< the view to render
+                                                                                                           false,
+                                                                                                           *strip, //< the region of interest (in pixel coordinates)
+                                                                                                           rod, // < any precomputed rod ? in canonical coordinates
+                                                                                                           components,
+                                                                                                           imageDepth,
+                                                                                                           false,
+                                                                                                           activeInputToRender.get(),
+                                                                                                           eStorageModeRAM,
+                                                                                                           time) );
+            EffectInstance::RenderRoIRetCode retCode;
+            retCode = activeInputToRender->renderRoI(*renderArgs, &planes);
+            if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
+                if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
+                    return "Render aborted";
+                } else {
+                    return "Error caught while rendering";
+                }
+            }
+        }
+
+        return std::string();
+    } // renderViewInternal
 
     virtual void renderFrame(int time,
                              const std::vector<ViewIdx>& viewsToRender,
@@ -2245,12 +3006,6 @@ private:
         }
 
         try {
-            ////Writers always render at scale 1.
-            int mipMapLevel = 0;
-            RenderScale scale(1.);
-            RectD rod;
-            bool isProjectFormat;
-
             // Do not catch exceptions: if an exception occurs here it is probably fatal, since
             // it comes from Natron itself. All exceptions from plugins are already caught
             // by the HostSupport library.
@@ -2265,98 +3020,40 @@ private:
                 }
             }
             assert(activeInputToRender);
-            NodePtr activeInputNode = activeInputToRender->getNode();
             U64 activeInputToRenderHash = isWriteNode ? isWriteNode->getHash() : activeInputToRender->getHash();
-            const double par = activeInputToRender->getAspectRatio(-1);
-            const bool isRenderDueToRenderInteraction = false;
-            const bool isSequentialRender = true;
-
-            for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
-                StatusEnum stat = activeInputToRender->getRegionOfDefinition_public(activeInputToRenderHash, time, scale, viewsToRender[view], &rod, &isProjectFormat);
-                if (stat == eStatusFailed) {
-                    _imp->scheduler->notifyRenderFailure("Error caught while rendering");
 
-                    return;
-                }
-                std::list<ImagePlaneDesc> components;
-                ImageBitDepthEnum imageDepth;
-
-                //Use needed components to figure out what we need to render
-                EffectInstance::ComponentsNeededMap neededComps;
-                std::list<ImagePlaneDesc> passThroughPlanes;
-                bool processAll;
-                double ptTime;
-                int ptView;
-                std::bitset<4> processChannels;
-                int ptInput;
-                activeInputToRender->getComponentsNeededAndProduced_public(activeInputToRenderHash,time, viewsToRender[view], &neededComps, &passThroughPlanes, &processAll, &ptTime, &ptView, &processChannels, &ptInput);
-
-
-                //Retrieve bitdepth only
-                imageDepth = activeInputToRender->getBitDepth(-1);
-                components.clear();
-
-                EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(-1);
-                if ( foundOutput != neededComps.end() ) {
-                    for (std::list<ImagePlaneDesc>::const_iterator it2 = foundOutput->second.begin(); it2 != foundOutput->second.end(); ++it2) {
-                        components.push_back(*it2);
-                    }
-                }
-                RectI renderWindow;
-                rod.toPixelEnclosing(scale, par, &renderWindow);
-
-
-                AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
-                if (isAbortableThread) {
-                    isAbortableThread->setAbortInfo(isRenderDueToRenderInteraction, abortInfo, activeInputToRender);
-                }
-
-                ParallelRenderArgsSetter frameRenderArgs(time,
-                                                         viewsToRender[view],
-                                                         isRenderDueToRenderInteraction,  // is this render due to user interaction ?
-                                                         isSequentialRender,
-                                                         abortInfo, //abortInfo
-                                                         activeInputNode, // viewer requester
-                                                         0, //texture index
-                                                         output->getApp()->getTimeLine().get(),
-                                                         NodePtr(),
-                                                         false,
-                                                         false,
-                                                         stats);
+            // All the views share the abort info of the thread running the frame, so that aborting the render aborts
+            // the views being rendered on other threads
+            AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+            if (isAbortableThread) {
+                isAbortableThread->setAbortInfo(false, abortInfo, activeInputToRender);
+            }
 
-                {
-                    FrameRequestMap request;
-                    stat = EffectInstance::computeRequestPass(time, viewsToRender[view], mipMapLevel, rod, activeInputNode, request);
-                    if (stat == eStatusFailed) {
-                        _imp->scheduler->notifyRenderFailure("Error caught while rendering");
+            // The views of a frame do not depend on each other: the input of the writer is rendered for all the views
+            // concurrently and cached, then the render action of the writer is called for each view in order and reads
+            // its input back from the cache. The writer thus always gets the views of a frame in order, one at a time.
+            // This is not done when rendering in strips, since the images cached upstream would then cover the full frame.
+            if ( (viewsToRender.size() > 1) && activeInputToRender->getInput(0) && !canRenderInStrips(activeInputToRender) ) {
+                NodePtr activeInputNode = activeInputToRender->getNode();
+                activeInputNode->setCachingInputsForViews(true);
+                QFuture<std::string> future = QtConcurrent::mapped( viewsToRender, boost::bind(&DefaultRenderFrameRunnable::renderInputView, this, time, activeInputToRender, activeInputToRenderHash, abortInfo, stats, _1) );
+                future.waitForFinished();
+                activeInputNode->setCachingInputsForViews(false);
+
+                for (int i = 0; i < future.resultCount(); ++i) {
+                    const std::string error = future.resultAt(i);
+                    if ( !error.empty() ) {
+                        _imp->scheduler->notifyRenderFailure(error);
 
                         return;
                     }
-                    frameRenderArgs.updateNodesRequest(request);
                 }
-                RenderingFlagSetter flagIsRendering( activeInputToRender->getNode() );
-                std::map<ImagePlaneDesc, ImagePtr> planes;
-                boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time, //< the time at which to render
-                                                                                                               scale, //< the scale at which to render
-                                                                                                               mipMapLevel, //< the mipmap level (redundant with the scale)
-                                                                                                               viewsToRender[view], //< the view to render
-                                                                                                               false,
-                                                                                                               renderWindow, //< the region of interest (in pixel coordinates)
-                                                                                                               rod, // < any precomputed rod ? in canonical coordinates
-                                                                                                               components,
-                                                                                                               imageDepth,
-                                                                                                               false,
-                                                                                                               activeInputToRender.get(),
-                                                                                                               eStorageModeRAM,
-                                                                                                               time) );
-                EffectInstance::RenderRoIRetCode retCode;
-                retCode = activeInputToRender->renderRoI(*renderArgs, &planes);
-                if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
-                    if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
-                        _imp->scheduler->notifyRenderFailure("Render aborted");
-                    } else {
-                        _imp->scheduler->notifyRenderFailure("Error caught while rendering");
-                    }
+            }
+
+            for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
+                std::string error = renderView(time, activeInputToRender, activeInputToRenderHash, abortInfo, stats, viewsToRender[view]);
+                if ( !error.empty() ) {
+                    _imp->scheduler->notifyRenderFailure(error);
 
                     return;
                 }
@@ -2947,6 +3644,10 @@ struct RenderEnginePrivate
     PlaybackModeEnum pbMode;
     ViewerCurrentFrameRequestScheduler* currentFrameScheduler;
 
+    // Shared by the frames of the sequential render, protected by bufferPoolMutex
+    mutable QMutex bufferPoolMutex;
+    ImageBufferPoolPtr bufferPool;
+
     // Only used on the main-thread
     boost::scoped_ptr<RenderEngineWatcher> engineWatcher;
     struct RefreshRequest
@@ -2971,6 +3672,8 @@ struct RenderEnginePrivate
         , pbModeMutex()
         , pbMode(ePlaybackModeLoop)
         , currentFrameScheduler(0)
+        , bufferPoolMutex()
+        , bufferPool()
         , refreshQueue()
     {
     }
@@ -3002,6 +3705,34 @@ RenderEngine::getOutput() const
     return _imp->output.lock();
 }
 
+ImageBufferPoolPtr
+RenderEngine::getImageBufferPool() const
+{
+    QMutexLocker k(&_imp->bufferPoolMutex);
+
+    return _imp->bufferPool;
+}
+
+void
+RenderEngine::createImageBufferPool()
+{
+    ImageBufferPoolPtr pool = boost::make_shared<ImageBufferPool>();
+    QMutexLocker k(&_imp->bufferPoolMutex);
+
+    _imp->bufferPool = pool;
+}
+
+void
+RenderEngine::releaseImageBufferPool()
+{
+    ImageBufferPoolPtr pool;
+    {
+        QMutexLocker k(&_imp->bufferPoolMutex);
+        pool.swap(_imp->bufferPool);
+    }
+    // The retained buffers are freed with the last frame still holding the pool
+}
+
 void
 RenderEngine::renderFrameRange(bool isBlocking,
                                bool enableRenderStats,
@@ -3767,7 +4498,11 @@ ViewerCurrentFrameRequestSchedulerPrivate::processProducedFrame(const RenderStat
             if (stats) {
                 double timeSpent;
                 std::map<NodePtr, NodeRenderStats > ret = stats->getStats(&timeSpent);
-                viewer->reportStats(0, ViewIdx(0), timeSpent, ret);
+                int nParallelRenders;
+                double parallelRendersFps;
+                ParallelRendersDecisionEnum parallelRendersDecision;
+                stats->getParallelRendersInfos(&nParallelRenders, &parallelRendersFps, &parallelRendersDecision);
+                viewer->reportStats(0, ViewIdx(0), timeSpent, ret, nParallelRenders, parallelRendersFps, parallelRendersDecision);
             }
 
             viewer->updateViewer(params);
@@ -3919,7 +4654,11 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
                 if ( stats && (i == 0) ) {
                     double timeSpent;
                     std::map<NodePtr, NodeRenderStats > statResults = stats->getStats(&timeSpent);
-                    _imp->viewer->reportStats(frame, view, timeSpent, statResults);
+                    int nParallelRenders;
+                    double parallelRendersFps;
+                    ParallelRendersDecisionEnum parallelRendersDecision;
+                    stats->getParallelRendersInfos(&nParallelRenders, &parallelRendersFps, &parallelRendersDecision);
+                    _imp->viewer->reportStats(frame, view, timeSpent, statResults, nParallelRenders, parallelRendersFps, parallelRendersDecision);
                 }
                 _imp->viewer->updateViewer(args[i]->params);
                 args[i].reset();
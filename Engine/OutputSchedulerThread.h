@@ -309,6 +309,11 @@ public:
      **/
     void notifyThreadAboutToQuit(RenderThreadTask* thread);
 
+    /**
+     * @brief Called by the render-threads once a frame is rendered, to adapt the number of frames read ahead during playback
+     **/
+    void notifyFrameRenderTime(double timeSpentSec);
+
     /**
      *@brief The slot called by the GUI to set the requested fps.
      **/
@@ -455,6 +460,19 @@ private:
      * @param optimalNThreads[out] Will be set to the new number of threads
      **/
     void adjustNumberOfThreads(int* newNThreads, int *lastNThreads);
+
+    /**
+     * @brief Returns how many frames should be queued ahead of the playhead for nThreads render threads.
+     * When FPS regulation is needed this adapts to the measured frame render time against the desired fps
+     * and is bounded by the RAM budget of the viewer cache.
+     **/
+    int getReadAheadDepth(int nThreads) const;
+
+    /**
+     * @brief Returns how many frames of the average measured size fit in the RAM budget of the viewer cache,
+     * or INT_MAX if no frame was measured yet.
+     **/
+    int getReadAheadMemoryLimit() const;
 #else
     void startTasksFromLastStartedFrame();
     void startTasks(int startingFrame);
@@ -765,6 +783,12 @@ public:
      **/
     bool isDoingSequentialRender() const;
 
+    /**
+     * @brief Returns the pool recycling the transient image buffers of the frames of the playback or render
+     * on disk currently running, or NULL if there is none.
+     **/
+    ImageBufferPoolPtr getImageBufferPool() const;
+
 public Q_SLOTS:
 
     void abortRendering_non_blocking()
@@ -840,6 +864,12 @@ private:
 
     void renderCurrentFrameInternal(bool enableRenderStats, bool canAbort);
 
+    /**
+     * The following functions are called by the OutputThreadScheduler when a sequential render starts and stops
+     **/
+    void createImageBufferPool();
+    void releaseImageBufferPool();
+
 
     /**
      * The following functions are called by the OutputThreadScheduler to Q_EMIT the corresponding signals
@@ -34,11 +34,15 @@
 #include "Engine/AppManager.h"
 #include "Engine/Settings.h"
 #include "Engine/EffectInstance.h"
+#include "Engine/EffectInstancePrivate.h"
 #include "Engine/Image.h"
+#include "Engine/ImageBufferPool.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/OSGLContext.h"
+#include "Engine/OutputEffectInstance.h"
+#include "Engine/OutputSchedulerThread.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/ViewIdx.h"
@@ -249,8 +253,17 @@ EffectInstance::treeRecurseFunctor(bool isRenderFunctor,
                                     continue;
                                 }
 
+                                // Skip the pass-through nodes resolved by the request pass
+                                EffectInstancePtr effectToRender = inputEffect;
                                 if (roiIsInRequestPass) {
-                                    frameArgs->request->getFrameViewCanonicalRoI(f, viewIt->first, &roi);
+                                    const FrameViewRequest* inputRequest = frameArgs->request->getFrameViewRequest(f, viewIt->first);
+                                    if (inputRequest) {
+                                        roi = inputRequest->finalData.finalRoi;
+                                        EffectInstancePtr passThroughEffect = inputRequest->finalData.passThroughEffect.lock();
+                                        if (passThroughEffect) {
+                                            effectToRender = passThroughEffect;
+                                        }
+                                    }
                                 }
 
                                 RectI inputRoIPixelCoords;
@@ -276,7 +289,7 @@ EffectInstance::treeRecurseFunctor(bool isRenderFunctor,
                                                                                          time /*callerRenderTime*/) );
 
                                     EffectInstance::RenderRoIRetCode ret;
-                                    ret = inputEffect->renderRoI(*renderArgs, &inputImgs); //< requested bitdepth
+                                    ret = effectToRender->renderRoI(*renderArgs, &inputImgs); //< requested bitdepth
                                     if (ret != EffectInstance::eRenderRoIRetCodeOk) {
                                         return ret;
                                     }
@@ -304,6 +317,181 @@ EffectInstance::treeRecurseFunctor(bool isRenderFunctor,
     return EffectInstance::eRenderRoIRetCodeOk;
 } // EffectInstance::treeRecurseFunctor
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Calls the actions needed to set up the global data of a frame/view requested for the first time in the request pass
+ **/
+static StatusEnum
+computeFrameViewGlobalData(const EffectInstancePtr& effect,
+                           const NodeFrameRequest& nodeRequest,
+                           bool useTransforms,
+                           double time,
+                           ViewIdx view,
+                           unsigned int mappedLevel,
+                           double par,
+                           EffectInstance::ViewInvarianceLevel viewInvariance,
+                           const RectD& canonicalRenderWindow,
+                           FrameViewRequestGlobalData* data)
+{
+    ///Check identity
+    data->identityInputNb = -1;
+    data->inputIdentityTime = 0.;
+    data->identityView = view;
+
+
+    RectI identityRegionPixel;
+    canonicalRenderWindow.toPixelEnclosing(mappedLevel, par, &identityRegionPixel);
+
+    if ( (view != 0) && (viewInvariance == EffectInstance::eViewInvarianceAllViewsInvariant) ) {
+        data->isIdentity = true;
+        data->identityInputNb = -2;
+        data->inputIdentityTime = time;
+    } else {
+        try {
+            data->isIdentity = effect->isIdentity_public(true, nodeRequest.nodeHash, time, nodeRequest.mappedScale, identityRegionPixel, view, &data->inputIdentityTime, &data->identityView, &data->identityInputNb);
+        } catch (...) {
+            return eStatusFailed;
+        }
+    }
+
+    /*
+       Do NOT call getRegionOfDefinition on the identity time, if the plug-in returns an identity time different from
+       this time, we expect that it handles getRegionOfDefinition itself correctly.
+     */
+    double rodTime = time; //data->isIdentity ? data->inputIdentityTime : time;
+    ViewIdx rodView = view; //data->isIdentity ? data->identityView : view;
+
+    ///Get the RoD
+    StatusEnum stat = effect->getRegionOfDefinition_public(nodeRequest.nodeHash, rodTime, nodeRequest.mappedScale, rodView, &data->rod, &data->isProjectFormat);
+    //If failed it should have failed earlier
+    if ( (stat == eStatusFailed) && !data->rod.isNull() ) {
+        return stat;
+    }
+
+
+    ///Concatenate transforms if needed
+    if (useTransforms) {
+        data->transforms = boost::make_shared<InputMatrixMap>();
+#pragma message WARN("TODO: can set draftRender properly here?")
+        effect->tryConcatenateTransforms( time, /*draftRender=*/false, view, nodeRequest.mappedScale, data->transforms.get() );
+    }
+
+    ///Get the frame/views needed for this frame/view
+    data->frameViewsNeeded = effect->getFramesNeeded_public(nodeRequest.nodeHash, time, view, mappedLevel);
+
+    return eStatusOK;
+} // computeFrameViewGlobalData
+
+static void
+addRequestPassInfos(const EffectInstancePtr& effect,
+                    bool reused)
+{
+    ParallelRenderArgsPtr frameArgs = effect->getParallelRenderArgsTLS();
+
+    if ( frameArgs && frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
+        frameArgs->stats->addRequestPassInfosForNode(effect->getNode(), reused);
+    }
+}
+
+/**
+ * @brief Returns the input to which the node forwards the render of the given frame/view without changing the time,
+ * the view or the requested planes, or NULL if the node renders this frame/view itself.
+ **/
+static EffectInstancePtr
+getPassThroughInput(const EffectInstancePtr& effect,
+                    const NodeFrameRequest& nodeRequest,
+                    double time,
+                    ViewIdx view,
+                    const FrameViewRequestGlobalData& data)
+{
+    if ( !data.isIdentity || (data.identityInputNb < 0) || (data.inputIdentityTime != time) || (data.identityView != view) ) {
+        return EffectInstancePtr();
+    }
+
+    NodePtr node = effect->getNode();
+
+    // The render of the nodes of the rotopaint tree is driven by the strokes
+    if ( node->getAttachedRotoItem() || node->isRotoPaintingNode() ) {
+        return EffectInstancePtr();
+    }
+
+    // With a channel selector, the identity node fetches upstream the planes selected by the user instead of the requested ones
+    if ( node->getChannelSelectorKnob(data.identityInputNb) ) {
+        return EffectInstancePtr();
+    }
+
+    // Planes not produced by the node are fetched on the pass-through input, which must then be the identity input
+    EffectInstance::ComponentsNeededMap neededComps;
+    std::list<ImagePlaneDesc> passThroughPlanes;
+    bool processAllRequested;
+    double ptTime;
+    int ptView;
+    std::bitset<4> processChannels;
+    int ptInputNb;
+    effect->getComponentsNeededAndProduced_public(nodeRequest.nodeHash, time, view, &neededComps, &passThroughPlanes, &processAllRequested, &ptTime, &ptView, &processChannels, &ptInputNb);
+    if ( neededComps.find(-1) == neededComps.end() ) {
+        return EffectInstancePtr();
+    }
+    if ( !passThroughPlanes.empty() && ( (ptInputNb != data.identityInputNb) || (ptTime != time) || (ptView != view) ) ) {
+        return EffectInstancePtr();
+    }
+
+    return effect->getInput(data.identityInputNb);
+} // getPassThroughInput
+
+/**
+ * @brief Once the request pass is done, resolves for each frame/view of the pass-through nodes the first effect upstream
+ * which actually renders, so that the render directly recurses on the graph stripped of these nodes.
+ * Groups are already flattened by the input redirections of Node::getInput.
+ **/
+static void
+compileRenderGraph(const FrameRequestMap& requests)
+{
+    for (FrameRequestMap::const_iterator it = requests.begin(); it != requests.end(); ++it) {
+        EffectInstancePtr effect = it->first->getEffectInstance();
+        for (NodeFrameViewRequestData::iterator it2 = it->second->frames.begin(); it2 != it->second->frames.end(); ++it2) {
+            double time = it2->first.time;
+            ViewIdx view = it2->first.view;
+            EffectInstancePtr passThroughEffect = getPassThroughInput(effect, *it->second, time, view, it2->second.globalData);
+            if (!passThroughEffect) {
+                continue;
+            }
+
+            // Follow the chain of pass-through nodes upstream
+            for (;;) {
+                FrameRequestMap::const_iterator foundInput = requests.find( passThroughEffect->getNode() );
+                if ( foundInput == requests.end() ) {
+                    break;
+                }
+                const FrameViewRequest* inputRequest = foundInput->second->getFrameViewRequest(time, view);
+                if (!inputRequest) {
+                    break;
+                }
+                EffectInstancePtr upstream = inputRequest->finalData.passThroughEffect.lock();
+                if (upstream) {
+                    // Already resolved
+                    passThroughEffect = upstream;
+                    break;
+                }
+                upstream = getPassThroughInput(passThroughEffect, *foundInput->second, time, view, inputRequest->globalData);
+                if (!upstream) {
+                    break;
+                }
+                passThroughEffect = upstream;
+            }
+            it2->second.finalData.passThroughEffect = passThroughEffect;
+
+            ParallelRenderArgsPtr frameArgs = effect->getParallelRenderArgsTLS();
+            if ( frameArgs && frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
+                frameArgs->stats->setNodeIdentity( it->first, passThroughEffect->getNode() );
+            }
+        }
+    }
+} // compileRenderGraph
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
 StatusEnum
 EffectInstance::getInputsRoIsFunctor(bool useTransforms,
                                      double time,
@@ -340,6 +528,7 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
         NodeFrameRequestPtr tmp = boost::make_shared<NodeFrameRequest>();
         tmp->mappedScale.x = tmp->mappedScale.y = Image::getScaleFromMipMapLevel(mappedLevel);
         tmp->nodeHash = effect->getRenderHash();
+        tmp->isTimeInvariant = !effect->isFrameVaryingOrAnimated_Recursive();
 
         std::pair<FrameRequestMap::iterator, bool> ret = requests.insert( std::make_pair(node, tmp) );
         assert(ret.second);
@@ -367,52 +556,19 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
 
         fvRequest = &nodeRequest->frames[frameView];
 
-
-        ///Check identity
-        fvRequest->globalData.identityInputNb = -1;
-        fvRequest->globalData.inputIdentityTime = 0.;
-        fvRequest->globalData.identityView = view;
-
-
-        RectI identityRegionPixel;
-        canonicalRenderWindow.toPixelEnclosing(mappedLevel, par, &identityRegionPixel);
-
-        if ( (view != 0) && (viewInvariance == eViewInvarianceAllViewsInvariant) ) {
-            fvRequest->globalData.isIdentity = true;
-            fvRequest->globalData.identityInputNb = -2;
-            fvRequest->globalData.inputIdentityTime = time;
-        } else {
-            try {
-                fvRequest->globalData.isIdentity = effect->isIdentity_public(true, nodeRequest->nodeHash, time, nodeRequest->mappedScale, identityRegionPixel, view, &fvRequest->globalData.inputIdentityTime, &fvRequest->globalData.identityView, &fvRequest->globalData.identityInputNb);
-            } catch (...) {
-                return eStatusFailed;
+        // For a node that does not depend on the time, try to reuse the results of a previous frame
+        const RequestPassCachePtr& requestPassCache = effect->_imp->requestPassCache;
+        bool reused = nodeRequest->isTimeInvariant && requestPassCache->getGlobalData(nodeRequest->nodeHash, time, view, mappedLevel, useTransforms, canonicalRenderWindow, &fvRequest->globalData);
+        if (!reused) {
+            StatusEnum stat = computeFrameViewGlobalData(effect, *nodeRequest, useTransforms, time, view, mappedLevel, par, viewInvariance, canonicalRenderWindow, &fvRequest->globalData);
+            if (stat == eStatusFailed) {
+                return stat;
+            }
+            if (nodeRequest->isTimeInvariant) {
+                requestPassCache->setGlobalData(nodeRequest->nodeHash, time, view, mappedLevel, useTransforms, canonicalRenderWindow, fvRequest->globalData);
             }
         }
-
-        /*
-           Do NOT call getRegionOfDefinition on the identity time, if the plug-in returns an identity time different from
-           this time, we expect that it handles getRegionOfDefinition itself correctly.
-         */
-        double rodTime = time; //fvRequest->globalData.isIdentity ? fvRequest->globalData.inputIdentityTime : time;
-        ViewIdx rodView = view; //fvRequest->globalData.isIdentity ? fvRequest->globalData.identityView : view;
-
-        ///Get the RoD
-        StatusEnum stat = effect->getRegionOfDefinition_public(nodeRequest->nodeHash, rodTime, nodeRequest->mappedScale, rodView, &fvRequest->globalData.rod, &fvRequest->globalData.isProjectFormat);
-        //If failed it should have failed earlier
-        if ( (stat == eStatusFailed) && !fvRequest->globalData.rod.isNull() ) {
-            return stat;
-        }
-
-
-        ///Concatenate transforms if needed
-        if (useTransforms) {
-            fvRequest->globalData.transforms = boost::make_shared<InputMatrixMap>();
-#pragma message WARN("TODO: can set draftRender properly here?")
-            effect->tryConcatenateTransforms( time, /*draftRender=*/false, view, nodeRequest->mappedScale, fvRequest->globalData.transforms.get() );
-        }
-
-        ///Get the frame/views needed for this frame/view
-        fvRequest->globalData.frameViewsNeeded = effect->getFramesNeeded_public(nodeRequest->nodeHash, time, view, mappedLevel);
+        addRequestPassInfos(effect, reused);
     } // if (foundFrameView != nodeRequest->frames.end()) {
 
     assert(fvRequest);
@@ -489,7 +645,13 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
 
     ///Compute the regions of interest in input for this RoI
     FrameViewPerRequestData fvPerRequestData;
-    effect->getRegionsOfInterest_public(time, nodeRequest->mappedScale, fvRequest->globalData.rod, canonicalRenderWindow, view, &fvPerRequestData.inputsRoi);
+    if ( !nodeRequest->isTimeInvariant ||
+         !effect->_imp->requestPassCache->getInputsRoI(nodeRequest->nodeHash, view, mappedLevel, canonicalRenderWindow, &fvPerRequestData.inputsRoi) ) {
+        effect->getRegionsOfInterest_public(time, nodeRequest->mappedScale, fvRequest->globalData.rod, canonicalRenderWindow, view, &fvPerRequestData.inputsRoi);
+        if (nodeRequest->isTimeInvariant) {
+            effect->_imp->requestPassCache->setInputsRoI(nodeRequest->nodeHash, view, mappedLevel, canonicalRenderWindow, fvPerRequestData.inputsRoi);
+        }
+    }
 
 
     ///Transform Rois and get the reroutes map
@@ -557,6 +719,8 @@ EffectInstance::computeRequestPass(double time,
         return stat;
     }
 
+    compileRenderGraph(request);
+
     //For all frame/view pair and for each node, compute the final roi as being the bounding box of all successive requests
     /*for (FrameRequestMap::iterator it = request.begin(); it != request.end(); ++it) {
         for (NodeFrameViewRequestData::iterator it2 = it->second->frames.begin(); it2 != it->second->frames.end(); ++it2) {
@@ -713,6 +877,15 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(double time,
 
     _openGLContext = glContext;
 
+    // During playback or a render on disk, the buffers are shared by all the frames of the render
+    OutputEffectInstance* isOutput = dynamic_cast<OutputEffectInstance*>( treeRoot->getEffectInstance().get() );
+    RenderEnginePtr engine = isOutput ? isOutput->getRenderEngine() : RenderEnginePtr();
+    if (engine) {
+        _bufferPool = engine->getImageBufferPool();
+    }
+    if (!_bufferPool) {
+        _bufferPool = boost::make_shared<ImageBufferPool>();
+    }
 
     bool doNanHandling = appPTR->getCurrentSettings()->isNaNHandlingEnabled();
 
@@ -739,7 +912,7 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(double time,
         {
             U64 nodeHash = node->getHashValue();
             liveInstance->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash,
-                                                   abortInfo, treeRoot, it->second.visitCounter, NodeFrameRequestPtr(), glContext,  textureIndex, timeline, isAnalysis, duringPaintStrokeCreation, rotoPaintNodes, safety, glSupport, doNanHandling, draftMode, stats);
+                                                   abortInfo, treeRoot, it->second.visitCounter, NodeFrameRequestPtr(), glContext,  textureIndex, timeline, isAnalysis, duringPaintStrokeCreation, rotoPaintNodes, safety, glSupport, doNanHandling, draftMode, stats, _bufferPool);
         }
         for (NodesList::iterator it2 = rotoPaintNodes.begin(); it2 != rotoPaintNodes.end(); ++it2) {
             U64 nodeHash = (*it2)->getHashValue();
@@ -749,7 +922,7 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(double time,
             (*it2)->getOutputs_mt_safe(outputs);
             int visitsCounter = (int)outputs.size();
 
-            (*it2)->getEffectInstance()->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash, abortInfo, treeRoot, visitsCounter, NodeFrameRequestPtr(), glContext, textureIndex, timeline, isAnalysis, activeRotoPaintNode && (*it2)->isDuringPaintStrokeCreation(), NodesList(), (*it2)->getCurrentRenderThreadSafety(),  (*it2)->getCurrentOpenGLRenderSupport(),doNanHandling, draftMode, stats);
+            (*it2)->getEffectInstance()->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash, abortInfo, treeRoot, visitsCounter, NodeFrameRequestPtr(), glContext, textureIndex, timeline, isAnalysis, activeRotoPaintNode && (*it2)->isDuringPaintStrokeCreation(), NodesList(), (*it2)->getCurrentRenderThreadSafety(),  (*it2)->getCurrentOpenGLRenderSupport(),doNanHandling, draftMode, stats, _bufferPool);
         }
 
         if ( node->isMultiInstance() ) {
@@ -765,7 +938,7 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(double time,
                 assert(childLiveInstance);
                 RenderSafetyEnum childSafety = (*it2)->getCurrentRenderThreadSafety();
                 PluginOpenGLRenderSupport childGlSupport = (*it2)->getCurrentOpenGLRenderSupport();
-                childLiveInstance->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash, abortInfo, treeRoot, 1, NodeFrameRequestPtr(), glContext, textureIndex, timeline, isAnalysis, false, NodesList(), childSafety, childGlSupport, doNanHandling, draftMode, stats);
+                childLiveInstance->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash, abortInfo, treeRoot, 1, NodeFrameRequestPtr(), glContext, textureIndex, timeline, isAnalysis, false, NodesList(), childSafety, childGlSupport, doNanHandling, draftMode, stats, _bufferPool);
             }
         }
 
@@ -884,6 +1057,7 @@ ParallelRenderArgs::ParallelRenderArgs()
     , visitsCount(0)
     , rotoPaintNodes()
     , stats()
+    , bufferPool()
     , openGLContext()
     , textureIndex(0)
     , currentThreadSafety(eRenderSafetyInstanceSafe)
@@ -118,6 +118,10 @@ public:
     ///Various stats local to the render of a frame
     RenderStatsPtr stats;
 
+    ///Recycles the buffers of the non-cached images allocated during the render of this frame,
+    ///shared with the other frames of a playback or render on disk
+    ImageBufferPoolPtr bufferPool;
+
     ///The OpenGL context to use for the render of this frame
     OSGLContextWPtr openGLContext;
 
@@ -187,6 +191,11 @@ struct FrameViewRequestGlobalData
 struct FrameViewRequestFinalData
 {
     RectD finalRoi;
+
+    ///If the node only forwards the render of this frame/view to one of its inputs (e.g: a Dot, a disabled node or an identity node),
+    ///this is the first effect upstream which actually renders, resolved once the request pass is done so that the render skips the
+    ///pass-through nodes.
+    EffectInstanceWPtr passThroughEffect;
 };
 
 struct FrameViewPerRequestData
@@ -238,6 +247,10 @@ public:
     U64 nodeHash;
     RenderScale mappedScale;
 
+    ///True if the node and its inputs are neither frame varying nor animated: the results of the request pass
+    ///of previous frames may be reused, set on first request
+    bool isTimeInvariant;
+
     bool getFrameViewCanonicalRoI(double time, ViewIdx view, RectD* roi) const;
 
     const FrameViewRequest* getFrameViewRequest(double time, ViewIdx view) const;
@@ -255,6 +268,9 @@ protected:
 
     OSGLContextWPtr _openGLContext;
 
+    // Shared by all the nodes of the frame render, and by the frames of the sequential render of the tree root
+    ImageBufferPoolPtr _bufferPool;
+
 public:
 
     /**
@@ -26,6 +26,7 @@
 #include "Project.h"
 
 #include <fstream>
+#include <sstream> // stringstream
 #include <algorithm> // min, max
 #include <ios>
 #include <cstdlib> // strtoul
@@ -70,6 +71,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
+#include "Engine/AutoSaveJournal.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/BezierCPSerialization.h"
 #include "Engine/EffectInstance.h"
@@ -78,6 +80,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/KnobFile.h"
 #include "Engine/Node.h"
 #include "Engine/OutputSchedulerThread.h"
+#include "Engine/ProjectBinarySerialization.h"
 #include "Engine/ProjectPrivate.h"
 #include "Engine/ProjectSerialization.h"
 #include "Engine/RectDSerialization.h"
@@ -230,7 +233,11 @@ Project::loadProject(const QString & path,
                                                   eStandardButtonYes);
                 }
                 if ( (ret == eStandardButtonNo) || (ret == eStandardButtonEscape) ) {
-                    QFile::remove(realPath + autosaveFileName);
+                    if ( AutoSaveJournal::isJournalFile(autosaveFileName) ) {
+                        AutoSaveJournal::removeJournalFile(realPath + autosaveFileName);
+                    } else {
+                        QFile::remove(realPath + autosaveFileName);
+                    }
                 } else {
                     realName = autosaveFileName;
                     isAutoSave = true;
@@ -275,21 +282,36 @@ Project::loadProject(const QString & path,
     return true;
 } // loadProject
 
-bool
-Project::loadProjectInternal(const QString & path,
-                             const QString & name,
-                             bool isAutoSave,
-                             bool isUntitledAutosave,
-                             bool* mustSave)
+/**
+ * @brief Throws the error to report when a project fails to load, with a more helpful message
+ * if the project was saved by a more recent version.
+ **/
+static void
+throwProjectLoadingError(const AppInstancePtr& app,
+                         const char* what)
 {
-    FlagSetter loadingProjectRAII(true, &_imp->isLoadingProject, &_imp->isLoadingProjectMutex);
-    QString filePath = path + name;
-    std::cout << tr("Loading project: %1").arg(filePath).toStdString() << std::endl;
+    const ProjectBeingLoadedInfo& pInfo = app->getProjectBeingLoadedInfo();
 
-    if ( !QFile::exists(filePath) ) {
-        throw std::invalid_argument( QString( filePath + QString::fromUtf8(" : no such file.") ).toStdString() );
+    if (pInfo.vMajor > NATRON_VERSION_MAJOR ||
+        (pInfo.vMajor == NATRON_VERSION_MAJOR && pInfo.vMinor > NATRON_VERSION_MINOR) ||
+        (pInfo.vMajor == NATRON_VERSION_MAJOR && pInfo.vMinor == NATRON_VERSION_MINOR && pInfo.vRev > NATRON_VERSION_REVISION)) {
+        QString message = Project::tr("This project was saved with a more recent version (%1.%2.%3) of %4. Projects are not forward compatible and may only be opened in a version of %4 equal or more recent than the version that saved it.").arg(pInfo.vMajor).arg(pInfo.vMinor).arg(pInfo.vRev).arg(QString::fromUtf8(NATRON_APPLICATION_NAME));
+        throw std::runtime_error(message.toStdString());
+    }
+    if (what) {
+        throw std::runtime_error( Project::tr("Unrecognized or damaged project file:").toStdString() + ' ' + what);
     }
+    throw std::runtime_error( Project::tr("Unrecognized or damaged project file").toStdString() );
+}
 
+bool
+Project::loadXMLProjectInternal(const QString & filePath,
+                                const QString & journalFilePath,
+                                const QString & path,
+                                const QString & name,
+                                bool isAutoSave,
+                                bool* mustSave)
+{
     bool ret = false;
     FStreamsSupport::ifstream ifile;
     FStreamsSupport::open( &ifile, filePath.toStdString() );
@@ -329,6 +351,9 @@ Project::loadProjectInternal(const QString & path,
             iArchive >> boost::serialization::make_nvp("Background_project", bgProject);
             ProjectSerialization projectSerializationObj( getApp() );
             iArchive >> boost::serialization::make_nvp("Project", projectSerializationObj);
+            if ( !journalFilePath.isEmpty() ) {
+                AutoSaveJournal::replay(journalFilePath, &projectSerializationObj);
+            }
             ret = load(projectSerializationObj, name, path, mustSave);
         } // __raii_loadingProjectInternal__
 
@@ -336,23 +361,89 @@ Project::loadProjectInternal(const QString & path,
             getApp()->loadProjectGui(isAutoSave, iArchive);
         }
     } catch (const std::exception &e) {
-        const ProjectBeingLoadedInfo& pInfo = getApp()->getProjectBeingLoadedInfo();
-        if (pInfo.vMajor > NATRON_VERSION_MAJOR ||
-            (pInfo.vMajor == NATRON_VERSION_MAJOR && pInfo.vMinor > NATRON_VERSION_MINOR) ||
-            (pInfo.vMajor == NATRON_VERSION_MAJOR && pInfo.vMinor == NATRON_VERSION_MINOR && pInfo.vRev > NATRON_VERSION_REVISION)) {
-            QString message = tr("This project was saved with a more recent version (%1.%2.%3) of %4. Projects are not forward compatible and may only be opened in a version of %4 equal or more recent than the version that saved it.").arg(pInfo.vMajor).arg(pInfo.vMinor).arg(pInfo.vRev).arg(QString::fromUtf8(NATRON_APPLICATION_NAME));
-            throw std::runtime_error(message.toStdString());
-        }
-        throw std::runtime_error( tr("Unrecognized or damaged project file:").toStdString() + ' ' + e.what());
+        throwProjectLoadingError( getApp(), e.what() );
+    } catch (...) {
+        throwProjectLoadingError(getApp(), 0);
+    }
+
+    return ret;
+} // Project::loadXMLProjectInternal
+
+bool
+Project::loadBinaryProjectInternal(const QString & filePath,
+                                   const QString & journalFilePath,
+                                   const QString & path,
+                                   const QString & name,
+                                   bool isAutoSave,
+                                   bool* mustSave)
+{
+    bool ret = false;
+    LoadProjectSplashScreen_RAII __raii_splashscreen__(getApp(), name);
+
+    try {
+        ProjectBinaryReader reader;
+        reader.open( filePath.toStdString() );
+        {
+            FlagSetter __raii_loadingProjectInternal__(true, &_imp->isLoadingProjectInternal, &_imp->isLoadingProjectMutex);
+
+            ProjectSerialization projectSerializationObj( getApp() );
+            reader.readProjectHeader(&projectSerializationObj);
+            // Nodes are decoded in parallel, they are then restored in order by load()
+            reader.readAllNodes(&projectSerializationObj);
+            if ( !journalFilePath.isEmpty() ) {
+                AutoSaveJournal::replay(journalFilePath, &projectSerializationObj);
+            }
+            ret = load(projectSerializationObj, name, path, mustSave);
+        } // __raii_loadingProjectInternal__
+
+        if ( !reader.isBackgroundProject() ) {
+            std::istringstream ss( reader.getGuiData() );
+            boost::archive::xml_iarchive iArchive(ss);
+            getApp()->loadProjectGui(isAutoSave, iArchive);
+        }
+    } catch (const std::exception &e) {
+        throwProjectLoadingError( getApp(), e.what() );
     } catch (...) {
-        const ProjectBeingLoadedInfo& pInfo = getApp()->getProjectBeingLoadedInfo();
-        if (pInfo.vMajor > NATRON_VERSION_MAJOR ||
-            (pInfo.vMajor == NATRON_VERSION_MAJOR && pInfo.vMinor > NATRON_VERSION_MINOR) ||
-            (pInfo.vMajor == NATRON_VERSION_MAJOR && pInfo.vMinor == NATRON_VERSION_MINOR && pInfo.vRev > NATRON_VERSION_REVISION)) {
-            QString message = tr("This project was saved with a more recent version (%1.%2.%3) of %4. Projects are not forward compatible and may only be opened in a version of %4 equal or more recent than the version that saved it.").arg(pInfo.vMajor).arg(pInfo.vMinor).arg(pInfo.vRev).arg(QString::fromUtf8(NATRON_APPLICATION_NAME));
-            throw std::runtime_error(message.toStdString());
+        throwProjectLoadingError(getApp(), 0);
+    }
+
+    return ret;
+} // Project::loadBinaryProjectInternal
+
+bool
+Project::loadProjectInternal(const QString & path,
+                             const QString & name,
+                             bool isAutoSave,
+                             bool isUntitledAutosave,
+                             bool* mustSave)
+{
+    FlagSetter loadingProjectRAII(true, &_imp->isLoadingProject, &_imp->isLoadingProjectMutex);
+    QString filePath = path + name;
+    std::cout << tr("Loading project: %1").arg(filePath).toStdString() << std::endl;
+
+    if ( !QFile::exists(filePath) ) {
+        throw std::invalid_argument( QString( filePath + QString::fromUtf8(" : no such file.") ).toStdString() );
+    }
+
+    // An auto-save journal is loaded by replaying it over its base file
+    QString journalFilePath;
+    QString baseFilePath = filePath;
+    if ( AutoSaveJournal::isJournalFile(filePath) ) {
+        journalFilePath = filePath;
+        baseFilePath = AutoSaveJournal::readBaseFilePath(journalFilePath);
+        if ( baseFilePath.isEmpty() ) {
+            throw std::runtime_error( tr("The auto-save journal %1 does not match its base project file any longer.").arg(filePath).toStdString() );
         }
-        throw std::runtime_error( tr("Unrecognized or damaged project file").toStdString() );
+    }
+
+    // The journal state must be computed from the loaded project, before any change
+    _imp->autoSaveJournal.clear();
+
+    bool ret = false;
+    if ( ProjectBinaryReader::isBinaryProjectFile( baseFilePath.toStdString() ) ) {
+        ret = loadBinaryProjectInternal(baseFilePath, journalFilePath, path, name, isAutoSave, mustSave);
+    } else {
+        ret = loadXMLProjectInternal(baseFilePath, journalFilePath, path, name, isAutoSave, mustSave);
     }
 
     Format f;
@@ -383,6 +474,13 @@ Project::loadProjectInternal(const QString & path,
         Q_EMIT projectNameChanged(projectPath + projectFilename, true);
     } else {
         Q_EMIT projectNameChanged(path + name, false);
+
+        // Journal the changes made from now on against the project file
+        if ( !getApp()->isBackground() && appPTR->getCurrentSettings()->isIncrementalAutoSaveEnabled() ) {
+            AutoSaveJournal::NodesStateMap nodesState;
+            AutoSaveJournal::getNodesState(shared_from_this(), &nodesState);
+            _imp->autoSaveJournal.reset(AutoSaveJournal::getJournalFilePath( filePath + QString::fromUtf8(".autosave") ), filePath, nodesState);
+        }
     }
 
     ///Try to take the project lock by creating a lock file
@@ -440,25 +538,66 @@ Project::saveProject_imp(const QString & path,
 
     QString ret;
 
+    // With incremental auto-save, the changes made after this save are journaled against the saved file.
+    // The state of the nodes is taken before serializing so that a change made meanwhile is not missed.
+    bool journalEnabled = updateProjectProperties && !getApp()->isBackground() &&
+                          !name.contains( QString::fromUtf8("RENDER_SAVE") ) &&
+                          appPTR->getCurrentSettings()->isIncrementalAutoSaveEnabled();
+    AutoSaveJournal::NodesStateMap nodesState;
+
     try {
         if (!autoS) {
             //if  (!isSaveUpToDate() || !QFile::exists(path+name)) {
             //We are saving, do not autosave.
             _imp->autoSaveTimer->stop();
 
+            if (journalEnabled) {
+                AutoSaveJournal::getNodesState(shared_from_this(), &nodesState);
+            }
+
             ret = saveProjectInternal(path, name, false, updateProjectProperties);
 
             ///We just saved, remove the last auto-save which is now obsolete
             removeLastAutosave();
 
+            if (journalEnabled) {
+                _imp->autoSaveJournal.reset(AutoSaveJournal::getJournalFilePath( ret + QString::fromUtf8(".autosave") ), ret, nodesState);
+            }
             //}
         } else {
-            if (updateProjectProperties) {
-                ///Replace the last auto-save with a more recent one
-                removeLastAutosave();
+            bool journaled = false;
+            if ( journalEnabled && _imp->autoSaveJournal.isActive() && !_imp->autoSaveJournal.mustCompact() ) {
+                try {
+                    _imp->autoSaveJournal.append( shared_from_this() );
+                    journaled = true;
+                } catch (const std::exception & e) {
+                    // Fallback to a full auto-save
+                    qDebug() << "Auto-save journal failure: " << e.what();
+                }
             }
 
-            ret = saveProjectInternal(path, name, true, updateProjectProperties);
+            if (journaled) {
+                ret = _imp->autoSaveJournal.getJournalFilePath();
+                QString projectPath = QString::fromUtf8( _imp->getProjectPath().c_str() );
+                QString projectFilename = QString::fromUtf8( _imp->getProjectFilename().c_str() );
+                Q_EMIT projectNameChanged(projectPath + projectFilename, true);
+                _imp->lastAutoSave = QDateTime::currentDateTime();
+            } else {
+                if (journalEnabled) {
+                    AutoSaveJournal::getNodesState(shared_from_this(), &nodesState);
+                }
+
+                if (updateProjectProperties) {
+                    ///Replace the last auto-save with a more recent one
+                    removeLastAutosave();
+                }
+
+                ret = saveProjectInternal(path, name, true, updateProjectProperties);
+
+                if (journalEnabled) {
+                    _imp->autoSaveJournal.reset(AutoSaveJournal::getJournalFilePath(ret), ret, nodesState);
+                }
+            }
         }
     } catch (const std::exception & e) {
         if (!autoS) {
@@ -556,9 +695,11 @@ Project::saveProjectInternal(const QString & path,
     StrUtils::ensureLastPathSeparator(tmpFilename);
     tmpFilename.append( QString::number( time.toMSecsSinceEpoch() ) );
 
+    // The project is saved in the binary format if its filename has the binary extension (this includes its auto-saves)
+    bool binaryFormat = ProjectBinaryReader::isBinaryProjectFileName( name.toStdString() );
     {
         FStreamsSupport::ofstream ofile;
-        FStreamsSupport::open( &ofile, tmpFilename.toStdString() );
+        FStreamsSupport::open( &ofile, tmpFilename.toStdString(), binaryFormat ? (std::ios_base::out | std::ios_base::binary) : std::ios_base::out );
         if (!ofile) {
             throw std::runtime_error( tr("Failed to open file ").toStdString() + tmpFilename.toStdString() );
         }
@@ -574,16 +715,30 @@ Project::saveProjectInternal(const QString & path,
         }
 
         try {
-            boost::archive::xml_oarchive oArchive(ofile);
             bool bgProject = getApp()->isBackground();
-            oArchive << boost::serialization::make_nvp("Background_project", bgProject);
             ProjectSerialization projectSerializationObj( getApp() );
             save(&projectSerializationObj);
-            oArchive << boost::serialization::make_nvp("Project", projectSerializationObj);
-            if (!bgProject) {
-                AppInstancePtr app = getApp();
-                if (app) {
-                    app->saveProjectGui(oArchive);
+            if (binaryFormat) {
+                std::string guiData;
+                if (!bgProject) {
+                    std::stringstream ss;
+                    {
+                        // xml_oarchive must be destroyed before obtaining ss.str(), or the </boost_serialization> tag is missing
+                        boost::archive::xml_oarchive guiArchive(ss);
+                        getApp()->saveProjectGui(guiArchive);
+                    }
+                    guiData = ss.str();
+                }
+                ProjectBinaryWriter::write(ofile, projectSerializationObj, bgProject, guiData);
+            } else {
+                boost::archive::xml_oarchive oArchive(ofile);
+                oArchive << boost::serialization::make_nvp("Background_project", bgProject);
+                oArchive << boost::serialization::make_nvp("Project", projectSerializationObj);
+                if (!bgProject) {
+                    AppInstancePtr app = getApp();
+                    if (app) {
+                        app->saveProjectGui(oArchive);
+                    }
                 }
             }
         } catch (...) {
@@ -726,10 +881,14 @@ Project::findAutoSaveForProject(const QString& projectPath,
     QDir savesDir(projectPath);
     QStringList entries = savesDir.entryList(QDir::Files | QDir::NoDotAndDotDot);
 
+    // Prefer a valid auto-save journal over its base auto-save
+    AutoSaveJournal::filterAutoSaves(projectPath, &entries);
+
+    bool isBinaryProject = ProjectBinaryReader::isBinaryProjectFileName( projectName.toStdString() );
     Q_FOREACH(const QString &entry, entries) {
         QString ntpExt( QLatin1Char('.') );
 
-        ntpExt.append( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) );
+        ntpExt.append( QString::fromUtf8(isBinaryProject ? NATRON_PROJECT_BINARY_FILE_EXT : NATRON_PROJECT_FILE_EXT) );
         QString searchStr(ntpExt);
         QString autosaveSuffix( QString::fromUtf8(".autosave") );
         searchStr.append(autosaveSuffix);
@@ -1678,6 +1837,101 @@ Project::isLoadingProjectInternal() const
     return _imp->isLoadingProjectInternal;
 }
 
+void
+Project::beginNodesChangesBatch()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    ++_imp->nodesChangesBatchLevel;
+}
+
+void
+Project::endNodesChangesBatch()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    assert(_imp->nodesChangesBatchLevel > 0);
+    if ( (_imp->nodesChangesBatchLevel == 0) || (--_imp->nodesChangesBatchLevel > 0) ) {
+        return;
+    }
+
+    // Propagate the hash of all the nodes changed during the batch at once
+    NodesList dirtyNodes;
+    for (std::map<Node*, NodeWPtr>::iterator it = _imp->batchedHashNodes.begin(); it != _imp->batchedHashNodes.end(); ++it) {
+        NodePtr node = it->second.lock();
+        if (node) {
+            dirtyNodes.push_back(node);
+        }
+    }
+    _imp->batchedHashNodes.clear();
+    if ( !dirtyNodes.empty() ) {
+        Node::computeHashForNodes(dirtyNodes);
+    }
+
+    // Now that hashes are up to date, the nodes can be evaluated
+    std::map<EffectInstance*, ProjectPrivate::BatchedEvaluation> evaluations;
+    evaluations.swap(_imp->batchedEvaluations);
+    for (std::map<EffectInstance*, ProjectPrivate::BatchedEvaluation>::iterator it = evaluations.begin(); it != evaluations.end(); ++it) {
+        EffectInstancePtr effect = it->second.effect.lock();
+        if (effect) {
+            effect->evaluate(it->second.isSignificant, it->second.refreshMetadata);
+        }
+    }
+}
+
+bool
+Project::deferHashComputation(const NodePtr& node)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    if (_imp->nodesChangesBatchLevel == 0) {
+        return false;
+    }
+    _imp->batchedHashNodes[node.get()] = node;
+
+    return true;
+}
+
+bool
+Project::deferEvaluation(const EffectInstancePtr& effect,
+                         bool isSignificant,
+                         bool refreshMetadata)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    if (_imp->nodesChangesBatchLevel == 0) {
+        return false;
+    }
+    std::map<EffectInstance*, ProjectPrivate::BatchedEvaluation>::iterator found = _imp->batchedEvaluations.find( effect.get() );
+    if ( found == _imp->batchedEvaluations.end() ) {
+        ProjectPrivate::BatchedEvaluation e;
+        e.effect = effect;
+        e.isSignificant = isSignificant;
+        e.refreshMetadata = refreshMetadata;
+        _imp->batchedEvaluations.insert( std::make_pair(effect.get(), e) );
+    } else {
+        found->second.isSignificant |= isSignificant;
+        found->second.refreshMetadata |= refreshMetadata;
+    }
+
+    return true;
+}
+
+NodesChangesBatch_RAII::NodesChangesBatch_RAII(const AppInstancePtr& app)
+    : _project()
+{
+    if (app) {
+        ProjectPtr project = app->getProject();
+        project->beginNodesChangesBatch();
+        _project = project;
+    }
+}
+
+NodesChangesBatch_RAII::~NodesChangesBatch_RAII()
+{
+    ProjectPtr project = _project.lock();
+
+    if (project) {
+        project->endNodesChangesBatch();
+    }
+}
+
 bool
 Project::isGraphWorthLess() const
 {
@@ -1797,7 +2051,20 @@ Project::removeLastAutosave()
     QString filepath = getLastAutoSaveFilePath();
 
     if ( !filepath.isEmpty() ) {
-        QFile::remove(filepath);
+        if ( AutoSaveJournal::isJournalFile(filepath) ) {
+            AutoSaveJournal::removeJournalFile(filepath);
+        } else {
+            QFile::remove(filepath);
+        }
+    }
+
+    /*
+     * The journal of incremental auto-saves is obsolete as well
+     */
+    QString journalFilePath = _imp->autoSaveJournal.getJournalFilePath();
+    _imp->autoSaveJournal.clear();
+    if ( !journalFilePath.isEmpty() ) {
+        QFile::remove(journalFilePath);
     }
 
     /*
@@ -1830,7 +2097,13 @@ Project::clearAutoSavesDir()
         QString searchStr( QLatin1Char('.') );
         searchStr.append( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) );
         searchStr.append( QLatin1Char('.') );
+        QString binarySearchStr( QLatin1Char('.') );
+        binarySearchStr.append( QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) );
+        binarySearchStr.append( QLatin1Char('.') );
         int suffixPos = entry.indexOf(searchStr);
+        if (suffixPos == -1) {
+            suffixPos = entry.indexOf(binarySearchStr);
+        }
         if (suffixPos != -1) {
             QString dirToRemove = savesDir.path();
             if ( !dirToRemove.endsWith( QLatin1Char('/') ) ) {
@@ -1966,6 +2239,7 @@ Project::doResetEnd(bool aboutToQuit)
             _imp->autoSaveTimer->stop();
             _imp->additionalFormats.clear();
         }
+        _imp->autoSaveJournal.clear();
         getApp()->removeAllKeyframesIndicators();
 
         Q_EMIT projectNameChanged(QString::fromUtf8(NATRON_PROJECT_UNTITLED), false);
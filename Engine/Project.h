@@ -132,6 +132,27 @@ public:
 
     bool isLoadingProjectInternal() const;
 
+    /**
+     * @brief Opens a batch of changes spanning several nodes, e.g: a single undo/redo step.
+     * Until the outermost batch is closed, node hashes are not propagated and nodes are not evaluated.
+     * Closing the batch recomputes the hash of all the nodes changed during the batch and of their outputs
+     * in a single topological pass (see Node::computeHashForNodes), then evaluates the changed nodes.
+     * Batches can be nested. This must be called on the main-thread.
+     **/
+    void beginNodesChangesBatch();
+
+    void endNodesChangesBatch();
+
+    /**
+     * @brief Returns true if a batch is opened, in which case the node hash will be computed when it is closed.
+     **/
+    bool deferHashComputation(const NodePtr& node);
+
+    /**
+     * @brief Returns true if a batch is opened, in which case the effect will be evaluated when it is closed.
+     **/
+    bool deferEvaluation(const EffectInstancePtr& effect, bool isSignificant, bool refreshMetadata);
+
     QString getProjectFilename() const WARN_UNUSED_RETURN;
 
     QString getLastAutoSaveFilePath() const;
@@ -386,6 +407,12 @@ private:
     bool loadProjectInternal(const QString & path, const QString & name, bool isAutoSave,
                              bool isUntitledAutosave, bool* mustSave);
 
+    bool loadXMLProjectInternal(const QString & filePath, const QString & journalFilePath, const QString & path, const QString & name,
+                                bool isAutoSave, bool* mustSave);
+
+    bool loadBinaryProjectInternal(const QString & filePath, const QString & journalFilePath, const QString & path, const QString & name,
+                                   bool isAutoSave, bool* mustSave);
+
     QString saveProjectInternal(const QString & path, const QString & name, bool autosave, bool updateProjectProperties);
 
 
@@ -431,6 +458,20 @@ private:
     boost::scoped_ptr<ProjectPrivate> _imp;
 };
 
+/**
+ * @brief Opens a nodes changes batch for the lifetime of the object, see Project::beginNodesChangesBatch
+ **/
+class NodesChangesBatch_RAII
+{
+    ProjectWPtr _project;
+
+public:
+
+    NodesChangesBatch_RAII(const AppInstancePtr& app);
+
+    ~NodesChangesBatch_RAII();
+};
+
 NATRON_NAMESPACE_EXIT
 
 #endif // NATRON_ENGINE_PROJECT_H
@@ -0,0 +1,554 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ProjectBinarySerialization.h"
+
+#include <cassert>
+#include <cstring> // memcmp
+#include <sstream> // stringstream
+#include <streambuf>
+#include <stdexcept>
+
+#if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+GCC_DIAG_OFF(unused-parameter)
+// /opt/local/include/boost/serialization/smart_cast.hpp:254:25: warning: unused parameter 'u' [-Wunused-parameter]
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+GCC_DIAG_ON(unused-parameter)
+#endif
+
+#include <QtCore/QDebug>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#include "Global/FStreamsSupport.h"
+
+#include "Engine/AppInstance.h"
+#include "Engine/NodeSerialization.h"
+#include "Engine/ProjectSerialization.h"
+
+NATRON_NAMESPACE_ENTER
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief A read-only stream buffer over a memory range, so that archives can be decoded
+ * directly from the file buffer without copying each blob.
+ **/
+class MemoryStreamBuf
+    : public std::streambuf
+{
+public:
+
+    MemoryStreamBuf(const char* data,
+                    std::size_t size)
+    {
+        char* begin = const_cast<char*>(data);
+
+        setg(begin, begin, begin + size);
+    }
+};
+
+void
+writeU32(std::ostream& stream,
+         U32 value)
+{
+    char bytes[4];
+
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = (char)( (value >> (8 * i)) & 0xff );
+    }
+    stream.write(bytes, 4);
+}
+
+void
+writeU64(std::ostream& stream,
+         U64 value)
+{
+    char bytes[8];
+
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = (char)( (value >> (8 * i)) & 0xff );
+    }
+    stream.write(bytes, 8);
+}
+
+void
+writeString(std::ostream& stream,
+            const std::string& str)
+{
+    writeU32( stream, (U32)str.size() );
+    stream.write( str.data(), str.size() );
+}
+
+/**
+ * @brief Reads the fixed-size part of the file, throwing if the file is truncated.
+ **/
+class BufferReader
+{
+    const std::string& _buffer;
+    std::size_t _pos;
+
+public:
+
+    BufferReader(const std::string& buffer,
+                 std::size_t pos)
+        : _buffer(buffer)
+        , _pos(pos)
+    {
+    }
+
+    void ensureAvailable(U64 nBytes) const
+    {
+        if ( nBytes > (U64)(_buffer.size() - _pos) ) {
+            throw std::runtime_error("Damaged binary project file: unexpected end of file");
+        }
+    }
+
+    U32 readU32()
+    {
+        ensureAvailable(4);
+        U32 ret = 0;
+        for (int i = 0; i < 4; ++i) {
+            ret |= ( (U32)(unsigned char)_buffer[_pos + i] ) << (8 * i);
+        }
+        _pos += 4;
+
+        return ret;
+    }
+
+    U64 readU64()
+    {
+        ensureAvailable(8);
+        U64 ret = 0;
+        for (int i = 0; i < 8; ++i) {
+            ret |= ( (U64)(unsigned char)_buffer[_pos + i] ) << (8 * i);
+        }
+        _pos += 8;
+
+        return ret;
+    }
+
+    std::string readString()
+    {
+        U32 size = readU32();
+
+        ensureAvailable(size);
+        std::string ret = _buffer.substr(_pos, size);
+        _pos += size;
+
+        return ret;
+    }
+};
+
+std::string
+encodeNode(const NodeSerializationPtr& node)
+{
+    // An empty result indicates a failure: QtConcurrent does not propagate std exceptions.
+    try {
+        return encodeBinaryNodeSerialization(*node);
+    } catch (const std::exception& e) {
+        qDebug() << "Failed to encode node" << node->getNodeScriptName().c_str() << ":" << e.what();
+
+        return std::string();
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+std::string
+encodeBinaryNodeSerialization(const NodeSerialization& node)
+{
+    std::ostringstream ss;
+    {
+        // binary_oarchive must be destroyed before obtaining ss.str()
+        boost::archive::binary_oarchive oArchive(ss);
+        oArchive << boost::serialization::make_nvp("item", node);
+    }
+
+    return ss.str();
+}
+
+NodeSerializationPtr
+decodeBinaryNodeSerialization(const char* data,
+                              std::size_t size)
+{
+    MemoryStreamBuf buf(data, size);
+    std::istream stream(&buf);
+    boost::archive::binary_iarchive iArchive(stream);
+    NodeSerializationPtr ret = boost::make_shared<NodeSerialization>();
+
+    iArchive >> boost::serialization::make_nvp("item", *ret);
+
+    return ret;
+}
+
+std::string
+encodeBinaryProjectHeader(const ProjectSerialization& project)
+{
+    std::ostringstream ss;
+    {
+        boost::archive::binary_oarchive oArchive(ss);
+        project.saveWithoutNodes(oArchive);
+    }
+
+    return ss.str();
+}
+
+void
+decodeBinaryProjectHeader(const char* data,
+                          std::size_t size,
+                          unsigned int projectSerializationVersion,
+                          ProjectSerialization* project)
+{
+    if (projectSerializationVersion > PROJECT_SERIALIZATION_VERSION) {
+        throw std::runtime_error("The project was produced with a more recent and incompatible version of " NATRON_APPLICATION_NAME);
+    }
+    MemoryStreamBuf buf(data, size);
+    std::istream stream(&buf);
+    boost::archive::binary_iarchive iArchive(stream);
+
+    project->loadWithoutNodes(iArchive, projectSerializationVersion);
+}
+
+void
+ProjectBinaryWriter::write(std::ostream& stream,
+                           const ProjectSerialization& project,
+                           bool isBackgroundProject,
+                           const std::string& guiData)
+{
+    std::string header = encodeBinaryProjectHeader(project);
+
+    const std::list<NodeSerializationPtr>& nodesList = project.getNodesSerialization().getNodesSerialization();
+    std::vector<NodeSerializationPtr> nodes( nodesList.begin(), nodesList.end() );
+    QFuture<std::string> future = QtConcurrent::mapped(nodes, encodeNode);
+    future.waitForFinished();
+
+    std::vector<std::string> blobs( nodes.size() );
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        blobs[i] = future.resultAt(i);
+        if ( blobs[i].empty() ) {
+            throw std::runtime_error("Failed to encode node " + nodes[i]->getNodeScriptName() + " in the binary project");
+        }
+    }
+
+    // Compute the size of the fixed part to know where the blobs start
+    U64 indexSize = NATRON_PROJECT_BINARY_MAGIC_SIZE + 4 + 4 + 4 + 2 * 16 + 4;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        indexSize += 4 + nodes[i]->getNodeScriptName().size() + 4 + nodes[i]->getPluginID().size() + 16;
+    }
+
+    U64 offset = indexSize;
+    stream.write(NATRON_PROJECT_BINARY_MAGIC, NATRON_PROJECT_BINARY_MAGIC_SIZE);
+    writeU32(stream, NATRON_PROJECT_BINARY_VERSION);
+    writeU32(stream, isBackgroundProject ? eProjectBinaryFlagBackgroundProject : eProjectBinaryFlagNone);
+    writeU32(stream, PROJECT_SERIALIZATION_VERSION);
+    writeU64(stream, offset);
+    writeU64( stream, header.size() );
+    offset += header.size();
+    writeU64(stream, offset);
+    writeU64( stream, guiData.size() );
+    offset += guiData.size();
+    writeU32( stream, (U32)nodes.size() );
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        writeString( stream, nodes[i]->getNodeScriptName() );
+        writeString( stream, nodes[i]->getPluginID() );
+        writeU64(stream, offset);
+        writeU64( stream, blobs[i].size() );
+        offset += blobs[i].size();
+    }
+
+    stream.write( header.data(), header.size() );
+    stream.write( guiData.data(), guiData.size() );
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        stream.write( blobs[i].data(), blobs[i].size() );
+    }
+
+    if (!stream) {
+        throw std::runtime_error("Failed to write the binary project");
+    }
+} // ProjectBinaryWriter::write
+
+struct ProjectBinaryReaderPrivate
+{
+    // The whole file: it is compact enough to be read at once, decoding is what is deferred.
+    std::string buffer;
+    U32 flags;
+    U32 projectSerializationVersion;
+    U64 headerOffset, headerSize;
+    U64 guiOffset, guiSize;
+    std::vector<ProjectBinaryNodeEntry> nodes;
+
+    ProjectBinaryReaderPrivate()
+        : buffer()
+        , flags(0)
+        , projectSerializationVersion(0)
+        , headerOffset(0)
+        , headerSize(0)
+        , guiOffset(0)
+        , guiSize(0)
+        , nodes()
+    {
+    }
+
+    void checkRange(U64 offset,
+                    U64 size) const
+    {
+        if ( (offset > buffer.size()) || (size > buffer.size() - offset) ) {
+            throw std::runtime_error("Damaged binary project file: invalid offset");
+        }
+    }
+};
+
+ProjectBinaryReader::ProjectBinaryReader()
+    : _imp( new ProjectBinaryReaderPrivate() )
+{
+}
+
+ProjectBinaryReader::~ProjectBinaryReader()
+{
+}
+
+bool
+ProjectBinaryReader::isBinaryProjectFile(const std::string& filePath)
+{
+    FStreamsSupport::ifstream ifile;
+
+    FStreamsSupport::open(&ifile, filePath, std::ios_base::in | std::ios_base::binary);
+    if (!ifile) {
+        return false;
+    }
+    char magic[NATRON_PROJECT_BINARY_MAGIC_SIZE];
+    ifile.read(magic, NATRON_PROJECT_BINARY_MAGIC_SIZE);
+    if ( ifile.gcount() != NATRON_PROJECT_BINARY_MAGIC_SIZE ) {
+        return false;
+    }
+
+    return std::memcmp(magic, NATRON_PROJECT_BINARY_MAGIC, NATRON_PROJECT_BINARY_MAGIC_SIZE) == 0;
+}
+
+bool
+ProjectBinaryReader::isBinaryProjectFileName(const std::string& fileName)
+{
+    return boost::algorithm::ends_with(fileName, "." NATRON_PROJECT_BINARY_FILE_EXT) ||
+           boost::algorithm::ends_with(fileName, "." NATRON_PROJECT_BINARY_FILE_EXT ".autosave");
+}
+
+void
+ProjectBinaryReader::open(const std::string& filePath)
+{
+    FStreamsSupport::ifstream ifile;
+
+    FStreamsSupport::open(&ifile, filePath, std::ios_base::in | std::ios_base::binary);
+    if (!ifile) {
+        throw std::runtime_error("Failed to open " + filePath);
+    }
+    ifile.seekg(0, std::ios_base::end);
+    std::streamoff fileSize = ifile.tellg();
+    ifile.seekg(0, std::ios_base::beg);
+    if (fileSize < NATRON_PROJECT_BINARY_MAGIC_SIZE) {
+        throw std::runtime_error(filePath + " is not a binary project file");
+    }
+    _imp->buffer.resize( (std::size_t)fileSize );
+    ifile.read( &_imp->buffer[0], fileSize );
+    if (!ifile) {
+        throw std::runtime_error("Failed to read " + filePath);
+    }
+
+    if ( std::memcmp(_imp->buffer.data(), NATRON_PROJECT_BINARY_MAGIC, NATRON_PROJECT_BINARY_MAGIC_SIZE) != 0 ) {
+        throw std::runtime_error(filePath + " is not a binary project file");
+    }
+
+    BufferReader reader(_imp->buffer, NATRON_PROJECT_BINARY_MAGIC_SIZE);
+    U32 version = reader.readU32();
+    if (version > NATRON_PROJECT_BINARY_VERSION) {
+        throw std::runtime_error("The binary project was produced with a more recent and incompatible version of " NATRON_APPLICATION_NAME);
+    }
+    _imp->flags = reader.readU32();
+    // Version 1 did not record the project serialization version, it was the one of the application that wrote it
+    _imp->projectSerializationVersion = (version >= 2) ? reader.readU32() : PROJECT_SERIALIZATION_CHANGE_VERSION_SERIALIZATION;
+    _imp->headerOffset = reader.readU64();
+    _imp->headerSize = reader.readU64();
+    _imp->checkRange(_imp->headerOffset, _imp->headerSize);
+    _imp->guiOffset = reader.readU64();
+    _imp->guiSize = reader.readU64();
+    _imp->checkRange(_imp->guiOffset, _imp->guiSize);
+
+    U32 nNodes = reader.readU32();
+    _imp->nodes.resize(nNodes);
+    for (U32 i = 0; i < nNodes; ++i) {
+        ProjectBinaryNodeEntry& entry = _imp->nodes[i];
+        entry.scriptName = reader.readString();
+        entry.pluginID = reader.readString();
+        entry.offset = reader.readU64();
+        entry.size = reader.readU64();
+        _imp->checkRange(entry.offset, entry.size);
+    }
+} // ProjectBinaryReader::open
+
+bool
+ProjectBinaryReader::isBackgroundProject() const
+{
+    return (_imp->flags & eProjectBinaryFlagBackgroundProject) != 0;
+}
+
+unsigned int
+ProjectBinaryReader::getProjectSerializationVersion() const
+{
+    return _imp->projectSerializationVersion;
+}
+
+void
+ProjectBinaryReader::readProjectHeader(ProjectSerialization* project) const
+{
+    decodeBinaryProjectHeader(_imp->buffer.data() + _imp->headerOffset, _imp->headerSize, _imp->projectSerializationVersion, project);
+}
+
+const std::vector<ProjectBinaryNodeEntry>&
+ProjectBinaryReader::getNodesIndex() const
+{
+    return _imp->nodes;
+}
+
+NodeSerializationPtr
+ProjectBinaryReader::readNode(std::size_t index) const
+{
+    assert( index < _imp->nodes.size() );
+    const ProjectBinaryNodeEntry& entry = _imp->nodes[index];
+
+    return decodeBinaryNodeSerialization(_imp->buffer.data() + entry.offset, entry.size);
+}
+
+static NodeSerializationPtr
+readNodeNoThrow(const ProjectBinaryReader* reader,
+                std::size_t index)
+{
+    // A null result indicates a failure: QtConcurrent does not propagate std exceptions.
+    try {
+        return reader->readNode(index);
+    } catch (const std::exception& e) {
+        qDebug() << "Failed to decode node" << reader->getNodesIndex()[index].scriptName.c_str() << ":" << e.what();
+
+        return NodeSerializationPtr();
+    }
+}
+
+void
+ProjectBinaryReader::readAllNodes(ProjectSerialization* project) const
+{
+    std::vector<std::size_t> indexes( _imp->nodes.size() );
+
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+        indexes[i] = i;
+    }
+
+    QFuture<NodeSerializationPtr> future = QtConcurrent::mapped( indexes, boost::bind(readNodeNoThrow, this, _1) );
+    future.waitForFinished();
+
+    // Keep the saving order, nodes are restored in that order
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+        NodeSerializationPtr node = future.resultAt(i);
+        if (!node) {
+            throw std::runtime_error("Damaged binary project file: failed to decode node " + _imp->nodes[i].scriptName);
+        }
+        project->addNodeSerialization(node);
+    }
+}
+
+std::string
+ProjectBinaryReader::getGuiData() const
+{
+    return _imp->buffer.substr(_imp->guiOffset, _imp->guiSize);
+}
+
+void
+convertProjectFile(const AppInstancePtr& app,
+                   const std::string& inputFilePath,
+                   const std::string& outputFilePath)
+{
+    ProjectSerialization projectSerializationObj(app);
+    bool bgProject = true;
+    // The Gui is carried as a standalone xml archive: it is small and its serialization lives in the Gui library.
+    std::string guiData;
+
+    if ( ProjectBinaryReader::isBinaryProjectFile(inputFilePath) ) {
+        ProjectBinaryReader reader;
+        reader.open(inputFilePath);
+        reader.readProjectHeader(&projectSerializationObj);
+        reader.readAllNodes(&projectSerializationObj);
+        bgProject = reader.isBackgroundProject();
+        guiData = reader.getGuiData();
+    } else {
+        FStreamsSupport::ifstream ifile;
+        FStreamsSupport::open(&ifile, inputFilePath);
+        if (!ifile) {
+            throw std::runtime_error("Failed to open " + inputFilePath);
+        }
+        boost::archive::xml_iarchive iArchive(ifile);
+        iArchive >> boost::serialization::make_nvp("Background_project", bgProject);
+        iArchive >> boost::serialization::make_nvp("Project", projectSerializationObj);
+        if ( !bgProject && !app->isBackground() ) {
+            std::stringstream ss;
+            {
+                // xml_oarchive must be destroyed before obtaining ss.str(), or the </boost_serialization> tag is missing
+                boost::archive::xml_oarchive guiArchive(ss);
+                app->copyProjectGui(iArchive, guiArchive);
+            }
+            guiData = ss.str();
+        }
+    }
+
+    if ( guiData.empty() || app->isBackground() ) {
+        // The Gui could not be carried over, the output project must not expect one
+        bgProject = true;
+        guiData.clear();
+    }
+
+    bool outputIsBinary = ProjectBinaryReader::isBinaryProjectFileName(outputFilePath);
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open( &ofile, outputFilePath, outputIsBinary ? (std::ios_base::out | std::ios_base::binary) : std::ios_base::out );
+    if (!ofile) {
+        throw std::runtime_error("Failed to open file " + outputFilePath);
+    }
+
+    if (outputIsBinary) {
+        ProjectBinaryWriter::write(ofile, projectSerializationObj, bgProject, guiData);
+    } else {
+        boost::archive::xml_oarchive oArchive(ofile);
+        oArchive << boost::serialization::make_nvp("Background_project", bgProject);
+        oArchive << boost::serialization::make_nvp("Project", projectSerializationObj);
+        if (!bgProject) {
+            std::istringstream ss(guiData);
+            boost::archive::xml_iarchive guiArchive(ss);
+            app->copyProjectGui(guiArchive, oArchive);
+        }
+    }
+} // convertProjectFile
+
+NATRON_NAMESPACE_EXIT
@@ -0,0 +1,188 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_ProjectBinarySerialization_h
+#define Engine_ProjectBinarySerialization_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+/*
+   Layout of a binary project file (all integers are little-endian):
+
+   char[8]  NATRON_PROJECT_BINARY_MAGIC
+   U32      container version
+   U32      flags (see ProjectBinaryFlagsEnum)
+   U32      version of the project serialization (PROJECT_SERIALIZATION_VERSION) of the project header
+   U64 U64  offset, size of the project header: boost binary archive of ProjectSerialization::saveWithoutNodes
+   U64 U64  offset, size of the Gui data: boost xml archive of the project Gui (empty for background projects)
+   U32      number of top-level nodes
+   for each node:
+       U32 + bytes  script-name
+       U32 + bytes  plugin ID
+       U64 U64      offset, size of the node: boost binary archive of a NodeSerialization
+   ... blobs
+
+   Since each node lives in its own archive, nodes can be decoded on demand from the index, or all at
+   once in parallel. Note that boost binary archives are not portable across architectures with a
+   different endianness or word size: the XML format remains the interchange format.
+ */
+#define NATRON_PROJECT_BINARY_MAGIC "NatronPB"
+#define NATRON_PROJECT_BINARY_MAGIC_SIZE 8
+#define NATRON_PROJECT_BINARY_VERSION 2
+
+NATRON_NAMESPACE_ENTER
+
+enum ProjectBinaryFlagsEnum
+{
+    eProjectBinaryFlagNone = 0x0,
+    eProjectBinaryFlagBackgroundProject = 0x1,
+};
+
+struct ProjectBinaryNodeEntry
+{
+    std::string scriptName;
+    std::string pluginID;
+    U64 offset;
+    U64 size;
+
+    ProjectBinaryNodeEntry()
+        : scriptName()
+        , pluginID()
+        , offset(0)
+        , size(0)
+    {
+    }
+};
+
+class ProjectBinaryWriter
+{
+public:
+
+    /**
+     * @brief Write the given project to the stream. Nodes are encoded in parallel.
+     * @param guiData The boost xml archive of the project Gui, may be empty.
+     * This function throws a std::exception upon failure.
+     **/
+    static void write(std::ostream& stream,
+                      const ProjectSerialization& project,
+                      bool isBackgroundProject,
+                      const std::string& guiData);
+};
+
+struct ProjectBinaryReaderPrivate;
+class ProjectBinaryReader
+{
+public:
+
+    ProjectBinaryReader();
+
+    ~ProjectBinaryReader();
+
+    /**
+     * @brief Returns true if the file at the given path starts with NATRON_PROJECT_BINARY_MAGIC
+     **/
+    static bool isBinaryProjectFile(const std::string& filePath);
+
+    /**
+     * @brief Returns true if the project filename has the binary project extension
+     **/
+    static bool isBinaryProjectFileName(const std::string& fileName);
+
+    /**
+     * @brief Reads the file in memory and parses the nodes index. Nothing is decoded yet.
+     * This function throws a std::exception upon failure.
+     **/
+    void open(const std::string& filePath);
+
+    bool isBackgroundProject() const;
+
+    /**
+     * @brief Returns the version of the project serialization the project header was written with
+     **/
+    unsigned int getProjectSerializationVersion() const;
+
+    /**
+     * @brief Decodes the project settings (knobs, formats, timeline) in the given object.
+     **/
+    void readProjectHeader(ProjectSerialization* project) const;
+
+    const std::vector<ProjectBinaryNodeEntry>& getNodesIndex() const;
+
+    /**
+     * @brief Decodes a single node from the index. This is MT-safe and can be called lazily,
+     * e.g: to inspect a node of a large project without decoding the others.
+     **/
+    NodeSerializationPtr readNode(std::size_t index) const;
+
+    /**
+     * @brief Decodes all nodes in parallel and adds them to the project in the index order.
+     **/
+    void readAllNodes(ProjectSerialization* project) const;
+
+    /**
+     * @brief Returns the boost xml archive of the project Gui, or an empty string
+     **/
+    std::string getGuiData() const;
+
+private:
+
+    boost::scoped_ptr<ProjectBinaryReaderPrivate> _imp;
+};
+
+/**
+ * @brief Encoding of the blobs of a binary project, also used by the auto-save journal (see AutoSaveJournal.h).
+ * These functions throw a std::exception upon failure.
+ **/
+std::string encodeBinaryNodeSerialization(const NodeSerialization& node);
+NodeSerializationPtr decodeBinaryNodeSerialization(const char* data, std::size_t size);
+std::string encodeBinaryProjectHeader(const ProjectSerialization& project);
+void decodeBinaryProjectHeader(const char* data, std::size_t size, unsigned int projectSerializationVersion, ProjectSerialization* project);
+
+/**
+ * @brief Converts a project file from the XML format to the binary format or the other way around, without
+ * loading it in the application. The output format is deduced from the output file extension.
+ * The Gui data can only be converted by a Gui application (see AppInstance::copyProjectGui), otherwise
+ * the output project is flagged as a background project.
+ * This function throws a std::exception upon failure.
+ **/
+void convertProjectFile(const AppInstancePtr& app,
+                        const std::string& inputFilePath,
+                        const std::string& outputFilePath);
+
+NATRON_NAMESPACE_EXIT
+
+#endif // Engine_ProjectBinarySerialization_h
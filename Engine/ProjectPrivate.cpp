@@ -90,8 +90,13 @@ ProjectPrivate::ProjectPrivate(Project* project)
     , isSavingProjectMutex()
     , isSavingProject(false)
     , autoSaveTimer( new QTimer() )
+    , autoSaveFutures()
+    , autoSaveJournal()
     , projectClosing(false)
     , tlsData( new TLSHolder<Project::ProjectTLSData>() )
+    , nodesChangesBatchLevel(0)
+    , batchedHashNodes()
+    , batchedEvaluations()
 
 {
     autoSaveTimer->setSingleShot(true);
@@ -42,6 +42,7 @@ CLANG_DIAG_OFF(uninitialized)
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Engine/AutoSaveJournal.h"
 #include "Engine/Format.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
@@ -106,10 +107,23 @@ public:
     bool isSavingProject; //< true when the project is saving
     boost::shared_ptr<QTimer> autoSaveTimer;
     std::list<boost::shared_ptr<QFutureWatcher<void> > > autoSaveFutures;
+    AutoSaveJournal autoSaveJournal; //< changes since the last full save, when incremental auto-save is enabled
     mutable QMutex projectClosingMutex;
     bool projectClosing;
     boost::shared_ptr<TLSHolder<Project::ProjectTLSData> > tlsData;
 
+    // only used on the main-thread, see Project::beginNodesChangesBatch
+    struct BatchedEvaluation
+    {
+        EffectInstanceWPtr effect;
+        bool isSignificant;
+        bool refreshMetadata;
+    };
+
+    int nodesChangesBatchLevel;
+    std::map<Node*, NodeWPtr> batchedHashNodes;
+    std::map<EffectInstance*, BatchedEvaluation> batchedEvaluations;
+
     // only used on the main-thread
     struct RenderWatcher
     {
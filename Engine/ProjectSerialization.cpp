@@ -41,6 +41,13 @@ ProjectSerialization::initialize(const Project* project)
     ///All the code in this function is MT-safe
 
     _nodes.initialize(*project);
+    initializeProjectData(project);
+}
+
+void
+ProjectSerialization::initializeProjectData(const Project* project)
+{
+    ///All the code in this function is MT-safe
 
     project->getAdditionalFormats(&_additionalFormats);
 
@@ -130,6 +130,11 @@ public:
 
     void initialize(const Project* project);
 
+    /**
+     * @brief Same as initialize() except that the nodes are not serialized.
+     **/
+    void initializeProjectData(const Project* project);
+
     SequenceTime getCurrentTime() const
     {
         return _timelineCurrent;
@@ -155,10 +160,43 @@ public:
         return _creationDate;
     }
 
-    friend class ::boost::serialization::access;
+    void addNodeSerialization(const NodeSerializationPtr& s)
+    {
+        _nodes.addNodeSerialization(s);
+    }
+
+    NodeCollectionSerialization & getNodesSerialization()
+    {
+        return _nodes;
+    }
+
+    /**
+     * @brief Same as the boost serialization save/load, except that the nodes collection is skipped.
+     * This is used by the binary project format (see ProjectBinarySerialization.h) which stores each
+     * node in its own archive so that nodes can be decoded independently.
+     * The archive does not record the class version: the caller stores PROJECT_SERIALIZATION_VERSION
+     * next to it when saving and passes it back when loading.
+     **/
     template<class Archive>
-    void save(Archive & ar,
-              const unsigned int /*version*/) const
+    void saveWithoutNodes(Archive & ar) const
+    {
+        saveVersionInfo(ar);
+        saveProjectData(ar);
+    }
+
+    template<class Archive>
+    void loadWithoutNodes(Archive & ar,
+                          unsigned int version)
+    {
+        _version = version;
+        loadVersionInfo(ar);
+        loadProjectData(ar, version);
+    }
+
+private:
+
+    template<class Archive>
+    void saveVersionInfo(Archive & ar) const
     {
         /*std::string natronVersion(NATRON_APPLICATION_NAME);
 
@@ -199,8 +237,11 @@ public:
 
         int bits = isApplication32Bits() ? 32 : 64;
         ar & ::boost::serialization::make_nvp("Bits", bits);
+    }
 
-        ar & ::boost::serialization::make_nvp("NodesCollection", _nodes);
+    template<class Archive>
+    void saveProjectData(Archive & ar) const
+    {
         int knobsCount = _projectKnobs.size();
         ar & ::boost::serialization::make_nvp("ProjectKnobsCount", knobsCount);
         for (std::list<KnobSerializationPtr>::const_iterator it = _projectKnobs.begin();
@@ -213,6 +254,60 @@ public:
         ar & ::boost::serialization::make_nvp("CreationDate", _creationDate);
     }
 
+    template<class Archive>
+    void loadVersionInfo(Archive & ar)
+    {
+        ar & ::boost::serialization::make_nvp("VersionMajor", _projectLoadedInfo.vMajor);
+        ar & ::boost::serialization::make_nvp("VersionMinor", _projectLoadedInfo.vMinor);
+        ar & ::boost::serialization::make_nvp("VersionRev", _projectLoadedInfo.vRev);
+        ar & ::boost::serialization::make_nvp("GitBranch", _projectLoadedInfo.gitBranch);
+        ar & ::boost::serialization::make_nvp("GitCommit", _projectLoadedInfo.gitCommit);
+        ar & ::boost::serialization::make_nvp("OS", _projectLoadedInfo.osStr);
+        ar & ::boost::serialization::make_nvp("Bits", _projectLoadedInfo.bits);
+        AppInstancePtr app = _app.lock();
+        assert(app);
+        app->setProjectBeingLoadedInfo(_projectLoadedInfo);
+    }
+
+    template<class Archive>
+    void loadProjectData(Archive & ar,
+                         const unsigned int version)
+    {
+        int knobsCount;
+        ar & ::boost::serialization::make_nvp("ProjectKnobsCount", knobsCount);
+
+        // The project data may be loaded again over a previous state (see AutoSaveJournal)
+        _projectKnobs.clear();
+        for (int i = 0; i < knobsCount; ++i) {
+            KnobSerializationPtr ks = boost::make_shared<KnobSerialization>();
+            ar & ::boost::serialization::make_nvp("item", *ks);
+            _projectKnobs.push_back(ks);
+        }
+
+        ar & ::boost::serialization::make_nvp("AdditionalFormats", _additionalFormats);
+        ar & ::boost::serialization::make_nvp("Timeline_current_time", _timelineCurrent);
+        if (version < PROJECT_SERIALIZATION_REMOVES_TIMELINE_BOUNDS) {
+            SequenceTime left, right;
+            ar & ::boost::serialization::make_nvp("Timeline_left_bound", left);
+            ar & ::boost::serialization::make_nvp("Timeline_right_bound", right);
+        }
+        if (version < PROJECT_SERIALIZATION_REMOVES_NODE_COUNTERS) {
+            std::map<std::string, int> _nodeCounters;
+            ar & ::boost::serialization::make_nvp("NodeCounters", _nodeCounters);
+        }
+        ar & ::boost::serialization::make_nvp("CreationDate", _creationDate);
+    }
+
+    friend class ::boost::serialization::access;
+    template<class Archive>
+    void save(Archive & ar,
+              const unsigned int /*version*/) const
+    {
+        saveVersionInfo(ar);
+        ar & ::boost::serialization::make_nvp("NodesCollection", _nodes);
+        saveProjectData(ar);
+    }
+
     template<class Archive>
     void load(Archive & ar,
               const unsigned int version)
@@ -249,17 +344,7 @@ public:
         }
 
         if (version >= PROJECT_SERIALIZATION_CHANGE_VERSION_SERIALIZATION) {
-            ar & ::boost::serialization::make_nvp("VersionMajor", _projectLoadedInfo.vMajor);
-            ar & ::boost::serialization::make_nvp("VersionMinor", _projectLoadedInfo.vMinor);
-            ar & ::boost::serialization::make_nvp("VersionRev", _projectLoadedInfo.vRev);
-            ar & ::boost::serialization::make_nvp("GitBranch", _projectLoadedInfo.gitBranch);
-            ar & ::boost::serialization::make_nvp("GitCommit", _projectLoadedInfo.gitCommit);
-            ar & ::boost::serialization::make_nvp("OS", _projectLoadedInfo.osStr);
-            ar & ::boost::serialization::make_nvp("Bits", _projectLoadedInfo.bits);
-            AppInstancePtr app = _app.lock();
-            assert(app);
-            app->setProjectBeingLoadedInfo(_projectLoadedInfo);
-
+            loadVersionInfo(ar);
         }
 
         if (version < PROJECT_SERIALIZATION_INTRODUCES_GROUPS) {
@@ -274,27 +359,7 @@ public:
             ar & ::boost::serialization::make_nvp("NodesCollection", _nodes);
         }
 
-        int knobsCount;
-        ar & ::boost::serialization::make_nvp("ProjectKnobsCount", knobsCount);
-
-        for (int i = 0; i < knobsCount; ++i) {
-            KnobSerializationPtr ks = boost::make_shared<KnobSerialization>();
-            ar & ::boost::serialization::make_nvp("item", *ks);
-            _projectKnobs.push_back(ks);
-        }
-
-        ar & ::boost::serialization::make_nvp("AdditionalFormats", _additionalFormats);
-        ar & ::boost::serialization::make_nvp("Timeline_current_time", _timelineCurrent);
-        if (version < PROJECT_SERIALIZATION_REMOVES_TIMELINE_BOUNDS) {
-            SequenceTime left, right;
-            ar & ::boost::serialization::make_nvp("Timeline_left_bound", left);
-            ar & ::boost::serialization::make_nvp("Timeline_right_bound", right);
-        }
-        if (version < PROJECT_SERIALIZATION_REMOVES_NODE_COUNTERS) {
-            std::map<std::string, int> _nodeCounters;
-            ar & ::boost::serialization::make_nvp("NodeCounters", _nodeCounters);
-        }
-        ar & ::boost::serialization::make_nvp("CreationDate", _creationDate);
+        loadProjectData(ar, version);
     } // load
 
     BOOST_SERIALIZATION_SPLIT_MEMBER()
@@ -66,6 +66,10 @@ struct NodeRenderStatsPrivate
     int nbCacheHit;
     int nbCacheHitButDownscaledImages;
 
+    //Request pass infos: number of frame/views for which the results were reused from a previous frame or computed
+    int nbRequestPassReused;
+    int nbRequestPassComputed;
+
     //Is tile support enabled for this render
     bool tileSupportEnabled;
 
@@ -89,6 +93,8 @@ struct NodeRenderStatsPrivate
         , nbCacheMisses(0)
         , nbCacheHit(0)
         , nbCacheHitButDownscaledImages(0)
+        , nbRequestPassReused(0)
+        , nbRequestPassComputed(0)
         , tileSupportEnabled(false)
         , renderScaleSupportEnabled(false)
         , channelsEnabled()
@@ -128,6 +134,8 @@ NodeRenderStats::operator=(const NodeRenderStats& other)
     _imp->nbCacheMisses = other._imp->nbCacheMisses;
     _imp->nbCacheHit = other._imp->nbCacheHit;
     _imp->nbCacheHitButDownscaledImages = other._imp->nbCacheHitButDownscaledImages;
+    _imp->nbRequestPassReused = other._imp->nbRequestPassReused;
+    _imp->nbRequestPassComputed = other._imp->nbRequestPassComputed;
     _imp->tileSupportEnabled = other._imp->tileSupportEnabled;
     _imp->renderScaleSupportEnabled = other._imp->renderScaleSupportEnabled;
     for (int i = 0; i < 4; ++i) {
@@ -254,6 +262,24 @@ NodeRenderStats::getCacheAccessInfos(int* nbCacheMisses,
     *nbCacheHitButDownscaledImages = _imp->nbCacheHitButDownscaledImages;
 }
 
+void
+NodeRenderStats::addRequestPassInfo(bool reused)
+{
+    if (reused) {
+        ++_imp->nbRequestPassReused;
+    } else {
+        ++_imp->nbRequestPassComputed;
+    }
+}
+
+void
+NodeRenderStats::getRequestPassInfos(int* nbReused,
+                                     int* nbComputed) const
+{
+    *nbReused = _imp->nbRequestPassReused;
+    *nbComputed = _imp->nbRequestPassComputed;
+}
+
 void
 NodeRenderStats::setTilesSupported(bool tilesSupported)
 {
@@ -315,12 +341,20 @@ struct RenderStatsPrivate
     typedef std::map<NodeWPtr, NodeRenderStats > NodeInfosMap;
     NodeInfosMap nodeInfos;
 
+    //State of the controller of the number of parallel frame renders of the scheduler when the frame was rendered
+    int nParallelRenders;
+    double framesPerSecond;
+    ParallelRendersDecisionEnum parallelRendersDecision;
+
 
     RenderStatsPrivate()
         : lock()
         , totalTimeSpentForFrameTimer()
         , doNodesProfiling(false)
         , nodeInfos()
+        , nParallelRenders(0)
+        , framesPerSecond(0.)
+        , parallelRendersDecision(eParallelRendersDecisionFixed)
     {
     }
 
@@ -415,6 +449,18 @@ RenderStats::addCacheInfosForNode(const NodePtr& node,
     stats.addCacheAccessInfo(isCacheMiss, hasDownscaled);
 }
 
+void
+RenderStats::addRequestPassInfosForNode(const NodePtr& node,
+                                        bool reused)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addRequestPassInfo(reused);
+}
+
 void
 RenderStats::addRenderInfosForNode(const NodePtr& node,
                                    const NodePtr& identity,
@@ -454,4 +500,28 @@ RenderStats::getStats(double *totalTimeSpent) const
     return ret;
 }
 
+void
+RenderStats::setParallelRendersInfos(int nParallelRenders,
+                                     double framesPerSecond,
+                                     ParallelRendersDecisionEnum decision)
+{
+    QMutexLocker k(&_imp->lock);
+
+    _imp->nParallelRenders = nParallelRenders;
+    _imp->framesPerSecond = framesPerSecond;
+    _imp->parallelRendersDecision = decision;
+}
+
+void
+RenderStats::getParallelRendersInfos(int* nParallelRenders,
+                                     double* framesPerSecond,
+                                     ParallelRendersDecisionEnum* decision) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    *nParallelRenders = _imp->nParallelRenders;
+    *framesPerSecond = _imp->framesPerSecond;
+    *decision = _imp->parallelRendersDecision;
+}
+
 NATRON_NAMESPACE_EXIT
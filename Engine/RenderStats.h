@@ -88,6 +88,9 @@ public:
     void addCacheAccessInfo(bool isCacheMiss, bool hasDownscaled);
     void getCacheAccessInfos(int* nbCacheMisses, int* nbCacheHits, int* nbCacheHitButDownscaledImages) const;
 
+    void addRequestPassInfo(bool reused);
+    void getRequestPassInfos(int* nbReused, int* nbComputed) const;
+
     void setTilesSupported(bool tilesSupported);
     bool isTilesSupportEnabled() const;
 
@@ -105,6 +108,17 @@ private:
     boost::scoped_ptr<NodeRenderStatsPrivate> _imp;
 };
 
+/**
+ * @brief The last decision taken by the controller of the number of parallel frame renders of a scheduler
+ **/
+enum ParallelRendersDecisionEnum
+{
+    eParallelRendersDecisionFixed = 0, // the number of parallel renders is set by the user
+    eParallelRendersDecisionKeep, // throughput did not change enough to move
+    eParallelRendersDecisionIncrease, // one more frame is rendered in parallel
+    eParallelRendersDecisionDecrease // one less frame is rendered in parallel, leaving more threads for tiles
+};
+
 /**
  * @brief Holds render infos for all nodes in a compositing tree for a frame.
  **/
@@ -137,6 +151,13 @@ public:
                               bool isCacheMiss,
                               bool hasDownscaled);
 
+    /**
+     * @brief Records whether the request pass results of a frame/view of the node were reused from a previous frame
+     * or computed by calling the plug-in actions.
+     **/
+    void addRequestPassInfosForNode(const NodePtr& node,
+                                    bool reused);
+
     void addRenderInfosForNode(const NodePtr& node,
                                const NodePtr& identity,
                                const std::string& plane,
@@ -145,6 +166,13 @@ public:
 
     std::map<NodePtr, NodeRenderStats > getStats(double *totalTimeSpent) const;
 
+    /**
+     * @brief Records the state of the parallel renders controller of the scheduler when this frame was rendered.
+     * framesPerSecond is the throughput measured over the last window of rendered frames.
+     **/
+    void setParallelRendersInfos(int nParallelRenders, double framesPerSecond, ParallelRendersDecisionEnum decision);
+    void getParallelRendersInfos(int* nParallelRenders, double* framesPerSecond, ParallelRendersDecisionEnum* decision) const;
+
 private:
 
     boost::scoped_ptr<RenderStatsPrivate> _imp;
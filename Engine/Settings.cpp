@@ -193,6 +193,14 @@ Settings::initializeKnobsGeneral()
                                                  "Disabling this will no longer save un-saved project.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _generalTab->addKnob(_autoSaveUnSavedProjects);
 
+    _autoSaveIncremental = AppManager::createKnob<KnobBool>( this, tr("Incremental Auto-save") );
+    _autoSaveIncremental->setName("autoSaveIncremental");
+    _autoSaveIncremental->setHintToolTip( tr("When activated, an auto-save only writes the nodes that changed since the previous "
+                                             "auto-save to a journal file next to the last full save, instead of saving the whole project. "
+                                             "This makes auto-saves of large projects much faster. The journal is periodically folded "
+                                             "back into a full auto-save.") );
+    _generalTab->addKnob(_autoSaveIncremental);
+
 
     _hostName = AppManager::createKnob<KnobChoice>( this, tr("Appear to plug-ins as") );
     _hostName->setName("pluginHostName");
@@ -293,7 +301,8 @@ Settings::initializeKnobsThreading()
     _numberOfParallelRenders = AppManager::createKnob<KnobInt>( this, tr("Number of parallel renders (0=\"guess\")") );
     _numberOfParallelRenders->setHintToolTip( tr("Controls the number of parallel frame that will be rendered at the same time by the renderer."
                                                  "A value of 0 indicate that %1 should automatically determine "
-                                                 "the best number of parallel renders to launch given your CPU activity. "
+                                                 "the best number of parallel renders to launch by measuring the rendering throughput: "
+                                                 "threads that do not render frames in parallel are used to render tiles of each frame. "
                                                  "Setting a value different than 0 should be done only if you know what you're doing and can lead "
                                                  "in some situations to worse performances. Overall to get the best performances you should have your "
                                                  "CPU at 100% activity without idle times.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
@@ -1050,7 +1059,9 @@ Settings::initializeKnobsViewers()
     textureModes.push_back(ChoiceOption("8u",
                                         tr("8-bit").toStdString(),
                                         tr("Post-processing done by the viewer (such as colorspace conversion) is done "
-                                           "by the CPU. The size of cached textures is thus smaller.").toStdString() ));
+                                           "by the CPU. Cached textures are stored before this post-processing as half-float RGBA, "
+                                           "so that changing the gain, gamma, colorspace or displayed channels does not invalidate them: "
+                                           "they take twice the memory of an 8-bit texture and half the memory of a 32-bit floating-point texture.").toStdString() ));
 
     //textureModes.push_back("16bits half-float");
     //helpStringsTextureModes.push_back("Not available yet. Similar to 32bits fp.");
@@ -1212,6 +1223,23 @@ Settings::initializeKnobsCaching()
                                            "output has its settings panel opened.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _cachingTab->addKnob(_aggressiveCaching);
 
+    _stripRenderingHeight = AppManager::createKnob<KnobInt>( this, tr("Strip rendering height (pixels)") );
+    _stripRenderingHeight->setName("stripRenderingHeight");
+    _stripRenderingHeight->disableSlider();
+    _stripRenderingHeight->setMinimum(0);
+    _stripRenderingHeight->setHintToolTip( tr("When greater than 0, Write nodes which support tiles render their output in horizontal "
+                                              "strips of at most this height, from the top of the image to the bottom. "
+                                              "Each strip is pulled through the graph on its own and the intermediate images "
+                                              "of the nodes upstream are released once the strip is written, so that the memory "
+                                              "needed to render very high resolution images is bounded by the strip height rather than by the "
+                                              "image size. Nodes which do not support tiles still render (and cache) the full image, "
+                                              "which is released once the frame is written.\n"
+                                              "Only writers which support tiles qualify: writers which need the full image at once, "
+                                              "such as the DiskCache node or writers encoding whole frames, always render full frames "
+                                              "(the \"Tiles Support\" column of the render statistics shows whether a node supports tiles).\n"
+                                              "When 0, the full image is rendered at once.") );
+    _cachingTab->addKnob(_stripRenderingHeight);
+
     _maxRAMPercent = AppManager::createKnob<KnobInt>( this, tr("Maximum amount of RAM memory used for caching (% of total RAM)") );
     _maxRAMPercent->setName("maxRAMPercent");
     _maxRAMPercent->disableSlider();
@@ -1446,6 +1474,7 @@ Settings::setDefaultValues()
     _enableCrashReports->setDefaultValue(true);
 #endif
     _autoSaveUnSavedProjects->setDefaultValue(true);
+    _autoSaveIncremental->setDefaultValue(false);
     _autoSaveDelay->setDefaultValue(5, 0);
     _hostName->setDefaultValue(0);
     _customHostName->setDefaultValue(NATRON_ORGANIZATION_DOMAIN_TOPLEVEL "." NATRON_ORGANIZATION_DOMAIN_SUB "." NATRON_APPLICATION_NAME);
@@ -1510,6 +1539,7 @@ Settings::setDefaultValues()
 
     // Caching
     _aggressiveCaching->setDefaultValue(false);
+    _stripRenderingHeight->setDefaultValue(0);
     _maxRAMPercent->setDefaultValue(50, 0);
     _unreachableRAMPercent->setDefaultValue(20); // see https://github.com/NatronGitHub/Natron/issues/486
     _maxViewerDiskCacheGB->setDefaultValue(5, 0);
@@ -2490,6 +2520,12 @@ Settings::isAggressiveCachingEnabled() const
     return _aggressiveCaching->getValue();
 }
 
+int
+Settings::getStripRenderingHeight() const
+{
+    return _stripRenderingHeight->getValue();
+}
+
 double
 Settings::getRamMaximumPercent() const
 {
@@ -2873,6 +2909,12 @@ Settings::isAutoSaveEnabledForUnsavedProjects() const
     return _autoSaveUnSavedProjects->getValue();
 }
 
+bool
+Settings::isIncrementalAutoSaveEnabled() const
+{
+    return _autoSaveIncremental->getValue();
+}
+
 bool
 Settings::isSnapToNodeEnabled() const
 {
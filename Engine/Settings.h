@@ -179,6 +179,8 @@ public:
 
     bool isAutoSaveEnabledForUnsavedProjects() const;
 
+    bool isIncrementalAutoSaveEnabled() const;
+
     bool isSnapToNodeEnabled() const;
 
     bool isCheckForUpdatesEnabled() const;
@@ -277,6 +279,11 @@ public:
 
     bool isAggressiveCachingEnabled() const;
 
+    /**
+     * @brief Returns the height of the strips Write nodes render in, or 0 if they render the full image at once.
+     **/
+    int getStripRenderingHeight() const;
+
     bool isAutoTurboEnabled() const;
 
     void setAutoTurboModeEnabled(bool e);
@@ -429,6 +436,7 @@ private:
     KnobButtonPtr _testCrashReportButton;
 #endif
     KnobBoolPtr _autoSaveUnSavedProjects;
+    KnobBoolPtr _autoSaveIncremental;
     KnobIntPtr _autoSaveDelay;
     KnobChoicePtr _hostName;
     KnobStringPtr _customHostName;
@@ -499,6 +507,7 @@ private:
     // Caching
     KnobPagePtr _cachingTab;
     KnobBoolPtr _aggressiveCaching;
+    KnobIntPtr _stripRenderingHeight;
     ///The percentage of the value held by _maxRAMPercent to dedicate to playback cache (viewer cache's in-RAM portion) only
     KnobStringPtr _maxPlaybackLabel;
 
@@ -39,6 +39,8 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QWaitCondition>
 #include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
 #include <QtCore/QCoreApplication>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
@@ -1794,6 +1796,119 @@ TrackSchedulerPrivate::trackStepFunctor(int trackIndex,
 
 NATRON_NAMESPACE_ANONYMOUS_ENTER
 
+/**
+ * @brief State shared by the scheduler thread and the task chains of the tracks during one tracking run.
+ **/
+struct TrackChainsSharedData
+{
+    QMutex lock;
+
+    // Woken up whenever a track has done a step
+    QWaitCondition trackStepDone;
+
+    // The last frame each track went through
+    std::vector<int> lastTrackedFrame;
+
+    // Whether each track still has a task chain running
+    std::vector<bool> trackActive;
+
+    // Number of track steps done over all tracks
+    int stepsDone;
+
+    // Number of task chains still running
+    int activeChains;
+
+    // Set by the scheduler when tracking is aborted: chains stop before their next step
+    bool aborted;
+
+    TrackChainsSharedData(int numTracks,
+                          int startFrame)
+        : lock()
+        , trackStepDone()
+        , lastTrackedFrame(numTracks, startFrame)
+        , trackActive(numTracks, true)
+        , stepsDone(0)
+        , activeChains(numTracks)
+        , aborted(false)
+    {
+    }
+};
+
+typedef boost::shared_ptr<TrackChainsSharedData> TrackChainsSharedDataPtr;
+
+/**
+ * @brief Tracks one marker at one frame then schedules the step of the same marker at the next frame
+ * on the global thread pool, so that each track advances through the frames independently of the others.
+ * The chain ends when the track fails, reaches the end of the range or when tracking is aborted.
+ **/
+class TrackStepRunnable
+    : public QRunnable
+{
+    TrackArgsPtr _args;
+    TrackChainsSharedDataPtr _data;
+    int _trackIndex;
+    int _time;
+
+public:
+
+    TrackStepRunnable(const TrackArgsPtr& args,
+                      const TrackChainsSharedDataPtr& data,
+                      int trackIndex,
+                      int time)
+        : QRunnable()
+        , _args(args)
+        , _data(data)
+        , _trackIndex(trackIndex)
+        , _time(time)
+    {
+    }
+
+    virtual ~TrackStepRunnable()
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        bool aborted;
+        {
+            QMutexLocker k(&_data->lock);
+            aborted = _data->aborted;
+        }
+
+        bool succeeded = false;
+        if (!aborted) {
+            const TrackMarkerAndOptionsPtr& track = _args->getTracks()[_trackIndex];
+            if ( track->natronMarker->isEnabled(_time) ) {
+                succeeded = TrackSchedulerPrivate::trackStepFunctor(_trackIndex, *_args, _time);
+            } else {
+                // A marker disabled at this frame is just skipped, it may be enabled again further
+                succeeded = true;
+                appPTR->getAppTLS()->cleanupTLSForThread();
+            }
+        }
+
+        int step = _args->getStep();
+        int next = _time + step;
+        bool continueChain = !aborted && succeeded && ( step > 0 ? next < _args->getEnd() : next > _args->getEnd() );
+        {
+            QMutexLocker k(&_data->lock);
+            if (!aborted) {
+                _data->lastTrackedFrame[_trackIndex] = _time;
+                ++_data->stepsDone;
+            }
+            if (!continueChain) {
+                _data->trackActive[_trackIndex] = false;
+                --_data->activeChains;
+            }
+            _data->trackStepDone.wakeOne();
+        }
+
+        if (continueChain) {
+            QThreadPool::globalInstance()->start( new TrackStepRunnable(_args, _data, _trackIndex, next) );
+        }
+    }
+};
+
 class IsTrackingFlagSetter_RAII
 {
     Q_DECLARE_TR_FUNCTIONS(TrackScheduler)
@@ -1863,9 +1978,7 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
 
     const std::vector<TrackMarkerAndOptionsPtr>& tracks = args->getTracks();
     const int numTracks = (int)tracks.size();
-    std::vector<int> trackIndexes( tracks.size() );
     for (std::size_t i = 0; i < tracks.size(); ++i) {
-        trackIndexes[i] = i;
         tracks[i]->natronMarker->notifyTrackingStarted();
         // unslave the enabled knob, since it is slaved to the gui but we may modify it
         KnobBoolPtr enabledKnob = tracks[i]->natronMarker->getEnabledKnob();
@@ -1881,7 +1994,6 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
     timeval lastProgressUpdateTime;
     gettimeofday(&lastProgressUpdateTime, 0);
 
-    bool allTrackFailed = false;
     {
         ///Use RAII style for setting the isDoingPartialUpdates flag so we're sure it gets removed
         IsTrackingFlagSetter_RAII __istrackingflag__(effect, this, frameStep, reportProgress, viewer, doPartialUpdates);
@@ -1892,44 +2004,45 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
         }
 
 
-        while (cur != end) {
-            ///Launch parallel thread for each track using the global thread pool
-            QFuture<bool> future = QtConcurrent::mapped( trackIndexes,
-                                                         boost::bind(&TrackSchedulerPrivate::trackStepFunctor,
-                                                                     _1,
-                                                                     *args,
-                                                                     cur) );
-            future.waitForFinished();
-
-            allTrackFailed = true;
-            for (QFuture<bool>::const_iterator it = future.begin(); it != future.end(); ++it) {
-                if ( (*it) ) {
-                    allTrackFailed = false;
-                    break;
-                }
+        // Each track runs its own chain of steps: a slow or stalled track does not hold back the others.
+        // This thread only reports progress, refreshes the viewer and checks for abortion.
+        TrackChainsSharedDataPtr chains = boost::make_shared<TrackChainsSharedData>(numTracks, lastValidFrame);
+        if ( (cur != end) && (numTracks > 0) ) {
+            for (int i = 0; i < numTracks; ++i) {
+                QThreadPool::globalInstance()->start( new TrackStepRunnable(args, chains, i, cur) );
             }
+        } else {
+            chains->activeChains = 0;
+        }
 
-
-
-            lastValidFrame = cur;
-
-
-
-            // We don't have any successful track, stop
-            if (allTrackFailed) {
-                break;
+        int lastReportedFrame = lastValidFrame;
+        QMutexLocker k(&chains->lock);
+        while (chains->activeChains > 0) {
+            chains->trackStepDone.wait(&chains->lock, NATRON_TRACKER_REPORT_PROGRESS_DELTA_MS);
+
+            // The frame shown is the one all the running tracks went through
+            int frontierFrame = lastValidFrame;
+            bool hasActiveTrack = false;
+            for (int i = 0; i < numTracks; ++i) {
+                int frame = chains->lastTrackedFrame[i];
+                if ( (frameStep > 0) ? (frame > lastValidFrame) : (frame < lastValidFrame) ) {
+                    lastValidFrame = frame;
+                }
+                if (chains->trackActive[i]) {
+                    if (!hasActiveTrack) {
+                        frontierFrame = frame;
+                        hasActiveTrack = true;
+                    } else if ( (frameStep > 0) ? (frame < frontierFrame) : (frame > frontierFrame) ) {
+                        frontierFrame = frame;
+                    }
+                }
             }
-
-
-
-            cur += frameStep;
-
-            double progress;
-            if (frameStep > 0) {
-                progress = (double)(cur - start) / framesCount;
-            } else {
-                progress = (double)(start - cur) / framesCount;
+            if (!hasActiveTrack) {
+                frontierFrame = lastValidFrame;
             }
+            double progress = framesCount > 0 ? (double)chains->stepsDone / ( (double)numTracks * framesCount ) : 1.;
+            bool isAborted = chains->aborted;
+            k.unlock();
 
             bool isUpdateViewerOnTrackingEnabled = _imp->paramsProvider->getUpdateViewer();
             bool isCenterViewerEnabled = _imp->paramsProvider->getCenterOnTrack();
@@ -1946,36 +2059,44 @@ TrackScheduler::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
                 }
             }
 
+            ///Refresh the viewer if needed at the frame all the tracks went through
+            if ( isUpdateViewerOnTrackingEnabled && viewer && (frontierFrame != lastReportedFrame) && enoughTimePassedToReportProgress ) {
+                lastReportedFrame = frontierFrame;
 
-            ///Ok all tracks are finished now for this frame, refresh viewer if needed
-            if (isUpdateViewerOnTrackingEnabled && viewer) {
                 //This will not refresh the viewer since when tracking, renderCurrentFrame()
                 //is not called on viewers, see Gui::onTimeChanged
-                timeline->seekFrame(cur, true, 0, eTimelineChangeReasonOtherSeek);
+                timeline->seekFrame(frontierFrame, true, 0, eTimelineChangeReasonOtherSeek);
 
-                if (enoughTimePassedToReportProgress) {
-                    if (doPartialUpdates) {
-                        std::list<RectD> updateRects;
-                        args->getRedrawAreasNeeded(cur, &updateRects);
-                        viewer->setPartialUpdateParams(updateRects, isCenterViewerEnabled);
-                    } else {
-                        viewer->clearPartialUpdateParams();
-                    }
-                    Q_EMIT renderCurrentFrameForViewer(viewer);
+                if (doPartialUpdates) {
+                    std::list<RectD> updateRects;
+                    args->getRedrawAreasNeeded(frontierFrame, &updateRects);
+                    viewer->setPartialUpdateParams(updateRects, isCenterViewerEnabled);
+                } else {
+                    viewer->clearPartialUpdateParams();
                 }
+                Q_EMIT renderCurrentFrameForViewer(viewer);
             }
 
             if (enoughTimePassedToReportProgress && reportProgress && effect) {
-                ///Notify we progressed of 1 frame
                 Q_EMIT trackingProgress(progress);
             }
 
-            // Check for abortion
-            state = resolveState();
+            // Check for abortion: the chains stop before their next step, wait for the running steps to return
+            if (!isAborted) {
+                state = resolveState();
+            }
+            k.relock();
             if ( (state == eThreadStateAborted) || (state == eThreadStateStopped) ) {
-                break;
+                chains->aborted = true;
             }
-        } // while (cur != end) {
+        } // while (chains->activeChains > 0)
+        for (int i = 0; i < numTracks; ++i) {
+            int frame = chains->lastTrackedFrame[i];
+            if ( (frameStep > 0) ? (frame > lastValidFrame) : (frame < lastValidFrame) ) {
+                lastValidFrame = frame;
+            }
+        }
+        k.unlock();
     } // IsTrackingFlagSetter_RAII
     TrackerContext* isContext = dynamic_cast<TrackerContext*>(_imp->paramsProvider);
     if (isContext) {
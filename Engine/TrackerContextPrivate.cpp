@@ -42,6 +42,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Engine/AppInstance.h"
 #include "Engine/Curve.h"
+#include "Engine/Hash64.h"
 #include "Engine/Project.h"
 #include "Engine/TimeLine.h"
 #include "Engine/KnobTypes.h"
@@ -1183,6 +1184,7 @@ TrackerContext::trackMarkers(const std::list<TrackMarkerPtr>& markers,
     
     /// The accessor and its cache is local to a track operation, it is wiped once the whole sequence track is finished.
     TrackerFrameAccessorPtr accessor( new TrackerFrameAccessor(this, enabledChannels, formatHeight) );
+    accessor->setTrackedMarkers(markers);
     mv::AutoTrackPtr trackContext( new mv::AutoTrack( accessor.get() ) );
     std::vector<TrackMarkerAndOptionsPtr> trackAndOptions;
     mv::TrackRegionOptions mvOptions;
@@ -1867,6 +1869,44 @@ TrackerContextPrivate::extractSortedPointsFromMarkers(double refTime,
     }
 } // TrackerContext::extractSortedPointsFromMarkers
 
+/**
+ * @brief Hash of all the data a frame is solved from, to find out whether its previous solution is still valid
+ **/
+static U64
+hashSolveInput(double refTime,
+               double time,
+               int jitterPeriod,
+               bool jitterAdd,
+               bool robustModel,
+               int w1,
+               int h1,
+               int w2,
+               int h2,
+               const std::vector<Point>& x1,
+               const std::vector<Point>& x2)
+{
+    Hash64 hash;
+
+    hash.append(refTime);
+    hash.append(time);
+    hash.append(jitterPeriod);
+    hash.append(jitterAdd);
+    hash.append(robustModel);
+    hash.append(w1);
+    hash.append(h1);
+    hash.append(w2);
+    hash.append(h2);
+    for (std::size_t i = 0; i < x1.size(); ++i) {
+        hash.append(x1[i].x);
+        hash.append(x1[i].y);
+        hash.append(x2[i].x);
+        hash.append(x2[i].y);
+    }
+    hash.computeHash();
+
+    return hash.value();
+}
+
 TrackerContextPrivate::TransformData
 TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
                                                               double time,
@@ -1911,6 +1951,15 @@ TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
         return data;
     }
 
+    // If the points at this frame did not change since the last solve, reuse its result
+    U64 inputHash = hashSolveInput(refTime, time, jitterPeriod, jitterAdd, robustModel, w1, h1, w2, h2, x1, x2);
+    {
+        QMutexLocker k(&lastSolveRequest.solvedFramesMutex);
+        std::map<double, std::pair<U64, TransformData> >::const_iterator found = lastSolveRequest.solvedTransformFrames.find(time);
+        if ( ( found != lastSolveRequest.solvedTransformFrames.end() ) && (found->second.first == inputHash) ) {
+            return found->second.second;
+        }
+    }
 
     const bool dataSetIsUserManual = true;
 
@@ -1926,6 +1975,11 @@ TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
         data.valid = false;
     }
 
+    {
+        QMutexLocker k(&lastSolveRequest.solvedFramesMutex);
+        lastSolveRequest.solvedTransformFrames[time] = std::make_pair(inputHash, data);
+    }
+
     return data;
 } // TrackerContextPrivate::computeTransformParamsFromTracksAtTime
 
@@ -1972,6 +2026,15 @@ TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
         return data;
     }
 
+    // If the points at this frame did not change since the last solve, reuse its result
+    U64 inputHash = hashSolveInput(refTime, time, jitterPeriod, jitterAdd, robustModel, w1, h1, w2, h2, x1, x2);
+    {
+        QMutexLocker k(&lastSolveRequest.solvedFramesMutex);
+        std::map<double, std::pair<U64, CornerPinData> >::const_iterator found = lastSolveRequest.solvedCornerPinFrames.find(time);
+        if ( ( found != lastSolveRequest.solvedCornerPinFrames.end() ) && (found->second.first == inputHash) ) {
+            return found->second.second;
+        }
+    }
 
     if (x1.size() == 1) {
         data.h.setTranslationFromOnePoint( euclideanToHomogenous(x1[0]), euclideanToHomogenous(x2[0]) );
@@ -1992,6 +2055,11 @@ TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
         }
     }
 
+    {
+        QMutexLocker k(&lastSolveRequest.solvedFramesMutex);
+        lastSolveRequest.solvedCornerPinFrames[time] = std::make_pair(inputHash, data);
+    }
+
     return data;
 } // TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime
 
@@ -2390,9 +2458,31 @@ TrackerContextPrivate::computeCornerParamsFromTracksEnd(double refTime,
     endSolve();
 } // TrackerContextPrivate::computeCornerParamsFromTracksEnd
 
+/**
+ * @brief Removes the solved frames that are no longer keyframes
+ **/
+template <typename DATA>
+static void
+removeUnusedSolvedFrames(const std::set<double>& keyframes,
+                         std::map<double, std::pair<U64, DATA> >* solvedFrames)
+{
+    typename std::map<double, std::pair<U64, DATA> >::iterator it = solvedFrames->begin();
+    while ( it != solvedFrames->end() ) {
+        if ( keyframes.find(it->first) == keyframes.end() ) {
+            solvedFrames->erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
 void
 TrackerContextPrivate::computeCornerParamsFromTracks()
 {
+    {
+        QMutexLocker k(&lastSolveRequest.solvedFramesMutex);
+        removeUnusedSolvedFrames(lastSolveRequest.keyframes, &lastSolveRequest.solvedCornerPinFrames);
+    }
 #ifndef TRACKER_GENERATE_DATA_SEQUENTIALLY
     lastSolveRequest.tWatcher.reset();
     lastSolveRequest.cpWatcher.reset( new QFutureWatcher<TrackerContextPrivate::CornerPinData>() );
@@ -2595,6 +2685,10 @@ TrackerContextPrivate::computeTransformParamsFromTracksEnd(double refTime,
 void
 TrackerContextPrivate::computeTransformParamsFromTracks()
 {
+    {
+        QMutexLocker k(&lastSolveRequest.solvedFramesMutex);
+        removeUnusedSolvedFrames(lastSolveRequest.keyframes, &lastSolveRequest.solvedTransformFrames);
+    }
 #ifndef TRACKER_GENERATE_DATA_SEQUENTIALLY
     lastSolveRequest.cpWatcher.reset();
     lastSolveRequest.tWatcher.reset( new QFutureWatcher<TrackerContextPrivate::TransformData>() );
@@ -31,6 +31,7 @@
 #include "TrackerContext.h"
 
 #include <list>
+#include <map>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/utility.hpp>
@@ -492,6 +493,12 @@ public:
         bool robustModel;
         double maxFittingError;
         std::vector<TrackMarkerPtr> allMarkers;
+
+        // The result of the previous solves at each frame, along with the hash of the data they were solved from.
+        // Frames whose data did not change are not solved again.
+        mutable QMutex solvedFramesMutex;
+        std::map<double, std::pair<U64, TransformData> > solvedTransformFrames;
+        std::map<double, std::pair<U64, CornerPinData> > solvedCornerPinFrames;
     };
 
     SolveRequest lastSolveRequest;
@@ -25,6 +25,9 @@
 
 #include "TrackerFrameAccessor.h"
 
+#include <cstring> // for std::memcpy
+#include <vector>
+
 #include <boost/utility.hpp>
 
 GCC_DIAG_OFF(unused-function)
@@ -36,6 +39,8 @@ GCC_DIAG_ON(unused-function)
 GCC_DIAG_ON(unused-parameter)
 
 #include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 
 #include "Engine/AbortableRenderInfo.h"
 #include "Engine/AppInstance.h"
@@ -43,9 +48,18 @@ GCC_DIAG_ON(unused-parameter)
 #include "Engine/TimeLine.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/Image.h"
+#include "Engine/KnobTypes.h"
 #include "Engine/Node.h"
+#include "Engine/TrackMarker.h"
 #include "Engine/TrackerContext.h"
 
+// Number of shared planes kept by the accessor, the least recently used ones are removed beyond that
+#define NATRON_TRACKER_ACCESSOR_MAX_SHARED_PLANES 16
+
+// The search area of a marker is enlarged by this fraction of its size on each side when computing the shared planes,
+// since the prediction of the marker position may move it before it is requested
+#define NATRON_TRACKER_ACCESSOR_SEARCH_AREA_MARGIN 0.25
+
 NATRON_NAMESPACE_ENTER
 
 namespace  {
@@ -118,13 +132,105 @@ struct FrameAccessorCacheEntry
 {
     MvFloatImagePtr image;
 
-    // If null, this is the full image
+    // The area requested by libmv
+    RectI requestedArea;
+
+    // The area covered by image, this is requestedArea clipped to the source image bounds
     RectI bounds;
     unsigned int referenceCount;
 };
 
 typedef std::multimap<FrameAccessorCacheKey, FrameAccessorCacheEntry, CacheKey_compare_less > FrameAccessorCache;
 
+/**
+ * @brief A grayscale plane of a frame covering the search areas of several markers. The image of each marker
+ * is extracted from it so that the pixels are rendered and converted only once per frame.
+ **/
+struct FrameAccessorSharedPlane
+{
+    // The area that was rendered, in pixel coordinates at the mipmap level of the key
+    RectI requestedArea;
+
+    // The area covered by image, this is requestedArea clipped to the source image bounds
+    RectI bounds;
+    MvFloatImagePtr image;
+
+    // False while a thread is rendering the plane
+    bool available;
+
+    // To remove the least recently used planes
+    U64 lastUseStamp;
+
+    FrameAccessorSharedPlane()
+        : requestedArea()
+        , bounds()
+        , image()
+        , available(false)
+        , lastUseStamp(0)
+    {
+    }
+};
+
+typedef boost::shared_ptr<FrameAccessorSharedPlane> FrameAccessorSharedPlanePtr;
+typedef std::multimap<FrameAccessorCacheKey, FrameAccessorSharedPlanePtr, CacheKey_compare_less > FrameAccessorSharedPlanes;
+
+/**
+ * @brief Copies the area roi of the plane into a new image
+ **/
+static MvFloatImagePtr
+extractLibMvFloatImage(const FrameAccessorSharedPlane& plane,
+                       const RectI& roi)
+{
+    assert( plane.bounds.contains(roi) );
+    if (roi == plane.bounds) {
+        // The plane is exactly what was requested, share it
+        return plane.image;
+    }
+    MvFloatImagePtr ret = boost::make_shared<MvFloatImage>( roi.height(), roi.width() );
+    const int srcRowElements = plane.bounds.width();
+    const float* src_pixels = plane.image->Data() + (roi.y1 - plane.bounds.y1) * srcRowElements + (roi.x1 - plane.bounds.x1);
+    float* dst_pixels = ret->Data();
+    const int w = roi.width();
+    for (int y = roi.y1; y < roi.y2; ++y, src_pixels += srcRowElements, dst_pixels += w) {
+        std::memcpy( dst_pixels, src_pixels, w * sizeof(float) );
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Makes the plane at the mipmap level downscale from a plane at level 0 by averaging blocks of 2^downscale pixels,
+ * this is the same box filter as the one used to build the mipmaps of Natron images.
+ **/
+static MvFloatImagePtr
+downscaleLibMvFloatImage(const FrameAccessorSharedPlane& fullScalePlane,
+                         unsigned int downscale,
+                         const RectI& roi)
+{
+    const int factor = 1 << downscale;
+
+    assert( fullScalePlane.bounds.contains( roi.upscalePowerOfTwo(downscale) ) );
+    MvFloatImagePtr ret = boost::make_shared<MvFloatImage>( roi.height(), roi.width() );
+    const int srcRowElements = fullScalePlane.bounds.width();
+    const float* src = fullScalePlane.image->Data();
+    float* dst_pixels = ret->Data();
+    const float norm = 1.f / (factor * factor);
+    for (int y = roi.y1; y < roi.y2; ++y) {
+        for (int x = roi.x1; x < roi.x2; ++x, ++dst_pixels) {
+            float sum = 0.f;
+            for (int j = 0; j < factor; ++j) {
+                const float* src_pixels = src + (y * factor + j - fullScalePlane.bounds.y1) * srcRowElements + (x * factor - fullScalePlane.bounds.x1);
+                for (int i = 0; i < factor; ++i) {
+                    sum += src_pixels[i];
+                }
+            }
+            *dst_pixels = sum * norm;
+        }
+    }
+
+    return ret;
+}
+
 
 template <bool doR, bool doG, bool doB>
 void
@@ -213,6 +319,14 @@ struct TrackerFrameAccessorPrivate
     NodePtr trackerInput;
     mutable QMutex cacheMutex;
     FrameAccessorCache cache;
+
+    // Protected by cacheMutex
+    FrameAccessorSharedPlanes sharedPlanes;
+    QWaitCondition sharedPlaneAvailableCond;
+    U64 sharedPlanesUseStamp;
+
+    // Set before tracking starts, then read-only
+    std::list<TrackMarkerPtr> markers;
     bool enabledChannels[3];
     int formatHeight;
 
@@ -223,6 +337,10 @@ struct TrackerFrameAccessorPrivate
         , trackerInput()
         , cacheMutex()
         , cache()
+        , sharedPlanes()
+        , sharedPlaneAvailableCond()
+        , sharedPlanesUseStamp(0)
+        , markers()
         , enabledChannels()
         , formatHeight(formatHeight)
     {
@@ -232,8 +350,171 @@ struct TrackerFrameAccessorPrivate
             this->enabledChannels[i] = enabledChannels[i];
         }
     }
+
+    void getMarkersSearchAreas(int frame, unsigned int mipMapLevel, std::vector<RectI>* areas) const;
+
+    FrameAccessorSharedPlanePtr getSharedPlane(const FrameAccessorCacheKey& key, const RectI& roi, const RectI& renderArea, const RectD& precomputedRoD);
+
+    bool renderToLibMvFloatImage(int frame, unsigned int downscale, const RectI& roi, const RectD& precomputedRoD, RectI* bounds, MvFloatImagePtr* image);
+
+    void removeUnusedSharedPlanes();
 };
 
+/**
+ * @brief Returns the search areas of all the tracked markers at the given frame, grouped so that
+ * markers close to each other share the same area while markers far apart do not make a huge area.
+ **/
+void
+TrackerFrameAccessorPrivate::getMarkersSearchAreas(int frame,
+                                                   unsigned int mipMapLevel,
+                                                   std::vector<RectI>* areas) const
+{
+    for (std::list<TrackMarkerPtr>::const_iterator it = markers.begin(); it != markers.end(); ++it) {
+        KnobDoublePtr searchBtmLeft = (*it)->getSearchWindowBottomLeftKnob();
+        KnobDoublePtr searchTopRight = (*it)->getSearchWindowTopRightKnob();
+        KnobDoublePtr centerKnob = (*it)->getCenterKnob();
+        KnobDoublePtr offsetKnob = (*it)->getOffsetKnob();
+        double cx = centerKnob->getValueAtTime(frame, 0) + offsetKnob->getValueAtTime(frame, 0);
+        double cy = centerKnob->getValueAtTime(frame, 1) + offsetKnob->getValueAtTime(frame, 1);
+        RectD area;
+        area.x1 = searchBtmLeft->getValueAtTime(frame, 0) + cx;
+        area.y1 = searchBtmLeft->getValueAtTime(frame, 1) + cy;
+        area.x2 = searchTopRight->getValueAtTime(frame, 0) + cx;
+        area.y2 = searchTopRight->getValueAtTime(frame, 1) + cy;
+        double marginX = area.width() * NATRON_TRACKER_ACCESSOR_SEARCH_AREA_MARGIN;
+        double marginY = area.height() * NATRON_TRACKER_ACCESSOR_SEARCH_AREA_MARGIN;
+        area.x1 -= marginX;
+        area.x2 += marginX;
+        area.y1 -= marginY;
+        area.y2 += marginY;
+        RectI pixelArea;
+        area.toPixelEnclosing(mipMapLevel, 1., &pixelArea);
+        if ( !pixelArea.isNull() ) {
+            areas->push_back(pixelArea);
+        }
+    }
+
+    // Merge 2 areas whenever their enclosing box is not larger than the 2 areas together
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (std::size_t i = 0; i < areas->size() && !merged; ++i) {
+            for (std::size_t j = i + 1; j < areas->size(); ++j) {
+                RectI enclosing = (*areas)[i];
+                enclosing.merge( (*areas)[j] );
+                if ( enclosing.area() <= (*areas)[i].area() + (*areas)[j].area() ) {
+                    (*areas)[i] = enclosing;
+                    areas->erase(areas->begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+} // TrackerFrameAccessorPrivate::getMarkersSearchAreas
+
+/**
+ * @brief Returns a shared plane of the frame containing roi. If none exists yet, renderArea is rendered
+ * to make one. If another thread is already making a plane containing roi, this waits for it.
+ **/
+FrameAccessorSharedPlanePtr
+TrackerFrameAccessorPrivate::getSharedPlane(const FrameAccessorCacheKey& key,
+                                            const RectI& roi,
+                                            const RectI& renderArea,
+                                            const RectD& precomputedRoD)
+{
+    FrameAccessorSharedPlanePtr plane;
+    FrameAccessorSharedPlanePtr fullScalePlane;
+    {
+        QMutexLocker k(&cacheMutex);
+        for (;;) {
+            FrameAccessorSharedPlanePtr found;
+            std::pair<FrameAccessorSharedPlanes::iterator, FrameAccessorSharedPlanes::iterator> range = sharedPlanes.equal_range(key);
+            for (FrameAccessorSharedPlanes::iterator it = range.first; it != range.second; ++it) {
+                if ( it->second->requestedArea.contains(roi) ) {
+                    found = it->second;
+                    break;
+                }
+            }
+            if (!found) {
+                break;
+            }
+            if (found->available) {
+                found->lastUseStamp = ++sharedPlanesUseStamp;
+
+                return found;
+            }
+            // Another thread is rendering it
+            sharedPlaneAvailableCond.wait(&cacheMutex);
+        }
+
+        if (key.mipMapLevel > 0) {
+            // Build this level of the pyramid from the full scale plane if there is one
+            FrameAccessorCacheKey fullScaleKey = key;
+            fullScaleKey.mipMapLevel = 0;
+            RectI fullScaleArea = renderArea.upscalePowerOfTwo(key.mipMapLevel);
+            std::pair<FrameAccessorSharedPlanes::iterator, FrameAccessorSharedPlanes::iterator> range = sharedPlanes.equal_range(fullScaleKey);
+            for (FrameAccessorSharedPlanes::iterator it = range.first; it != range.second; ++it) {
+                if ( it->second->available && it->second->bounds.contains(fullScaleArea) ) {
+                    fullScalePlane = it->second;
+                    break;
+                }
+            }
+        }
+
+        plane = boost::make_shared<FrameAccessorSharedPlane>();
+        plane->requestedArea = renderArea;
+        plane->lastUseStamp = ++sharedPlanesUseStamp;
+        sharedPlanes.insert( std::make_pair(key, plane) );
+        removeUnusedSharedPlanes();
+    }
+
+    bool ok;
+    if (fullScalePlane) {
+        plane->bounds = renderArea;
+        plane->image = downscaleLibMvFloatImage(*fullScalePlane, key.mipMapLevel, renderArea);
+        ok = true;
+    } else {
+        ok = renderToLibMvFloatImage(key.frame, key.mipMapLevel, renderArea, precomputedRoD, &plane->bounds, &plane->image);
+    }
+
+    QMutexLocker k(&cacheMutex);
+    if (ok) {
+        plane->available = true;
+    } else {
+        std::pair<FrameAccessorSharedPlanes::iterator, FrameAccessorSharedPlanes::iterator> range = sharedPlanes.equal_range(key);
+        for (FrameAccessorSharedPlanes::iterator it = range.first; it != range.second; ++it) {
+            if (it->second == plane) {
+                sharedPlanes.erase(it);
+                break;
+            }
+        }
+        plane.reset();
+    }
+    sharedPlaneAvailableCond.wakeAll();
+
+    return plane;
+} // TrackerFrameAccessorPrivate::getSharedPlane
+
+void
+TrackerFrameAccessorPrivate::removeUnusedSharedPlanes()
+{
+    // cacheMutex must be locked
+    while (sharedPlanes.size() > NATRON_TRACKER_ACCESSOR_MAX_SHARED_PLANES) {
+        FrameAccessorSharedPlanes::iterator oldest = sharedPlanes.end();
+        for (FrameAccessorSharedPlanes::iterator it = sharedPlanes.begin(); it != sharedPlanes.end(); ++it) {
+            if ( it->second->available && ( ( oldest == sharedPlanes.end() ) || (it->second->lastUseStamp < oldest->second->lastUseStamp) ) ) {
+                oldest = it;
+            }
+        }
+        if ( oldest == sharedPlanes.end() ) {
+            // All planes are being rendered
+            return;
+        }
+        sharedPlanes.erase(oldest);
+    }
+}
+
 TrackerFrameAccessor::TrackerFrameAccessor(const TrackerContext* context,
                                            bool enabledChannels[3],
                                            int formatHeight)
@@ -276,84 +557,38 @@ TrackerFrameAccessor::convertLibMVRegionToRectI(const mv::Region& region,
     //roi->y2 = invertYCoordinate(region.min(1), formatHeight);
 }
 
+void
+TrackerFrameAccessor::setTrackedMarkers(const std::list<TrackMarkerPtr>& markers)
+{
+    _imp->markers = markers;
+}
+
 /*
- * @brief This is called by LibMV to retrieve an image either for reference or as search frame.
+ * @brief Renders the area roi of the tracker input and converts it to a grayscale libmv image.
  */
-mv::FrameAccessor::Key
-TrackerFrameAccessor::GetImage(int /*clip*/,
-                               int frame,
-                               mv::FrameAccessor::InputMode input_mode,
-                               int downscale,            // Downscale by 2^downscale.
-                               const mv::Region* region,     // Get full image if NULL.
-                               const mv::FrameAccessor::Transform* /*transform*/, // May be NULL.
-                               mv::FloatImage** destination)
+bool
+TrackerFrameAccessorPrivate::renderToLibMvFloatImage(int frame,
+                                                     unsigned int downscale,
+                                                     const RectI& roi,
+                                                     const RectD& precomputedRoD,
+                                                     RectI* bounds,
+                                                     MvFloatImagePtr* image)
 {
-    // Since libmv only uses MONO images for now we have only optimized for this case, remove and handle properly
-    // other case(s) when they get integrated into libmv.
-    assert(input_mode == mv::FrameAccessor::MONO);
-
-
-    FrameAccessorCacheKey key;
-    key.frame = frame;
-    key.mipMapLevel = downscale;
-    key.mode = input_mode;
-
-    /*
-       Check if a frame exists in the cache with matching key and bounds enclosing the given region
-     */
-    RectI roi;
-    if (region) {
-        convertLibMVRegionToRectI(*region, _imp->formatHeight, &roi);
-
-        QMutexLocker k(&_imp->cacheMutex);
-        std::pair<FrameAccessorCache::iterator, FrameAccessorCache::iterator> range = _imp->cache.equal_range(key);
-        for (FrameAccessorCache::iterator it = range.first; it != range.second; ++it) {
-            if ( (roi.x1 >= it->second.bounds.x1) && (roi.x2 <= it->second.bounds.x2) &&
-                 ( roi.y1 >= it->second.bounds.y1) && ( roi.y2 <= it->second.bounds.y2) ) {
-#ifdef TRACE_LIB_MV
-                qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Found cached image at frame" << frame << "with RoI x1="
-                         << region->min(0) << "y1=" << region->max(1) << "x2=" << region->max(0) << "y2=" << region->min(1);
-#endif
-                // LibMV is kinda dumb on this we must necessarily copy the data either via CopyFrom or the
-                // assignment constructor:
-                // EDIT: fixed libmv
-                *destination = it->second.image.get();
-                //destination->CopyFrom<float>(*it->second.image);
-                ++it->second.referenceCount;
-
-                return (mv::FrameAccessor::Key)it->second.image.get();
-            }
-        }
-    }
-
     EffectInstancePtr effect;
-    if (_imp->trackerInput) {
-        effect = _imp->trackerInput->getEffectInstance();
+    if (trackerInput) {
+        effect = trackerInput->getEffectInstance();
     }
     if (!effect) {
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
-    // Not in accessor cache, call renderRoI
     RenderScale scale;
-    scale.y = scale.x = Image::getScaleFromMipMapLevel( (unsigned int)downscale );
-
-
-    RectD precomputedRoD;
-    if (!region) {
-        bool isProjectFormat;
-        StatusEnum stat = effect->getRegionOfDefinition_public(_imp->trackerInput->getHashValue(), frame, scale, ViewIdx(0), &precomputedRoD, &isProjectFormat);
-        if (stat == eStatusFailed) {
-            return (mv::FrameAccessor::Key)0;
-        }
-        double par = effect->getAspectRatio(-1);
-        precomputedRoD.toPixelEnclosing( (unsigned int)downscale, par, &roi );
-    }
+    scale.y = scale.x = Image::getScaleFromMipMapLevel(downscale);
 
     std::list<ImagePlaneDesc> components;
     components.push_back( ImagePlaneDesc::getRGBComponents() );
 
-    NodePtr node = _imp->context->getNode();
+    NodePtr node = context->getNode();
     const bool isRenderUserInteraction = true;
     const bool isSequentialRender = false;
     AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(false, 0);
@@ -383,7 +618,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
                                         components,
                                         eImageBitDepthFloat,
                                         true,
-                                        _imp->context->getNode()->getEffectInstance().get(),
+                                        node->getEffectInstance().get(),
                                         eStorageModeRAM /*returnOpenGLTex*/,
                                         frame);
     std::map<ImagePlaneDesc, ImagePtr> planes;
@@ -394,7 +629,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
                  << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2;
 #endif
 
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
     assert( !planes.empty() );
@@ -407,7 +642,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
                  << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2 << ")";
 #endif
 
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
 #ifdef TRACE_LIB_MV
@@ -418,18 +653,111 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
     /*
        Copy the Natron image to the LivMV float image
      */
-    FrameAccessorCacheEntry entry;
-    entry.image = boost::make_shared<MvFloatImage>( intersectedRoI.height(), intersectedRoI.width() );
-    entry.bounds = intersectedRoI;
-    entry.referenceCount = 1;
-    natronImageToLibMvFloatImage(_imp->enabledChannels,
+    *image = boost::make_shared<MvFloatImage>( intersectedRoI.height(), intersectedRoI.width() );
+    *bounds = intersectedRoI;
+    natronImageToLibMvFloatImage(enabledChannels,
                                  sourceImage.get(),
                                  intersectedRoI,
-                                 *entry.image);
+                                 **image);
     // we ignore the transform parameter and do it in natronImageToLibMvFloatImage instead
 
+    return true;
+} // TrackerFrameAccessorPrivate::renderToLibMvFloatImage
+
+/*
+ * @brief This is called by LibMV to retrieve an image either for reference or as search frame.
+ */
+mv::FrameAccessor::Key
+TrackerFrameAccessor::GetImage(int /*clip*/,
+                               int frame,
+                               mv::FrameAccessor::InputMode input_mode,
+                               int downscale,            // Downscale by 2^downscale.
+                               const mv::Region* region,     // Get full image if NULL.
+                               const mv::FrameAccessor::Transform* /*transform*/, // May be NULL.
+                               mv::FloatImage** destination)
+{
+    // Since libmv only uses MONO images for now we have only optimized for this case, remove and handle properly
+    // other case(s) when they get integrated into libmv.
+    assert(input_mode == mv::FrameAccessor::MONO);
+
+
+    FrameAccessorCacheKey key;
+    key.frame = frame;
+    key.mipMapLevel = downscale;
+    key.mode = input_mode;
+
+    RectI roi;
+    RectD precomputedRoD;
+    if (region) {
+        convertLibMVRegionToRectI(*region, _imp->formatHeight, &roi);
+
+        /*
+           Check if the image of this region was already extracted
+         */
+        QMutexLocker k(&_imp->cacheMutex);
+        std::pair<FrameAccessorCache::iterator, FrameAccessorCache::iterator> range = _imp->cache.equal_range(key);
+        for (FrameAccessorCache::iterator it = range.first; it != range.second; ++it) {
+            if (it->second.requestedArea == roi) {
+#ifdef TRACE_LIB_MV
+                qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Found cached image at frame" << frame << "with RoI x1="
+                         << region->min(0) << "y1=" << region->max(1) << "x2=" << region->max(0) << "y2=" << region->min(1);
+#endif
+                *destination = it->second.image.get();
+                ++it->second.referenceCount;
+
+                return (mv::FrameAccessor::Key)it->second.image.get();
+            }
+        }
+    } else {
+        EffectInstancePtr effect;
+        if (_imp->trackerInput) {
+            effect = _imp->trackerInput->getEffectInstance();
+        }
+        if (!effect) {
+            return (mv::FrameAccessor::Key)0;
+        }
+        RenderScale scale;
+        scale.y = scale.x = Image::getScaleFromMipMapLevel( (unsigned int)downscale );
+        bool isProjectFormat;
+        StatusEnum stat = effect->getRegionOfDefinition_public(_imp->trackerInput->getHashValue(), frame, scale, ViewIdx(0), &precomputedRoD, &isProjectFormat);
+        if (stat == eStatusFailed) {
+            return (mv::FrameAccessor::Key)0;
+        }
+        double par = effect->getAspectRatio(-1);
+        precomputedRoD.toPixelEnclosing( (unsigned int)downscale, par, &roi );
+    }
+
+    /*
+       Render the search areas of all markers close to this one at once, so that the other markers
+       at this frame find their image in the same shared plane.
+     */
+    RectI renderArea = roi;
+    if (region) {
+        std::vector<RectI> searchAreas;
+        _imp->getMarkersSearchAreas(frame, (unsigned int)downscale, &searchAreas);
+        for (std::vector<RectI>::const_iterator it = searchAreas.begin(); it != searchAreas.end(); ++it) {
+            if ( it->intersects(roi) ) {
+                renderArea.merge(*it);
+            }
+        }
+    }
+    FrameAccessorSharedPlanePtr plane = _imp->getSharedPlane(key, roi, renderArea, precomputedRoD);
+    if (!plane) {
+        return (mv::FrameAccessor::Key)0;
+    }
+
+    RectI intersectedRoI;
+    if ( !roi.intersect(plane->bounds, &intersectedRoI) ) {
+        return (mv::FrameAccessor::Key)0;
+    }
+
+    FrameAccessorCacheEntry entry;
+    entry.image = extractLibMvFloatImage(*plane, intersectedRoI);
+    entry.requestedArea = roi;
+    entry.bounds = intersectedRoI;
+    entry.referenceCount = 1;
+
     *destination = entry.image.get();
-    //destination->CopyFrom<float>(*entry.image);
 
     //insert into the cache
     {
@@ -437,7 +765,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
         _imp->cache.insert( std::make_pair(key, entry) );
     }
 #ifdef TRACE_LIB_MV
-    qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Rendered frame" << frame << "with RoI x1="
+    qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Extracted frame" << frame << "with RoI x1="
              << intersectedRoI.x1 << "y1=" << intersectedRoI.y1 << "x2=" << intersectedRoI.x2 << "y2=" << intersectedRoI.y2;
 #endif
 
@@ -456,9 +784,9 @@ TrackerFrameAccessor::ReleaseImage(Key key)
             --it->second.referenceCount;
             if (!it->second.referenceCount) {
                 _imp->cache.erase(it);
-
-                return;
             }
+
+            return;
         }
     }
 }
@@ -28,6 +28,8 @@
 
 #include "Global/Macros.h"
 
+#include <list>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
 #endif
@@ -54,6 +56,13 @@ public:
 
     void getEnabledChannels(bool* r, bool* g, bool* b) const;
 
+    /**
+     * @brief Set the markers that are going to be tracked. For each frame, the search areas of all markers are rendered
+     * and converted once into a few shared planes, from which the image requested for each marker is extracted.
+     * This must be called before tracking starts.
+     **/
+    void setTrackedMarkers(const std::list<TrackMarkerPtr>& markers);
+
 
     // Get a possibly-filtered version of a frame of a video. Downscale will
     // cause the input image to get downscaled by 2^downscale for pyramid access.
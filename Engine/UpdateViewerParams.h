@@ -32,6 +32,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <cstddef>
 
 #include "Global/Enums.h"
@@ -58,12 +59,15 @@ public:
         // use a shared_ptr here, so that the cache entry is never released before the end of updateViewer()
         FrameEntryPtr cachedData;
         bool isCached;
-        unsigned char* ramBuffer; // a pointer to the RAM buffer held either by the cached frame or allocated by malloc()
+        unsigned char* ramBuffer; // a pointer to the RAM buffer held either by the cached frame, the display buffer or allocated by malloc()
         std::size_t bytesCount; // number of bytes in the texture
 
+        // When the cached frame is display-neutral (8-bit textures), this holds the cached frame with the
+        // viewer display transform applied and ramBuffer points to it
+        boost::shared_ptr<std::vector<unsigned char> > displayBuffer;
 
         CachedTile()
-            : rect(), rectRounded(), cachedData(), isCached(false), ramBuffer(0), bytesCount(0) {}
+            : rect(), rectRounded(), cachedData(), isCached(false), ramBuffer(0), bytesCount(0), displayBuffer() {}
     };
 
     UpdateViewerParams()
@@ -31,6 +31,7 @@
 #include <cassert>
 #include <cstring> // for std::memcpy
 #include <cfloat> // DBL_MAX
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -40,6 +41,10 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <boost/bind/bind.hpp>
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
+GCC_DIAG_OFF(unused-parameter)
+#include <Eigen/Core> // Eigen::half
+GCC_DIAG_ON(unused-parameter)
+
 CLANG_DIAG_OFF(deprecated)
 #include <QtCore/QtGlobal>
 #include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
@@ -116,6 +121,10 @@ static void scaleToTexture32bits(const RectI& roi,
                                  const RenderViewerArgs & args,
                                  const UpdateViewerParams::CachedTile& tile,
                                  float *output);
+static void scaleToTexture16bits(const RectI& roi,
+                                 const RenderViewerArgs & args,
+                                 const UpdateViewerParams::CachedTile& tile,
+                                 Eigen::half *output);
 static MinMaxVal findAutoContrastVminVmax(const ImagePtr inputImage,
                                                          DisplayChannelsEnum channels,
                                                          const RectI & rect);
@@ -123,6 +132,10 @@ static void renderFunctor(const RectI& roi,
                           const RenderViewerArgs & args,
                           ViewerInstance* viewer,
                           UpdateViewerParams::CachedTile tile);
+static void applyDisplayTransformToTiles(ViewerInstance* viewer,
+                                         DisplayChannelsEnum channels,
+                                         bool singleThreaded,
+                                         UpdateViewerParams* params);
 
 /**
  *@brief Actually converting to ARGB... but it is called BGRA by
@@ -138,6 +151,80 @@ toBGRA(unsigned char r,
     return (a << 24) | (r << 16) | (g << 8) | b;
 }
 
+/**
+ * @brief When the viewer displays 8-bit textures, the display transform (gain, gamma, colorspace and R/G/B/Y channel selection)
+ * is done on the CPU. In that case the viewer cache stores display-neutral tiles instead: linear half float RGBA at the
+ * viewer mipmap level, which takes twice the memory of an 8-bit tile. The display transform is applied to them by applyDisplayTransformToTiles() once they are fetched,
+ * so that grading the viewer does not invalidate the cache.
+ * The matte overlay is not display-neutral: it is composited on top of the display-referred image.
+ **/
+static bool
+isTextureCacheDisplayNeutral(ImageBitDepthEnum textureDepth,
+                             DisplayChannelsEnum channels)
+{
+    return textureDepth == eImageBitDepthByte && channels != eDisplayChannelsMatte;
+}
+
+static DisplayChannelsEnum
+getDisplayNeutralChannels(DisplayChannelsEnum channels)
+{
+    switch (channels) {
+    case eDisplayChannelsA:
+        // This does not read the same layer
+        return channels;
+    default:
+        return eDisplayChannelsRGB;
+    }
+}
+
+static FrameKey
+makeTextureCacheKey(const CacheEntryHolder* holder,
+                    const UpdateViewerParams& params,
+                    U64 viewerHash,
+                    DisplayChannelsEnum channels,
+                    const TextureRect& textureRect,
+                    const std::string& inputName,
+                    bool draftMode)
+{
+    const std::string alphaChannelFullName = params.alphaLayer.getPlaneID() + params.alphaChannelName;
+
+    if ( isTextureCacheDisplayNeutral(params.depth, channels) ) {
+        return FrameKey(holder,
+                        params.time,
+                        viewerHash,
+                        1.,
+                        1.,
+                        (int)eViewerColorSpaceLinear,
+                        (int)eImageBitDepthHalf,
+                        (int)getDisplayNeutralChannels(channels),
+                        params.view,
+                        textureRect,
+                        params.mipMapLevel,
+                        inputName,
+                        params.layer,
+                        alphaChannelFullName,
+                        false /*useShaders*/,
+                        draftMode);
+    }
+
+    return FrameKey(holder,
+                    params.time,
+                    viewerHash,
+                    params.gain,
+                    params.gamma,
+                    params.lut,
+                    (int)params.depth,
+                    channels,
+                    params.view,
+                    textureRect,
+                    params.mipMapLevel,
+                    inputName,
+                    params.layer,
+                    alphaChannelFullName,
+                    params.depth == eImageBitDepthFloat,
+                    draftMode);
+}
+
 const Color::Lut*
 ViewerInstance::lutFromColorspace(ViewerColorSpaceEnum cs)
 {
@@ -404,7 +491,7 @@ public:
             U64 nodeHash = viewerInput->getHashValue();
 
 
-            viewerInput->getEffectInstance()->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash,  abortInfo, treeRoot, 1, NodeFrameRequestPtr(), _openGLContext.lock(), textureIndex, timeline, isAnalysis, false, NodesList(), viewerInput->getCurrentRenderThreadSafety(), viewerInput->getCurrentOpenGLRenderSupport(), doNanHandling, draftMode, stats);
+            viewerInput->getEffectInstance()->setParallelRenderArgsTLS(time, view, isRenderUserInteraction, isSequential, nodeHash,  abortInfo, treeRoot, 1, NodeFrameRequestPtr(), _openGLContext.lock(), textureIndex, timeline, isAnalysis, false, NodesList(), viewerInput->getCurrentRenderThreadSafety(), viewerInput->getCurrentOpenGLRenderSupport(), doNanHandling, draftMode, stats, _bufferPool);
         }
     }
 
@@ -1080,22 +1167,13 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
     if (useCache) {
         FrameEntryLocker entryLocker(_imp.get());
         for (std::list<UpdateViewerParams::CachedTile>::iterator it = outArgs->params->tiles.begin(); it != outArgs->params->tiles.end(); ++it) {
-            FrameKey key(getNode().get(),
-                         outArgs->params->time,
-                         viewerHash,
-                         outArgs->params->gain,
-                         outArgs->params->gamma,
-                         outArgs->params->lut,
-                         (int)outArgs->params->depth,
-                         outArgs->channels,
-                         outArgs->params->view,
-                         it->rect,
-                         mipmapLevel,
-                         inputToRenderName,
-                         outArgs->params->layer,
-                         outArgs->params->alphaLayer.getPlaneID() + outArgs->params->alphaChannelName,
-                         outArgs->params->depth == eImageBitDepthFloat,
-                         isDraftMode);
+            FrameKey key = makeTextureCacheKey(getNode().get(),
+                                               *outArgs->params,
+                                               viewerHash,
+                                               outArgs->channels,
+                                               it->rect,
+                                               inputToRenderName,
+                                               isDraftMode);
             std::list<FrameEntryPtr> entries;
             bool hasTextureCached = appPTR->getTexture(key, &entries);
             if ( stats  && stats->isInDepthProfilingEnabled() ) {
@@ -1150,6 +1228,11 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
                 ++outArgs->params->nbCachedTile;
             }
         }
+
+        if ( isTextureCacheDisplayNeutral(outArgs->params->depth, outArgs->channels) ) {
+            QReadLocker k(&_imp->gammaLookupMutex);
+            applyDisplayTransformToTiles(this, outArgs->channels, false, outArgs->params.get());
+        }
     }
 
 
@@ -1620,6 +1703,12 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
         }*/
 
         const bool viewerRenderRoiOnly = !useTextureCache;
+
+        // Tiles stored in a display-neutral cache entry are rendered as linear half float RGBA: the display transform
+        // is applied by applyDisplayTransformToTiles once they are rendered (@see isTextureCacheDisplayNeutral)
+        const bool renderDisplayNeutral = useTextureCache && isTextureCacheDisplayNeutral(inArgs.params->depth, inArgs.channels);
+        const ImageBitDepthEnum renderDepth = renderDisplayNeutral ? eImageBitDepthHalf : inArgs.params->depth;
+        const DisplayChannelsEnum renderChannels = renderDisplayNeutral ? getDisplayNeutralChannels(inArgs.channels) : inArgs.channels;
         ViewerColorSpaceEnum srcColorSpace = colorImage ? getApp()->getDefaultColorSpaceForBitDepth( colorImage->getBitDepth() ) : eViewerColorSpaceSRGB;
 
         if ( ( (inArgs.channels == eDisplayChannelsA) && ( !colorImage || (alphaChannelIndex < 0) || ( alphaChannelIndex >= (int)colorImage->getComponentsCount() ) ) ) ||
@@ -1781,22 +1870,13 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
                     assert(!it->ramBuffer);
 
 
-                    FrameKey key(getNode().get(),
-                                 inArgs.params->time,
-                                 viewerHash,
-                                 inArgs.params->gain,
-                                 inArgs.params->gamma,
-                                 inArgs.params->lut,
-                                 (int)inArgs.params->depth,
-                                 inArgs.channels,
-                                 inArgs.params->view,
-                                 it->rect,
-                                 inArgs.params->mipMapLevel,
-                                 inputToRenderName,
-                                 inArgs.params->layer,
-                                 inArgs.params->alphaLayer.getPlaneID() + inArgs.params->alphaChannelName,
-                                 inArgs.params->depth == eImageBitDepthFloat,
-                                 inArgs.draftModeEnabled);
+                    FrameKey key = makeTextureCacheKey(getNode().get(),
+                                                       *inArgs.params,
+                                                       viewerHash,
+                                                       inArgs.channels,
+                                                       it->rect,
+                                                       inputToRenderName,
+                                                       inArgs.draftModeEnabled);
 
 
 
@@ -1857,7 +1937,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
         std::size_t tileRowElements = inArgs.params->tileSize;
         // Internally the buffer is interpreted as U32 when 8bit, so we do not multiply it by 4 for RGBA
-        if (updateParams->depth == eImageBitDepthFloat) {
+        if (renderDepth != eImageBitDepthByte) {
             tileRowElements *= 4;
         }
 
@@ -1879,9 +1959,9 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
             const RenderViewerArgs args(colorImage,
                                         alphaImage,
-                                        inArgs.channels,
+                                        renderChannels,
                                         updateParams->srcPremult,
-                                        updateParams->depth,
+                                        renderDepth,
                                         updateParams->gain,
                                         updateParams->gamma,
                                         updateParams->offset,
@@ -1947,9 +2027,9 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
             const RenderViewerArgs args(colorImage,
                                         alphaImage,
-                                        inArgs.channels,
+                                        renderChannels,
                                         updateParams->srcPremult,
-                                        updateParams->depth,
+                                        renderDepth,
                                         updateParams->gain,
                                         updateParams->gamma,
                                         updateParams->offset,
@@ -1980,6 +2060,11 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
             }
         } // if (singleThreaded)
 
+        if (renderDisplayNeutral) {
+            QReadLocker k(&_imp->gammaLookupMutex);
+            applyDisplayTransformToTiles(this, inArgs.channels, singleThreaded, updateParams.get());
+        }
+
 
         if ( colorImage && stats && stats->isInDepthProfilingEnabled() ) {
             stats->addRenderInfosForNode( getNode(), NodePtr(), colorImage->getComponents().getChannelsLabel(), viewerRenderRoI, viewerRenderTimeRecorder->getTimeSinceCreation() );
@@ -2039,12 +2124,175 @@ renderFunctor(const RectI& roi,
     if ( (args.bitDepth == eImageBitDepthFloat) ) {
         // image is stored as linear, the OpenGL shader with do gamma/sRGB/Rec709 decompression, as well as gain and offset
         scaleToTexture32bits(roi, args, tile, (float*)tile.ramBuffer);
+    } else if (args.bitDepth == eImageBitDepthHalf) {
+        // display-neutral cached tile, the display transform is applied by applyDisplayTransform
+        scaleToTexture16bits(roi, args, tile, (Eigen::half*)tile.ramBuffer);
     } else {
         // texture is stored as sRGB/Rec709 compressed 8-bit RGBA
         scaleToTexture8bits(roi, args, viewer, tile, (U32*)tile.ramBuffer);
     }
 }
 
+/**
+ * @brief Applies gain and offset to a scanline plane. The loop only reads and writes contiguous floats
+ * so that the compiler vectorizes it.
+ **/
+static void
+applyGainAndOffset(const float* src,
+                   float* dst,
+                   int width,
+                   float gain,
+                   float offset)
+{
+    for (int x = 0; x < width; ++x) {
+        dst[x] = src[x] * gain + offset;
+    }
+}
+
+/**
+ * @brief Converts a display-neutral cached tile (linear half float RGBA) to the 8-bit display texture,
+ * applying gain/offset, gamma, channel selection and the viewer colorspace.
+ * Each scanline is first split into float planes so that the arithmetic is done by vectorizable loops,
+ * the gamma and colorspace lookups are done per pixel.
+ **/
+static void
+applyDisplayTransform(const UpdateViewerParams* params,
+                      DisplayChannelsEnum channels,
+                      const Color::Lut* colorSpace,
+                      ViewerInstance* viewer,
+                      UpdateViewerParams::CachedTile& tile)
+{
+    if (!tile.cachedData || tile.displayBuffer) {
+        return;
+    }
+    const Eigen::half* src = (const Eigen::half*)tile.cachedData->data();
+    if (!src) {
+        return;
+    }
+    tile.displayBuffer = boost::make_shared<std::vector<unsigned char> >(tile.bytesCount, 0);
+    tile.ramBuffer = &tile.displayBuffer->front();
+
+    // The cached tile is rounded to the tile size, only its rect portion is valid
+    U32* dst = (U32*)tile.ramBuffer;
+    const int rowElements = params->tileSize;
+    const int x1 = tile.rect.x1 - tile.rectRounded.x1;
+    const int width = tile.rect.x2 - tile.rect.x1;
+    if (width <= 0) {
+        return;
+    }
+    const bool luminance = (channels == eDisplayChannelsY);
+    const int srcChannel = (channels == eDisplayChannelsR) ? 0 : (channels == eDisplayChannelsG) ? 1 : (channels == eDisplayChannelsB) ? 2 : -1;
+    const float gain = params->gain;
+    const float offset = params->offset;
+    const double gamma = params->gamma;
+
+    // One plane per channel, r, g and b are contiguous
+    std::vector<float> planes(width * 4);
+    float* r = &planes[0];
+    float* g = r + width;
+    float* b = g + width;
+    float* a = b + width;
+    const float* rgb[3] = { r, g, b };
+
+    for (int y = tile.rect.y1; y < tile.rect.y2; ++y) {
+        const int rowOffset = (y - tile.rectRounded.y1) * rowElements + x1;
+        const Eigen::half* src_pixels = src + rowOffset * 4;
+        U32* dst_pixels = dst + rowOffset;
+
+        for (int x = 0; x < width; ++x) {
+            r[x] = static_cast<float>(src_pixels[x * 4]);
+            g[x] = static_cast<float>(src_pixels[x * 4 + 1]);
+            b[x] = static_cast<float>(src_pixels[x * 4 + 2]);
+            a[x] = static_cast<float>(src_pixels[x * 4 + 3]);
+        }
+
+        if (srcChannel >= 0) {
+            applyGainAndOffset(rgb[srcChannel], r, width, gain, offset);
+            std::copy(r, r + width, g);
+            std::copy(r, r + width, b);
+        } else {
+            applyGainAndOffset(r, r, width, gain, offset);
+            applyGainAndOffset(g, g, width, gain, offset);
+            applyGainAndOffset(b, b, width, gain, offset);
+        }
+
+        if (gamma <= 0) {
+            for (int i = 0; i < width * 3; ++i) {
+                r[i] = (r[i] < 1.f) ? 0.f : (r[i] == 1.f ? 1.f : std::numeric_limits<float>::infinity() );
+            }
+        } else if (gamma != 1.) {
+            for (int i = 0; i < width * 3; ++i) {
+                r[i] = viewer->interpolateGammaLut(r[i]);
+            }
+        }
+
+        if (luminance) {
+            for (int x = 0; x < width; ++x) {
+                r[x] = 0.299f * r[x] + 0.587f * g[x] + 0.114f * b[x];
+            }
+            std::copy(r, r + width, g);
+            std::copy(r, r + width, b);
+        }
+
+        if (!colorSpace) {
+            for (int x = 0; x < width; ++x) {
+                dst_pixels[x] = toBGRA(Color::floatToInt<256>(r[x]), Color::floatToInt<256>(g[x]), Color::floatToInt<256>(b[x]), Color::floatToInt<256>(a[x]));
+            }
+            continue;
+        }
+
+        // Dither the same way as scaleToTexture8bits_generic: start at a random position of the scanline
+        // and diffuse the error forward, then backward from that position
+        // coverity[dont_call]
+        int start = (int)( rand() % width );
+        for (int backward = 0; backward < 2; ++backward) {
+            int index = backward ? start - 1 : start;
+            unsigned error_r = 0x80;
+            unsigned error_g = 0x80;
+            unsigned error_b = 0x80;
+
+            while (index < width && index >= 0) {
+                error_r = (error_r & 0xff) + colorSpace->toColorSpaceUint8xxFromLinearFloatFast(r[index]);
+                error_g = (error_g & 0xff) + colorSpace->toColorSpaceUint8xxFromLinearFloatFast(g[index]);
+                error_b = (error_b & 0xff) + colorSpace->toColorSpaceUint8xxFromLinearFloatFast(b[index]);
+                assert(error_r < 0x10000 && error_g < 0x10000 && error_b < 0x10000);
+                dst_pixels[index] = toBGRA( (U8)(error_r >> 8), (U8)(error_g >> 8), (U8)(error_b >> 8), Color::floatToInt<256>(a[index]) );
+
+                if (backward) {
+                    --index;
+                } else {
+                    ++index;
+                }
+            }
+        }
+    }
+} // applyDisplayTransform
+
+// The gamma lookup mutex of the viewer must be locked for reading
+static void
+applyDisplayTransformToTiles(ViewerInstance* viewer,
+                             DisplayChannelsEnum channels,
+                             bool singleThreaded,
+                             UpdateViewerParams* params)
+{
+    const Color::Lut* colorSpace = ViewerInstance::lutFromColorspace(params->lut);
+
+    if ( singleThreaded || (params->tiles.size() == 1) ||
+         ( QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount() ) ) {
+        for (std::list<UpdateViewerParams::CachedTile>::iterator it = params->tiles.begin(); it != params->tiles.end(); ++it) {
+            applyDisplayTransform(params, channels, colorSpace, viewer, *it);
+        }
+    } else {
+        QtConcurrent::map( params->tiles,
+                           boost::bind(&applyDisplayTransform,
+                                       params,
+                                       channels,
+                                       colorSpace,
+                                       viewer,
+                                       _1) ).waitForFinished();
+    }
+}
+
 inline
 MinMaxVal
 findAutoContrastVminVmax_generic(const ImagePtr inputImage,
@@ -2905,6 +3153,31 @@ scaleToTexture32bits(const RectI& roi,
     }
 } // scaleToTexture32bits
 
+void
+scaleToTexture16bits(const RectI& roi,
+                     const RenderViewerArgs & args,
+                     const UpdateViewerParams::CachedTile& tile,
+                     Eigen::half *output)
+{
+    assert(output && !args.renderOnlyRoI);
+
+    // Render the tile as linear float with the layout of the cached tile, then store the valid portion as half float
+    const int rowElements = (int)args.tileRowElements;
+    std::vector<float> buffer( (std::size_t)rowElements * (tile.rect.y2 - tile.rectRounded.y1) );
+    scaleToTexture32bits(roi, args, tile, &buffer.front());
+
+    const int x1 = (tile.rect.x1 - tile.rectRounded.x1) * 4;
+    const int width = (tile.rect.x2 - tile.rect.x1) * 4;
+    for (int y = tile.rect.y1; y < tile.rect.y2; ++y) {
+        const int rowOffset = (y - tile.rectRounded.y1) * rowElements + x1;
+        const float* src_pixels = &buffer[rowOffset];
+        Eigen::half* dst_pixels = output + rowOffset;
+        for (int x = 0; x < width; ++x) {
+            dst_pixels[x] = Eigen::half(src_pixels[x]);
+        }
+    }
+}
+
 void
 ViewerInstance::ViewerInstancePrivate::updateViewer(UpdateViewerParamsPtr params)
 {
@@ -3540,9 +3813,12 @@ void
 ViewerInstance::reportStats(int time,
                             ViewIdx view,
                             double wallTime,
-                            const RenderStatsMap& stats)
+                            const RenderStatsMap& stats,
+                            int nParallelRenders,
+                            double parallelRendersFps,
+                            ParallelRendersDecisionEnum parallelRendersDecision)
 {
-    Q_EMIT renderStatsAvailable(time, view, wallTime, stats);
+    Q_EMIT renderStatsAvailable(time, view, wallTime, stats, nParallelRenders, parallelRendersFps, parallelRendersDecision);
 }
 
 NATRON_NAMESPACE_EXIT
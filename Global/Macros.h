@@ -91,6 +91,8 @@ namespace NATRON_PYTHON_NAMESPACE { }
 // - tools/linux/include/qs/natron.qs
 #define NATRON_PROJECT_FILE_EXT "ntp"
 #define NATRON_PROJECT_FILE_MIME_TYPE "application/vnd.natron.project"
+// binary projects (see Engine/ProjectBinarySerialization.h) use the same MIME type
+#define NATRON_PROJECT_BINARY_FILE_EXT "ntpb"
 #define NATRON_PROJECT_UNTITLED "Untitled." NATRON_PROJECT_FILE_EXT
 #define NATRON_CACHE_FILE_EXT "ntc"
 #define NATRON_LAYOUT_FILE_EXT "nl"
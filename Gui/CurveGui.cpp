@@ -287,6 +287,16 @@ drawLineStrip(const std::vector<float>& vertices,
     glEnd();
 }
 
+void
+CurveGui::evaluateSamples(const double* x,
+                          int count,
+                          double* y) const
+{
+    for (int i = 0; i < count; ++i) {
+        y[i] = evaluate(false, x[i]);
+    }
+}
+
 void
 CurveGui::drawCurve(int curveIndex,
                     int curvesCount)
@@ -344,28 +354,40 @@ CurveGui::drawCurve(int curveIndex,
             bool isX1AKey = false;
             KeyFrame x1Key;
             KeyFrameSet::const_iterator lastUpperIt = keyframes.end();
+            // The points which are not keyframes are evaluated all at once afterwards
+            std::vector<double> samplesX;
+            std::vector<std::size_t> samplesVertexIndex;
 
             while ( x1 < (widgetWidth - 1) ) {
-                double x, y;
+                double x;
                 if (!isX1AKey) {
                     x = _curveWidget->toZoomCoordinates(x1, 0).x();
-                    y = evaluate(false, x);
+                    samplesX.push_back(x);
+                    samplesVertexIndex.push_back( vertices.size() + 1 );
+                    vertices.push_back( (float)x );
+                    vertices.push_back(0.f);
                 } else {
                     x = x1Key.getTime();
-                    y = x1Key.getValue();
+                    vertices.push_back( (float)x );
+                    vertices.push_back( (float)x1Key.getValue() );
                 }
 
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
                 nextPointForSegment(x, keyframes, isPeriodic, parametricRange.first, parametricRange.second,  &lastUpperIt, &x2, &x1Key, &isX1AKey);
                 x1 = x2;
             }
             //also add the last point
             {
                 double x = _curveWidget->toZoomCoordinates(x1, 0).x();
-                double y = evaluate(false, x);
+                samplesX.push_back(x);
+                samplesVertexIndex.push_back( vertices.size() + 1 );
                 vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
+                vertices.push_back(0.f);
+            }
+
+            std::vector<double> samplesY( samplesX.size() );
+            evaluateSamples( &samplesX[0], (int)samplesX.size(), &samplesY[0] );
+            for (std::size_t i = 0; i < samplesY.size(); ++i) {
+                vertices[samplesVertexIndex[i]] = (float)samplesY[i];
             }
         } catch (...) {
         }
@@ -677,6 +699,20 @@ KnobCurveGui::evaluate(bool useExpr,
     }
 }
 
+void
+KnobCurveGui::evaluateSamples(const double* x,
+                              int count,
+                              double* y) const
+{
+    KnobIPtr knob = getInternalKnob();
+    KnobParametric* isParametric = dynamic_cast<KnobParametric*>( knob.get() );
+    CurvePtr curve = isParametric ? isParametric->getParametricCurve(_dimension) : _internalCurve;
+
+    assert(curve);
+    // The curve is locked once for all the samples
+    curve->getValuesAt(x, count, y, false);
+}
+
 CurvePtr
 KnobCurveGui::getInternalCurve() const
 {
@@ -35,6 +35,7 @@
 #include "Engine/Knob.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
+#include "Engine/Project.h"
 #include "Engine/ReadNode.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h"
@@ -369,6 +370,9 @@ DSTransformKeysCommand::undo()
         }
     }
 
+    // Propagate the hash of all the nodes once all keys are moved
+    NodesChangesBatch_RAII batch( differentKnobs.empty() ? AppInstancePtr() : differentKnobs.front()->getApp() );
+
     for (TransformKeys::iterator it = _keys.begin(); it != _keys.end(); ++it) {
         it->first->getInternalKnob()->cloneCurve(ViewSpec::all(), it->first->getDimension(), *it->second.oldCurve);
     }
@@ -404,6 +408,9 @@ DSTransformKeysCommand::redo()
         }
     }
 
+    // Propagate the hash of all the nodes once all keys are moved
+    NodesChangesBatch_RAII batch( differentKnobs.empty() ? AppInstancePtr() : differentKnobs.front()->getApp() );
+
     if (!_firstRedoCalled) {
         for (TransformKeys::iterator it = _keys.begin(); it != _keys.end(); ++it) {
             it->second.oldCurve.reset( new Curve( *it->first->getInternalKnob()->getCurve( ViewIdx(0), it->first->getDimension() ) ) );
@@ -117,6 +117,12 @@ DotGui::DotGui(QGraphicsItem* parent)
 {
 }
 
+QGraphicsItem*
+DotGui::getSimplifiedShape() const
+{
+    return diskShape;
+}
+
 void
 DotGui::createGui()
 {
@@ -68,6 +68,8 @@ private:
     virtual void applyBrush(const QBrush & brush) OVERRIDE FINAL;
     virtual bool canResize() OVERRIDE FINAL WARN_UNUSED_RETURN { return false; }
 
+    virtual QGraphicsItem* getSimplifiedShape() const OVERRIDE FINAL WARN_UNUSED_RETURN;
+
     virtual QRectF boundingRect() const OVERRIDE FINAL;
     virtual QPainterPath shape() const OVERRIDE FINAL;
     QGraphicsEllipseItem* diskShape;
@@ -33,6 +33,7 @@
 #include <QPainter>
 #include <QApplication>
 #include <QGraphicsScene>
+#include <QStyleOptionGraphicsItem>
 
 #include "Gui/NodeGui.h"
 #include "Gui/NodeGraph.h"
@@ -435,6 +436,13 @@ Edge::initLine()
         return;
     }
 
+    // Connections may be made by scripts or auto-connect, outside of the interactions refreshing the navigator
+    NodeGuiPtr anyNode = dest ? dest : source;
+    NodeGraph* graph = anyNode->getDagGui();
+    if (graph) {
+        graph->invalidateNavigatorSceneCache();
+    }
+
     double sc = scale();
     QRectF sourceBBOX = source ? mapFromItem( source.get(), source->boundingRect() ).boundingRect() : QRectF(0, 0, 1, 1);
     QRectF destBBOX = dest ? mapFromItem( dest.get(), dest->boundingRect() ).boundingRect()  : QRectF(0, 0, 1, 1);
@@ -757,8 +765,19 @@ Edge::paint(QPainter *painter,
 
     QPen myPen = pen();
     NodeGuiPtr dst = _imp->dest.lock();
+    bool simplified = false;
     if (dst) {
-        if ( dst->getDagGui()->isDoingNavigatorRender() ) {
+        NodeGraph* graph = dst->getDagGui();
+        if ( graph->isDoingNavigatorRender() ) {
+            return;
+        }
+        simplified = graph->isLevelOfDetailEnabled();
+    }
+
+    if (simplified) {
+        ///Cull edges that would cover less than a pixel on screen
+        double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+        if (line().length() * lod < 1.) {
             return;
         }
     }
@@ -791,6 +810,11 @@ Edge::paint(QPainter *painter,
 
     painter->drawLine( line() );
 
+    if (simplified) {
+        ///Arrow heads and bend points are not distinguishable when zoomed out
+        return;
+    }
+
     myPen.setStyle(Qt::SolidLine);
     painter->setPen(myPen);
 
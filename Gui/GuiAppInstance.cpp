@@ -33,6 +33,7 @@
 #include <QtCore/QMutex>
 #include <QtCore/QCoreApplication>
 
+#include "Engine/AutoSaveJournal.h"
 #include "Engine/CLArgs.h"
 #include "Engine/Project.h"
 #include "Engine/CreateNodeArgs.h"
@@ -61,6 +62,7 @@
 #include "Gui/KnobGuiFile.h"
 #include "Gui/MultiInstancePanel.h"
 #include "Gui/ProgressPanel.h"
+#include "Gui/ProjectGuiSerialization.h"
 #include "Gui/ViewerTab.h"
 #include "Gui/SplashScreen.h"
 #include "Gui/ScriptEditor.h"
@@ -388,7 +390,7 @@ GuiAppInstance::loadInternal(const CLArgs& cl,
             ///If this is a Python script, execute it
             loadPythonScript(info);
             execOnProjectCreatedCallback();
-        } else if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
+        } else if ( ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) || ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_BINARY_FILE_EXT) ) ) {
             ///Otherwise just load the project specified.
             QString name = info.fileName();
             QString path = info.path();
@@ -435,6 +437,7 @@ GuiAppInstance::findAndTryLoadUntitledAutoSave()
 
         foundAutosaves << entry;
     }
+    AutoSaveJournal::filterAutoSaves(savesDir.path(), &foundAutosaves);
     if ( foundAutosaves.empty() ) {
         return false;
     }
@@ -798,6 +801,16 @@ GuiAppInstance::saveProjectGui(boost::archive::xml_oarchive & archive)
     }
 }
 
+void
+GuiAppInstance::copyProjectGui(boost::archive::xml_iarchive & inArchive,
+                               boost::archive::xml_oarchive & outArchive) const
+{
+    ProjectGuiSerialization obj;
+
+    inArchive >> boost::serialization::make_nvp("ProjectGui", obj);
+    outArchive << boost::serialization::make_nvp("ProjectGui", obj);
+}
+
 void
 GuiAppInstance::setupViewersForViews(const std::vector<std::string>& viewNames)
 {
@@ -42,6 +42,7 @@ GCC_DIAG_ON(unused-parameter)
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
 #include "Engine/Node.h"
+#include "Engine/Project.h"
 #include "Engine/TimeLine.h"
 #include "Engine/AppInstance.h"
 #include "Engine/KnobSerialization.h"
@@ -310,6 +311,8 @@ MultipleKnobEditsUndoCommand::undo()
 {
     assert( !knobs.empty() );
     KnobHolder* holder = knobs.begin()->first.lock()->getKnob()->getHolder();
+    // The knobs may belong to several nodes: propagate their hash once all values are set
+    NodesChangesBatch_RAII batch( holder ? holder->getApp() : AppInstancePtr() );
     if (holder) {
         holder->beginChanges();
     }
@@ -385,6 +388,8 @@ MultipleKnobEditsUndoCommand::redo()
 {
     assert( !knobs.empty() );
     KnobHolder* holder = knobs.begin()->first.lock()->getKnob()->getHolder();
+    // The knobs may belong to several nodes: propagate their hash once all values are set
+    NodesChangesBatch_RAII batch( holder ? holder->getApp() : AppInstancePtr() );
     if (holder) {
         holder->beginChanges();
     }
@@ -311,9 +311,12 @@ NodeGraph::paintEvent(QPaintEvent* e)
         QPointF navTopLeftScene = mapToScene(navTopLeftWidget);
 
         _imp->_navigator->refreshPosition(navTopLeftScene, navWidth, navHeight);
-        updateNavigator();
+        refreshLevelOfDetail();
+        ///The view moved but not the nodes: the navigator can re-use its render of the scene
+        updateNavigator(false);
         _imp->_refreshOverlays = false;
     }
+    refreshPendingPreviews();
     QGraphicsView::paintEvent(e);
 
     if (drawLockedMode) {
@@ -413,6 +416,9 @@ NodeGraph::createNodeGUI(const NodePtr & node,
         QMutexLocker l(&_imp->_nodesMutex);
         _imp->_nodes.push_back(node_ui);
     }
+    if (_imp->levelOfDetailEnabled) {
+        node_ui->setSimplifiedRendering(true);
+    }
 
     //NodeGroup* parentIsGroup = dynamic_cast<NodeGroup*>(node->getGroup().get());;
     const std::list<NodePtr>& nodesBeingCreated = getGui()->getApp()->getNodesBeingCreated();
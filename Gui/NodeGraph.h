@@ -96,12 +96,36 @@ public:
 
     QImage getFullSceneScreenShot();
 
+    /**
+     * @brief Marks the render of the scene used by the navigator as outdated, e.g. because an edge changed.
+     **/
+    void invalidateNavigatorSceneCache();
+
     bool areAllNodesVisible();
 
     /**
-     * @brief Repaint the navigator
+     * @brief Repaint the navigator.
+     * @param sceneChanged If false, only the view moved: the cached render of the nodes is re-used
+     * and only the highlight of the visible portion is refreshed.
+     **/
+    void updateNavigator(bool sceneChanged = true);
+
+    /**
+     * @brief Returns true when the graph is zoomed out below NATRON_NODEGRAPH_LOD_ZOOM_THRESHOLD:
+     * nodes are then drawn as plain shapes, edges without arrows and previews are not computed.
      **/
-    void updateNavigator();
+    bool isLevelOfDetailEnabled() const;
+
+    /**
+     * @brief Returns true if the details of the given node (e.g: its preview) are visible on screen
+     **/
+    bool isNodeDetailVisible(const NodeGui* node) const;
+
+    /**
+     * @brief Called by a node which skipped the computation of its preview because it was not visible,
+     * see refreshPendingPreviews()
+     **/
+    void notifyPreviewPending();
 
     const NodesGuiList & getAllActiveNodes() const;
     NodesGuiList getAllActiveNodes_mt_safe() const;
@@ -260,6 +284,12 @@ private:
 
     bool isNearbyNavigator(const QPoint& widgetPos, QPointF& scenePos) const;
 
+    void refreshLevelOfDetail();
+
+    void refreshPendingPreviews();
+
+    QImage renderNavigatorScene(const QRectF& nodesRect, int navWidth, int navHeight);
+
     virtual void enterEvent(QEvent* e) OVERRIDE FINAL;
     virtual void leaveEvent(QEvent* e) OVERRIDE FINAL;
     virtual void keyPressEvent(QKeyEvent* e) OVERRIDE FINAL;
@@ -441,6 +441,7 @@ NodeGraph::mouseMoveEvent(QMouseEvent* e)
     case eEventStateDraggingNode: {
         mustUpdate = true;
         mustUpdateNavigator = true;
+        _imp->navigatorSceneCacheDirty = true;
         bool controlDown = modifierHasControl(e);
         bool shiftdown = modifierHasShift(e);
         moveSelectedNodesBy(shiftdown, controlDown, lastMousePosScene, newPos, sceneR, true);
@@ -458,6 +459,7 @@ NodeGraph::mouseMoveEvent(QMouseEvent* e)
     }
     case eEventStateResizingBackdrop: {
         mustUpdateNavigator = true;
+        _imp->navigatorSceneCacheDirty = true;
         assert(_imp->_backdropResized);
         QPointF p = _imp->_backdropResized->scenePos();
         int w = newPos.x() - p.x();
@@ -454,8 +454,11 @@ NodeGraph::clearSelection()
 }
 
 void
-NodeGraph::updateNavigator()
+NodeGraph::updateNavigator(bool sceneChanged)
 {
+    if (sceneChanged) {
+        _imp->navigatorSceneCacheDirty = true;
+    }
     if ( !areAllNodesVisible() ) {
         _imp->_navigator->setPixmap( QPixmap::fromImage( getFullSceneScreenShot() ) );
         _imp->_navigator->show();
@@ -481,4 +484,75 @@ NodeGraph::areAllNodesVisible()
     return true;
 }
 
+bool
+NodeGraph::isLevelOfDetailEnabled() const
+{
+    return _imp->levelOfDetailEnabled;
+}
+
+void
+NodeGraph::refreshLevelOfDetail()
+{
+    bool enabled = transform().m11() < NATRON_NODEGRAPH_LOD_ZOOM_THRESHOLD;
+
+    if (enabled == _imp->levelOfDetailEnabled) {
+        return;
+    }
+    _imp->levelOfDetailEnabled = enabled;
+
+    ///Antialiasing is not noticeable at this zoom level but costly with thousands of items
+    setRenderHint(QPainter::Antialiasing, !enabled);
+
+    QMutexLocker l(&_imp->_nodesMutex);
+    for (NodesGuiList::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+        (*it)->setSimplifiedRendering(enabled);
+    }
+}
+
+bool
+NodeGraph::isNodeDetailVisible(const NodeGui* node) const
+{
+    if ( _imp->levelOfDetailEnabled || !isVisible() ) {
+        return false;
+    }
+
+    return visibleSceneRect().intersects( node->sceneBoundingRect() );
+}
+
+void
+NodeGraph::notifyPreviewPending()
+{
+    _imp->hasPendingPreviews = true;
+}
+
+void
+NodeGraph::refreshPendingPreviews()
+{
+    if ( !_imp->hasPendingPreviews || _imp->levelOfDetailEnabled ) {
+        return;
+    }
+
+    QRectF visibleRect = visibleSceneRect();
+    NodesGuiList toCompute;
+    bool stillPending = false;
+    {
+        QMutexLocker l(&_imp->_nodesMutex);
+        for (NodesGuiList::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+            if ( !(*it)->isPreviewPending() ) {
+                continue;
+            }
+            if ( visibleRect.intersects( (*it)->sceneBoundingRect() ) ) {
+                toCompute.push_back(*it);
+            } else {
+                stillPending = true;
+            }
+        }
+    }
+    _imp->hasPendingPreviews = stillPending;
+
+    for (NodesGuiList::iterator it = toCompute.begin(); it != toCompute.end(); ++it) {
+        (*it)->computePendingPreview();
+    }
+}
+
 NATRON_NAMESPACE_EXIT
@@ -58,22 +58,73 @@ CLANG_DIAG_ON(uninitialized)
 
 NATRON_NAMESPACE_ENTER
 QImage
-NodeGraph::getFullSceneScreenShot()
+NodeGraph::renderNavigatorScene(const QRectF& nodesRect,
+                                int navWidth,
+                                int navHeight)
 {
+    // Render the nodes at the resolution of the navigator, keeping their aspect ratio
+    double scaleFactor = std::max( 0.001, std::min( navWidth / nodesRect.width(), navHeight / nodesRect.height() ) );
+    int w = std::max( 1, (int)std::floor(nodesRect.width() * scaleFactor) );
+    int h = std::max( 1, (int)std::floor(nodesRect.height() * scaleFactor) );
+    QImage renderImage(w, h, QImage::Format_ARGB32_Premultiplied);
+
+    renderImage.fill( QColor(71, 71, 71, 255) );
+
     _imp->isDoingPreviewRender = true;
 
+    QPainter painter(&renderImage);
+
+    // Remove the overlays from the scene before rendering it
+    scene()->removeItem(_imp->_cacheSizeText);
+    scene()->removeItem(_imp->_navigator);
+
+    // Render into the QImage with downscaling
+    scene()->render(&painter, renderImage.rect(), nodesRect, Qt::KeepAspectRatio);
+
+    // Add the overlays back
+    scene()->addItem(_imp->_navigator);
+    scene()->addItem(_imp->_cacheSizeText);
+
+    _imp->isDoingPreviewRender = false;
+
+    return renderImage;
+}
+
+void
+NodeGraph::invalidateNavigatorSceneCache()
+{
+    _imp->navigatorSceneCacheDirty = true;
+}
+
+QImage
+NodeGraph::getFullSceneScreenShot()
+{
     // The bbox of all nodes in the nodegraph
-    QRectF sceneR = _imp->calcNodesBoundingRect();
+    QRectF nodesR = _imp->calcNodesBoundingRect();
 
     // The visible portion of the nodegraph
     QRectF viewRect = visibleSceneRect();
 
-    // Make sure the visible rect is included in the scene rect
-    sceneR = sceneR.united(viewRect);
-
     int navWidth = std::ceil(width() * NATRON_NAVIGATOR_BASE_WIDTH);
     int navHeight = std::ceil(height() * NATRON_NAVIGATOR_BASE_HEIGHT);
 
+    // Rendering the whole scene is linear in the number of items: only do it when the nodes changed,
+    // panning and zooming re-use the cached render
+    if ( _imp->navigatorSceneCacheDirty || (nodesR != _imp->navigatorSceneCacheRect) ||
+         ( QSize(navWidth, navHeight) != _imp->navigatorSceneCacheSize ) ) {
+        if ( nodesR.isEmpty() ) {
+            _imp->navigatorSceneCache = QImage();
+        } else {
+            _imp->navigatorSceneCache = renderNavigatorScene(nodesR, navWidth, navHeight);
+        }
+        _imp->navigatorSceneCacheRect = nodesR;
+        _imp->navigatorSceneCacheSize = QSize(navWidth, navHeight);
+        _imp->navigatorSceneCacheDirty = false;
+    }
+
+    // Make sure the visible rect is included in the scene rect
+    QRectF sceneR = nodesR.united(viewRect);
+
     // Make sceneR and viewRect keep the same aspect ratio as the navigator
     double xScale = navWidth / sceneR.width();
     double yScale =  navHeight / sceneR.height();
@@ -81,7 +132,7 @@ NodeGraph::getFullSceneScreenShot()
     int sceneW_navPixelCoord = std::floor(sceneR.width() * scaleFactor);
     int sceneH_navPixelCoord = std::floor(sceneR.height() * scaleFactor);
 
-    // Render the scene in an image with the same aspect ratio  as the scene rect
+    // Compose the scene in an image with the same aspect ratio  as the scene rect
     QImage renderImage(sceneW_navPixelCoord, sceneH_navPixelCoord, QImage::Format_ARGB32_Premultiplied);
 
     // Fill the background
@@ -102,16 +153,12 @@ NodeGraph::getFullSceneScreenShot()
     // Paint the visible portion with a highlight
     QPainter painter(&renderImage);
 
-    // Remove the overlays from the scene before rendering it
-    scene()->removeItem(_imp->_cacheSizeText);
-    scene()->removeItem(_imp->_navigator);
-
-    // Render into the QImage with downscaling
-    scene()->render(&painter, renderImage.rect(), sceneR, Qt::KeepAspectRatio);
-
-    // Add the overlays back
-    scene()->addItem(_imp->_navigator);
-    scene()->addItem(_imp->_cacheSizeText);
+    // Draw the cached render of the nodes where they are in the scene rect
+    if ( !_imp->navigatorSceneCache.isNull() ) {
+        QRectF nodesR_navCoordinates( (nodesR.x() - sceneR.x() ) * scaleFactor, (nodesR.y() - sceneR.y() ) * scaleFactor,
+                                      nodesR.width() * scaleFactor, nodesR.height() * scaleFactor );
+        painter.drawImage(nodesR_navCoordinates, _imp->navigatorSceneCache);
+    }
 
     // Fill the highlight with a semi transparent whitish grey
     painter.fillRect( viewRect_navCoordinates, QColor(200, 200, 200, 100) );
@@ -152,8 +199,6 @@ NodeGraph::getFullSceneScreenShot()
         }
     }
 
-    _imp->isDoingPreviewRender = false;
-
     return img;
 } // getFullSceneScreenShot
 
@@ -201,6 +246,7 @@ NodeGraph::restoreFromTrash(NodeGui* node)
     QMutexLocker l(&_imp->_nodesMutex);
     for (NodesGuiList::iterator it = _imp->_nodesTrash.begin(); it != _imp->_nodesTrash.end(); ++it) {
         if ( (*it).get() == node ) {
+            (*it)->setSimplifiedRendering(_imp->levelOfDetailEnabled);
             _imp->_nodes.push_back(*it);
             _imp->_nodesTrash.erase(it);
             break;
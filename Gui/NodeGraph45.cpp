@@ -27,6 +27,7 @@
 #include "NodeGraphPrivate.h"
 
 #include <map>
+#include <set>
 #include <vector>
 #include <stdexcept>
 
@@ -42,6 +43,7 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Engine/EffectInstance.h"
 #include "Engine/Node.h"
 #include "Engine/NodeSerialization.h"
 #include "Engine/OutputSchedulerThread.h" // RenderEngine
@@ -61,6 +63,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Gui/LineEdit.h"
 #include "Gui/NodeClipBoard.h"
 #include "Gui/NodeGui.h"
+#include "Gui/NodeSettingsPanel.h"
 #include "Gui/TabWidget.h"
 #include "Gui/ViewerTab.h"
 
@@ -130,8 +133,33 @@ void
 NodeGraph::refreshNodesKnobsAtTime(bool onlyTimeEvaluationKnobs,
                                    SequenceTime time)
 {
-    ///Refresh all knobs at the current time
-    for (NodesGuiList::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+    Gui* gui = getGui();
+    if (!gui) {
+        return;
+    }
+
+    ///Only the nodes with time-varying knobs and the nodes with an opened settings panel (whose extra state,
+    ///e.g: overlays, may depend on the time) need to be refreshed
+    std::set<NodeGuiPtr> nodesToRefresh;
+    std::list<KnobHolder*> holders = gui->getApp()->getTimeVaryingKnobHolders();
+    for (std::list<KnobHolder*>::iterator it = holders.begin(); it != holders.end(); ++it) {
+        EffectInstance* effect = dynamic_cast<EffectInstance*>(*it);
+        NodePtr node = effect ? effect->getNode() : NodePtr();
+        NodeGuiPtr nodeGui = node ? boost::dynamic_pointer_cast<NodeGui>( node->getNodeGui() ) : NodeGuiPtr();
+        if ( nodeGui && (nodeGui->getDagGui() == this) ) {
+            nodesToRefresh.insert(nodeGui);
+        }
+    }
+    const std::list<DockablePanel*>& panels = gui->getVisiblePanels();
+    for (std::list<DockablePanel*>::const_iterator it = panels.begin(); it != panels.end(); ++it) {
+        NodeSettingsPanel* isNodePanel = dynamic_cast<NodeSettingsPanel*>(*it);
+        NodeGuiPtr nodeGui = isNodePanel ? isNodePanel->getNode() : NodeGuiPtr();
+        if ( nodeGui && (nodeGui->getDagGui() == this) ) {
+            nodesToRefresh.insert(nodeGui);
+        }
+    }
+
+    for (std::set<NodeGuiPtr>::iterator it = nodesToRefresh.begin(); it != nodesToRefresh.end(); ++it) {
         (*it)->refreshKnobsAfterTimeChange(onlyTimeEvaluationKnobs, time);
     }
 }
@@ -145,7 +173,8 @@ NodeGraph::refreshAllKnobsGui()
 
             for (std::list<std::pair<KnobIWPtr, KnobGuiPtr> >::const_iterator it2 = knobs.begin(); it2 != knobs.end(); ++it2) {
                 KnobIPtr knob = it2->first.lock();
-                if ( !knob->getIsSecret() ) {
+                ///Knobs that do not vary with time cannot be animated, skip them early
+                if ( knob && !knob->getIsSecret() && knob->isTimeVarying() ) {
                     for (int i = 0; i < knob->getDimension(); ++i) {
                         if ( knob->isAnimated(i) ) {
                             it2->second->onInternalValueChanged(ViewSpec::all(), i, eValueChangedReasonPluginEdited);
@@ -93,6 +93,12 @@ NodeGraphPrivate::NodeGraphPrivate(NodeGraph* p,
     , _hasMovedOnce(false)
     , lastSelectedViewer(0)
     , isDoingPreviewRender(false)
+    , levelOfDetailEnabled(false)
+    , hasPendingPreviews(false)
+    , navigatorSceneCache()
+    , navigatorSceneCacheRect()
+    , navigatorSceneCacheSize()
+    , navigatorSceneCacheDirty(true)
     , autoScrollTimer()
 {
     appPTR->getIcon(NATRON_PIXMAP_LOCKED, &unlockIcon);
@@ -47,9 +47,11 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QGraphicsPixmapItem>
 #include <QPainter>
 #include <QtCore/QPointF>
+#include <QtCore/QSize>
 #include <QColor>
 #include <QPen>
 #include <QStyleOptionGraphicsItem>
+#include <QImage>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
@@ -66,6 +68,9 @@ CLANG_DIAG_ON(uninitialized)
 #define NATRON_NAVIGATOR_BASE_HEIGHT 0.2
 #define NATRON_NAVIGATOR_BASE_WIDTH 0.2
 
+///Below this zoom factor nodes are drawn with a simplified representation
+#define NATRON_NODEGRAPH_LOD_ZOOM_THRESHOLD 0.35
+
 #define NATRON_SCENE_MAX 1e6
 #define NATRON_SCENE_MIN 0
 
@@ -210,6 +215,18 @@ public:
 
     ///True when the graph is rendered from the getFullSceneScreenShot() function
     bool isDoingPreviewRender;
+
+    ///True when zoomed out below NATRON_NODEGRAPH_LOD_ZOOM_THRESHOLD
+    bool levelOfDetailEnabled;
+
+    ///True if some nodes are waiting to be visible to compute their preview
+    bool hasPendingPreviews;
+
+    ///Low resolution render of the nodes used by the navigator, re-rendered only when the graph changes
+    QImage navigatorSceneCache;
+    QRectF navigatorSceneCacheRect;
+    QSize navigatorSceneCacheSize;
+    bool navigatorSceneCacheDirty;
     QTimer autoScrollTimer;
     QTimer refreshRenderStateTimer;
 
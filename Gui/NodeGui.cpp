@@ -170,6 +170,9 @@ NodeGui::NodeGui(QGraphicsItem *parent)
     , _previewData( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) )
     , _previewW(NATRON_PREVIEW_WIDTH)
     , _previewH(NATRON_PREVIEW_HEIGHT)
+    , _previewPending(false)
+    , _previewPendingTime(0.)
+    , _simplifiedRendering(false)
     , _persistentMessage(NULL)
     , _stateIndicator(NULL)
     , _mergeHintActive(false)
@@ -749,6 +752,9 @@ NodeGui::ensurePreviewCreated()
         _previewPixmap->setTransform(QTransform::fromScale( appPTR->getLogicalDPIXRATIO(), appPTR->getLogicalDPIYRATIO() ), true);
         _previewPixmap->setPixmap(prev_pixmap);
         _previewPixmap->setZValue(getBaseDepth() + 1);
+        if (_simplifiedRendering) {
+            _previewPixmap->setOpacity(0.);
+        }
     }
     QSize size = getSize();
     int w, h;
@@ -1310,6 +1316,16 @@ NodeGui::updatePreviewImage(double time)
             return;
         }
 
+        if ( !_graph->isNodeDetailVisible(this) ) {
+            ///Delay until the node gets visible, see NodeGraph::refreshPendingPreviews()
+            _previewPending = true;
+            _previewPendingTime = time;
+            _graph->notifyPreviewPending();
+
+            return;
+        }
+
+        _previewPending = false;
         ensurePreviewCreated();
 
         NodeGuiPtr thisShared = shared_from_this();
@@ -1332,6 +1348,15 @@ NodeGui::forceComputePreview(double time)
             return;
         }
 
+        if ( !_graph->isNodeDetailVisible(this) ) {
+            _previewPending = true;
+            _previewPendingTime = time;
+            _graph->notifyPreviewPending();
+
+            return;
+        }
+
+        _previewPending = false;
         ensurePreviewCreated();
         NodeGuiPtr thisShared = shared_from_this();
         assert(thisShared);
@@ -1339,6 +1364,51 @@ NodeGui::forceComputePreview(double time)
     }
 }
 
+void
+NodeGui::computePendingPreview()
+{
+    if (!_previewPending) {
+        return;
+    }
+    _previewPending = false;
+    forceComputePreview(_previewPendingTime);
+}
+
+void
+NodeGui::setSimplifiedRendering(bool simplified)
+{
+    if (_simplifiedRendering == simplified) {
+        return;
+    }
+    _simplifiedRendering = simplified;
+
+    QGraphicsItem* shape = getSimplifiedShape();
+    QList<QGraphicsItem*> children = childItems();
+    for (QList<QGraphicsItem*>::iterator it = children.begin(); it != children.end(); ++it) {
+        if (*it != shape) {
+            ///Fully transparent items are skipped when drawing the scene but can still be picked
+            (*it)->setOpacity(simplified ? 0. : 1.);
+        }
+    }
+
+    ///Also hide the labels of the input edges
+    for (std::size_t i = 0; i < _inputEdges.size(); ++i) {
+        if (!_inputEdges[i]) {
+            continue;
+        }
+        QList<QGraphicsItem*> edgeChildren = _inputEdges[i]->childItems();
+        for (QList<QGraphicsItem*>::iterator it = edgeChildren.begin(); it != edgeChildren.end(); ++it) {
+            (*it)->setOpacity(simplified ? 0. : 1.);
+        }
+    }
+}
+
+QGraphicsItem*
+NodeGui::getSimplifiedShape() const
+{
+    return _boundingBox;
+}
+
 void
 NodeGui::onPreviewImageComputed()
 {
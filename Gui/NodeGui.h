@@ -312,6 +312,24 @@ public:
 
     void refreshKnobsAfterTimeChange(bool onlyTimeEvaluationKnobs, SequenceTime time);
 
+    /**
+     * @brief When simplified, only the shape of the node is drawn: the label, icons, indicators and preview
+     * are made fully transparent (they remain part of the scene so that they can still be picked).
+     * This is used by the NodeGraph when zoomed out, see NodeGraph::isLevelOfDetailEnabled()
+     **/
+    void setSimplifiedRendering(bool simplified);
+
+    /**
+     * @brief Returns true if a preview was requested while the node was not visible in the NodeGraph.
+     * computePendingPreview() computes it, it is called by the NodeGraph once the node becomes visible.
+     **/
+    bool isPreviewPending() const
+    {
+        return _previewPending;
+    }
+
+    void computePendingPreview();
+
     MultiInstancePanelPtr getMultiInstancePanel() const;
 
     void setParentMultiInstance(const NodeGuiPtr & parent);
@@ -418,6 +436,9 @@ protected:
 
     virtual int getBaseDepth() const { return 20; }
 
+    ///The item still drawn when the node is in simplified rendering
+    virtual QGraphicsItem* getSimplifiedShape() const;
+
     virtual bool canResize() { return true; }
 
     virtual bool mustFrameName() const { return false; }
@@ -612,6 +633,9 @@ private:
     mutable QMutex _previewDataMutex;
     std::vector<unsigned int> _previewData;
     int _previewW, _previewH;
+    bool _previewPending; //< a preview was requested while the node was not visible
+    double _previewPendingTime;
+    bool _simplifiedRendering;
     QGraphicsSimpleTextItem* _persistentMessage;
     NodeGraphRectItem* _stateIndicator;
     bool _mergeHintActive;
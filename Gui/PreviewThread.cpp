@@ -26,6 +26,7 @@
 #include "PreviewThread.h"
 
 #include <list>
+#include <map>
 #include <vector>
 #include <stdexcept>
 #include <cstring> // for std::memcpy, std::memset
@@ -36,7 +37,15 @@
 #include "Gui/GuiDefines.h"
 #include "Gui/NodeGui.h"
 
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppInstance.h"
 #include "Engine/Node.h"
+#include "Engine/OutputSchedulerThread.h"
+#include "Engine/Project.h"
+#include "Engine/ViewerInstance.h"
+
+///Time to wait before checking again whether the viewers are done rendering
+#define NATRON_PREVIEW_YIELD_SLEEP_MS 20
 
 
 NATRON_NAMESPACE_ENTER
@@ -46,13 +55,16 @@ class ComputePreviewRequest
 {
 public:
 
+    // Protected by requestsMutex: updated when a newer request for the same node is coalesced into this one
     double time;
     NodeGuiWPtr node;
+    AbortableRenderInfoPtr abortInfo;
 
     ComputePreviewRequest()
         : GenericThreadStartArgs()
         , time(0)
         , node()
+        , abortInfo()
     {}
 
     virtual ~ComputePreviewRequest()
@@ -62,16 +74,64 @@ public:
 
 typedef boost::shared_ptr<ComputePreviewRequest> ComputePreviewRequestPtr;
 
+/**
+ * @brief Orders the nodes by ownership rather than by address: the address of a deleted node may be reused
+ * by a new one, whereas the weak pointer held by a request keeps the ownership of the deleted node distinct.
+ **/
+struct NodeGuiWPtrOwnerLess
+{
+    bool operator()(const NodeGuiWPtr& a,
+                    const NodeGuiWPtr& b) const
+    {
+        return a.owner_before(b);
+    }
+};
+
+typedef std::map<NodeGuiWPtr, ComputePreviewRequestPtr, NodeGuiWPtrOwnerLess> PreviewRequestsMap;
+
 struct PreviewThreadPrivate
 {
     std::vector<unsigned int> data;
 
+    // Protects pendingRequests, currentRequest and the time of the requests
+    QMutex requestsMutex;
+
+    // Requests that were not processed yet, at most one per node
+    PreviewRequestsMap pendingRequests;
+
+    // The request being rendered
+    ComputePreviewRequestPtr currentRequest;
+
     PreviewThreadPrivate()
         : data( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) )
+        , requestsMutex()
+        , pendingRequests()
+        , currentRequest()
     {
     }
 };
 
+/**
+ * @brief Returns true if a viewer of the application is rendering, in which case previews should wait
+ **/
+static bool
+isViewerRendering(const AppInstancePtr& app)
+{
+    if ( !app || !app->getProject() ) {
+        return false;
+    }
+    std::list<ViewerInstance*> viewers;
+    app->getProject()->getViewers(&viewers);
+    for (std::list<ViewerInstance*>::iterator it = viewers.begin(); it != viewers.end(); ++it) {
+        RenderEnginePtr engine = (*it)->getRenderEngine();
+        if ( engine && engine->hasThreadsWorking() ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 PreviewThread::PreviewThread()
     : GenericSchedulerThread()
     , _imp( new PreviewThreadPrivate() )
@@ -89,10 +149,29 @@ void
 PreviewThread::appendToQueue(const NodeGuiPtr& node,
                              double time)
 {
-    ComputePreviewRequestPtr r = boost::make_shared<ComputePreviewRequest>();
+    ComputePreviewRequestPtr r;
+    {
+        QMutexLocker k(&_imp->requestsMutex);
 
-    r->node = node;
-    r->time = time;
+        if ( _imp->currentRequest && (_imp->currentRequest->node.lock() == node) ) {
+            ///The preview being rendered for this node is now stale
+            _imp->currentRequest->abortInfo->setAborted();
+        }
+
+        PreviewRequestsMap::iterator found = _imp->pendingRequests.find(node);
+        if ( found != _imp->pendingRequests.end() ) {
+            ///Coalesce with the request already queued for this node
+            found->second->time = time;
+
+            return;
+        }
+
+        r = boost::make_shared<ComputePreviewRequest>();
+        r->node = node;
+        r->time = time;
+        r->abortInfo = AbortableRenderInfo::create(true, 0);
+        _imp->pendingRequests[node] = r;
+    }
     startTask(r);
 }
 
@@ -104,8 +183,31 @@ PreviewThread::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
     assert(args);
 
 
+    double time;
+    {
+        QMutexLocker k(&_imp->requestsMutex);
+        PreviewRequestsMap::iterator found = _imp->pendingRequests.find(args->node);
+        if ( ( found != _imp->pendingRequests.end() ) && (found->second == args) ) {
+            _imp->pendingRequests.erase(found);
+        }
+        time = args->time;
+        _imp->currentRequest = args;
+    }
+
     NodeGuiPtr node = args->node.lock();
+    NodePtr internalNode;
     if (node) {
+        internalNode = node->getNode();
+    }
+    if (internalNode) {
+        ///Previews have the lowest priority: let the viewers finish their renders first
+        AppInstancePtr app = internalNode->getApp();
+        while ( isViewerRendering(app) && !mustQuitThread() && !args->abortInfo->isAborted() ) {
+            QThread::msleep(NATRON_PREVIEW_YIELD_SLEEP_MS);
+        }
+    }
+
+    if ( internalNode && !mustQuitThread() && !args->abortInfo->isAborted() ) {
         ///Mark this thread as running
         appPTR->fetchAndAddNRunningThreads(1);
 
@@ -121,10 +223,9 @@ PreviewThread::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
             _imp->data[i] = qRgba(0, 0, 0, 255);
         }
 #endif
-        NodePtr internalNode = node->getNode();
-        if (internalNode) {
-            bool ok = internalNode->makePreviewImage( args->time, &w, &h, &_imp->data.front() );
-            Q_UNUSED(ok);
+        bool ok = internalNode->makePreviewImage( time, &w, &h, &_imp->data.front(), args->abortInfo );
+        ///If aborted, a more recent request for this node is queued: keep the current preview until then
+        if ( ok || !args->abortInfo->isAborted() ) {
             node->copyPreviewImageBuffer(_imp->data, w, h);
         }
 
@@ -132,6 +233,11 @@ PreviewThread::threadLoopOnce(const GenericThreadStartArgsPtr& inArgs)
         appPTR->fetchAndAddNRunningThreads(-1);
     }
 
+    {
+        QMutexLocker k(&_imp->requestsMutex);
+        _imp->currentRequest.reset();
+    }
+
     return eThreadStateActive;
 } // PreviewThread::threadLoopOnce
 
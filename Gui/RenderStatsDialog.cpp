@@ -65,8 +65,10 @@
 #define COL_NB_CACHE_HIT 13
 #define COL_NB_CACHE_HIT_DOWNSCALED 14
 #define COL_NB_CACHE_MISS 15
+#define COL_NB_REQUEST_PASS_REUSED 16
+#define COL_NB_REQUEST_PASS_COMPUTED 17
 
-#define NUM_COLS 16
+#define NUM_COLS 18
 
 NATRON_NAMESPACE_ENTER
 
@@ -646,6 +648,70 @@ public:
                 }
             }
         }
+        {
+            TableItem* item = 0;
+            int nb = 0;
+            if (exists) {
+                item = view->item(row, COL_NB_REQUEST_PASS_REUSED);
+                if (item) {
+                    nb = item->text().toInt();
+                }
+            } else {
+                item = new TableItem;
+                QString tt = NATRON_NAMESPACE::convertFromPlainText(tr("The number of frames/views for which the regions of definition and of interest "
+                                                               "of this node were reused from a previous frame, because the node and its inputs are not animated."), NATRON_NAMESPACE::WhiteSpaceNormal);
+                item->setToolTip(tt);
+                item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+            }
+            assert(item);
+            if (item) {
+                int nbRequestPassReused, nbRequestPassComputed;
+                stats.getRequestPassInfos(&nbRequestPassReused, &nbRequestPassComputed);
+                nb += nbRequestPassReused;
+
+                QString str = QString::number(nb);
+                if (nodeUi) {
+                    item->setTextColor(Qt::black);
+                    item->setBackgroundColor(c);
+                }
+                item->setText(str);
+                if (!exists) {
+                    view->setItem(row, COL_NB_REQUEST_PASS_REUSED, item);
+                }
+            }
+        }
+        {
+            TableItem* item = 0;
+            int nb = 0;
+            if (exists) {
+                item = view->item(row, COL_NB_REQUEST_PASS_COMPUTED);
+                if (item) {
+                    nb = item->text().toInt();
+                }
+            } else {
+                item = new TableItem;
+                QString tt = NATRON_NAMESPACE::convertFromPlainText(tr("The number of frames/views for which the regions of definition and of interest "
+                                                               "of this node were computed by the plug-in."), NATRON_NAMESPACE::WhiteSpaceNormal);
+                item->setToolTip(tt);
+                item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+            }
+            assert(item);
+            if (item) {
+                int nbRequestPassReused, nbRequestPassComputed;
+                stats.getRequestPassInfos(&nbRequestPassReused, &nbRequestPassComputed);
+                nb += nbRequestPassComputed;
+
+                QString str = QString::number(nb);
+                if (nodeUi) {
+                    item->setTextColor(Qt::black);
+                    item->setBackgroundColor(c);
+                }
+                item->setText(str);
+                if (!exists) {
+                    view->setItem(row, COL_NB_REQUEST_PASS_COMPUTED, item);
+                }
+            }
+        }
         if (!exists) {
             rows.push_back(node);
         }
@@ -704,6 +770,8 @@ struct RenderStatsDialogPrivate
     Label* totalTimeSpentDescLabel;
     Label* totalTimeSpentValueLabel;
     double totalSpentTime;
+    Label* parallelRendersDescLabel;
+    Label* parallelRendersValueLabel;
     Button* resetButton;
     QWidget* filterContainer;
     QHBoxLayout* filterLayout;
@@ -730,6 +798,8 @@ struct RenderStatsDialogPrivate
         , totalTimeSpentDescLabel(0)
         , totalTimeSpentValueLabel(0)
         , totalSpentTime(0)
+        , parallelRendersDescLabel(0)
+        , parallelRendersValueLabel(0)
         , resetButton(0)
         , filterContainer(0)
         , filterLayout(0)
@@ -811,6 +881,20 @@ RenderStatsDialog::RenderStatsDialog(Gui* gui)
     _imp->globalInfosLayout->addWidget(_imp->totalTimeSpentDescLabel);
     _imp->globalInfosLayout->addWidget(_imp->totalTimeSpentValueLabel);
 
+    _imp->globalInfosLayout->addSpacing(20);
+
+    QString parallelRenderstt = NATRON_NAMESPACE::convertFromPlainText(tr("The number of frames that were rendered in parallel when the last frame was rendered, "
+                                                                          "the throughput measured by the scheduler and the last decision it took "
+                                                                          "to adjust the number of parallel renders.\n"
+                                                                          "This is only available when rendering a sequence."), NATRON_NAMESPACE::WhiteSpaceNormal);
+    _imp->parallelRendersDescLabel = new Label(tr("Parallel renders:"), _imp->globalInfosContainer);
+    _imp->parallelRendersDescLabel->setToolTip(parallelRenderstt);
+    _imp->parallelRendersValueLabel = new Label(QString::fromUtf8("-"), _imp->globalInfosContainer);
+    _imp->parallelRendersValueLabel->setToolTip(parallelRenderstt);
+
+    _imp->globalInfosLayout->addWidget(_imp->parallelRendersDescLabel);
+    _imp->globalInfosLayout->addWidget(_imp->parallelRendersValueLabel);
+
     _imp->resetButton = new Button(tr("Reset"), _imp->globalInfosContainer);
     _imp->resetButton->setToolTip( tr("Clears the statistics.") );
     QObject::connect( _imp->resetButton, SIGNAL(clicked(bool)), this, SLOT(resetStats()) );
@@ -891,7 +975,9 @@ RenderStatsDialog::RenderStatsDialog(Gui* gui)
         << tr("Rendered Planes")
         << tr("Cache Hits")
         << tr("Cache Hits Higher Scale")
-        << tr("Cache Misses");
+        << tr("Cache Misses")
+        << tr("Request Pass Reused")
+        << tr("Request Pass Computed");
 
     _imp->view->setColumnCount( dimensionNames.size() );
     _imp->view->setHorizontalHeaderLabels(dimensionNames);
@@ -965,6 +1051,8 @@ RenderStatsDialog::refreshAdvancedColsVisibility()
     _imp->view->setColumnHidden(COL_NB_CACHE_HIT, !checked);
     _imp->view->setColumnHidden(COL_NB_CACHE_HIT_DOWNSCALED, !checked);
     _imp->view->setColumnHidden(COL_NB_CACHE_MISS, !checked);
+    _imp->view->setColumnHidden(COL_NB_REQUEST_PASS_REUSED, !checked);
+    _imp->view->setColumnHidden(COL_NB_REQUEST_PASS_COMPUTED, !checked);
 }
 
 void
@@ -972,6 +1060,7 @@ RenderStatsDialog::resetStats()
 {
     _imp->model->clearRows();
     _imp->totalTimeSpentValueLabel->setText( QString::fromUtf8("0.0 sec") );
+    _imp->parallelRendersValueLabel->setText( QString::fromUtf8("-") );
     _imp->totalSpentTime = 0;
 }
 
@@ -979,7 +1068,10 @@ void
 RenderStatsDialog::addStats(int /*time*/,
                             ViewIdx /*view*/,
                             double wallTime,
-                            const std::map<NodePtr, NodeRenderStats >& stats)
+                            const std::map<NodePtr, NodeRenderStats >& stats,
+                            int nParallelRenders,
+                            double parallelRendersFps,
+                            ParallelRendersDecisionEnum parallelRendersDecision)
 {
     if ( !_imp->accumulateCheckbox->isChecked() ) {
         _imp->model->clearRows();
@@ -989,6 +1081,28 @@ RenderStatsDialog::addStats(int /*time*/,
     _imp->totalSpentTime += wallTime;
     _imp->totalTimeSpentValueLabel->setText( Timer::printAsTime(_imp->totalSpentTime, false) );
 
+    // A render of the current frame does not go through the parallel renders controller
+    if (nParallelRenders <= 0) {
+        _imp->parallelRendersValueLabel->setText( QString::fromUtf8("-") );
+    } else {
+        QString parallelRendersStr = QString::number(nParallelRenders);
+        switch (parallelRendersDecision) {
+        case eParallelRendersDecisionFixed:
+            break;
+        case eParallelRendersDecisionKeep:
+            parallelRendersStr += tr(" (kept)");
+            break;
+        case eParallelRendersDecisionIncrease:
+            parallelRendersStr += tr(" (increased)");
+            break;
+        case eParallelRendersDecisionDecrease:
+            parallelRendersStr += tr(" (decreased)");
+            break;
+        }
+        parallelRendersStr += tr(", %1 fps").arg(parallelRendersFps, 0, 'f', 1);
+        _imp->parallelRendersValueLabel->setText(parallelRendersStr);
+    }
+
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
         _imp->model->editNodeRow(it->first, it->second);
     }
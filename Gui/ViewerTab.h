@@ -442,7 +442,7 @@ public Q_SLOTS:
 
     void onSyncViewersButtonPressed(bool clicked);
 
-    void onRenderStatsAvailable(int time, ViewIdx view, double wallTime, const RenderStatsMap& stats);
+    void onRenderStatsAvailable(int time, ViewIdx view, double wallTime, const RenderStatsMap& stats, int nParallelRenders, double parallelRendersFps, ParallelRendersDecisionEnum parallelRendersDecision);
 
     void nextLayer();
     void previousLayer();
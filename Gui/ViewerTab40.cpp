@@ -1278,12 +1278,15 @@ void
 ViewerTab::onRenderStatsAvailable(int time,
                                   ViewIdx view,
                                   double wallTime,
-                                  const RenderStatsMap& stats)
+                                  const RenderStatsMap& stats,
+                                  int nParallelRenders,
+                                  double parallelRendersFps,
+                                  ParallelRendersDecisionEnum parallelRendersDecision)
 {
     assert( QThread::currentThread() == qApp->thread() );
     RenderStatsDialog* dialog = getGui()->getRenderStatsDialog();
     if (dialog) {
-        dialog->addStats(time, view, wallTime, stats);
+        dialog->addStats(time, view, wallTime, stats, nParallelRenders, parallelRendersFps, parallelRendersDecision);
     }
 }
 
@@ -140,4 +140,5 @@ HEADERS += \
     ../libs/OpenFX/include/nuke/fnOfxExtensions.h \
     ../libs/OpenFX/include/nuke/fnPublicOfxExtensions.h \
     ../libs/OpenFX/include/tuttle/ofxReadWrite.h \
-    ../libs/OpenFX_extensions/ofxhParametricParam.h
+    ../libs/OpenFX_extensions/ofxhParametricParam.h \
+    ../libs/OpenFX_extensions/ofxNatronParametricParam.h
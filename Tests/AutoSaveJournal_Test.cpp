@@ -0,0 +1,163 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include "BaseTest.h"
+
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/AutoSaveJournal.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/Node.h"
+#include "Engine/Project.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_USING
+
+// Upper bound of the number of appends before the journal asks for a compaction
+#define kJournalMaxAppends 1000
+
+static KnobDouble*
+getSlopeKnob(const AppInstancePtr& app,
+             const std::string& nodeName)
+{
+    NodePtr node = app->getNodeByFullySpecifiedName(nodeName);
+
+    return node ? dynamic_cast<KnobDouble*>( node->getKnobByName("noiseZSlope").get() ) : 0;
+}
+
+static void
+setSlope(const AppInstancePtr& app,
+         const std::string& nodeName,
+         double value)
+{
+    KnobDouble* slope = getSlopeKnob(app, nodeName);
+
+    ASSERT_TRUE(slope);
+    slope->setValue(value, ViewSpec::all(), 0);
+}
+
+static double
+getSlope(const AppInstancePtr& app,
+         const std::string& nodeName)
+{
+    KnobDouble* slope = getSlopeKnob(app, nodeName);
+
+    return slope ? slope->getValue() : -1.;
+}
+
+///Replays the journal over its base file after edits, a crash while appending, a compaction and a save of the base file
+TEST_F(BaseTest, AutoSaveJournalReplay)
+{
+    ProjectPtr project = getApp()->getProject();
+    std::vector<std::string> names;
+
+    for (int i = 0; i < 3; ++i) {
+        NodePtr generator = createNode(_generatorPluginID);
+        ASSERT_TRUE( bool(generator) );
+        names.push_back( generator->getScriptName() );
+        setSlope(getApp(), names.back(), 0.);
+    }
+
+    QString path = appPTR->getApplicationBinaryPath() + QString::fromUtf8("/");
+    QString baseName = QString::fromUtf8("test_journal_project." NATRON_PROJECT_FILE_EXT);
+    QString journalName = AutoSaveJournal::getJournalFilePath( baseName + QString::fromUtf8(".autosave") );
+    QString compactedName = QString::fromUtf8("test_journal_project_compacted." NATRON_PROJECT_FILE_EXT);
+    QString compactedJournalName = AutoSaveJournal::getJournalFilePath( compactedName + QString::fromUtf8(".autosave") );
+
+    // The state is taken before saving the base file, as Project::saveProject does
+    AutoSaveJournal journal;
+    AutoSaveJournal::NodesStateMap state;
+    AutoSaveJournal::getNodesState(project, &state);
+    EXPECT_EQ( names.size(), state.size() );
+    ASSERT_TRUE( project->saveProject(path, baseName, 0) );
+    journal.reset(path + journalName, path + baseName, state);
+    EXPECT_FALSE( journal.mustCompact() );
+
+    // Two complete batches: an edit, then an edit and a removal
+    setSlope(getApp(), names[0], 0.5);
+    journal.append(project);
+    setSlope(getApp(), names[1], 0.25);
+    getApp()->getNodeByFullySpecifiedName(names[2])->destroyNode(true, false);
+    journal.append(project);
+
+    // A crash while appending the third batch leaves its commit record truncated: the batch is dropped
+    setSlope(getApp(), names[0], 0.75);
+    journal.append(project);
+    {
+        QFile file(path + journalName);
+        ASSERT_TRUE( file.resize(file.size() - 1) );
+    }
+
+    EXPECT_EQ( QFileInfo(path + baseName).absoluteFilePath(), AutoSaveJournal::readBaseFilePath(path + journalName) );
+    ASSERT_TRUE( project->loadProject(path, journalName, false, false) );
+    EXPECT_EQ( 0.5, getSlope(getApp(), names[0]) );
+    EXPECT_EQ( 0.25, getSlope(getApp(), names[1]) );
+    EXPECT_FALSE( bool( getApp()->getNodeByFullySpecifiedName(names[2]) ) );
+
+    // Compaction: a full save becomes the base of a new journal and the previous journal is removed
+    AutoSaveJournal::getNodesState(project, &state);
+    ASSERT_TRUE( project->saveProject(path, compactedName, 0) );
+    journal.reset(path + compactedJournalName, path + compactedName, state);
+    EXPECT_FALSE( QFile::exists(path + journalName) );
+    EXPECT_FALSE( journal.mustCompact() );
+
+    // The journal asks for a new compaction once replaying it costs more than loading a full save
+    int nAppends = 0;
+    while ( !journal.mustCompact() && (nAppends < kJournalMaxAppends) ) {
+        ++nAppends;
+        setSlope(getApp(), names[1], nAppends);
+        journal.append(project);
+    }
+    EXPECT_TRUE( journal.mustCompact() );
+
+    ASSERT_TRUE( project->loadProject(path, compactedJournalName, false, false) );
+    EXPECT_EQ( 0.5, getSlope(getApp(), names[0]) );
+    EXPECT_EQ( (double)nAppends, getSlope(getApp(), names[1]) );
+
+    // Saving the base file again makes the journal stale: it must not be replayed over the new base
+    {
+        QFile file(path + compactedName);
+        ASSERT_TRUE( file.open(QIODevice::WriteOnly | QIODevice::Append) );
+        file.write("\n");
+    }
+    EXPECT_TRUE( AutoSaveJournal::readBaseFilePath(path + compactedJournalName).isEmpty() );
+    EXPECT_FALSE( project->loadProject(path, compactedJournalName, false, false) );
+
+    RecordProperty( "appends before compaction", nAppends );
+
+    QFile::remove(path + baseName);
+    QFile::remove(path + compactedName);
+    QFile::remove(path + compactedJournalName);
+}
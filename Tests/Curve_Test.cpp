@@ -125,3 +125,40 @@ TEST(Curve, Basic)
 }
 
 
+
+TEST(Curve, BulkSampling)
+{
+    Curve c;
+
+    c.setYRange(0., 15.);
+    EXPECT_TRUE( c.addKeyFrame( KeyFrame(0., 0., 0., 0., eKeyframeTypeLinear) ) );
+    EXPECT_TRUE( c.addKeyFrame( KeyFrame(1., 20., 0., 0., eKeyframeTypeLinear) ) );
+
+    // Arbitrary positions give the same results as getValueAt()
+    const double positions[5] = { -1., 0., 0.25, 0.5, 2. };
+    double values[5];
+    c.getValuesAt(positions, 5, values);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ( c.getValueAt(positions[i]), values[i] );
+    }
+
+    // Evenly spaced samples, both ends included, clamped to the Y range
+    double samples[5];
+    c.getSampledValues(0., 1., 5, samples);
+    EXPECT_EQ( 0., samples[0] );
+    EXPECT_EQ( 5., samples[1] );
+    EXPECT_EQ( 10., samples[2] );
+    EXPECT_EQ( 15., samples[3] );
+    EXPECT_EQ( 15., samples[4] );
+
+    // The cached samples are invalidated when the curve changes
+    EXPECT_FALSE( c.addKeyFrame( KeyFrame(1., 4., 0., 0., eKeyframeTypeLinear) ) );
+    c.getSampledValues(0., 1., 5, samples);
+    EXPECT_EQ( 0., samples[0] );
+    EXPECT_EQ( 2., samples[2] );
+    EXPECT_EQ( 4., samples[4] );
+
+    c.clearKeyFrames();
+    c.getSampledValues(0., 1., 5, samples);
+    EXPECT_EQ( 0., samples[4] );
+}
@@ -0,0 +1,168 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Engine/ImageKernels.h"
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_USING
+
+// Number of pixels processed by each kernel: about a 2K frame
+#define kKernelsBenchmarkPixels (2048 * 1024)
+
+namespace {
+// Random values in [-0.5, 1.5], with some zero alphas to exercise the unpremult special case
+void
+fillRandomRGBA(std::vector<float>& pixels)
+{
+    std::srand(2021);
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = 2.f * std::rand() / (float)RAND_MAX - 0.5f;
+        if ( (i % 4 == 3) && (std::rand() % 8 == 0) ) {
+            pixels[i] = 0.f;
+        }
+    }
+}
+
+bool
+sameBits(const std::vector<float>& a,
+         const std::vector<float>& b)
+{
+    return a.size() == b.size() && std::memcmp( &a[0], &b[0], a.size() * sizeof(float) ) == 0;
+}
+
+void
+recordThroughput(const std::string& kernel,
+                 double scalarTime,
+                 double vectorTime)
+{
+    double mpix = kKernelsBenchmarkPixels / 1e6;
+
+    ::testing::Test::RecordProperty( kernel + " scalar (Mpix/s)", (int)(mpix / scalarTime) );
+    ::testing::Test::RecordProperty( kernel + " vectorized (Mpix/s)", (int)(mpix / vectorTime) );
+}
+} // anon namespace
+
+TEST(ImageKernelsTest, Premult)
+{
+    std::vector<float> scalar(kKernelsBenchmarkPixels * 4);
+
+    fillRandomRGBA(scalar);
+    std::vector<float> vectorized(scalar);
+
+    TimeLapse timer;
+    ImageKernels::premultRowRGBAScalar(&scalar[0], kKernelsBenchmarkPixels);
+    double scalarTime = timer.getTimeElapsedReset();
+    ImageKernels::premultRowRGBA(&vectorized[0], kKernelsBenchmarkPixels);
+    double vectorTime = timer.getTimeElapsedReset();
+    EXPECT_TRUE( sameBits(scalar, vectorized) );
+    recordThroughput("premult", scalarTime, vectorTime);
+
+    ImageKernels::unpremultRowRGBAScalar(&scalar[0], kKernelsBenchmarkPixels);
+    scalarTime = timer.getTimeElapsedReset();
+    ImageKernels::unpremultRowRGBA(&vectorized[0], kKernelsBenchmarkPixels);
+    vectorTime = timer.getTimeElapsedReset();
+    EXPECT_TRUE( sameBits(scalar, vectorized) );
+    recordThroughput("unpremult", scalarTime, vectorTime);
+}
+
+TEST(ImageKernelsTest, MaskMix)
+{
+    std::vector<float> src(kKernelsBenchmarkPixels * 4);
+    std::vector<float> mask(kKernelsBenchmarkPixels);
+    std::vector<float> scalar(kKernelsBenchmarkPixels * 4);
+
+    fillRandomRGBA(src);
+    fillRandomRGBA(mask);
+    fillRandomRGBA(scalar);
+    std::vector<float> vectorized(scalar);
+
+    TimeLapse timer;
+    ImageKernels::maskMixRowRGBAScalar(&scalar[0], &src[0], &mask[0], 1, true, 0.7f, kKernelsBenchmarkPixels);
+    double scalarTime = timer.getTimeElapsedReset();
+    ImageKernels::maskMixRowRGBA(&vectorized[0], &src[0], &mask[0], 1, true, 0.7f, kKernelsBenchmarkPixels);
+    double vectorTime = timer.getTimeElapsedReset();
+    EXPECT_TRUE( sameBits(scalar, vectorized) );
+    recordThroughput("mask mix", scalarTime, vectorTime);
+
+    // No mask, no source image
+    ImageKernels::maskMixRowRGBAScalar(&scalar[0], 0, 0, 1, false, 0.3f, kKernelsBenchmarkPixels);
+    ImageKernels::maskMixRowRGBA(&vectorized[0], 0, 0, 1, false, 0.3f, kKernelsBenchmarkPixels);
+    EXPECT_TRUE( sameBits(scalar, vectorized) );
+}
+
+TEST(ImageKernelsTest, CopyChannels)
+{
+    std::vector<float> src(kKernelsBenchmarkPixels * 4);
+    std::vector<float> scalar(kKernelsBenchmarkPixels * 4, 0.25f);
+    std::vector<float> vectorized(scalar);
+
+    fillRandomRGBA(src);
+
+    TimeLapse timer;
+    ImageKernels::copyChannelsRowRGBAScalar(&scalar[0], &src[0], true, false, true, true, kKernelsBenchmarkPixels);
+    double scalarTime = timer.getTimeElapsedReset();
+    ImageKernels::copyChannelsRowRGBA(&vectorized[0], &src[0], true, false, true, true, kKernelsBenchmarkPixels);
+    double vectorTime = timer.getTimeElapsedReset();
+    EXPECT_TRUE( sameBits(scalar, vectorized) );
+    EXPECT_EQ(0.25f, vectorized[1]);
+    recordThroughput("copy channels", scalarTime, vectorTime);
+
+    // Outside of the source image the channels are cleared
+    ImageKernels::copyChannelsRowRGBAScalar(&scalar[0], 0, false, true, false, true, kKernelsBenchmarkPixels);
+    ImageKernels::copyChannelsRowRGBA(&vectorized[0], 0, false, true, false, true, kKernelsBenchmarkPixels);
+    EXPECT_TRUE( sameBits(scalar, vectorized) );
+    EXPECT_EQ(0.f, vectorized[3]);
+}
+
+TEST(ImageKernelsTest, ExtractChannel)
+{
+    std::vector<float> src(kKernelsBenchmarkPixels * 4);
+
+    fillRandomRGBA(src);
+    // Odd count to check the end of the row
+    const int count = kKernelsBenchmarkPixels - 3;
+    for (int channel = 0; channel < 4; ++channel) {
+        std::vector<float> scalar(kKernelsBenchmarkPixels, -1.f);
+        std::vector<float> vectorized(scalar);
+        TimeLapse timer;
+        ImageKernels::extractChannelRowScalar(&scalar[0], &src[0], 4, channel, count);
+        double scalarTime = timer.getTimeElapsedReset();
+        ImageKernels::extractChannelRow(&vectorized[0], &src[0], 4, channel, count);
+        double vectorTime = timer.getTimeElapsedReset();
+        EXPECT_TRUE( sameBits(scalar, vectorized) );
+        EXPECT_EQ(src[4 * (count - 1) + channel], vectorized[count - 1]);
+        if (channel == 3) {
+            recordThroughput("extract alpha", scalarTime, vectorTime);
+        }
+    }
+}
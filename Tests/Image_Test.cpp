@@ -25,10 +25,18 @@
 
 #include "Global/Macros.h"
 
+#include <bitset>
 #include <cstring>
+#include <sstream> // stringstream
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
 #include "Engine/Image.h"
+#include "Engine/ImagePlaneDesc.h"
+#include "Engine/Timer.h"
 #include "Engine/ViewIdx.h"
 
 NATRON_NAMESPACE_USING
@@ -160,3 +168,275 @@ TEST(ImageKeyTest, Difference) {
     ASSERT_TRUE(keyHash1 != keyHash2);
 }
 
+
+// Size of the images used by the mipmap benchmark
+#define kMipMapBenchmarkWidth 3840
+#define kMipMapBenchmarkHeight 2160
+
+// Integer division rounding towards minus infinity
+static int
+floorDiv2(int x)
+{
+    return x >= 0 ? x / 2 : -( (-x + 1) / 2 );
+}
+
+template <typename PIX>
+static void
+expectPixelEq(PIX expected,
+              PIX actual)
+{
+    EXPECT_EQ(expected, actual);
+}
+
+template <>
+void
+expectPixelEq<float>(float expected,
+                     float actual)
+{
+    EXPECT_FLOAT_EQ(expected, actual);
+}
+
+/**
+ * @brief Downscales then upscales an image with the given bounds and compares every pixel of the results
+ * with a scalar reference: each pixel of the half scale image is the box filter of the part of the 2x2 block
+ * above it which is inside the source image, and each pixel of the upscaled image is a copy of the half scale
+ * pixel covering it. Odd sizes and non-zero (and negative) origins cover the split between the border and the
+ * interior code paths, large images cover the seams between the rows processed by different threads.
+ **/
+template <typename PIX>
+static void
+checkMipMap(ImageBitDepthEnum depth,
+            const ImagePlaneDesc& components,
+            const RectI& bounds,
+            const char* label)
+{
+    SCOPED_TRACE(label);
+    const RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    const int nComps = components.getNumComponents();
+    ImagePtr fullScale = boost::make_shared<Image>(components, rod, bounds, 0, 1., depth, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone);
+    {
+        Image::WriteAccess acc( fullScale.get() );
+        for (int y = bounds.y1; y < bounds.y2; ++y) {
+            PIX* pix = (PIX*)acc.pixelAt(bounds.x1, y);
+            for (int x = bounds.x1; x < bounds.x2; ++x) {
+                for (int k = 0; k < nComps; ++k, ++pix) {
+                    *pix = PIX( ( (x - bounds.x1) * 7 + (y - bounds.y1) * 13 + k * 31 ) % 251 );
+                }
+            }
+        }
+    }
+
+    const RectI halfBounds = bounds.downscalePowerOfTwoSmallestEnclosing(1);
+    ImagePtr halfScale = boost::make_shared<Image>(components, rod, halfBounds, 1, 1., depth, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone);
+    ImagePtr upscaled = boost::make_shared<Image>(components, rod, bounds, 0, 1., depth, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone);
+
+    TimeLapse timer;
+    fullScale->downscaleMipMap(rod, bounds, 0, 1, false, halfScale.get());
+    double downscaleTime = timer.getTimeElapsedReset();
+    halfScale->upscaleMipMap(halfBounds, 1, 0, upscaled.get());
+    double upscaleTime = timer.getTimeElapsedReset();
+
+    Image::ReadAccess fullAcc( fullScale.get() );
+    Image::ReadAccess halfAcc( halfScale.get() );
+    Image::ReadAccess upAcc( upscaled.get() );
+
+    // The pixels of the half scale image which are computed (see Image::halveRoIForDepth)
+    RectI halvedRoI;
+    halvedRoI.x1 = (bounds.x1 + 1) / 2;
+    halvedRoI.y1 = (bounds.y1 + 1) / 2;
+    halvedRoI.x2 = bounds.x2 / 2;
+    halvedRoI.y2 = bounds.y2 / 2;
+    // Stop at the first row with a mismatch to avoid flooding the output
+    for (int y = halvedRoI.y1; y < halvedRoI.y2 && !::testing::Test::HasFailure(); ++y) {
+        for (int x = halvedRoI.x1; x < halvedRoI.x2; ++x) {
+            const PIX* half = (const PIX*)halfAcc.pixelAt(x, y);
+            for (int k = 0; k < nComps; ++k) {
+                // a + b + c + d as in Image::halveRoIForDepth, without the pixels outside of the source image
+                double sum = 0.;
+                int count = 0;
+                for (int srcy = y * 2; srcy < y * 2 + 2; ++srcy) {
+                    for (int srcx = x * 2; srcx < x * 2 + 2; ++srcx) {
+                        if ( (bounds.x1 <= srcx) && (srcx < bounds.x2) && (bounds.y1 <= srcy) && (srcy < bounds.y2) ) {
+                            sum += ( (const PIX*)fullAcc.pixelAt(srcx, srcy) )[k];
+                            ++count;
+                        }
+                    }
+                }
+                ASSERT_GT(count, 0);
+                expectPixelEq<PIX>(PIX(sum / count), half[k]);
+            }
+        }
+    }
+
+    for (int y = bounds.y1; y < bounds.y2 && !::testing::Test::HasFailure(); ++y) {
+        for (int x = bounds.x1; x < bounds.x2; ++x) {
+            const PIX* half = (const PIX*)halfAcc.pixelAt( floorDiv2(x), floorDiv2(y) );
+            const PIX* up = (const PIX*)upAcc.pixelAt(x, y);
+            // The upscale is a copy: compare the bits, the pixels of the half scale image outside of the halved RoI are not initialized
+            EXPECT_EQ( 0, std::memcmp( half, up, nComps * sizeof(PIX) ) );
+        }
+    }
+
+    std::stringstream key;
+    key << label << " " << bounds.width() << "x" << bounds.height();
+    ::testing::Test::RecordProperty( key.str() + " downscale (us)", (int)(downscaleTime * 1e6) );
+    ::testing::Test::RecordProperty( key.str() + " upscale (us)", (int)(upscaleTime * 1e6) );
+}
+
+template <typename PIX>
+static void
+checkMipMapBounds(ImageBitDepthEnum depth,
+                  const ImagePlaneDesc& components,
+                  const char* label)
+{
+    checkMipMap<PIX>(depth, components, RectI(0, 0, kMipMapBenchmarkWidth, kMipMapBenchmarkHeight), label);
+    checkMipMap<PIX>(depth, components, RectI(13, 7, 1014, 610), label);
+    checkMipMap<PIX>(depth, components, RectI(-301, -77, 1746, 1134), label);
+    checkMipMap<PIX>(depth, components, RectI(-1025, -603, -3, -1), label);
+}
+
+///Benchmark and check of the mipmap box filters for all bit depths
+TEST(ImageMipMapTest, Benchmark)
+{
+    checkMipMapBounds<float>(eImageBitDepthFloat, ImagePlaneDesc::getRGBAComponents(), "RGBA float");
+    checkMipMapBounds<float>(eImageBitDepthFloat, ImagePlaneDesc::getAlphaComponents(), "Alpha float");
+    checkMipMapBounds<float>(eImageBitDepthFloat, ImagePlaneDesc::getXYComponents(), "XY float");
+    checkMipMapBounds<unsigned short>(eImageBitDepthShort, ImagePlaneDesc::getRGBAComponents(), "RGBA 16 bits");
+    checkMipMapBounds<unsigned char>(eImageBitDepthByte, ImagePlaneDesc::getRGBAComponents(), "RGBA 8 bits");
+    checkMipMapBounds<unsigned char>(eImageBitDepthByte, ImagePlaneDesc::getRGBComponents(), "RGB 8 bits");
+}
+
+
+#if NATRON_ENABLE_TRIMAP
+
+// Size of the image and of the tiles used by the tiled rendering benchmark
+#define kTileBenchmarkSize 2048
+#define kTileBenchmarkTileSize 128
+
+struct TileRenderArgs
+{
+    Image* image;
+    RectI tile;
+    bool inPlace;
+};
+
+// What a plug-in would render, with enough work per pixel to matter
+static float
+tilePixelValue(int x,
+               int y,
+               int k)
+{
+    float v = (x * 7 + y * 13 + k * 31) % 251;
+
+    for (int i = 0; i < 16; ++i) {
+        v = v * 0.5f + 1.f;
+    }
+
+    return v;
+}
+
+/**
+ * @brief Renders a tile of the image the way EffectInstance::tiledRenderingFunctor does: the tile is marked
+ * for rendering in the bitmap, rendered either directly in the image or in a temporary image, then the
+ * post-render pass mixes it and the tile is marked as rendered.
+ **/
+static void
+renderTile(TileRenderArgs& args)
+{
+    bool isBeingRenderedElsewhere = false;
+    const RectI rect = args.image->getMinimalRectAndMarkForRendering_trimap(args.tile, &isBeingRenderedElsewhere);
+
+    ASSERT_FALSE(isBeingRenderedElsewhere);
+    ASSERT_FALSE( rect.isNull() );
+
+    ImagePtr tmpImage;
+    const Image* renderedImage = args.image;
+    boost::shared_ptr<GenericAccess> access;
+    float* pixels;
+    int rowElements;
+    if (args.inPlace) {
+        Image::SharedWriteAccessPtr sharedAccess( new Image::SharedWriteAccess(args.image) );
+        pixels = (float*)sharedAccess->pixelAt(rect.x1, rect.y1);
+        access = sharedAccess;
+        rowElements = 4 * args.image->getBounds().width();
+    } else {
+        const RectD rod(rect.x1, rect.y1, rect.x2, rect.y2);
+        tmpImage = boost::make_shared<Image>(ImagePlaneDesc::getRGBAComponents(), rod, rect, 0, 1., eImageBitDepthFloat, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone);
+        Image::WriteAccessPtr writeAccess( new Image::WriteAccess( tmpImage.get() ) );
+        pixels = (float*)writeAccess->pixelAt(rect.x1, rect.y1);
+        access = writeAccess;
+        renderedImage = tmpImage.get();
+        rowElements = 4 * rect.width();
+    }
+    for (int y = rect.y1; y < rect.y2; ++y, pixels += rowElements) {
+        float* pix = pixels;
+        for (int x = rect.x1; x < rect.x2; ++x) {
+            for (int k = 0; k < 4; ++k, ++pix) {
+                *pix = tilePixelValue(x, y, k);
+            }
+        }
+    }
+    access.reset();
+
+    std::bitset<4> processChannels;
+    processChannels.set();
+    // Mix with black
+    EXPECT_TRUE( args.image->applyPostRenderPass(rect, renderedImage, processChannels, ImagePtr(), true, NULL, false, false, 0.5f) );
+    args.image->markForRendered(rect);
+}
+
+static ImagePtr
+renderTiles(bool inPlace,
+            double* time)
+{
+    const RectI bounds(0, 0, kTileBenchmarkSize, kTileBenchmarkSize);
+    const RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    ImagePtr image = boost::make_shared<Image>(ImagePlaneDesc::getRGBAComponents(), rod, bounds, 0, 1., eImageBitDepthFloat, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone, true);
+
+    std::vector<TileRenderArgs> tiles;
+    for (int y = bounds.y1; y < bounds.y2; y += kTileBenchmarkTileSize) {
+        for (int x = bounds.x1; x < bounds.x2; x += kTileBenchmarkTileSize) {
+            TileRenderArgs args;
+            args.image = image.get();
+            args.tile = RectI(x, y, x + kTileBenchmarkTileSize, y + kTileBenchmarkTileSize);
+            args.inPlace = inPlace;
+            tiles.push_back(args);
+        }
+    }
+
+    TimeLapse timer;
+    QtConcurrent::blockingMap(tiles, renderTile);
+    *time = timer.getTimeElapsedReset();
+
+    std::list<RectI> rest;
+    image->getRestToRender(bounds, rest);
+    EXPECT_TRUE( rest.empty() );
+
+    return image;
+}
+
+///Benchmark and check of the tiles of an image rendered in parallel, directly in the image or through a temporary image
+TEST(ImageTileTest, RenderInPlace)
+{
+    double inPlaceTime, tmpImageTime;
+    ImagePtr inPlace = renderTiles(true, &inPlaceTime);
+    ImagePtr tmpImage = renderTiles(false, &tmpImageTime);
+
+    Image::ReadAccess inPlaceAcc( inPlace.get() );
+    Image::ReadAccess tmpImageAcc( tmpImage.get() );
+    for (int y = 0; y < kTileBenchmarkSize && !::testing::Test::HasFailure(); ++y) {
+        const float* inPlacePix = (const float*)inPlaceAcc.pixelAt(0, y);
+        const float* tmpImagePix = (const float*)tmpImageAcc.pixelAt(0, y);
+        for (int x = 0; x < kTileBenchmarkSize; ++x) {
+            for (int k = 0; k < 4; ++k, ++inPlacePix, ++tmpImagePix) {
+                EXPECT_FLOAT_EQ(tilePixelValue(x, y, k) * 0.5f, *inPlacePix);
+                EXPECT_EQ(*tmpImagePix, *inPlacePix);
+            }
+        }
+    }
+
+    ::testing::Test::RecordProperty( "in place (us)", (int)(inPlaceTime * 1e6) );
+    ::testing::Test::RecordProperty( "temporary image (us)", (int)(tmpImageTime * 1e6) );
+}
+
+#endif // NATRON_ENABLE_TRIMAP
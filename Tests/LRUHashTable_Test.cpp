@@ -0,0 +1,117 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#endif
+
+#include "Engine/LRUHashTable.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+
+struct TestEntry
+{
+    double priority;
+    bool pinned;
+
+    TestEntry(double priority,
+              bool pinned)
+        : priority(priority)
+        , pinned(pinned)
+    {
+    }
+};
+
+typedef boost::shared_ptr<TestEntry> TestEntryPtr;
+
+#ifdef NATRON_CACHE_USE_BOOST
+typedef BoostLRUHashTable<int, TestEntryPtr> TestTable;
+#else
+typedef StlLRUHashTable<int, TestEntryPtr> TestTable;
+#endif
+
+struct TestPriorityFunctor
+{
+    bool operator()(const TestEntryPtr& entry,
+                    double* priority) const
+    {
+        if (entry->pinned) {
+            return false;
+        }
+        *priority = entry->priority;
+
+        return true;
+    }
+};
+}
+
+TEST(LRUHashTable,
+     EvictLowestPriority)
+{
+    TestTable table;
+    const double priorities[5] = {5., 1., 3., 0.5, 4.};
+
+    for (int i = 0; i < 5; ++i) {
+        table.insert( i, boost::make_shared<TestEntry>(priorities[i], i == 3) );
+    }
+
+    // Accessing an entry makes it the most recently used, holding it prevents its eviction
+    TestEntryPtr held = table(1)->second.front();
+    double priority = 0.;
+
+    std::pair<int, TestEntryPtr> evicted = table.evictLowestPriority(TestPriorityFunctor(), 32, &priority);
+    ASSERT_TRUE(evicted.second) << "Entry 1 is used and entry 3 is pinned, entry 2 has the lowest priority among the others";
+    EXPECT_EQ(2, evicted.first);
+    EXPECT_EQ(3., priority);
+
+    // Only the 2 least recently used entries are candidates: 0 and 4
+    evicted = table.evictLowestPriority(TestPriorityFunctor(), 2, &priority);
+    ASSERT_TRUE(evicted.second);
+    EXPECT_EQ(4, evicted.first);
+
+    held.reset();
+    evicted = table.evictLowestPriority(TestPriorityFunctor(), 32, &priority);
+    ASSERT_TRUE(evicted.second);
+    EXPECT_EQ(1, evicted.first);
+
+    evicted = table.evictLowestPriority(TestPriorityFunctor(), 32, &priority);
+    ASSERT_TRUE(evicted.second);
+    EXPECT_EQ(0, evicted.first);
+
+    evicted = table.evictLowestPriority(TestPriorityFunctor(), 32, &priority);
+    EXPECT_FALSE(evicted.second) << "Only the pinned entry is left";
+
+    evicted = table.evict();
+    ASSERT_TRUE(evicted.second) << "The pinned entry can still be evicted in LRU order";
+    EXPECT_EQ(3, evicted.first);
+    EXPECT_EQ(0U, table.size());
+}
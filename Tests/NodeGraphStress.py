@@ -0,0 +1,77 @@
+# -*- coding: utf-8 -*-
+# Generates a very large node graph to benchmark the NodeGraph (panning, zooming,
+# level of detail, navigator and previews).
+#
+# Usage, from the command line:
+#     Natron Tests/NodeGraphStress.py
+# or from the Script Editor of an opened project:
+#     exec(open("Tests/NodeGraphStress.py").read())
+#
+# The number of nodes can be changed with the NATRON_STRESS_GRAPH_NODES environment variable.
+
+import os
+
+import NatronEngine
+
+# Distance between 2 nodes of the grid, in NodeGraph coordinates
+kSpacingX = 150
+kSpacingY = 100
+
+# Number of nodes in a branch before it is merged with its neighbour
+kBranchLength = 40
+
+# Insert a Dot every kDotInterval nodes of a branch
+kDotInterval = 4
+
+
+def generateStressGraph(app, nodesCount=3000):
+    """Creates about nodesCount nodes: branches of Grade nodes interleaved with Dots,
+    merged pair-wise until a single output remains."""
+    branchesCount = max(1, nodesCount // kBranchLength)
+    created = 0
+    outputs = []
+    for b in range(branchesCount):
+        x = b * kSpacingX
+        previous = app.createNode("net.sf.openfx.CheckerBoardPlugin")
+        previous.setPosition(x, 0)
+        created += 1
+        for i in range(1, kBranchLength):
+            if i % kDotInterval == 0:
+                node = app.createNode("fr.inria.built-in.Dot")
+            else:
+                node = app.createNode("net.sf.openfx.GradePlugin")
+            node.setPosition(x, i * kSpacingY)
+            node.connectInput(0, previous)
+            previous = node
+            created += 1
+        outputs.append(previous)
+
+    # Merge the branches pair-wise, each level below the previous one
+    y = kBranchLength * kSpacingY
+    while len(outputs) > 1:
+        y += kSpacingY
+        merged = []
+        for i in range(0, len(outputs) - 1, 2):
+            merge = app.createNode("net.sf.openfx.MergePlugin")
+            merge.setPosition( (outputs[i].getPosition()[0] + outputs[i + 1].getPosition()[0]) / 2, y )
+            merge.connectInput(0, outputs[i + 1])
+            merge.connectInput(1, outputs[i])
+            merged.append(merge)
+            created += 1
+        if len(outputs) % 2 == 1:
+            merged.append(outputs[-1])
+        outputs = merged
+
+    return created
+
+
+def _getApp():
+    try:
+        return app
+    except NameError:
+        return app1
+
+
+if __name__ == "__main__" or "app1" in globals():
+    count = int( os.environ.get("NATRON_STRESS_GRAPH_NODES", "3000") )
+    print("Created %d nodes" % generateStressGraph(_getApp(), count))
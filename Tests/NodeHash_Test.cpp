@@ -0,0 +1,92 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "BaseTest.h"
+
+#include "Engine/AppInstance.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/Node.h"
+#include "Engine/Project.h"
+#include "Engine/Timer.h"
+
+NATRON_NAMESPACE_USING
+
+// Number of nodes of the synthetic graph: a generator followed by a chain of Dots
+#define kBenchmarkNodesCount 2000
+
+///Hash propagation benchmark on a large graph
+TEST_F(BaseTest, HashPropagation)
+{
+    std::vector<NodePtr> nodes;
+    NodePtr generator = createNode(_generatorPluginID);
+    ASSERT_TRUE( bool(generator) );
+    nodes.push_back(generator);
+    for (int i = 1; i < kBenchmarkNodesCount; ++i) {
+        NodePtr dot = createNode( QString::fromUtf8(PLUGINID_NATRON_DOT) );
+        ASSERT_TRUE( bool(dot) );
+        connectNodes(nodes.back(), dot, 0, true);
+        nodes.push_back(dot);
+    }
+
+    KnobDouble* slope = dynamic_cast<KnobDouble*>( generator->getKnobByName("noiseZSlope").get() );
+    ASSERT_TRUE(slope);
+
+    // A change at the root must reach the end of the chain
+    U64 tailHash = nodes.back()->getHashValue();
+    TimeLapse timer;
+    slope->setValue(0.25);
+    double rootEditTime = timer.getTimeElapsedReset();
+    EXPECT_NE( tailHash, nodes.back()->getHashValue() );
+
+    // A change of all nodes within a single batch is propagated once
+    std::vector<U64> hashes( nodes.size() );
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        hashes[i] = nodes[i]->getHashValue();
+    }
+    timer.getTimeElapsedReset();
+    {
+        NodesChangesBatch_RAII batch( getApp() );
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i]->incrementKnobsAge();
+        }
+        // Nothing is recomputed until the batch is closed
+        EXPECT_EQ( hashes.back(), nodes.back()->getHashValue() );
+    }
+    double batchEditTime = timer.getTimeElapsedReset();
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        EXPECT_NE( hashes[i], nodes[i]->getHashValue() );
+    }
+
+    ::testing::Test::RecordProperty( "nodes", (int)nodes.size() );
+    ::testing::Test::RecordProperty( "edit at the root (us)", (int)(rootEditTime * 1e6) );
+    ::testing::Test::RecordProperty( "batched edit of all nodes (us)", (int)(batchEditTime * 1e6) );
+}
@@ -0,0 +1,165 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <https://natrongithub.github.io/>,
+ * (C) 2018-2021 The Natron developers
+ * (C) 2013-2018 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
+#include "BaseTest.h"
+
+#include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
+#include "Engine/Curve.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/Node.h"
+#include "Engine/Project.h"
+#include "Engine/ProjectBinarySerialization.h"
+#include "Engine/Timer.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_USING
+
+// Number of nodes of the synthetic project, each with a densely animated parameter
+#define kBenchmarkNodesCount 500
+#define kBenchmarkKeyframesCount 200
+
+// For each dimension of the numeric knobs of all nodes: the value followed by the time and value of each keyframe
+typedef std::map<std::string, std::vector<double> > KnobsSnapshot;
+
+static void
+getKnobsSnapshot(const ProjectPtr& project,
+                 KnobsSnapshot* snapshot)
+{
+    NodesList nodes = project->getNodes();
+
+    for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        const KnobsVec& knobs = (*it)->getEffectInstance()->getKnobs();
+        for (KnobsVec::const_iterator it2 = knobs.begin(); it2 != knobs.end(); ++it2) {
+            Knob<double>* isDouble = dynamic_cast<Knob<double>*>( it2->get() );
+            Knob<int>* isInt = dynamic_cast<Knob<int>*>( it2->get() );
+            Knob<bool>* isBool = dynamic_cast<Knob<bool>*>( it2->get() );
+            if (!isDouble && !isInt && !isBool) {
+                continue;
+            }
+            for (int dim = 0; dim < (*it2)->getDimension(); ++dim) {
+                std::vector<double>& values = (*snapshot)[(*it)->getScriptName() + "." + (*it2)->getName() + "." + QString::number(dim).toStdString()];
+                values.push_back( isDouble ? isDouble->getValue(dim) : isInt ? (double)isInt->getValue(dim) : (double)isBool->getValue(dim) );
+                CurvePtr curve = (*it2)->getCurve(ViewIdx(0), dim);
+                if (!curve) {
+                    continue;
+                }
+                KeyFrameSet keys = curve->getKeyFrames_mt_safe();
+                for (KeyFrameSet::const_iterator it3 = keys.begin(); it3 != keys.end(); ++it3) {
+                    values.push_back( it3->getTime() );
+                    values.push_back( it3->getValue() );
+                }
+            }
+        }
+    }
+}
+
+///Load-time benchmark of the XML and binary formats on a synthetic large project
+TEST_F(BaseTest, BinaryProjectLoad)
+{
+    for (int i = 0; i < kBenchmarkNodesCount; ++i) {
+        NodePtr generator = createNode(_generatorPluginID);
+        ASSERT_TRUE( bool(generator) );
+        KnobDouble* slope = dynamic_cast<KnobDouble*>( generator->getKnobByName("noiseZSlope").get() );
+        ASSERT_TRUE(slope);
+        for (int k = 0; k < kBenchmarkKeyframesCount; ++k) {
+            slope->setValueAtTime(k, (double)( (i + k) % 17 ) / 17., ViewSpec::all(), 0);
+        }
+    }
+
+    ProjectPtr project = getApp()->getProject();
+    std::size_t nodesCount = project->getNodes().size();
+    KnobsSnapshot originalSnapshot;
+    getKnobsSnapshot(project, &originalSnapshot);
+    ASSERT_FALSE( originalSnapshot.empty() );
+    QString path = appPTR->getApplicationBinaryPath() + QString::fromUtf8("/");
+    QString xmlName = QString::fromUtf8("test_binary_project." NATRON_PROJECT_FILE_EXT);
+    QString binaryName = QString::fromUtf8("test_binary_project." NATRON_PROJECT_BINARY_FILE_EXT);
+
+    TimeLapse timer;
+    ASSERT_TRUE( project->saveProject(path, xmlName, 0) );
+    double xmlSaveTime = timer.getTimeElapsedReset();
+    ASSERT_TRUE( project->saveProject(path, binaryName, 0) );
+    double binarySaveTime = timer.getTimeElapsedReset();
+
+    ASSERT_TRUE( ProjectBinaryReader::isBinaryProjectFile( (path + binaryName).toStdString() ) );
+    EXPECT_FALSE( ProjectBinaryReader::isBinaryProjectFile( (path + xmlName).toStdString() ) );
+
+    // Lazy access: a single node can be decoded from the index without decoding the others
+    {
+        ProjectBinaryReader reader;
+        reader.open( (path + binaryName).toStdString() );
+        EXPECT_EQ( nodesCount, reader.getNodesIndex().size() );
+        NodeSerializationPtr lastNode = reader.readNode(reader.getNodesIndex().size() - 1);
+        EXPECT_TRUE( bool(lastNode) );
+    }
+
+    timer.getTimeElapsedReset();
+    ASSERT_TRUE( project->loadProject(path, xmlName, false, false) );
+    double xmlLoadTime = timer.getTimeElapsedReset();
+    EXPECT_EQ( nodesCount, project->getNodes().size() );
+
+    ASSERT_TRUE( project->loadProject(path, binaryName, false, false) );
+    double binaryLoadTime = timer.getTimeElapsedReset();
+    EXPECT_EQ( nodesCount, project->getNodes().size() );
+
+    KnobsSnapshot loadedSnapshot;
+    getKnobsSnapshot(project, &loadedSnapshot);
+    EXPECT_EQ(originalSnapshot, loadedSnapshot);
+
+    // Round-trip through the converter: XML -> binary -> XML
+    QString convertedBinaryName = QString::fromUtf8("test_binary_project_converted." NATRON_PROJECT_BINARY_FILE_EXT);
+    QString convertedName = QString::fromUtf8("test_binary_project_converted." NATRON_PROJECT_FILE_EXT);
+    convertProjectFile( getApp(), (path + xmlName).toStdString(), (path + convertedBinaryName).toStdString() );
+    convertProjectFile( getApp(), (path + convertedBinaryName).toStdString(), (path + convertedName).toStdString() );
+    ASSERT_TRUE( project->loadProject(path, convertedName, false, false) );
+    EXPECT_EQ( nodesCount, project->getNodes().size() );
+
+    KnobsSnapshot convertedSnapshot;
+    getKnobsSnapshot(project, &convertedSnapshot);
+    EXPECT_EQ(originalSnapshot, convertedSnapshot);
+
+    RecordProperty( "nodes", (int)nodesCount );
+    RecordProperty( "XML save (ms)", (int)(xmlSaveTime * 1000) );
+    RecordProperty( "XML load (ms)", (int)(xmlLoadTime * 1000) );
+    RecordProperty( "binary save (ms)", (int)(binarySaveTime * 1000) );
+    RecordProperty( "binary load (ms)", (int)(binaryLoadTime * 1000) );
+
+    QFile::remove(path + xmlName);
+    QFile::remove(path + binaryName);
+    QFile::remove(path + convertedBinaryName);
+    QFile::remove(path + convertedName);
+}
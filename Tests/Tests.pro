@@ -44,10 +44,15 @@ SOURCES += \
     google-test/src/gtest-all.cc \
     google-mock/src/gmock-all.cc \
     BaseTest.cpp \
+    AutoSaveJournal_Test.cpp \
     Hash64_Test.cpp \
     Image_Test.cpp \
+    ImageKernels_Test.cpp \
     Lut_Test.cpp \
+    NodeHash_Test.cpp \
+    ProjectBinary_Test.cpp \
     KnobFile_Test.cpp \
+    LRUHashTable_Test.cpp \
     Curve_Test.cpp \
     Tracker_Test.cpp \
     wmain.cpp
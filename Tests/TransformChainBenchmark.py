@@ -0,0 +1,129 @@
+# -*- coding: utf-8 -*-
+# Benchmarks the concatenation of transforms through chains of Transform nodes interleaved
+# with nodes that pass their input through (Dots, disabled nodes, identity nodes, groups).
+# Each chain is rendered with transform concatenation enabled then disabled: when enabled,
+# the whole chain should be resampled only once.
+# The transforms are animated so that every frame has to be rendered, and the animation is
+# changed before each run so that no run reuses the images cached by a previous one.
+#
+# Usage, from the command line:
+#     NatronRenderer Tests/TransformChainBenchmark.py
+#
+# The number of frames rendered can be changed with the NATRON_BENCHMARK_FRAMES environment
+# variable, and the chain lengths with NATRON_BENCHMARK_CHAIN_LENGTHS (e.g. "5,10,20").
+
+import os
+import tempfile
+import time
+
+import NatronEngine
+
+kTransformPluginID = "net.sf.openfx.TransformPlugin"
+kDotPluginID = "fr.inria.built-in.Dot"
+kGroupPluginID = "fr.inria.built-in.Group"
+kBlurPluginID = "net.sf.cimg.CImgBlur"
+kGradePluginID = "net.sf.openfx.GradePlugin"
+kSourcePluginID = "net.sf.openfx.CheckerBoardPlugin"
+kWriterPluginID = "fr.inria.openfx.WriteOIIO"
+
+
+def _addTransform(app, previous, index, transforms, group=None):
+    """Adds a Transform node slightly rotating and scaling its input, so that each one needs a filtered resample.
+    The rotation is animated by animateChain()."""
+    node = app.createNode(kTransformPluginID, -1, group) if group else app.createNode(kTransformPluginID)
+    node.getParam("scale").setValue(1.01, 0)
+    node.getParam("scale").setValue(1.01, 1)
+    node.connectInput(0, previous)
+    transforms.append(node)
+    return node
+
+
+def _addPassThrough(app, previous, index, transforms):
+    """Adds a node that does not modify its input, cycling through the different kinds of pass-through nodes."""
+    kind = index % 4
+    if kind == 0:
+        node = app.createNode(kDotPluginID)
+    elif kind == 1:
+        # A disabled node
+        node = app.createNode(kBlurPluginID)
+        node.getParam("size").setValue(10., 0)
+        node.getParam("size").setValue(10., 1)
+        node.getParam("disableNode").setValue(True)
+    elif kind == 2:
+        # A node with default parameters, hence identity
+        node = app.createNode(kGradePluginID)
+    else:
+        # A group holding a Transform: concatenation also goes through the group input and output
+        node = app.createNode(kGroupPluginID)
+        groupInput = node.getNode("Input1")
+        groupOutput = node.getNode("Output1")
+        if groupInput is None:
+            groupInput = app.createNode("fr.inria.built-in.Input", -1, node)
+        transform = _addTransform(app, groupInput, index, transforms, node)
+        groupOutput.connectInput(0, transform)
+    node.connectInput(0, previous)
+    return node
+
+
+def makeTransformChain(app, chainLength, outputFilename):
+    """Creates a source followed by chainLength Transform nodes, with a pass-through node between each of them,
+    and a writer. Returns the writer and the list of all the Transform nodes (including those in groups)."""
+    transforms = []
+    previous = app.createNode(kSourcePluginID)
+    for i in range(chainLength):
+        previous = _addTransform(app, previous, i, transforms)
+        previous = _addPassThrough(app, previous, i, transforms)
+    writer = app.createNode(kWriterPluginID)
+    writer.getParam("filename").setValue(outputFilename)
+    writer.connectInput(0, previous)
+    return writer, transforms
+
+
+def animateChain(transforms, framesCount, run):
+    """Animates the rotation of each Transform over the frames, so that no frame can reuse the images of another one.
+    The animation depends on run, so that a run does not reuse the images cached by the previous runs."""
+    for index, transform in enumerate(transforms):
+        rotate = transform.getParam("rotate")
+        rotate.removeAnimation()
+        rotate.setValueAtTime(2. + index + run * 0.1, 1)
+        rotate.setValueAtTime(12. + index + run * 0.1, framesCount)
+
+
+def renderChain(app, writer, framesCount, concatenate):
+    """Renders framesCount frames of the chain and returns the time it took, in seconds."""
+    NatronEngine.natron.getSettings().getParam("transformCatSupport").setValue(concatenate)
+    start = time.time()
+    app.render(writer, 1, framesCount)
+    return time.time() - start
+
+
+def runBenchmark(app, chainLengths=(5, 10, 20), framesCount=50):
+    outputDir = tempfile.mkdtemp()
+    results = []
+    run = 0
+    for chainLength in chainLengths:
+        writer, transforms = makeTransformChain(app, chainLength, os.path.join(outputDir, "chain%d_####.exr" % chainLength))
+        animateChain(transforms, framesCount, run)
+        run += 1
+        concatenated = renderChain(app, writer, framesCount, True)
+        animateChain(transforms, framesCount, run)
+        run += 1
+        resampled = renderChain(app, writer, framesCount, False)
+        results.append( (chainLength, concatenated, resampled) )
+        print("%d transforms: %.2f s concatenated, %.2f s resampled at each step (x%.1f)" %
+              (chainLength, concatenated, resampled, resampled / max(concatenated, 1e-6)))
+    NatronEngine.natron.getSettings().getParam("transformCatSupport").setValue(True)
+    return results
+
+
+def _getApp():
+    try:
+        return app
+    except NameError:
+        return app1
+
+
+if __name__ == "__main__" or "app1" in globals():
+    frames = int( os.environ.get("NATRON_BENCHMARK_FRAMES", "50") )
+    lengths = [int(l) for l in os.environ.get("NATRON_BENCHMARK_CHAIN_LENGTHS", "5,10,20").split(",")]
+    runBenchmark(_getApp(), lengths, frames)
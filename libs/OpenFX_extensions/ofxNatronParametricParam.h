@@ -0,0 +1,84 @@
+#ifndef _ofxNatronParametricParam_h_
+#define _ofxNatronParametricParam_h_
+
+/*
+ Software License :
+
+ Copyright (c) 2021, The Natron developers. All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice,
+ this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+ * Neither the name of the copyright holder nor the names of its
+ contributors may be used to endorse or promote products derived from this
+ software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file ofxNatronParametricParam.h
+ Natron extension to the parametric parameter suite, to evaluate a parametric curve at many positions in a single call.
+ */
+
+#include "ofxParametricParam.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief string value to the ::kOfxPropType property for the Natron parametric parameter suite */
+#define kNatronParametricParameterSuite "NatronParametricParameterSuite"
+
+/** @brief The Natron extension to the OFX Parametric Parameter Suite.
+
+ Plug-ins building a lookup table from a parametric parameter (e.g. color curves) would otherwise call
+ OfxParametricParameterSuiteV1::parametricParamGetValue() once per entry. This suite evaluates all the
+ entries in a single call.
+ */
+typedef struct NatronParametricParameterSuiteV1 {
+  /** @brief Evaluates a parametric parameter at several positions
+
+      \arg param                 handle to the parametric parameter
+      \arg curveIndex            which dimension to evaluate
+      \arg time                  the time to evaluate to the parametric param at
+      \arg nSamples              the number of positions to evaluate
+      \arg parametricPositions   nSamples positions to evaluate the parametric param at, or NULL to evaluate
+                                 it at nSamples evenly spaced positions covering the parametric range
+                                 (::kOfxParamPropParametricRange), both ends included
+      \arg returnValues          pointer to nSamples doubles where the values are returned
+
+      When parametricPositions is NULL, the host may cache the result until the curve changes, so that
+      rebuilding a lookup table of the same size for each render is cheap.
+
+      @returns
+      - ::kOfxStatOK            - all was fine
+      - ::kOfxStatErrBadHandle  - if the paramter handle was invalid
+      - ::kOfxStatErrBadIndex   - the curve index was invalid
+   */
+  OfxStatus (*parametricParamGetValues)(OfxParamHandle param,
+                                        int   curveIndex,
+                                        OfxTime time,
+                                        int   nSamples,
+                                        const double *parametricPositions,
+                                        double *returnValues);
+} NatronParametricParameterSuiteV1;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -271,6 +271,33 @@ OfxStatus ParametricInstance::deleteAllKeys()
     return kOfxStatErrMissingHostFeature;
 }
 
+OfxStatus ParametricInstance::getValues(int curveIndex,OfxTime time,int nSamples,const double* parametricPositions,double *returnValues)
+{
+    if (nSamples < 0) {
+        return kOfxStatErrValue;
+    }
+    double min = 0., max = 1.;
+    if (!parametricPositions) {
+        min = getProperties().getDoubleProperty(kOfxParamPropParametricRange, 0);
+        max = getProperties().getDoubleProperty(kOfxParamPropParametricRange, 1);
+    }
+    for (int i = 0; i < nSamples; ++i) {
+        double position;
+        if (parametricPositions) {
+            position = parametricPositions[i];
+        } else if (i == nSamples - 1) {
+            position = max;
+        } else {
+            position = min + i * (max - min) / (nSamples - 1);
+        }
+        OfxStatus stat = getValue(curveIndex, time, position, &returnValues[i]);
+        if (stat != kOfxStatOK) {
+            return stat;
+        }
+    }
+    return kOfxStatOK;
+}
+
 OfxStatus ParametricInstance::getNControlPoints(int /*curveIndex*/,double /*time*/,int */*returnValue*/)
 {
     return kOfxStatErrMissingHostFeature;
@@ -398,6 +425,44 @@ static OfxStatus parametricParamGetValue(OfxParamHandle param,
 }
 
 
+/** @brief Evaluates a parametric parameter at several positions, see NatronParametricParameterSuiteV1
+             */
+static OfxStatus parametricParamGetValues(OfxParamHandle param,
+                                          int   curveIndex,
+                                          OfxTime time,
+                                          int   nSamples,
+                                          const double *parametricPositions,
+                                          double *returnValues){
+#   ifdef OFX_DEBUG_PARAMETERS
+    std::cout << "OFX: parametricParamGetValues - " << param << " ...";
+#   endif
+    Param::Base *base = reinterpret_cast<Param::Base*>(param);
+    if(!base || !base->verifyMagic()) {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(kOfxStatErrBadHandle) << std::endl;
+#       endif
+        return kOfxStatErrBadHandle;
+    }
+
+    ParametricInstance* instance = dynamic_cast<ParametricInstance*>(base);
+    if(!instance || !instance->isInitialized()) {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(kOfxStatErrBadHandle) << std::endl;
+#       endif
+        return kOfxStatErrBadHandle;
+    }
+
+
+    OfxStatus stat = instance->getValues(curveIndex, time, nSamples, parametricPositions, returnValues);
+
+#   ifdef OFX_DEBUG_PARAMETERS
+    std::cout << ' ' << StatStr(stat) << std::endl;
+#   endif
+    return stat;
+
+}
+
+
 /** @brief Returns the number of control points in the parametric param.
 
              \arg param                 handle to the parametric parameter
@@ -1155,6 +1220,10 @@ static OfxParametricParameterSuiteV2 gSuite2 = {
 };
 #endif // #ifdef OFX_SUPPORTS_PARAMETRIC_V2
 
+static NatronParametricParameterSuiteV1 gNatronSuite = {
+    parametricParamGetValues
+};
+
 /// return the OFX function suite that manages parametric params
 void *GetSuite(int version)
 {
@@ -1169,6 +1238,15 @@ void *GetSuite(int version)
     return NULL;
 }
 
+/// return the Natron extension to the parametric params suite
+void *GetNatronSuite(int version)
+{
+    if (version == 1) {
+        return (void *)(&gNatronSuite);
+    }
+    return NULL;
+}
+
 } //namespace ParametricParam
 
 } //namespace Host
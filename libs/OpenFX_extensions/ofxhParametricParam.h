@@ -30,6 +30,7 @@
 
 // parametric params
 #include "ofxParametricParam.h"
+#include "ofxNatronParametricParam.h"
 
 #include "ofxhParam.h"
 
@@ -99,6 +100,23 @@ public:
      - ::kOfxStatErrBadIndex   - the curve index was invalid
      */
     virtual OfxStatus getValue(int curveIndex,OfxTime time,double parametricPosition,double *returnValue) = 0;
+
+    /** @brief Evaluates a parametric parameter at several positions (Natron extension)
+
+     \arg curveIndex            which dimension to evaluate
+     \arg time                  the time to evaluate to the parametric param at
+     \arg nSamples              the number of positions to evaluate
+     \arg parametricPositions   the positions to evaluate the parametric param at, or NULL for
+                                nSamples evenly spaced positions covering the parametric range
+     \arg returnValues          pointer to nSamples doubles where the values are returned
+
+     The default implementation calls getValue() for each position.
+
+     @returns
+     - ::kOfxStatOK            - all was fine
+     - ::kOfxStatErrBadIndex   - the curve index was invalid
+     */
+    virtual OfxStatus getValues(int curveIndex,OfxTime time,int nSamples,const double* parametricPositions,double *returnValues);
     
     /** @brief Returns the number of control points in the parametric param.
      
@@ -283,6 +301,9 @@ public:
 /// fetch the parametric params suite
 void *GetSuite(int version);
 
+/// fetch the Natron extension to the parametric params suite
+void *GetNatronSuite(int version);
+
 } //namespace ParametricParam
 
 } //namespace Host